@@ -0,0 +1,266 @@
+// File: vssim_bench.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+#include "ssd.h"
+#include "vssim_trace_manager.h"
+
+#include <unistd.h>
+
+#define PROGRESS_INTERVAL	1000000
+#define PRECOND_OVERWRITE_NB	2
+
+void PRINT_USAGE(char* name)
+{
+	printf("Usage: %s [-t blktrace|msr|spc] [-n request_nb] [-c] [-s] \\\n", name);
+	printf("	[-p seq|rand|trace] [-o overwrite_nb] [-b io_sector_nb] [-w request_nb] [trace_file]\n");
+	printf("  -t : trace format (default: blktrace)\n");
+	printf("  -n : replay only the first request_nb requests\n");
+	printf("  -c : closed loop, ignore the arrival time of the trace\n");
+	printf("  -s : write with the stream ID of the trace (MSR disk number, SPC ASU)\n");
+	printf("  -p : precondition the SSD without the timing before the replay (PAGE_MAP only)\n");
+	printf("       seq : sequential fill, rand : sequential fill and random overwrites,\n");
+	printf("       trace : the writes of the first request_nb (-w) requests of the trace\n");
+	printf("  -o : random overwrites of the SSD capacity (default: %d)\n", PRECOND_OVERWRITE_NB);
+	printf("  -b : IO size of seq & rand in SSD sectors (default: a page)\n");
+	printf("  -w : requests of the trace prefix, the replay starts after them\n");
+	printf("The SSD configuration is read from ./data/ssd.conf\n");
+	printf("Without trace_file, the preconditioned SSD is saved to ./data and the replay is skipped\n");
+}
+
+/* Trace sector to SSD sector, wrap around the SSD capacity */
+void GET_SSD_REQUEST(trace_entry* t_entry, int64_t* sector_nb, unsigned int* length)
+{
+	*sector_nb = t_entry->sector_nb * 512 / SECTOR_SIZE;
+	*length = (t_entry->length * 512 + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+	*sector_nb = *sector_nb % SECTOR_NB;
+	if(*sector_nb + *length > SECTOR_NB){
+		*length = SECTOR_NB - *sector_nb;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int opt;
+	int trace_type = TRACE_BLKTRACE;
+	int closed_loop = 0;
+	int use_stream = 0;
+	int64_t max_request_nb = -1;
+	int precond_pattern = -1;
+	int overwrite_nb = PRECOND_OVERWRITE_NB;
+	unsigned int io_sector_nb = 0;
+	int64_t prefix_request_nb = -1;
+	int64_t precond_request_nb = 0;
+	char* trace_file = NULL;
+
+	trace_entry t_entry;
+	int64_t base_time;
+	int64_t first_arrival_time = 0;
+	int64_t arrival_time;
+	int64_t sector_nb;
+	unsigned int length;
+
+	int64_t request_nb = 0;
+	int64_t read_request_nb = 0;
+	int64_t write_request_nb = 0;
+	int64_t trim_request_nb = 0;
+	int64_t read_sector_nb = 0;
+	int64_t write_sector_nb = 0;
+
+	int64_t wall_start;
+	int64_t wall_time;
+	int64_t sim_time;
+
+	while((opt = getopt(argc, argv, "t:n:csp:o:b:w:h")) != -1){
+		switch(opt){
+			case 't':
+				trace_type = GET_TRACE_TYPE(optarg);
+				if(trace_type == -1){
+					printf("ERROR[%s] Unknown trace format %s\n", __FUNCTION__, optarg);
+					PRINT_USAGE(argv[0]);
+					return 1;
+				}
+				break;
+
+			case 'n':
+				max_request_nb = atoll(optarg);
+				break;
+
+			case 'c':
+				closed_loop = 1;
+				break;
+
+			case 's':
+				use_stream = 1;
+				break;
+
+			case 'p':
+#ifdef PAGE_MAP
+				precond_pattern = GET_PRECONDITION_PATTERN(optarg);
+				if(precond_pattern == -1){
+					printf("ERROR[%s] Unknown precondition pattern %s\n", __FUNCTION__, optarg);
+					PRINT_USAGE(argv[0]);
+					return 1;
+				}
+				break;
+#else
+				printf("ERROR[%s] The preconditioning is only for PAGE_MAP\n", __FUNCTION__);
+				return 1;
+#endif
+
+			case 'o':
+				overwrite_nb = atoi(optarg);
+				break;
+
+			case 'b':
+				io_sector_nb = (unsigned int)atoi(optarg);
+				break;
+
+			case 'w':
+				prefix_request_nb = atoll(optarg);
+				break;
+
+			default:
+				PRINT_USAGE(argv[0]);
+				return 1;
+		}
+	}
+
+	if(optind < argc){
+		trace_file = argv[optind];
+	}
+
+	/* Only the preconditioning runs without a trace */
+	if(trace_file == NULL && precond_pattern == -1){
+		PRINT_USAGE(argv[0]);
+		return 1;
+	}
+#ifdef PAGE_MAP
+	if(precond_pattern == PRECOND_TRACE && (trace_file == NULL || prefix_request_nb < 0)){
+		PRINT_USAGE(argv[0]);
+		return 1;
+	}
+#endif
+
+	if(trace_file != NULL && OPEN_TRACE(trace_file, trace_type) == FAIL){
+		return 1;
+	}
+
+	/* The virtual clock never waits for the host clock */
+	SET_VTIME_MODE(VTIME_OFFLINE);
+	SSD_INIT();
+
+#ifdef PAGE_MAP
+	/* Steady state of the SSD at the memory speed, the replay starts from it */
+	if(precond_pattern != -1){
+		wall_start = get_wall_usec();
+		START_PRECONDITION();
+
+		if(precond_pattern == PRECOND_TRACE){
+			while(precond_request_nb < prefix_request_nb \
+					&& GET_NEXT_TRACE_ENTRY(&t_entry) == SUCCESS){
+
+				/* The reads do not change the SSD */
+				if(t_entry.io_type == WRITE){
+					GET_SSD_REQUEST(&t_entry, &sector_nb, &length);
+					PRECONDITION_WRITE((int32_t)sector_nb, length, \
+							use_stream == 1 ? t_entry.stream_id + 1 : 0);
+				}
+				else if(t_entry.io_type == TRIM){
+					GET_SSD_REQUEST(&t_entry, &sector_nb, &length);
+					SSD_TRIM(length, (int32_t)sector_nb);
+				}
+				precond_request_nb++;
+			}
+		}
+		else{
+			FTL_PRECONDITION(precond_pattern, overwrite_nb, io_sector_nb);
+		}
+
+		END_PRECONDITION();
+		printf("Precondition Time	%.3lf sec (%lld trace requests)\n", \
+				(double)(get_wall_usec() - wall_start) / 1000000, (long long)precond_request_nb);
+	}
+#endif
+
+	base_time = GET_VIRTUAL_TIME();
+	wall_start = get_wall_usec();
+
+	while(trace_file != NULL && (max_request_nb < 0 || request_nb < max_request_nb)){
+
+		if(GET_NEXT_TRACE_ENTRY(&t_entry) == FAIL){
+			break;
+		}
+
+		GET_SSD_REQUEST(&t_entry, &sector_nb, &length);
+
+#ifdef PAGE_MAP
+		/* The replay after a trace prefix starts at its first request */
+		if(request_nb == 0 && precond_pattern == PRECOND_TRACE){
+			first_arrival_time = t_entry.arrival_time;
+		}
+#endif
+
+		/* Idle time until the arrival of the request */
+		if(closed_loop == 0){
+			arrival_time = base_time + t_entry.arrival_time - first_arrival_time;
+			if(arrival_time > GET_VIRTUAL_TIME()){
+				SSD_IDLE(arrival_time - GET_VIRTUAL_TIME());
+			}
+			if(arrival_time > GET_VIRTUAL_TIME()){
+				SET_VIRTUAL_TIME(arrival_time);
+			}
+		}
+
+		if(t_entry.io_type == WRITE){
+			/* Stream ID 0 means no hint */
+			if(use_stream == 1){
+				SSD_WRITE_STREAM(length, (int32_t)sector_nb, t_entry.stream_id + 1);
+			}
+			else{
+				SSD_WRITE(length, (int32_t)sector_nb);
+			}
+			write_request_nb++;
+			write_sector_nb += length;
+		}
+		else if(t_entry.io_type == TRIM){
+			SSD_TRIM(length, (int32_t)sector_nb);
+			trim_request_nb++;
+		}
+		else{
+			SSD_READ(length, (int32_t)sector_nb);
+			read_request_nb++;
+			read_sector_nb += length;
+		}
+		request_nb++;
+
+		if(request_nb % PROGRESS_INTERVAL == 0){
+			printf("[%s] %lld requests, simulated %.3lf sec\n", __FUNCTION__, \
+				(long long)request_nb, \
+				(double)(GET_VIRTUAL_TIME() - base_time) / 1000000);
+		}
+	}
+
+	/* Flush the buffered requests and the pending NAND operations */
+	SSD_TERM();
+	if(trace_file != NULL){
+		CLOSE_TRACE();
+	}
+
+	sim_time = GET_VIRTUAL_TIME() - base_time;
+	wall_time = get_wall_usec() - wall_start;
+
+	printf("Replayed Requests	%lld (read %lld, write %lld, trim %lld)\n", (long long)request_nb, \
+			(long long)read_request_nb, (long long)write_request_nb, (long long)trim_request_nb);
+	printf("Read Sectors		%lld\n", (long long)read_sector_nb);
+	printf("Write Sectors		%lld\n", (long long)write_sector_nb);
+	printf("Simulated Time		%.3lf sec\n", (double)sim_time / 1000000);
+	printf("Wall Clock Time		%.3lf sec\n", (double)wall_time / 1000000);
+
+	return 0;
+}
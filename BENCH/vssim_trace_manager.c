@@ -0,0 +1,224 @@
+// File: vssim_trace_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+#include "vssim_trace_manager.h"
+
+#include <ctype.h>
+
+FILE* fp_trace;
+int trace_format;
+
+int64_t first_arrival_time;
+int first_entry;
+
+int64_t trace_line_nb;
+
+int GET_TRACE_TYPE(char* type_name)
+{
+	if(strcmp(type_name, "blktrace") == 0){
+		return TRACE_BLKTRACE;
+	}
+	else if(strcmp(type_name, "msr") == 0){
+		return TRACE_MSR;
+	}
+	else if(strcmp(type_name, "spc") == 0){
+		return TRACE_SPC;
+	}
+
+	return -1;
+}
+
+int OPEN_TRACE(char* file_name, int trace_type)
+{
+	if(trace_type != TRACE_BLKTRACE && trace_type != TRACE_MSR \
+			&& trace_type != TRACE_SPC){
+		printf("ERROR[%s] Wrong trace type %d\n", __FUNCTION__, trace_type);
+		return FAIL;
+	}
+
+	fp_trace = fopen(file_name, "r");
+	if(fp_trace == NULL){
+		printf("ERROR[%s] Open %s fail\n", __FUNCTION__, file_name);
+		return FAIL;
+	}
+
+	trace_format = trace_type;
+	first_arrival_time = 0;
+	first_entry = 1;
+	trace_line_nb = 0;
+
+	return SUCCESS;
+}
+
+void CLOSE_TRACE(void)
+{
+	if(fp_trace != NULL){
+		fclose(fp_trace);
+		fp_trace = NULL;
+	}
+}
+
+int GET_NEXT_TRACE_ENTRY(trace_entry* t_entry)
+{
+	char line[TRACE_LINE_SIZE];
+	int ret = FAIL;
+
+	while(fgets(line, TRACE_LINE_SIZE, fp_trace) != NULL){
+
+		trace_line_nb++;
+
+		switch(trace_format){
+			case TRACE_BLKTRACE:
+				ret = PARSE_BLKTRACE_LINE(line, t_entry);
+				break;
+
+			case TRACE_MSR:
+				ret = PARSE_MSR_LINE(line, t_entry);
+				break;
+
+			case TRACE_SPC:
+				ret = PARSE_SPC_LINE(line, t_entry);
+				break;
+
+			default:
+				ret = FAIL;
+				break;
+		}
+
+		/* Skip headers, summaries and non read/write requests */
+		if(ret == FAIL || t_entry->length == 0){
+			continue;
+		}
+
+		/* Arrival time is relative to the first request */
+		if(first_entry == 1){
+			first_arrival_time = t_entry->arrival_time;
+			first_entry = 0;
+		}
+		t_entry->arrival_time -= first_arrival_time;
+		if(t_entry->arrival_time < 0){
+			t_entry->arrival_time = 0;
+		}
+
+		return SUCCESS;
+	}
+
+	return FAIL;
+}
+
+/* ex) 8,0    3        1     0.000000000   697  Q   W 223490 + 8 [kjournald] */
+int PARSE_BLKTRACE_LINE(char* line, trace_entry* t_entry)
+{
+	double time;
+	char action[8];
+	char rwbs[16];
+	long long int sector_nb;
+	unsigned int length;
+	int ret;
+
+	ret = sscanf(line, "%*s %*d %*u %lf %*d %7s %15s %lld + %u", \
+			&time, action, rwbs, &sector_nb, &length);
+	if(ret != 5){
+		return FAIL;
+	}
+
+	/* Only the requests queued by the host */
+	if(strcmp(action, "Q") != 0){
+		return FAIL;
+	}
+
+	/* Discards are "D" or "DS", checked before the writes */
+	if(strchr(rwbs, 'D') != NULL){
+		t_entry->io_type = TRIM;
+	}
+	else if(strchr(rwbs, 'W') != NULL){
+		t_entry->io_type = WRITE;
+	}
+	else if(strchr(rwbs, 'R') != NULL){
+		t_entry->io_type = READ;
+	}
+	else{
+		return FAIL;
+	}
+
+	t_entry->arrival_time = (int64_t)(time * 1000000);
+	t_entry->sector_nb = sector_nb;
+	t_entry->length = length;
+	t_entry->stream_id = 0;
+
+	return SUCCESS;
+}
+
+/* ex) 128166372003061629,hm,1,Read,3154128896,4096,4927 */
+int PARSE_MSR_LINE(char* line, trace_entry* t_entry)
+{
+	long long int timestamp;
+	int disk_nb;
+	char type[16];
+	long long int offset;
+	unsigned int size;
+	int ret;
+
+	ret = sscanf(line, "%lld,%*[^,],%d,%15[^,],%lld,%u", \
+			&timestamp, &disk_nb, type, &offset, &size);
+	if(ret != 5){
+		return FAIL;
+	}
+
+	if(strcasecmp(type, "Write") == 0){
+		t_entry->io_type = WRITE;
+	}
+	else if(strcasecmp(type, "Read") == 0){
+		t_entry->io_type = READ;
+	}
+	else{
+		return FAIL;
+	}
+
+	/* Windows filetime, 100 nsec unit */
+	t_entry->arrival_time = (int64_t)(timestamp / 10);
+	t_entry->sector_nb = offset / 512;
+	t_entry->length = (size + 511) / 512;
+	t_entry->stream_id = disk_nb;
+
+	return SUCCESS;
+}
+
+/* ex) 0,20941264,8192,W,0.551706 */
+int PARSE_SPC_LINE(char* line, trace_entry* t_entry)
+{
+	int asu;
+	long long int lba;
+	unsigned int size;
+	char opcode;
+	double time;
+	int ret;
+
+	ret = sscanf(line, "%d,%lld,%u,%c,%lf", &asu, &lba, &size, &opcode, &time);
+	if(ret != 5){
+		return FAIL;
+	}
+
+	opcode = toupper(opcode);
+	if(opcode == 'W'){
+		t_entry->io_type = WRITE;
+	}
+	else if(opcode == 'R'){
+		t_entry->io_type = READ;
+	}
+	else{
+		return FAIL;
+	}
+
+	t_entry->arrival_time = (int64_t)(time * 1000000);
+	t_entry->sector_nb = lba;
+	t_entry->length = (size + 511) / 512;
+	t_entry->stream_id = asu;
+
+	return SUCCESS;
+}
@@ -0,0 +1,38 @@
+// File: vssim_trace_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _TRACE_MANAGER_H_
+#define _TRACE_MANAGER_H_
+
+/* Trace Format */
+#define TRACE_BLKTRACE	0	// blkparse text output, "Q" events
+#define TRACE_MSR	1	// MSR-Cambridge CSV
+#define TRACE_SPC	2	// SPC (UMass) ASU,LBA,Size,Opcode,Timestamp
+
+#define TRACE_LINE_SIZE	1024
+
+typedef struct trace_entry
+{
+	int64_t arrival_time;	// usec from the first request
+	int io_type;		// READ, WRITE, TRIM (blktrace discards)
+	int64_t sector_nb;	// 512 byte sector
+	unsigned int length;	// sector count
+	int stream_id;		// MSR disk number, SPC ASU, 0 for blktrace
+}trace_entry;
+
+int GET_TRACE_TYPE(char* type_name);
+
+int OPEN_TRACE(char* file_name, int trace_type);
+void CLOSE_TRACE(void);
+
+int GET_NEXT_TRACE_ENTRY(trace_entry* t_entry);
+
+int PARSE_BLKTRACE_LINE(char* line, trace_entry* t_entry);
+int PARSE_MSR_LINE(char* line, trace_entry* t_entry);
+int PARSE_SPC_LINE(char* line, trace_entry* t_entry);
+
+#endif
@@ -71,6 +71,27 @@ int CHANNEL_SWITCH_DELAY_R;
 
 int DSM_TRIM_ENABLE;
 int IO_PARALLELISM;
+int CACHE_MODE;		// 1 : Cache program & cache read of the planes
+
+/* Channel Bandwidth : 0 CHANNEL_RATE for the REG_WRITE_DELAY & REG_READ_DELAY of the file */
+int CHANNEL_RATE;		// MT/s
+int CHANNEL_BUS_WIDTH;		// bit
+int CHANNEL_CMD_DELAY;		// Command & address cycles (us)
+
+/* IO Scheduler of the die queues */
+int IO_SCHEDULER;		// 0 : FIFO, 1 : READ_FIRST, 2 : DEADLINE
+int SCHED_EXPIRE_TIME;		// Max wait of the queued commands for DEADLINE (us)
+int SCHED_QUEUE_DEPTH;		// Max queued commands of a plane
+
+/* Program & Erase Suspend for the host reads */
+int PROGRAM_SUSPEND;		// 1 : A host read suspends the program of the plane
+int ERASE_SUSPEND;		// 1 : A host read suspends the erase of the plane
+int SUSPEND_DELAY;		// The array stops after the suspend command (us)
+int RESUME_DELAY;		// The command goes on after the resume command (us)
+int SUSPEND_LIMIT;		// Max suspends of a program or an erase
+
+/* Metadata Checkpoint */
+int CHECKPOINT_INTERVAL;	// Journal records between the checkpoints
 
 /* Garbage Collection */
 #if defined PAGE_MAP || defined BLOCK_MAP || defined DA_MAP
@@ -86,6 +107,21 @@ int GC_VICTIM_NB;
 uint32_t WRITE_BUFFER_FRAME_NB;		// 8192 for 4MB with 512B Sector size
 uint32_t READ_BUFFER_FRAME_NB;
 
+/* Wear Leveling */
+#ifdef FTL_WEAR_LEVELING
+unsigned int WL_THRESHOLD;
+#endif
+
+/* Multi Stream */
+#ifdef FTL_MULTI_STREAM
+int STREAM_NB;
+#endif
+
+/* Sub-page Mapping */
+#ifdef FTL_SUB_PAGE
+int SUB_PAGE_LOG_NB;
+#endif
+
 /* Map Cache */
 #if defined FTL_MAP_CACHE || defined Polymorphic_FTL
 int CACHE_IDX_SIZE;
@@ -139,6 +175,10 @@ void INIT_SSD_CONFIG(void)
 	
 	szCommand = (char*)malloc(1024);
 	memset(szCommand, 0x00, 1024);
+#ifdef FTL_MULTI_STREAM
+	int64_t spare_block_nb;
+	int max_stream_nb;
+#endif
 	if(pfData!=NULL)
 	{
 		while(fscanf(pfData, "%s", szCommand)!=EOF)
@@ -211,6 +251,58 @@ void INIT_SSD_CONFIG(void)
 			{
 				fscanf(pfData, "%d", &IO_PARALLELISM);
 			}
+			else if(strcmp(szCommand, "CACHE_MODE") == 0)
+			{
+				fscanf(pfData, "%d", &CACHE_MODE);
+			}
+			else if(strcmp(szCommand, "CHANNEL_RATE") == 0)
+			{
+				fscanf(pfData, "%d", &CHANNEL_RATE);
+			}
+			else if(strcmp(szCommand, "CHANNEL_BUS_WIDTH") == 0)
+			{
+				fscanf(pfData, "%d", &CHANNEL_BUS_WIDTH);
+			}
+			else if(strcmp(szCommand, "CHANNEL_CMD_DELAY") == 0)
+			{
+				fscanf(pfData, "%d", &CHANNEL_CMD_DELAY);
+			}
+			else if(strcmp(szCommand, "IO_SCHEDULER") == 0)
+			{
+				fscanf(pfData, "%d", &IO_SCHEDULER);
+			}
+			else if(strcmp(szCommand, "SCHED_EXPIRE_TIME") == 0)
+			{
+				fscanf(pfData, "%d", &SCHED_EXPIRE_TIME);
+			}
+			else if(strcmp(szCommand, "SCHED_QUEUE_DEPTH") == 0)
+			{
+				fscanf(pfData, "%d", &SCHED_QUEUE_DEPTH);
+			}
+			else if(strcmp(szCommand, "PROGRAM_SUSPEND") == 0)
+			{
+				fscanf(pfData, "%d", &PROGRAM_SUSPEND);
+			}
+			else if(strcmp(szCommand, "ERASE_SUSPEND") == 0)
+			{
+				fscanf(pfData, "%d", &ERASE_SUSPEND);
+			}
+			else if(strcmp(szCommand, "SUSPEND_DELAY") == 0)
+			{
+				fscanf(pfData, "%d", &SUSPEND_DELAY);
+			}
+			else if(strcmp(szCommand, "RESUME_DELAY") == 0)
+			{
+				fscanf(pfData, "%d", &RESUME_DELAY);
+			}
+			else if(strcmp(szCommand, "SUSPEND_LIMIT") == 0)
+			{
+				fscanf(pfData, "%d", &SUSPEND_LIMIT);
+			}
+			else if(strcmp(szCommand, "CHECKPOINT_INTERVAL") == 0)
+			{
+				fscanf(pfData, "%d", &CHECKPOINT_INTERVAL);
+			}
 			else if(strcmp(szCommand, "CHANNEL_NB") == 0)
 			{
 				fscanf(pfData, "%d", &CHANNEL_NB);
@@ -219,6 +311,34 @@ void INIT_SSD_CONFIG(void)
 			{
 				fscanf(pfData, "%d", &OVP);
 			}
+#if defined PAGE_MAP || defined BLOCK_MAP || defined DA_MAP
+			else if(strcmp(szCommand, "GC_THRESHOLD") == 0)
+			{
+				fscanf(pfData, "%lf", &GC_THRESHOLD);
+			}
+			else if(strcmp(szCommand, "GC_THRESHOLD_HARD") == 0)
+			{
+				fscanf(pfData, "%lf", &GC_THRESHOLD_HARD);
+			}
+#endif
+#ifdef FTL_WEAR_LEVELING
+			else if(strcmp(szCommand, "WL_THRESHOLD") == 0)
+			{
+				fscanf(pfData, "%u", &WL_THRESHOLD);
+			}
+#endif
+#ifdef FTL_MULTI_STREAM
+			else if(strcmp(szCommand, "STREAM_NB") == 0)
+			{
+				fscanf(pfData, "%d", &STREAM_NB);
+			}
+#endif
+#ifdef FTL_SUB_PAGE
+			else if(strcmp(szCommand, "SUB_PAGE_LOG_NB") == 0)
+			{
+				fscanf(pfData, "%d", &SUB_PAGE_LOG_NB);
+			}
+#endif
 #if defined FTL_MAP_CACHE || defined Polymorphic_FTL
 			else if(strcmp(szCommand, "CACHE_IDX_SIZE") == 0)
 			{
@@ -281,6 +401,37 @@ void INIT_SSD_CONFIG(void)
 	WAY_NB = FLASH_NB / CHANNEL_NB;
 #endif
 
+	/* Channel Bandwidth : the page transfer time of the bus */
+	if(CHANNEL_RATE != 0){
+		if(CHANNEL_BUS_WIDTH == 0){
+			CHANNEL_BUS_WIDTH = 8;
+		}
+		REG_WRITE_DELAY = (int)(((int64_t)PAGE_SIZE * 8 + (int64_t)CHANNEL_RATE * CHANNEL_BUS_WIDTH / 2) \
+				/ ((int64_t)CHANNEL_RATE * CHANNEL_BUS_WIDTH));
+		if(REG_WRITE_DELAY == 0){
+			REG_WRITE_DELAY = 1;
+		}
+		REG_READ_DELAY = REG_WRITE_DELAY;
+	}
+
+	/* IO Scheduler */
+	if(SCHED_EXPIRE_TIME == 0){
+		SCHED_EXPIRE_TIME = BLOCK_ERASE_DELAY * 4;
+	}
+	if(SCHED_QUEUE_DEPTH == 0){
+		SCHED_QUEUE_DEPTH = PAGE_NB;
+	}
+
+	/* Program & Erase Suspend */
+	if(SUSPEND_LIMIT == 0){
+		SUSPEND_LIMIT = 1;
+	}
+
+	/* Metadata Checkpoint */
+	if(CHECKPOINT_INTERVAL == 0){
+		CHECKPOINT_INTERVAL = 4 * 1024 * 1024;
+	}
+
 	/* Mapping Table */
 	BLOCK_MAPPING_ENTRY_NB = (int64_t)BLOCK_NB * (int64_t)FLASH_NB;
 	PAGES_IN_SSD = (int64_t)PAGE_NB * (int64_t)BLOCK_NB * (int64_t)FLASH_NB;
@@ -350,11 +501,28 @@ void INIT_SSD_CONFIG(void)
 
 	/* Garbage Collection */
 #if defined PAGE_MAP || defined BLOCK_MAP || defined DA_MAP
-	GC_THRESHOLD = 0.95; // 0.7 for 70%, 0.9 for 90%
-	GC_THRESHOLD_HARD = 0.98;
+	if(GC_THRESHOLD == 0){
+		GC_THRESHOLD = 0.95; // 0.7 for 70%, 0.9 for 90%
+	}
+	if(GC_THRESHOLD_HARD == 0){
+		GC_THRESHOLD_HARD = 0.98;
+	}
 	GC_THRESHOLD_BLOCK_NB = (int)((1-GC_THRESHOLD) * (double)BLOCK_MAPPING_ENTRY_NB);
 	GC_THRESHOLD_BLOCK_NB_HARD = (int)((1-GC_THRESHOLD_HARD) * (double)BLOCK_MAPPING_ENTRY_NB);
+
+	/* Foreground GC needs an empty block in each plane */
+	if(GC_THRESHOLD_BLOCK_NB_HARD < FLASH_NB * PLANES_PER_FLASH){
+		GC_THRESHOLD_BLOCK_NB_HARD = FLASH_NB * PLANES_PER_FLASH;
+	}
+	if(GC_THRESHOLD_BLOCK_NB < GC_THRESHOLD_BLOCK_NB_HARD){
+		GC_THRESHOLD_BLOCK_NB = GC_THRESHOLD_BLOCK_NB_HARD;
+	}
 	GC_THRESHOLD_BLOCK_NB_EACH = (int)((1-GC_THRESHOLD) * (double)EACH_EMPTY_TABLE_ENTRY_NB);
+
+	/* Per plane GC needs the open block & an empty block for the copies */
+	if(GC_THRESHOLD_BLOCK_NB_EACH < 2){
+		GC_THRESHOLD_BLOCK_NB_EACH = 2;
+	}
 	if(OVP != 0){
 		GC_VICTIM_NB = FLASH_NB * BLOCK_NB * OVP / 100 / 2;
 	}
@@ -363,11 +531,64 @@ void INIT_SSD_CONFIG(void)
 	}
 #endif
 
+	/* Wear Leveling */
+#ifdef FTL_WEAR_LEVELING
+	if(WL_THRESHOLD == 0){
+		WL_THRESHOLD = 100;	// Erase count spread to move the cold data
+	}
+#endif
+
+	/* Multi Stream : the stream 0 for GC & the streams for the host data */
+#ifdef FTL_MULTI_STREAM
+	/* Each host stream keeps an open block in each plane out of the spare blocks,
+		the open blocks may take an eighth of them at most */
+	if(OVP != 0){
+		spare_block_nb = BLOCK_MAPPING_ENTRY_NB * OVP / 100;
+	}
+	else{
+		spare_block_nb = GC_THRESHOLD_BLOCK_NB;
+	}
+	max_stream_nb = 1 + (int)(spare_block_nb / 8 / (FLASH_NB * PLANES_PER_FLASH));
+
+	if(STREAM_NB == 0){
+		STREAM_NB = 4;
+		if(STREAM_NB > max_stream_nb){
+			STREAM_NB = max_stream_nb;
+		}
+	}
+	else if(STREAM_NB < 2){
+		STREAM_NB = 2;
+	}
+	else if(STREAM_NB > 256){
+		STREAM_NB = 256;
+	}
+
+	/* With 1 stream, the host data is written to the stream 0 like the single stream FTL */
+	if(STREAM_NB > max_stream_nb){
+		printf("[INIT_SSD_CONFIG] STREAM_NB %d -> %d, %lld spare blocks\n", STREAM_NB, max_stream_nb, (long long)spare_block_nb);
+		STREAM_NB = max_stream_nb;
+	}
+#endif
+
+	/* Sub-page Mapping : the log pages of the partial page writes */
+#ifdef FTL_SUB_PAGE
+	if(SUB_PAGE_LOG_NB == 0){
+		SUB_PAGE_LOG_NB = (int)(PAGES_IN_SSD / 256);
+	}
+	if(SUB_PAGE_LOG_NB < 64){
+		SUB_PAGE_LOG_NB = 64;
+	}
+#endif
+
 	/* Map Cache */
 #ifdef FTL_MAP_CACHE
+	/* The translation block is out of the empty pool too */
+	GC_THRESHOLD_BLOCK_NB_HARD += 1;
+	GC_THRESHOLD_BLOCK_NB += 1;
+
 	MAP_ENTRY_SIZE = sizeof(int32_t);
 	MAP_ENTRIES_PER_PAGE = PAGE_SIZE / MAP_ENTRY_SIZE;
-	MAP_ENTRY_NB = PAGE_MAPPING_ENTRY_NB / MAP_ENTRIES_PER_PAGE;	
+	MAP_ENTRY_NB = (PAGE_MAPPING_ENTRY_NB + MAP_ENTRIES_PER_PAGE - 1) / MAP_ENTRIES_PER_PAGE;
 #endif
 
 	/* Polymorphic FTL */
@@ -75,10 +75,32 @@ extern int CHANNEL_SWITCH_DELAY_W;
 
 extern int DSM_TRIM_ENABLE;
 extern int IO_PARALLELISM;
+extern int CACHE_MODE;
+
+/* Channel Bandwidth */
+extern int CHANNEL_RATE;
+extern int CHANNEL_BUS_WIDTH;
+extern int CHANNEL_CMD_DELAY;
+
+/* IO Scheduler */
+extern int IO_SCHEDULER;
+extern int SCHED_EXPIRE_TIME;
+extern int SCHED_QUEUE_DEPTH;
+
+/* Program & Erase Suspend */
+extern int PROGRAM_SUSPEND;
+extern int ERASE_SUSPEND;
+extern int SUSPEND_DELAY;
+extern int RESUME_DELAY;
+extern int SUSPEND_LIMIT;
+
+/* Metadata Checkpoint */
+extern int CHECKPOINT_INTERVAL;
 
 /* Garbage Collection */
 #if defined PAGE_MAP || defined BLOCK_MAP || defined DA_MAP
 extern double GC_THRESHOLD;
+extern double GC_THRESHOLD_HARD;
 extern int GC_THRESHOLD_BLOCK_NB;
 extern int GC_THRESHOLD_BLOCK_NB_HARD;
 extern int GC_THRESHOLD_BLOCK_NB_EACH;
@@ -89,6 +111,21 @@ extern int GC_VICTIM_NB;
 extern uint32_t WRITE_BUFFER_FRAME_NB;		// 8192 for 32MB with 4KB Page size
 extern uint32_t READ_BUFFER_FRAME_NB;
 
+/* Wear Leveling */
+#ifdef FTL_WEAR_LEVELING
+extern unsigned int WL_THRESHOLD;
+#endif
+
+/* Multi Stream */
+#ifdef FTL_MULTI_STREAM
+extern int STREAM_NB;
+#endif
+
+/* Sub-page Mapping */
+#ifdef FTL_SUB_PAGE
+extern int SUB_PAGE_LOG_NB;
+#endif
+
 /* Map Cache */
 #if defined FTL_MAP_CACHE || defined Polymorphic_FTL
 extern int CACHE_IDX_SIZE;
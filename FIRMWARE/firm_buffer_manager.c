@@ -8,9 +8,17 @@
 #include "common.h"
 #include <pthread.h>
 
+#ifdef FIRM_BUFFER_THREAD
+#include <unistd.h>
+#include <sys/eventfd.h>
+#endif
+
 event_queue* e_queue;
 event_queue* c_e_queue;
 
+/* Event entries, used by the firmware thread only */
+obj_pool event_pool;
+
 /* Global Variable for IO Buffer */
 void* write_buffer;
 void* read_buffer;
@@ -34,13 +42,23 @@ event_queue_entry* last_read_entry;
 int empty_write_buffer_frame;
 int empty_read_buffer_frame;
 
+/* Index of the valid pending write events */
+event_queue_entry* write_index_root;
+event_queue_entry** overwritten_event_list;
+int64_t write_event_seq_nb;
+unsigned int write_index_seed;
+
 #ifdef FIRM_BUFFER_THREAD
-int r_queue_full = 0;
-int w_queue_full = 0;
 pthread_t firm_buffer_thread_id;
-pthread_cond_t eq_ready = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t eq_lock = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t cq_lock = PTHREAD_MUTEX_INITIALIZER;
+int firm_buffer_thread_stop;
+int firm_buffer_thread_done;
+
+/* Host -> firmware thread, firmware thread -> host */
+io_ring sq_ring;
+io_ring cq_ring;
+
+io_waiter host_waiter;
+io_waiter firm_waiter;
 #endif
 
 void INIT_FIRM_IO_BUFFER(void)
@@ -72,6 +90,13 @@ void INIT_FIRM_IO_BUFFER(void)
 		c_e_queue->tail = NULL;
 	}
 
+	/* An event holds at least one buffer frame until it is dequeued */
+	if(INIT_POOL(&event_pool, "event", sizeof(event_queue_entry), \
+				WRITE_BUFFER_FRAME_NB + READ_BUFFER_FRAME_NB) == FAIL){
+		printf("ERROR [%s] Allocation event pool fail.\n",__FUNCTION__);
+		return;
+	}
+
 	/* Allocation Write Buffer in DRAM */
 	write_buffer = (void*)calloc(WRITE_BUFFER_FRAME_NB, SECTOR_SIZE);
 	write_buffer_end = write_buffer + WRITE_BUFFER_FRAME_NB*SECTOR_SIZE;	
@@ -99,21 +124,75 @@ void INIT_FIRM_IO_BUFFER(void)
 	empty_write_buffer_frame = WRITE_BUFFER_FRAME_NB;
 	empty_read_buffer_frame = READ_BUFFER_FRAME_NB; 
 
+	/* Initialization Pending Write Index,
+		a valid write event holds at least one write buffer frame */
+	write_index_root = NULL;
+	write_event_seq_nb = 0;
+	write_index_seed = 2463534242U;
+	overwritten_event_list = (event_queue_entry**)calloc(WRITE_BUFFER_FRAME_NB, sizeof(event_queue_entry*));
+	if(overwritten_event_list == NULL){
+		printf("ERROR [%s] Allocation write index fail.\n",__FUNCTION__);
+		return;
+	}
+
 #ifdef FIRM_BUFFER_THREAD
+	/* A pending read holds at least one read buffer frame,
+		so the completion ring is never full */
+	if(INIT_IO_RING(&sq_ring, SUBMISSION_RING_ENTRY_NB) == FAIL
+			|| INIT_IO_RING(&cq_ring, READ_BUFFER_FRAME_NB) == FAIL){
+		printf("ERROR [%s] Allocation IO ring fail.\n",__FUNCTION__);
+		return;
+	}
+	if(INIT_IO_WAITER(&host_waiter) == FAIL || INIT_IO_WAITER(&firm_waiter) == FAIL){
+		printf("ERROR [%s] Create eventfd fail.\n",__FUNCTION__);
+		return;
+	}
+	firm_buffer_thread_stop = 0;
+	firm_buffer_thread_done = 0;
+
 	pthread_create(&firm_buffer_thread_id, NULL, FIRM_BUFFER_THREAD_MAIN_LOOP, NULL);
 #endif
 }
 
 void TERM_FIRM_IO_BUFFER(void)
 {
+#ifdef FIRM_BUFFER_THREAD
+	/* The firmware thread flushes all event before it exits */
+	__atomic_store_n(&firm_buffer_thread_stop, 1, __ATOMIC_RELEASE);
+	WAKE_UP_IO_WAITER(&firm_waiter);
+
+	while(__atomic_load_n(&firm_buffer_thread_done, __ATOMIC_ACQUIRE) == 0){
+		PREPARE_IO_WAIT(&host_waiter);
+		if(__atomic_load_n(&firm_buffer_thread_done, __ATOMIC_ACQUIRE) == 0 \
+				&& IO_RING_IS_EMPTY(&cq_ring)){
+			IO_WAIT(&host_waiter);
+		}
+		else{
+			CANCEL_IO_WAIT(&host_waiter);
+		}
+
+		/* Free the read buffer frames the thread may wait for */
+		DEQUEUE_COMPLETED_HOST_READ();
+	}
+	pthread_join(firm_buffer_thread_id, NULL);
+	DEQUEUE_COMPLETED_HOST_READ();
+
+	TERM_IO_RING(&sq_ring);
+	TERM_IO_RING(&cq_ring);
+	TERM_IO_WAITER(&host_waiter);
+	TERM_IO_WAITER(&firm_waiter);
+#else
 	/* Flush all event in event queue */
 	FLUSH_EVENT_QUEUE_UNTIL(e_queue->tail);
+#endif
 
 	/* Deallocate Buffer & Event queue */
 	free(write_buffer);
 	free(read_buffer);
 	free(e_queue);
 	free(c_e_queue);
+	free(overwritten_event_list);
+	TERM_POOL(&event_pool);
 }
 
 void INIT_WB_VALID_ARRAY(void)
@@ -133,38 +212,285 @@ void INIT_WB_VALID_ARRAY(void)
 #ifdef FIRM_BUFFER_THREAD
 void *FIRM_BUFFER_THREAD_MAIN_LOOP(void *arg)
 {
+	event_queue_entry s_entry;
+
 	while(1){
-		pthread_mutex_lock(&eq_lock);
+		/* Move the submitted IO to the event queue */
+		while(IO_RING_POP(&sq_ring, &s_entry) == SUCCESS){
+
+			/* The host may wait for an empty slot */
+			WAKE_UP_IO_WAITER(&host_waiter);
 
+			/* The consecutive trims go to the FTL at once */
+			if(s_entry.io_type == TRIM){
+				INSERT_TRIM_SECTORS(s_entry.sector_nb, s_entry.length);
+				continue;
+			}
+			APPLY_TRIM_SECTORS();
+
+			if(s_entry.io_type == WRITE && EVENT_QUEUE_IS_FULL(WRITE, s_entry.length)){
+				SECURE_WRITE_BUFFER();
+			}
+			else if(s_entry.io_type == READ){
+				WAIT_READ_BUFFER_FRAME(s_entry.length);
+			}
+
+			ENQUEUE_HOST_IO(s_entry.io_type, s_entry.sector_nb, s_entry.length);
+		}
+		APPLY_TRIM_SECTORS();
+
+		/* Mode 1: Process the events right away,
+			Mode 2: Process the events only when the buffer is full */
 #if defined FIRM_BUFFER_THREAD_MODE_1
-		while(e_queue->entry_nb == 0){
-#ifdef FIRM_BUFFER_THREAD_DEBUG
-			printf("[%s] wait signal..\n",__FUNCTION__);
+		while(e_queue->entry_nb != 0){
+			DEQUEUE_HOST_IO();
+		}
 #endif
-			pthread_cond_wait(&eq_ready, &eq_lock);
+#ifdef GC_BACKGROUND
+		/* Idle, reclaim blocks until the host submits a new IO */
+		while(IO_RING_IS_EMPTY(&sq_ring) \
+				&& __atomic_load_n(&firm_buffer_thread_stop, __ATOMIC_ACQUIRE) == 0){
+			if(BACKGROUND_GARBAGE_COLLECTION() == FAIL){
+				break;
+			}
 		}
+#endif
+		if(__atomic_load_n(&firm_buffer_thread_stop, __ATOMIC_ACQUIRE) == 1 \
+				&& IO_RING_IS_EMPTY(&sq_ring)){
+			break;
+		}
+
+		/* Sleep until the host submits a new IO */
+		PREPARE_IO_WAIT(&firm_waiter);
+		if(IO_RING_IS_EMPTY(&sq_ring) \
+				&& __atomic_load_n(&firm_buffer_thread_stop, __ATOMIC_ACQUIRE) == 0){
 #ifdef FIRM_BUFFER_THREAD_DEBUG
-		printf("[%s] Get up! \n",__FUNCTION__);
+			printf("[%s] wait signal..\n",__FUNCTION__);
 #endif
-		DEQUEUE_HOST_IO();
-#elif defined FIRM_BUFFER_THREAD_MODE_2
-		while(r_queue_full == 0 && w_queue_full == 0){
-			pthread_cond_wait(&eq_ready, &eq_lock);
+			IO_WAIT(&firm_waiter);
 		}
-		if(r_queue_full == 1){
-			SECURE_READ_BUFFER();
-			r_queue_full = 0;
+		else{
+			CANCEL_IO_WAIT(&firm_waiter);
 		}
-		else if(w_queue_full == 1){
-			SECURE_WRITE_BUFFER();
-			w_queue_full = 0;
+	}
+
+	/* Flush all event in event queue */
+	FLUSH_EVENT_QUEUE_UNTIL(e_queue->tail);
+
+	__atomic_store_n(&firm_buffer_thread_done, 1, __ATOMIC_RELEASE);
+	WAKE_UP_IO_WAITER(&host_waiter);
+
+	return NULL;
+}
+
+void SUBMIT_HOST_IO(int io_type, int32_t sector_nb, unsigned int length)
+{
+	event_queue_entry s_entry;
+
+	s_entry.io_type = io_type;
+	s_entry.valid = VALID;
+	s_entry.sector_nb = sector_nb;
+	s_entry.length = length;
+	s_entry.buf = NULL;
+	s_entry.next = NULL;
+
+	/* Back pressure: wait until the firmware thread takes a slot */
+	while(IO_RING_PUSH(&sq_ring, &s_entry) == FAIL){
+
+		PREPARE_IO_WAIT(&host_waiter);
+		if(IO_RING_IS_FULL(&sq_ring) && IO_RING_IS_EMPTY(&cq_ring)){
+			IO_WAIT(&host_waiter);
+		}
+		else{
+			CANCEL_IO_WAIT(&host_waiter);
+		}
+
+		/* The firmware thread may wait for the read buffer frames */
+		DEQUEUE_COMPLETED_HOST_READ();
+	}
+
+	WAKE_UP_IO_WAITER(&firm_waiter);
+}
+
+void PUSH_COMPLETED_HOST_READ(event_queue_entry* e_q_entry)
+{
+	while(IO_RING_PUSH(&cq_ring, e_q_entry) == FAIL){
+
+		PREPARE_IO_WAIT(&firm_waiter);
+		if(IO_RING_IS_FULL(&cq_ring)){
+			IO_WAIT(&firm_waiter);
+		}
+		else{
+			CANCEL_IO_WAIT(&firm_waiter);
+		}
+	}
+
+	WAKE_UP_IO_WAITER(&host_waiter);
+}
+
+void WAIT_READ_BUFFER_FRAME(unsigned int length)
+{
+	/* The read buffer frames are freed when the host takes the completion */
+	while(EVENT_QUEUE_IS_FULL(READ, length)){
+
+		SECURE_READ_BUFFER();
+
+		PREPARE_IO_WAIT(&firm_waiter);
+		if(EVENT_QUEUE_IS_FULL(READ, length)){
+			IO_WAIT(&firm_waiter);
 		}
 		else{
-			printf("ERROR[%s] Wrong signal \n",__FUNCTION__);
+			CANCEL_IO_WAIT(&firm_waiter);
+		}
+	}
+}
+
+int INIT_IO_RING(io_ring* ring, unsigned int entry_nb)
+{
+	unsigned int slot_nb = 1;
+
+	while(slot_nb < entry_nb){
+		slot_nb <<= 1;
+	}
+
+	ring->slot = (event_queue_entry*)calloc(slot_nb, sizeof(event_queue_entry));
+	if(ring->slot == NULL){
+		return FAIL;
+	}
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->mask = slot_nb - 1;
+
+	return SUCCESS;
+}
+
+void TERM_IO_RING(io_ring* ring)
+{
+	free(ring->slot);
+	ring->slot = NULL;
+}
+
+/* Called only by the producer */
+int IO_RING_PUSH(io_ring* ring, event_queue_entry* e_q_entry)
+{
+	unsigned int tail = ring->tail;
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	if(tail - head > ring->mask){
+		return FAIL;
+	}
+
+	ring->slot[tail & ring->mask] = *e_q_entry;
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return SUCCESS;
+}
+
+/* Called only by the consumer */
+int IO_RING_POP(io_ring* ring, event_queue_entry* e_q_entry)
+{
+	unsigned int head = ring->head;
+	unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	if(head == tail){
+		return FAIL;
+	}
+
+	*e_q_entry = ring->slot[head & ring->mask];
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	return SUCCESS;
+}
+
+int IO_RING_IS_EMPTY(io_ring* ring)
+{
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	return (head == tail);
+}
+
+int IO_RING_IS_FULL(io_ring* ring)
+{
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	return (tail - head > ring->mask);
+}
+
+int INIT_IO_WAITER(io_waiter* waiter)
+{
+	waiter->event_fd = eventfd(0, 0);
+	waiter->sleeping = 0;
+
+	if(waiter->event_fd == -1){
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+void TERM_IO_WAITER(io_waiter* waiter)
+{
+	close(waiter->event_fd);
+}
+
+/* Announce the sleep, the caller checks its condition again after this */
+void PREPARE_IO_WAIT(io_waiter* waiter)
+{
+	__atomic_store_n(&waiter->sleeping, 1, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void CANCEL_IO_WAIT(io_waiter* waiter)
+{
+	__atomic_store_n(&waiter->sleeping, 0, __ATOMIC_RELAXED);
+}
+
+void IO_WAIT(io_waiter* waiter)
+{
+	uint64_t value;
+
+	if(read(waiter->event_fd, &value, sizeof(uint64_t)) != sizeof(uint64_t)){
+		printf("ERROR[%s] eventfd read fail\n",__FUNCTION__);
+	}
+	__atomic_store_n(&waiter->sleeping, 0, __ATOMIC_RELAXED);
+}
+
+/* A system call only if the waiter announced the sleep */
+void WAKE_UP_IO_WAITER(io_waiter* waiter)
+{
+	uint64_t value = 1;
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&waiter->sleeping, __ATOMIC_RELAXED) == 0){
+		return;
+	}
+
+	if(__atomic_exchange_n(&waiter->sleeping, 0, __ATOMIC_SEQ_CST) == 1){
+		if(write(waiter->event_fd, &value, sizeof(uint64_t)) != sizeof(uint64_t)){
+			printf("ERROR[%s] eventfd write fail\n",__FUNCTION__);
 		}
+	}
+}
 #endif
 
-		pthread_mutex_unlock(&eq_lock);
+#if defined GC_BACKGROUND && !defined FIRM_BUFFER_THREAD
+/* No host IO until idle_end_time, the background GC stops at that time */
+void FIRM_IDLE(int64_t idle_end_time)
+{
+	/* Start a GC step only if it ends before the next host IO */
+	int64_t step_time = REG_READ_DELAY + CELL_READ_DELAY + REG_WRITE_DELAY + CELL_PROGRAM_DELAY;
+
+	if(BLOCK_ERASE_DELAY > step_time){
+		step_time = BLOCK_ERASE_DELAY;
+	}
+
+	while(get_usec() + step_time <= idle_end_time){
+		if(BACKGROUND_GARBAGE_COLLECTION() == FAIL){
+			break;
+		}
 	}
 }
 #endif
@@ -219,7 +545,10 @@ void DEQUEUE_HOST_IO(void)
 	}
 
 	if(e_q_entry->io_type == WRITE){
-		free(e_q_entry);
+		if(valid == VALID){
+			REMOVE_WRITE_INDEX(e_q_entry);
+		}
+		POOL_FREE(&event_pool, e_q_entry);
 	}
 	else{
 		if(e_q_entry == last_read_entry){
@@ -250,8 +579,12 @@ void DEQUEUE_HOST_IO(void)
 	}
 
 #ifdef FIRM_BUFFER_THREAD
-	pthread_mutex_lock(&cq_lock);
-#endif
+	if(io_type == READ){
+		/* Pass the completed read to the host */
+		PUSH_COMPLETED_HOST_READ(e_q_entry);
+		POOL_FREE(&event_pool, e_q_entry);
+	}
+#else
 	if(io_type == READ){
 		/* Move event queue entry to completed event queue */
 		e_q_entry->next = NULL;
@@ -265,9 +598,6 @@ void DEQUEUE_HOST_IO(void)
 		}
 		c_e_queue->entry_nb++;
 	}
-
-#ifdef FIRM_BUFFER_THREAD
-	pthread_mutex_unlock(&cq_lock);
 #endif
 
 #ifdef FIRM_IO_BUF_DEBUG
@@ -280,7 +610,23 @@ void DEQUEUE_COMPLETED_HOST_READ(void)
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] Start.\n",__FUNCTION__);
 #endif
-	
+
+#ifdef FIRM_BUFFER_THREAD
+	event_queue_entry c_e_entry;
+	int count = 0;
+
+	while(IO_RING_POP(&cq_ring, &c_e_entry) == SUCCESS){
+
+		/* Read data from buffer to host */
+		READ_DATA_FROM_BUFFER_TO_HOST(&c_e_entry);
+		count++;
+	}
+
+	/* The firmware thread may wait for the read buffer frames */
+	if(count != 0){
+		WAKE_UP_IO_WAITER(&firm_waiter);
+	}
+#else
 	if(c_e_queue->entry_nb == 0 || c_e_queue->head == NULL){
 #ifdef FIRM_IO_BUF_DEBUG
 		printf("[%s] There is no completed read event. \n",__FUNCTION__);
@@ -308,7 +654,7 @@ void DEQUEUE_COMPLETED_HOST_READ(void)
 		c_e_queue->entry_nb--;
 
 		/* Deallication completed read IO */
-		free(temp_c_e_q_entry);
+		POOL_FREE(&event_pool, temp_c_e_q_entry);
 	}
 
 	if(c_e_queue->entry_nb != 0){
@@ -318,6 +664,7 @@ void DEQUEUE_COMPLETED_HOST_READ(void)
 		c_e_queue->head = NULL;
 		c_e_queue->tail = NULL;
 	}
+#endif
 
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] End.\n",__FUNCTION__);
@@ -332,7 +679,7 @@ void ENQUEUE_HOST_READ(int32_t sector_nb, unsigned int length)
 	void* p_buf = NULL;
 	event_queue_entry* ret_e_q_entry = NULL;
 	event_queue_entry* new_e_q_entry = NULL;
-	event_queue_entry* temp_e_q_entry = calloc(1, sizeof(event_queue_entry));
+	event_queue_entry temp_e_q_entry;
 
 	/* Make New Read Event */
 	new_e_q_entry = ALLOC_NEW_EVENT(READ, sector_nb, length, p_buf);
@@ -347,18 +694,18 @@ void ENQUEUE_HOST_READ(int32_t sector_nb, unsigned int length)
 
 		if(ret_e_q_entry != NULL){
 
-			temp_e_q_entry->sector_nb = ret_e_q_entry->sector_nb;
-			temp_e_q_entry->length = ret_e_q_entry->length;
-			temp_e_q_entry->buf = ret_e_q_entry->buf;
+			temp_e_q_entry.sector_nb = ret_e_q_entry->sector_nb;
+			temp_e_q_entry.length = ret_e_q_entry->length;
+			temp_e_q_entry.buf = ret_e_q_entry->buf;
 
 			/* If the data can be read from write buffer, */
 			FLUSH_EVENT_QUEUE_UNTIL(ret_e_q_entry);
 
-			if(temp_e_q_entry->sector_nb <= sector_nb && \
-				(sector_nb + length) <= (temp_e_q_entry->sector_nb + temp_e_q_entry->length)){
+			if(temp_e_q_entry.sector_nb <= sector_nb && \
+				(sector_nb + length) <= (temp_e_q_entry.sector_nb + temp_e_q_entry.length)){
 
 				new_e_q_entry->buf = ftl_read_ptr;
-				COPY_DATA_TO_READ_BUFFER(new_e_q_entry, temp_e_q_entry);
+				COPY_DATA_TO_READ_BUFFER(new_e_q_entry, &temp_e_q_entry);
 			}
 
 			ret_e_q_entry = NULL;
@@ -390,10 +737,9 @@ void ENQUEUE_HOST_READ(int32_t sector_nb, unsigned int length)
 	e_queue->entry_nb++;
 
 
-	/* Update empry read buffer frame number */
-	empty_read_buffer_frame -= length;
+	/* Update empry read buffer frame number, shared with the host thread */
+	__atomic_sub_fetch(&empty_read_buffer_frame, length, __ATOMIC_RELAXED);
 
-	free(temp_e_q_entry);
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] End.\n",__FUNCTION__);
 #endif
@@ -409,6 +755,8 @@ void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length)
 
 	void* p_buf = NULL;
 	int invalid_len;
+	int overwritten_nb;
+	int i;
 
 	int flag_allocated = 0;
 
@@ -416,31 +764,26 @@ void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length)
 	p_buf = sata_write_ptr;
 	WRITE_DATA_TO_BUFFER(length);
 
-	if(last_read_entry != NULL)
-		e_q_entry = last_read_entry->next;
-	else
-		e_q_entry = e_queue->head;
-
-	/* Check pending write event */
-	while(e_q_entry != NULL){
+	/* Find the overwritten events in the pending write index */
+	overwritten_nb = FIND_OVERWRITTEN_EVENTS(write_index_root, sector_nb, length, 0);
 
-		/* Check if there is overwrited event */
-		if(e_q_entry->valid == VALID && CHECK_OVERWRITE(e_q_entry, sector_nb, length)==SUCCESS){
-			
-			/* Update event entry validity */
-			e_q_entry->valid = INVALID;
+	for(i=0;i<overwritten_nb;i++){
+		e_q_entry = overwritten_event_list[i];
 
-			/* Update write buffer valid array */
-			UPDATE_WB_VALID_ARRAY(e_q_entry, 'I');
-		}
+		/* Update event entry validity */
+		REMOVE_WRITE_INDEX(e_q_entry);
+		e_q_entry->valid = INVALID;
 
-		e_q_entry = e_q_entry->next;
+		/* Update write buffer valid array */
+		UPDATE_WB_VALID_ARRAY(e_q_entry, 'I');
 	}
 	
 	/* Check if the event is prior sequential event */
 	if(CHECK_SEQUENTIALITY(e_queue->tail, sector_nb)==SUCCESS){
 		/* Update the last write event */
+		REMOVE_WRITE_INDEX(e_queue->tail);
 		e_queue->tail->length += length;
+		INSERT_WRITE_INDEX(e_queue->tail);
 
 		/* Do not need to allocate new event */
 		flag_allocated = 1;
@@ -454,7 +797,9 @@ void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length)
 		UPDATE_WB_VALID_ARRAY_PARTIAL(e_queue->tail, 'I', invalid_len, 1);
 
 		/* Update the last write event */
+		REMOVE_WRITE_INDEX(e_queue->tail);
 		e_queue->tail->length += (length - invalid_len);			
+		INSERT_WRITE_INDEX(e_queue->tail);
 
 		/* Do not need to allocate new event */
 		flag_allocated = 1;
@@ -475,6 +820,8 @@ void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length)
 			e_queue->tail = new_e_q_entry;
 		}
 		e_queue->entry_nb++;
+
+		INSERT_WRITE_INDEX(new_e_q_entry);
 	}
 
 #ifdef FIRM_IO_BUF_DEBUG
@@ -482,12 +829,37 @@ void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 }
 
+/* The queued writes in the trimmed sectors are dropped,
+	the writes partly in them go to the FTL before the trim */
+void TRIM_EVENT_QUEUE(int32_t sector_nb, unsigned int length)
+{
+	event_queue_entry* e_q_entry;
+	int overwritten_nb;
+	int i;
+
+	overwritten_nb = FIND_OVERWRITTEN_EVENTS(write_index_root, sector_nb, length, 0);
+
+	for(i=0;i<overwritten_nb;i++){
+		e_q_entry = overwritten_event_list[i];
+
+		REMOVE_WRITE_INDEX(e_q_entry);
+		e_q_entry->valid = INVALID;
+
+		UPDATE_WB_VALID_ARRAY(e_q_entry, 'I');
+	}
+
+	e_q_entry = FIND_LAST_OVERLAPPED_EVENT(write_index_root, sector_nb, sector_nb + (int32_t)length - 1);
+	if(e_q_entry != NULL){
+		FLUSH_EVENT_QUEUE_UNTIL(e_q_entry);
+	}
+}
+
 event_queue_entry* ALLOC_NEW_EVENT(int io_type, int32_t sector_nb, unsigned int length, void* buf)
 {
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] Start.\n",__FUNCTION__);
 #endif
-	event_queue_entry* new_e_q_entry = calloc(1, sizeof(event_queue_entry));
+	event_queue_entry* new_e_q_entry = (event_queue_entry*)POOL_ALLOC(&event_pool);
 	if(new_e_q_entry == NULL){
 		printf("[%s] Allocation new event fail.\n", __FUNCTION__);
 		return NULL;
@@ -500,6 +872,10 @@ event_queue_entry* ALLOC_NEW_EVENT(int io_type, int32_t sector_nb, unsigned int
 	new_e_q_entry->buf = buf;
 	new_e_q_entry->next = NULL;
 
+	new_e_q_entry->seq_nb = write_event_seq_nb++;
+	new_e_q_entry->left = NULL;
+	new_e_q_entry->right = NULL;
+
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] End.\n",__FUNCTION__);
 #endif
@@ -649,6 +1025,184 @@ void FLUSH_EVENT_QUEUE_UNTIL(event_queue_entry* e_q_entry)
 #endif
 }
 
+static int COMPARE_WRITE_INDEX_KEY(event_queue_entry* entry1, event_queue_entry* entry2)
+{
+	if(entry1->sector_nb != entry2->sector_nb){
+		return (entry1->sector_nb < entry2->sector_nb) ? -1 : 1;
+	}
+	if(entry1->seq_nb != entry2->seq_nb){
+		return (entry1->seq_nb < entry2->seq_nb) ? -1 : 1;
+	}
+	return 0;
+}
+
+static void UPDATE_WRITE_INDEX_NODE(event_queue_entry* node)
+{
+	int32_t max_end_sector_nb = node->sector_nb + node->length;
+
+	if(node->left != NULL && node->left->max_end_sector_nb > max_end_sector_nb){
+		max_end_sector_nb = node->left->max_end_sector_nb;
+	}
+	if(node->right != NULL && node->right->max_end_sector_nb > max_end_sector_nb){
+		max_end_sector_nb = node->right->max_end_sector_nb;
+	}
+
+	node->max_end_sector_nb = max_end_sector_nb;
+}
+
+/* Every key of the left tree is smaller than the keys of the right tree */
+static event_queue_entry* MERGE_WRITE_INDEX(event_queue_entry* left, event_queue_entry* right)
+{
+	if(left == NULL){
+		return right;
+	}
+	else if(right == NULL){
+		return left;
+	}
+
+	if(left->priority > right->priority){
+		left->right = MERGE_WRITE_INDEX(left->right, right);
+		UPDATE_WRITE_INDEX_NODE(left);
+		return left;
+	}
+	else{
+		right->left = MERGE_WRITE_INDEX(left, right->left);
+		UPDATE_WRITE_INDEX_NODE(right);
+		return right;
+	}
+}
+
+/* Split the tree into the keys smaller than the key of e_q_entry and the others */
+static void SPLIT_WRITE_INDEX(event_queue_entry* root, event_queue_entry* e_q_entry, \
+				event_queue_entry** left, event_queue_entry** right)
+{
+	if(root == NULL){
+		*left = NULL;
+		*right = NULL;
+		return;
+	}
+
+	if(COMPARE_WRITE_INDEX_KEY(root, e_q_entry) < 0){
+		SPLIT_WRITE_INDEX(root->right, e_q_entry, &root->right, right);
+		*left = root;
+	}
+	else{
+		SPLIT_WRITE_INDEX(root->left, e_q_entry, left, &root->left);
+		*right = root;
+	}
+	UPDATE_WRITE_INDEX_NODE(root);
+}
+
+static event_queue_entry* DELETE_WRITE_INDEX_NODE(event_queue_entry* root, event_queue_entry* e_q_entry)
+{
+	int ret;
+
+	if(root == NULL){
+		printf("ERROR[%s] The event is not in the write index.\n",__FUNCTION__);
+		return NULL;
+	}
+
+	if(root == e_q_entry){
+		return MERGE_WRITE_INDEX(root->left, root->right);
+	}
+
+	ret = COMPARE_WRITE_INDEX_KEY(e_q_entry, root);
+	if(ret < 0){
+		root->left = DELETE_WRITE_INDEX_NODE(root->left, e_q_entry);
+	}
+	else{
+		root->right = DELETE_WRITE_INDEX_NODE(root->right, e_q_entry);
+	}
+	UPDATE_WRITE_INDEX_NODE(root);
+
+	return root;
+}
+
+void INSERT_WRITE_INDEX(event_queue_entry* e_q_entry)
+{
+	event_queue_entry* left = NULL;
+	event_queue_entry* right = NULL;
+
+	/* xorshift32 random priority keeps the treap balanced */
+	write_index_seed ^= write_index_seed << 13;
+	write_index_seed ^= write_index_seed >> 17;
+	write_index_seed ^= write_index_seed << 5;
+
+	e_q_entry->priority = write_index_seed;
+	e_q_entry->left = NULL;
+	e_q_entry->right = NULL;
+	UPDATE_WRITE_INDEX_NODE(e_q_entry);
+
+	SPLIT_WRITE_INDEX(write_index_root, e_q_entry, &left, &right);
+	write_index_root = MERGE_WRITE_INDEX(MERGE_WRITE_INDEX(left, e_q_entry), right);
+}
+
+void REMOVE_WRITE_INDEX(event_queue_entry* e_q_entry)
+{
+	write_index_root = DELETE_WRITE_INDEX_NODE(write_index_root, e_q_entry);
+
+	e_q_entry->left = NULL;
+	e_q_entry->right = NULL;
+}
+
+/* Collect the events whose sectors are all in [sector_nb, sector_nb + length)
+	to overwritten_event_list, return the number of collected events */
+int FIND_OVERWRITTEN_EVENTS(event_queue_entry* root, int32_t sector_nb, unsigned int length, int count)
+{
+	if(root == NULL || root->max_end_sector_nb <= sector_nb){
+		return count;
+	}
+
+	/* The left subtree does not start after root */
+	if(root->sector_nb >= sector_nb){
+		count = FIND_OVERWRITTEN_EVENTS(root->left, sector_nb, length, count);
+	}
+
+	if(root->sector_nb >= sector_nb + (int32_t)length){
+		return count;
+	}
+
+	if(CHECK_OVERWRITE(root, sector_nb, length) == SUCCESS){
+		overwritten_event_list[count] = root;
+		count++;
+	}
+
+	return FIND_OVERWRITTEN_EVENTS(root->right, sector_nb, length, count);
+}
+
+/* Return the latest event which overlaps [sector_nb, last_sector_nb] */
+event_queue_entry* FIND_LAST_OVERLAPPED_EVENT(event_queue_entry* root, int32_t sector_nb, int32_t last_sector_nb)
+{
+	event_queue_entry* ret_e_q_entry = NULL;
+	event_queue_entry* temp_e_q_entry;
+
+	if(root == NULL || root->max_end_sector_nb <= sector_nb){
+		return NULL;
+	}
+
+	ret_e_q_entry = FIND_LAST_OVERLAPPED_EVENT(root->left, sector_nb, last_sector_nb);
+
+	/* The right subtree starts after root */
+	if(root->sector_nb > last_sector_nb){
+		return ret_e_q_entry;
+	}
+
+	if(root->sector_nb + (int32_t)root->length > sector_nb){
+		if(ret_e_q_entry == NULL || ret_e_q_entry->seq_nb < root->seq_nb){
+			ret_e_q_entry = root;
+		}
+	}
+
+	temp_e_q_entry = FIND_LAST_OVERLAPPED_EVENT(root->right, sector_nb, last_sector_nb);
+	if(temp_e_q_entry != NULL){
+		if(ret_e_q_entry == NULL || ret_e_q_entry->seq_nb < temp_e_q_entry->seq_nb){
+			ret_e_q_entry = temp_e_q_entry;
+		}
+	}
+
+	return ret_e_q_entry;
+}
+
 int CHECK_OVERWRITE(event_queue_entry* e_q_entry, int32_t sector_nb, unsigned int length)
 {
 #ifdef FIRM_IO_BUF_DEBUG
@@ -708,33 +1262,10 @@ event_queue_entry* CHECK_IO_DEPENDENCY_FOR_READ(int32_t sector_nb, unsigned int
 	printf("[%s] Start.\n",__FUNCTION__);
 #endif
 	int32_t last_sector_nb = sector_nb + length - 1;
-	int32_t temp_sector_nb;
-	int32_t temp_last_sector_nb;
-
 	event_queue_entry* ret_e_q_entry = NULL;
-	event_queue_entry* e_q_entry = NULL;
 
-	if(last_read_entry == NULL){
-		e_q_entry = e_queue->head;
-	}
-	else{
-		e_q_entry = last_read_entry->next;
-	}
-
-	while(e_q_entry != NULL){
-		if(e_q_entry->valid == VALID){
-			temp_sector_nb = e_q_entry->sector_nb;
-			temp_last_sector_nb = temp_sector_nb + e_q_entry->length - 1; 
-
-			/* Find the last IO event which has dependency */		
-			if(temp_sector_nb <= last_sector_nb && \
-				sector_nb <= temp_last_sector_nb){
-				
-				ret_e_q_entry = e_q_entry;
-			}
-		}
-		e_q_entry = e_q_entry->next;
-	}
+	/* Find the last IO event which has dependency */
+	ret_e_q_entry = FIND_LAST_OVERLAPPED_EVENT(write_index_root, sector_nb, last_sector_nb);
 
 #ifdef FIRM_IO_BUF_DEBUG
 	printf("[%s] End.\n",__FUNCTION__);
@@ -784,7 +1315,7 @@ int EVENT_QUEUE_IS_FULL(int io_type, unsigned int length)
 			ret = SUCCESS;
 	}
 	else if(io_type == READ){
-		if(empty_read_buffer_frame < length)
+		if(__atomic_load_n(&empty_read_buffer_frame, __ATOMIC_ACQUIRE) < length)
 			ret = SUCCESS;
 	}
 
@@ -798,6 +1329,12 @@ void SECURE_WRITE_BUFFER(void)
 
 void SECURE_READ_BUFFER(void)
 {
+#ifdef FIRM_BUFFER_THREAD
+	/* The host frees the read buffer frames of the completed reads */
+	if(last_read_entry != NULL){
+		FLUSH_EVENT_QUEUE_UNTIL(last_read_entry);
+	}
+#else
 	if(c_e_queue->entry_nb != 0){
 		DEQUEUE_COMPLETED_HOST_READ();
 	}
@@ -806,6 +1343,7 @@ void SECURE_READ_BUFFER(void)
 		FLUSH_EVENT_QUEUE_UNTIL(last_read_entry);
 		DEQUEUE_COMPLETED_HOST_READ();
 	}
+#endif
 }
 
 char GET_WB_VALID_ARRAY_ENTRY(void* buffer_pointer)
@@ -943,14 +1481,15 @@ void INCREASE_RB_SATA_POINTER(int entry_nb)
 	int i;
 
 	for(i=0; i<entry_nb; i++){
-		empty_read_buffer_frame++;
-
 		sata_read_ptr = sata_read_ptr + SECTOR_SIZE;
 
 		if(sata_read_ptr == read_buffer_end){
 			sata_read_ptr = read_buffer;
 		}
 	}
+
+	/* Release the frames to the firmware thread */
+	__atomic_add_fetch(&empty_read_buffer_frame, entry_nb, __ATOMIC_RELEASE);
 #ifdef FIRM_IO_BUF_DEBUG
 	index = (int)(sata_read_ptr - read_buffer)/SECTOR_SIZE;
 	printf("%d End.\n",index);
@@ -9,11 +9,8 @@
 #define _FIRM_BUFFER_MANAGER_H_
 
 #ifdef FIRM_BUFFER_THREAD
-extern int r_queue_full;
-extern int w_queue_full;
-extern pthread_cond_t eq_ready;
-extern pthread_mutex_t eq_lock;
-extern pthread_mutex_t cq_lock;
+/* The number of submission ring slots (power of 2) */
+#define SUBMISSION_RING_ENTRY_NB	256
 #endif
 
 typedef struct event_queue_entry
@@ -24,6 +21,13 @@ typedef struct event_queue_entry
 	unsigned int length;
 	void* buf;
 	struct event_queue_entry* next;
+
+	/* Pending write index (treap keyed by sector_nb, seq_nb) */
+	int64_t seq_nb;
+	int32_t max_end_sector_nb;	// Max sector_nb + length of the subtree
+	unsigned int priority;
+	struct event_queue_entry* left;
+	struct event_queue_entry* right;
 }event_queue_entry;
 
 typedef struct event_queue
@@ -33,14 +37,63 @@ typedef struct event_queue
 	event_queue_entry* tail;
 }event_queue;
 
+#ifdef FIRM_BUFFER_THREAD
+/* Single producer, single consumer ring of preallocated event slots */
+typedef struct io_ring
+{
+	unsigned int head __attribute__((aligned(64)));	// Written by the consumer
+	unsigned int tail __attribute__((aligned(64)));	// Written by the producer
+	unsigned int mask;				// Slot number - 1
+	event_queue_entry* slot;
+}io_ring;
+
+/* A thread sleeping on an eventfd */
+typedef struct io_waiter
+{
+	int event_fd;
+	int sleeping;
+}io_waiter;
+
+extern io_ring sq_ring;
+extern io_ring cq_ring;
+extern io_waiter host_waiter;
+extern io_waiter firm_waiter;
+#endif
+
 void INIT_FIRM_IO_BUFFER(void);
 void TERM_FIRM_IO_BUFFER(void);
 void INIT_WB_VALID_ARRAY(void);
 
+#ifdef FIRM_BUFFER_THREAD
 void *FIRM_BUFFER_THREAD_MAIN_LOOP(void *arg);
+void SUBMIT_HOST_IO(int io_type, int32_t sector_nb, unsigned int length);
+void PUSH_COMPLETED_HOST_READ(event_queue_entry* e_q_entry);
+void WAIT_READ_BUFFER_FRAME(unsigned int length);
+
+/* SPSC Ring */
+int INIT_IO_RING(io_ring* ring, unsigned int entry_nb);
+void TERM_IO_RING(io_ring* ring);
+int IO_RING_PUSH(io_ring* ring, event_queue_entry* e_q_entry);
+int IO_RING_POP(io_ring* ring, event_queue_entry* e_q_entry);
+int IO_RING_IS_EMPTY(io_ring* ring);
+int IO_RING_IS_FULL(io_ring* ring);
+
+/* Thread Wakeup */
+int INIT_IO_WAITER(io_waiter* waiter);
+void TERM_IO_WAITER(io_waiter* waiter);
+void PREPARE_IO_WAIT(io_waiter* waiter);
+void CANCEL_IO_WAIT(io_waiter* waiter);
+void IO_WAIT(io_waiter* waiter);
+void WAKE_UP_IO_WAITER(io_waiter* waiter);
+#endif
+
 void ENQUEUE_HOST_IO(int io_type, int32_t sector_nb, unsigned int length);
+#if defined GC_BACKGROUND && !defined FIRM_BUFFER_THREAD
+void FIRM_IDLE(int64_t idle_end_time);
+#endif
 void ENQUEUE_HOST_READ(int32_t sector_nb, unsigned int length);
 void ENQUEUE_HOST_WRITE(int32_t sector_nb, unsigned int length);
+void TRIM_EVENT_QUEUE(int32_t sector_nb, unsigned int length);
 
 void DEQUEUE_HOST_IO(void);
 void DEQUEUE_COMPLETED_HOST_READ(void);
@@ -56,6 +109,12 @@ int EVENT_QUEUE_IS_FULL(int io_type, unsigned int length);
 void SECURE_WRITE_BUFFER(void);
 void SECURE_READ_BUFFER(void);
 
+/* Pending Write Index */
+void INSERT_WRITE_INDEX(event_queue_entry* e_q_entry);
+void REMOVE_WRITE_INDEX(event_queue_entry* e_q_entry);
+int FIND_OVERWRITTEN_EVENTS(event_queue_entry* root, int32_t sector_nb, unsigned int length, int count);
+event_queue_entry* FIND_LAST_OVERLAPPED_EVENT(event_queue_entry* root, int32_t sector_nb, int32_t last_sector_nb);
+
 /* Check Event */
 int CHECK_OVERWRITE(event_queue_entry* e_q_entry, int32_t sector_nb, unsigned int length);
 int CHECK_SEQUENTIALITY(event_queue_entry* e_q_entry, int32_t sector_nb);
@@ -8,46 +8,30 @@
 #include "ssd.h"
 #include "common.h"
 
-//sector_entry* PARSE_SECTOR_LIST(trim_data, length);
 void SSD_INIT(void)
 {
+	INIT_TRIM();
 	FTL_INIT();
+
+	/* The pools are sized, no malloc from now */
+	START_IO_PATH_MALLOC_COUNT();
 }
 
 void SSD_TERM(void)
 {	
 	FTL_TERM();
+	TERM_TRIM();
+
+	PRINT_IO_PATH_MALLOC();
 }
 
 void SSD_WRITE(unsigned int length, int32_t sector_nb)
 {
-#if defined FIRM_BUFFER_THREAD	
-
-	pthread_mutex_lock(&cq_lock);
+#if defined FIRM_BUFFER_THREAD
 	DEQUEUE_COMPLETED_HOST_READ();
-	pthread_mutex_unlock(&cq_lock);
 
-	/* added to prevent infinite loop in mode 1 */
-#if defined FIRM_BUFFER_THREAD_MODE_1
-	while(EVENT_QUEUE_IS_FULL(WRITE, length)){
-		pthread_cond_signal(&eq_ready);
-	}
-#elif defined FIRM_BUFFER_THREAD_MODE_2
-	if(EVENT_QUEUE_IS_FULL(WRITE, length)){
-		w_queue_full = 1;
-		while(w_queue_full == 1){
-			pthread_cond_signal(&eq_ready);
-		}
-	}
-#endif
-	
-	pthread_mutex_lock(&eq_lock);
-	ENQUEUE_HOST_IO(WRITE, sector_nb, length);
-	pthread_mutex_unlock(&eq_lock);
-
-    #ifdef FIRM_BUFFER_THREAD_MODE_1
-	pthread_cond_signal(&eq_ready);
-    #endif
+	/* Hand over the IO to the firmware thread, wait if the ring is full */
+	SUBMIT_HOST_IO(WRITE, sector_nb, length);
 
 #elif defined FIRM_IO_BUFFER
 	DEQUEUE_COMPLETED_HOST_READ();
@@ -67,35 +51,22 @@ void SSD_WRITE(unsigned int length, int32_t sector_nb)
 
 }
 
+/* Write with the stream ID of the host, 0 : let the FTL classify the data */
+void SSD_WRITE_STREAM(unsigned int length, int32_t sector_nb, int stream_id)
+{
+#ifdef FTL_MULTI_STREAM
+	SET_STREAM_HINT(sector_nb, length, stream_id);
+#endif
+	SSD_WRITE(length, sector_nb);
+}
+
 void SSD_READ(unsigned int length, int32_t sector_nb)
 {
 #if defined FIRM_BUFFER_THREAD
-
-	pthread_mutex_lock(&cq_lock);
 	DEQUEUE_COMPLETED_HOST_READ();
-	pthread_mutex_unlock(&cq_lock);
-	
-	/* added to prevent infinite loop in mode 1 */
-#if defined FIRM_BUFFER_THREAD_MODE_1
-	while(EVENT_QUEUE_IS_FULL(READ, length)){
-		pthread_cond_signal(&eq_ready);
-	}
-#elif defined FIRM_BUFFER_THREAD_MODE_2
-	if(EVENT_QUEUE_IS_FULL(READ, length)){
-		r_queue_full = 1;
-		while(r_queue_full == 1){
-			pthread_cond_signal(&eq_ready);
-		}
-	}
-#endif
-
-	pthread_mutex_lock(&eq_lock);
-	ENQUEUE_HOST_IO(READ, sector_nb, length);
-	pthread_mutex_unlock(&eq_lock);
 
-    #ifdef FIRM_BUFFER_THREAD_MODE_1
-	pthread_cond_signal(&eq_ready);
-    #endif
+	/* Hand over the IO to the firmware thread, wait if the ring is full */
+	SUBMIT_HOST_IO(READ, sector_nb, length);
 
 #elif defined FIRM_IO_BUFFER
 	DEQUEUE_COMPLETED_HOST_READ();
@@ -114,56 +85,84 @@ void SSD_READ(unsigned int length, int32_t sector_nb)
 #endif
 }
 
-void SSD_DSM_TRIM(unsigned int length, void* trim_data)
+/* Trim the sectors [sector_nb, sector_nb + length) */
+void SSD_TRIM(unsigned int length, int32_t sector_nb)
 {
-/*
-	if(DSM_TRIM_ENABLE == 0)
+	if(DSM_TRIM_ENABLE == 0){
 		return;
-		
-	
-	sector_entry* pSE_T = NULL;
-	sector_entry* pSE = NULL;
-	
+	}
+
+#if defined FIRM_BUFFER_THREAD
+	/* The firmware thread applies the trim after the IO submitted before it */
+	SUBMIT_HOST_IO(TRIM, sector_nb, length);
+#else
+	INSERT_TRIM_SECTORS(sector_nb, length);
+	APPLY_TRIM_SECTORS();
+#endif
+
+#ifdef MONITOR_ON
+	char szTemp[1024];
+	sprintf(szTemp, "TRIM INSERT %d ", 1);
+	WRITE_LOG(szTemp);
+#endif
+}
+
+/* The payload of Data Set Management is length bytes of 8 byte entries,
+	a 48 bit LBA and a 16 bit sector count in little endian */
+void SSD_DSM_TRIM(unsigned int length, void* trim_data)
+{
 	int i;
+	int entry_nb = length / 8;
+	uint8_t* entry = (uint8_t*)trim_data;
 	int64_t sector_nb;
 	unsigned int sector_length;
-	int* pBuff;
-	
-	pBuff = (int*)trim_data;
-	int k = 0;
-	for(i=0;i<length;i++)
-	{
-		sector_nb = (int64_t)*pBuff;
-		pBuff++;
-		sector_length = (int)*pBuff;	
-		sector_length = sector_length >> 16;
-		if(sector_nb == 0 && sector_length == 0)
-			break;
-		
-		pSE_T = new_sector_entry();
-		pSE_T->sector_nb = sector_nb;
-		pSE_T->length = sector_length;
-		
-		if(pSE == NULL)
-			pSE = pSE_T;
-		else
-		{
-			k++;
-			add_sector_list(pSE, pSE_T);
+
+	if(DSM_TRIM_ENABLE == 0 || trim_data == NULL){
+		return;
+	}
+
+	for(i=0;i<entry_nb;i++,entry+=8){
+		sector_nb = (int64_t)entry[0] | (int64_t)entry[1] << 8 | (int64_t)entry[2] << 16 \
+				| (int64_t)entry[3] << 24 | (int64_t)entry[4] << 32 | (int64_t)entry[5] << 40;
+		sector_length = (unsigned int)entry[6] | (unsigned int)entry[7] << 8;
+
+		/* The unused entries are zero */
+		if(sector_length == 0 || sector_nb >= SECTOR_NB){
+			continue;
+		}
+		if(sector_nb + sector_length > SECTOR_NB){
+			sector_length = SECTOR_NB - sector_nb;
 		}
-		
-		pBuff++;
+
+#if defined FIRM_BUFFER_THREAD
+		SUBMIT_HOST_IO(TRIM, (int32_t)sector_nb, sector_length);
+#else
+		INSERT_TRIM_SECTORS(sector_nb, sector_length);
+#endif
 	}
-	
-	INSERT_TRIM_SECTORS(pSE);
 
-	release_sector_list(pSE);
-*/
+#ifndef FIRM_BUFFER_THREAD
+	/* The ranges of the command go to the FTL at once */
+	APPLY_TRIM_SECTORS();
+#endif
+
+#ifdef MONITOR_ON
+	char szTemp[1024];
+	sprintf(szTemp, "TRIM INSERT %d ", entry_nb);
+	WRITE_LOG(szTemp);
+#endif
+}
+
+/* The host does not issue IO for idle_time usec */
+void SSD_IDLE(int64_t idle_time)
+{
+#if defined GC_BACKGROUND && !defined FIRM_BUFFER_THREAD
+	FIRM_IDLE(get_usec() + idle_time);
+#endif
 }
 
 int SSD_IS_SUPPORT_TRIM(void)
 {
-//	return DSM_TRIM_ENABLE;
-	return 0;
+	return DSM_TRIM_ENABLE;
 }
 
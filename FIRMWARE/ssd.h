@@ -8,7 +8,11 @@
 #ifndef _SSD_H_
 #define _SSD_H_
 
+#ifndef VSSIM_BENCH
 #include "hw.h"
+#else
+#include <stdint.h>
+#endif
 
 
 //FILE *fp;
@@ -16,8 +20,12 @@ void SSD_INIT(void);
 void SSD_TERM(void);
 
 void SSD_WRITE(unsigned int length, int32_t sector_nb);
+void SSD_WRITE_STREAM(unsigned int length, int32_t sector_nb, int stream_id);
 void SSD_READ(unsigned int length, int32_t sector_nb);
+void SSD_TRIM(unsigned int length, int32_t sector_nb);
 void SSD_DSM_TRIM(unsigned int length, void* trim_data);
 int SSD_IS_SUPPORT_TRIM(void);
 
+void SSD_IDLE(int64_t idle_time);
+
 #endif
@@ -29,7 +29,6 @@ void FTL_INIT(void)
 		INIT_INVERSE_MAPPING_TABLE();
 
 		INIT_BLOCK_STATE_TABLE();
-		INIT_VALID_ARRAY();
 		INIT_EMPTY_BLOCK_LIST();
 		INIT_PERF_CHECKER();
 
@@ -59,10 +58,13 @@ void FTL_TERM(void)
 
 #ifdef FIRM_IO_BUFFER
 	TERM_IO_BUFFER();
+#endif
+#ifdef VIRTUAL_TIME
+	TERM_SCHED_MANAGER();
+	TERM_TIME_MANAGER();
 #endif
 	TERM_MAPPING_TABLE();
 	TERM_INVERSE_MAPPING_TABLE();
-	TERM_VALID_ARRAY();
 	TERM_BLOCK_STATE_TABLE();
 	TERM_EMPTY_BLOCK_LIST();
 	TERM_PERF_CHECKER();
@@ -83,6 +85,22 @@ void FTL_WRITE(int32_t sector_nb, unsigned int length)
 	_FTL_WRITE(sector_nb, length);
 }
 
+void FTL_TRIM(trim_range* range, int range_nb)
+{
+	int i;
+	int trimmed_page_nb = 0;
+
+	for(i=0;i<range_nb;i++){
+		trimmed_page_nb += _FTL_TRIM(range[i].sector_nb, range[i].length);
+	}
+
+#ifdef MONITOR_ON
+	char szTemp[1024];
+	sprintf(szTemp, "TRIM INVALID %d ", trimmed_page_nb);
+	WRITE_LOG(szTemp);
+#endif
+}
+
 int _FTL_READ(int32_t sector_nb, unsigned int length)
 {
 #ifdef FTL_DEBUG
@@ -325,3 +343,38 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 	return ret;
 }
+
+/* Invalidate the pages which are all in the trimmed sectors,
+	the merge of the block does not copy them */
+int _FTL_TRIM(int32_t sector_nb, unsigned int length)
+{
+	int32_t lpn;
+	int32_t end_lpn;
+	int32_t lbn;
+	int32_t pbn;
+	int32_t block_offset;
+	int trimmed_page_nb = 0;
+
+	if((int64_t)sector_nb + length > SECTOR_NB){
+		printf("ERROR[%s] Exceed Sector number\n", __FUNCTION__);
+		return 0;
+	}
+
+	lpn = (int32_t)(((int64_t)sector_nb + SECTORS_PER_PAGE - 1) / SECTORS_PER_PAGE);
+	end_lpn = (int32_t)(((int64_t)sector_nb + length) / SECTORS_PER_PAGE);
+
+	for(;lpn<end_lpn;lpn++){
+		lbn = lpn / PAGE_NB;
+		block_offset = lpn % (int32_t)PAGE_NB;
+
+		pbn = GET_VALID_MAPPING(lbn, block_offset);
+		if(pbn == -1){
+			continue;
+		}
+
+		UPDATE_BLOCK_STATE_ENTRY(pbn, block_offset, INVALID);
+		trimmed_page_nb++;
+	}
+
+	return trimmed_page_nb;
+}
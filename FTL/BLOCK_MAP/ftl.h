@@ -15,9 +15,11 @@ void FTL_TERM(void);
 
 void FTL_READ(int32_t sector_nb, unsigned int length);
 void FTL_WRITE(int32_t sector_nb, unsigned int length);
+void FTL_TRIM(trim_range* range, int range_nb);
 
 int _FTL_READ(int32_t sector_nb, unsigned int length);
 int _FTL_WRITE(int32_t sector_nb, unsigned int length);
+int _FTL_TRIM(int32_t sector_nb, unsigned int length);
 
 //TEMP
 extern int data_block_nb;
@@ -74,17 +74,7 @@ int GARBAGE_COLLECTION(void)
 
 int COUNT_INVALID_PAGES(block_state_entry* b_s_entry)
 {
-	int count=0;
-	int i;
-	char* valid_array = b_s_entry->valid_array;
-
-        for(i=0;i<PAGE_NB;i++){
-                if(valid_array[i] == 'I'){
-                        count++;
-                }
-	}
-
-	return count;
+	return COUNT_INVALID_PAGES_IN_BITMAP(b_s_entry->page_bitmap);
 }
 
 int BM_GARBAGE_COLLECTION(int32_t victim_pbn)
@@ -273,17 +263,16 @@ int COPY_VALID_PAGES(int32_t old_pbn, int32_t new_pbn)
 	unsigned int new_block_nb = CALC_BLOCK(new_pbn);;
 
 	block_state_entry* old_b_s_entry = GET_BLOCK_STATE_ENTRY(old_pbn);
-	char* valid_array = old_b_s_entry->valid_array;
+	uint64_t* valid_bitmap = VALID_BITMAP(old_b_s_entry->page_bitmap);
 
-	for(i=0;i<PAGE_NB;i++){
-		if(valid_array[i] == 'V'){
-			SSD_PAGE_READ(old_flash_nb, old_block_nb, i, -1, GC_READ, -1);
-			SSD_PAGE_WRITE(new_flash_nb, new_block_nb, i, -1, GC_WRITE, -1);
+	/* Visit only the valid pages */
+	for(i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0);i>=0;i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, i+1)){
+		SSD_PAGE_READ(old_flash_nb, old_block_nb, i, -1, GC_READ, -1);
+		SSD_PAGE_WRITE(new_flash_nb, new_block_nb, i, -1, GC_WRITE, -1);
 
-			UPDATE_BLOCK_STATE_ENTRY(new_pbn, i, VALID);
-			UPDATE_BLOCK_STATE_ENTRY(old_pbn, i, INVALID);
-			copy_page_nb++;
-		}
+		UPDATE_BLOCK_STATE_ENTRY(new_pbn, i, VALID);
+		UPDATE_BLOCK_STATE_ENTRY(old_pbn, i, INVALID);
+		copy_page_nb++;
 	}
 
 	return copy_page_nb;
@@ -9,6 +9,7 @@
 
 int32_t* inverse_mapping_table;
 void* block_state_table;
+int block_state_entry_size;
 
 void* empty_block_list;
 
@@ -40,8 +41,11 @@ void INIT_INVERSE_MAPPING_TABLE(void)
 
 void INIT_BLOCK_STATE_TABLE(void)
 {
+	/* The page bitmap is stored inline, after each block state entry */
+	block_state_entry_size = sizeof(block_state_entry) + PAGE_BITMAP_SIZE;
+
 	/* Allocation Memory for Inverse Block Mapping Table */
-	block_state_table = (void*)calloc(BLOCK_MAPPING_ENTRY_NB, sizeof(block_state_entry));
+	block_state_table = (void*)calloc(BLOCK_MAPPING_ENTRY_NB, block_state_entry_size);
 	if(block_state_table == NULL){
 		printf("ERROR[%s] Calloc mapping table fail\n",__FUNCTION__);
 		return;
@@ -50,13 +54,16 @@ void INIT_BLOCK_STATE_TABLE(void)
 	/* Initialization Inverse Block Mapping Table */
 	FILE* fp = fopen("./data/block_state_table.dat","r");
 	if(fp != NULL){
-		fread(block_state_table, sizeof(block_state_entry), BLOCK_MAPPING_ENTRY_NB, fp);
+		fread(block_state_table, block_state_entry_size, BLOCK_MAPPING_ENTRY_NB, fp);
+		fclose(fp);
 	}
 	else{
 		int i;
-		block_state_entry* curr_b_s_entry = (block_state_entry*)block_state_table;
+		block_state_entry* curr_b_s_entry;
 
 		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
+			curr_b_s_entry = (block_state_entry*)((char*)block_state_table + (int64_t)i * block_state_entry_size);
+
 			curr_b_s_entry->type		= EMPTY_BLOCK;
 			curr_b_s_entry->valid_page_nb	= 0;
 			curr_b_s_entry->erase_count	= 0;
@@ -64,39 +71,10 @@ void INIT_BLOCK_STATE_TABLE(void)
 			curr_b_s_entry->rp_count = 0;
 			curr_b_s_entry->rp_head = NULL;
 			curr_b_s_entry->rp_root_pbn = -1;
-
-			curr_b_s_entry += 1;
 		}
 	}
 }
 
-void INIT_VALID_ARRAY(void)
-{
-	int i;
-	block_state_entry* curr_b_s_entry = (block_state_entry*)block_state_table;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","r");
-	if(fp != NULL){
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			fread(valid_array, sizeof(char), PAGE_NB, fp);
-			curr_b_s_entry->valid_array = valid_array;
-
-			curr_b_s_entry += 1;
-		}
-	}
-	else{
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			memset(valid_array,0,PAGE_NB);
-			curr_b_s_entry->valid_array = valid_array;
-
-			curr_b_s_entry += 1;
-		}			
-	}
-}
-
 void INIT_EMPTY_BLOCK_LIST(void)
 {
 	int i, j, k;
@@ -207,32 +185,14 @@ void TERM_BLOCK_STATE_TABLE(void)
 		return;
 	}
 
-	/* Write The inverse block table to file */
-	fwrite(block_state_table, sizeof(block_state_entry), BLOCK_MAPPING_ENTRY_NB, fp);
+	/* Write The inverse block table with the page bitmaps to file */
+	fwrite(block_state_table, block_state_entry_size, BLOCK_MAPPING_ENTRY_NB, fp);
+	fclose(fp);
 
 	/* Free The inverse block table memory */
 	free(block_state_table);
 }
 
-void TERM_VALID_ARRAY(void)
-{
-	int i;
-	block_state_entry* curr_entry = (block_state_entry*)block_state_table;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","w");
-        if(fp == NULL){
-		printf("ERROR[%s] File open fail\n",__FUNCTION__);
-		return;
-	}
- 
-	for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-		valid_array = curr_entry->valid_array;
-		fwrite(valid_array, sizeof(char), PAGE_NB, fp);
-		curr_entry += 1;
-	}
-}
-
 void TERM_EMPTY_BLOCK_LIST(void)
 {
 	int i, j, k;
@@ -445,15 +405,14 @@ int INSERT_EMPTY_BLOCK(int32_t new_empty_pbn)
 
 char GET_PAGE_STATE(int32_t pbn, int32_t block_offset)
 {
-	char page_state;
 	block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(pbn);
 
-	return b_s_entry->valid_array[block_offset];
+	return GET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, block_offset);
 }
 
 block_state_entry* GET_BLOCK_STATE_ENTRY(int32_t pbn)
 {
-	return ((block_state_entry*)block_state_table + pbn);
+	return (block_state_entry*)((char*)block_state_table + (int64_t)pbn * block_state_entry_size);
 }
 
 int32_t GET_INVERSE_MAPPING_INFO(int32_t pbn)
@@ -477,14 +436,12 @@ int UPDATE_INVERSE_MAPPING(int32_t pbn, int32_t lbn)
 
 int UPDATE_BLOCK_STATE(int32_t pbn, int block_type)
 {
-        int i;
         block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(pbn);
         b_s_entry->type = block_type;
 	
         if(block_type == EMPTY_BLOCK){
-                for(i=0;i<PAGE_NB;i++){
-                        UPDATE_BLOCK_STATE_ENTRY(pbn, i, 0);
-                }
+		CLEAR_PAGE_BITMAP(b_s_entry->page_bitmap);
+		b_s_entry->valid_page_nb = 0;
 
 		if(b_s_entry->rp_head != NULL || b_s_entry->rp_count != 0){
 			printf("ERROR[%s] Some rp blocks are remain .. \n", __FUNCTION__);
@@ -503,34 +460,26 @@ int UPDATE_BLOCK_STATE_ENTRY(int32_t pbn, int32_t block_offset, int valid)
 		return FAIL;
 	}
 
-	int i;
-	int valid_count = 0;
-
 	/* Get the block state Info */
 	block_state_entry* state_entry = GET_BLOCK_STATE_ENTRY(pbn);
-	char* valid_array = state_entry->valid_array;
+	uint64_t* page_bitmap = state_entry->page_bitmap;
 
 	/* Update the page state */
 	if(valid == VALID){
-		valid_array[block_offset] = 'V';
+		SET_BITMAP_PAGE_STATE(page_bitmap, block_offset, 'V');
 	}
 	else if(valid == INVALID){
-		valid_array[block_offset] = 'I';
+		SET_BITMAP_PAGE_STATE(page_bitmap, block_offset, 'I');
 	}
 	else if(valid == 0){
-		valid_array[block_offset] = '0';
+		SET_BITMAP_PAGE_STATE(page_bitmap, block_offset, '0');
 	}
 	else{
 		printf("ERROR[%s] Wrong valid value\n",__FUNCTION__);
 	}
 
 	/* Update valid_page_nb */
-	for(i=0;i<PAGE_NB;i++){
-		if(valid_array[i] == 'V'){
-			valid_count++;
-		}
-	}
-	state_entry->valid_page_nb = valid_count;
+	state_entry->valid_page_nb = COUNT_BITMAP(VALID_BITMAP(page_bitmap), PAGE_BITMAP_WORD_NB);
 
 	return SUCCESS;
 }
@@ -543,7 +492,7 @@ void PRINT_VALID_ARRAY(int32_t pbn)
 
 	printf("Type %d [%d][%d]valid array:\n", b_s_entry->type, CALC_FLASH(pbn), CALC_BLOCK(pbn));
 	for(i=0;i<PAGE_NB;i++){
-		printf("%c ", b_s_entry->valid_array[i]);
+		printf("%c ", GET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, i));
 		cnt++;
 		if(cnt == 10){
 			printf("\n");
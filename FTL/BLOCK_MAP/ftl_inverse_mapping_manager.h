@@ -26,13 +26,17 @@ typedef struct block_state_entry
 	int valid_page_nb;
 	int type;
 	unsigned int erase_count;
-	char* valid_array;
 
 	int rp_count;
 	int32_t rp_root_pbn;
 	rp_block_entry* rp_head;
+
+	/* Valid & written page bitmap (PAGE_BITMAP_SIZE byte) */
+	uint64_t page_bitmap[];
 }block_state_entry;
 
+extern int block_state_entry_size;
+
 typedef struct empty_block_root
 {
 	struct empty_block_entry* head;
@@ -50,12 +54,10 @@ typedef struct empty_block_entry
 void INIT_INVERSE_MAPPING_TABLE(void);
 void INIT_BLOCK_STATE_TABLE(void);
 void INIT_EMPTY_BLOCK_LIST(void);
-void INIT_VALID_ARRAY(void);
 
 void TERM_INVERSE_MAPPING_TABLE(void);
 void TERM_BLOCK_STATE_TABLE(void);
 void TERM_EMPTY_BLOCK_LIST(void);
-void TERM_VALID_ARRAY(void);
 
 empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index);
 int INSERT_EMPTY_BLOCK(int32_t new_empty_pbn);
@@ -18,24 +18,49 @@
 
 /* FTL */
 /* VSSIM Function */
+#ifndef VSSIM_BENCH
 #define MONITOR_ON
+#endif
 
 #define GC_ON			/* Garbage Collection for PAGE MAP */
-#define GC_TRIGGER_OVERALL
+#ifndef GC_TRIGGER_PLANE
+#define GC_TRIGGER_OVERALL	/* -DGC_TRIGGER_PLANE for the per plane GC trigger */
+#endif
+//#define GC_BACKGROUND		/* Idle time GC for PAGE MAP, down to the soft watermark */
 //#define GC_VICTIM_OVERALL
 //#define WRITE_NOPARAL
 //#define FTL_MAP_CACHE		/* FTL MAP Cache for PAGE MAP */
+//#define FTL_WEAR_LEVELING	/* Dynamic & static wear leveling for PAGE MAP */
+//#define FTL_MULTI_STREAM	/* Hot/cold write streams for PAGE MAP */
+//#define FTL_MULTI_PLANE	/* Multi-plane program of the host writes for PAGE MAP */
+//#define FTL_SUB_PAGE		/* Sector log of the partial page writes for PAGE MAP */
+//#define FTL_EXTENT_MAP	/* Extent compressed mapping tables for PAGE MAP */
+
+/* VSSIM Timing Engine */
+//#define VIRTUAL_TIME		/* Discrete-event virtual clock instead of busy-wait delay */
+#if defined VSSIM_BENCH && !defined VIRTUAL_TIME
+#define VIRTUAL_TIME		/* Trace replay always runs in virtual time */
+#endif
 
 /* VSSIM Benchmark*/
+#ifndef VIRTUAL_TIME
 #define DEL_QEMU_OVERHEAD
+#endif
 #define FIRM_IO_BUFFER	/* SSD Read/Write Buffer ON */
+#ifndef VSSIM_BENCH
 #define FIRM_BUFFER_THREAD		/* Enable SSD thread & SSD Read/Write Buffer */
 #define FIRM_BUFFER_THREAD_MODE_1
+#endif
 // #define FIRM_BUFFER_THREAD_MODE_2
 
 /* HEADER - VSSIM CONFIGURATION */
 #include "vssim_config_manager.h"
 
+/* HEADER - FTL COMMON */
+#include "ftl_bitmap.h"
+#include "ftl_pool_manager.h"
+#include "ssd_trim_manager.h"
+
 /* HEADER - FTL MODULE */
 #include "ftl.h"
 #include "ftl_perf_manager.h"
@@ -49,6 +74,8 @@
 /* HEADER - SSD MODULE */
 #include "ssd_io_manager.h"
 #include "ssd_log_manager.h"
+#include "ssd_time_manager.h"
+#include "ssd_sched_manager.h"
 
 /* HEADER - FIRMWARE */
 #include "firm_buffer_manager.h"
@@ -59,6 +86,14 @@
 	#include "ftl_gc_manager.h"
 	#include "ftl_mapping_manager.h"
 #endif
+#ifdef PAGE_MAP
+	#include "ftl_wear_leveling_manager.h"
+	#include "ftl_stream_manager.h"
+	#include "ftl_journal_manager.h"
+	#include "ftl_precondition_manager.h"
+	#include "ftl_sub_page_manager.h"
+	#include "ftl_extent_map_manager.h"
+#endif
 #if defined FAST_FTL || defined LAST_FTL
 	#include "ftl_log_mapping_manager.h"
 	#include "ftl_data_mapping_manager.h"
@@ -99,6 +134,7 @@
 #define	EMPTY_RAN_HOT_BLOCK	38
 #define DATA_BLOCK              39
 #define EMPTY_DATA_BLOCK        40
+#define MAP_BLOCK		44	/* Translation block of FTL_MAP_CACHE */
 
 /* GC Copy Valid Page Type */
 #define VICTIM_OVERALL	41
@@ -157,6 +193,12 @@
 #define RAN_HOT_MERGE_WRITE	817
 #define MAP_READ		818
 #define MAP_WRITE		819
+#define WL_READ			820
+#define WL_WRITE		821
+#define TRIM			822
+#define SUB_LOG_WRITE		823
+#define SUB_MERGE_READ		824
+#define SUB_MERGE_WRITE		825
 
 #define UPDATE_START_TIME	900
 #define UPDATE_END_TIME		901
@@ -0,0 +1,133 @@
+// File: ftl_bitmap.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _FTL_BITMAP_H_
+#define _FTL_BITMAP_H_
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/* Page bitmap of a block : PAGE_NB valid bits, then PAGE_NB written bits
+ *	'0' (empty)	: written 0, valid 0
+ *	'V' (valid)	: written 1, valid 1
+ *	'I' (invalid)	: written 1, valid 0
+ */
+#define BITMAP_WORD_NB(bit_nb)		(((bit_nb) + 63) / 64)
+#define PAGE_BITMAP_WORD_NB		BITMAP_WORD_NB(PAGE_NB)
+#define PAGE_BITMAP_SIZE		(2 * PAGE_BITMAP_WORD_NB * sizeof(uint64_t))
+
+#define VALID_BITMAP(page_bitmap)	(page_bitmap)
+#define WRITTEN_BITMAP(page_bitmap)	((page_bitmap) + PAGE_BITMAP_WORD_NB)
+
+#define TEST_BIT(bitmap, nb)		(((bitmap)[(nb) >> 6] >> ((nb) & 63)) & 1)
+#define SET_BIT(bitmap, nb)		((bitmap)[(nb) >> 6] |= (1ULL << ((nb) & 63)))
+#define CLEAR_BIT(bitmap, nb)		((bitmap)[(nb) >> 6] &= ~(1ULL << ((nb) & 63)))
+
+static inline int COUNT_BITMAP(const uint64_t* bitmap, int word_nb)
+{
+	int i;
+	int count = 0;
+
+	for(i=0;i<word_nb;i++){
+		count += __builtin_popcountll(bitmap[i]);
+	}
+
+	return count;
+}
+
+/* The number of written but not valid pages */
+static inline int COUNT_INVALID_PAGES_IN_BITMAP(const uint64_t* page_bitmap)
+{
+	int i;
+	int count = 0;
+	int word_nb = PAGE_BITMAP_WORD_NB;
+	const uint64_t* valid_bitmap = VALID_BITMAP(page_bitmap);
+	const uint64_t* written_bitmap = WRITTEN_BITMAP(page_bitmap);
+
+	for(i=0;i<word_nb;i++){
+		count += __builtin_popcountll(written_bitmap[i] & ~valid_bitmap[i]);
+	}
+
+	return count;
+}
+
+/* Return the first set bit from start, -1 if there is not */
+static inline int FIND_NEXT_BIT(const uint64_t* bitmap, int bit_nb, int start)
+{
+	int word_nb = BITMAP_WORD_NB(bit_nb);
+	int index;
+	uint64_t word;
+
+	if(start >= bit_nb){
+		return -1;
+	}
+
+	index = start >> 6;
+	word = bitmap[index] & (~0ULL << (start & 63));
+
+	while(word == 0){
+		index++;
+#ifdef __AVX2__
+		/* Skip four empty words at once */
+		while(index + 4 <= word_nb){
+			__m256i v = _mm256_loadu_si256((const __m256i*)(bitmap + index));
+			if(!_mm256_testz_si256(v, v)){
+				break;
+			}
+			index += 4;
+		}
+#endif
+		if(index >= word_nb){
+			return -1;
+		}
+		word = bitmap[index];
+	}
+
+	index = (index << 6) + __builtin_ctzll(word);
+	if(index >= bit_nb){
+		return -1;
+	}
+
+	return index;
+}
+
+static inline char GET_BITMAP_PAGE_STATE(const uint64_t* page_bitmap, int page_nb)
+{
+	if(TEST_BIT(VALID_BITMAP(page_bitmap), page_nb)){
+		return 'V';
+	}
+	else if(TEST_BIT(WRITTEN_BITMAP(page_bitmap), page_nb)){
+		return 'I';
+	}
+
+	return '0';
+}
+
+/* state : 'V', 'I' or '0' */
+static inline void SET_BITMAP_PAGE_STATE(uint64_t* page_bitmap, int page_nb, char state)
+{
+	if(state == 'V'){
+		SET_BIT(VALID_BITMAP(page_bitmap), page_nb);
+		SET_BIT(WRITTEN_BITMAP(page_bitmap), page_nb);
+	}
+	else if(state == 'I'){
+		CLEAR_BIT(VALID_BITMAP(page_bitmap), page_nb);
+		SET_BIT(WRITTEN_BITMAP(page_bitmap), page_nb);
+	}
+	else{
+		CLEAR_BIT(VALID_BITMAP(page_bitmap), page_nb);
+		CLEAR_BIT(WRITTEN_BITMAP(page_bitmap), page_nb);
+	}
+}
+
+static inline void CLEAR_PAGE_BITMAP(uint64_t* page_bitmap)
+{
+	memset(page_bitmap, 0, PAGE_BITMAP_SIZE);
+}
+
+#endif
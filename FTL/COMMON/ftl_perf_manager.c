@@ -7,6 +7,8 @@
 
 #include "common.h"
 
+#include <pthread.h>
+
 /* Average IO Time */
 double avg_write_delay;
 double total_write_count;
@@ -68,8 +70,12 @@ double total_ran_hot_merge_write_delay;
 unsigned int io_request_nb;
 unsigned int io_request_seq_nb;
 
-struct io_request* io_request_start;
-struct io_request* io_request_end;
+struct io_request* io_request_ring;
+int64_t* io_request_time_slab;
+int64_t io_request_drop_nb;
+
+/* n_io_info of the GC, WL, map & stripe page IOs */
+obj_pool nand_io_info_pool;
 
 /* Calculate IO Latency */
 double read_latency_count;
@@ -88,6 +94,22 @@ int idx_write_latency;
 int arr_read_full;
 int arr_write_full;
 
+/* Latency Histogram : each thread records to its own interval histograms,
+	the rotation merges them to the total histograms */
+__thread latency_histogram* interval_histogram;
+latency_histogram* total_histogram;
+latency_histogram* thread_histogram_list[HIST_THREAD_NB];
+int thread_histogram_nb;
+pthread_mutex_t histogram_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* hist_class_name[HIST_CLASS_NB] = {
+	"READ", "WRITE", "GC_READ", "GC_WRITE",
+	"SEQ_MERGE_READ", "RAN_MERGE_READ", "SEQ_MERGE_WRITE", "RAN_MERGE_WRITE",
+	"MAP_READ", "MAP_WRITE", "ERASE", "WL_READ", "WL_WRITE",
+	"QUEUE_WAIT", "SUSPEND",
+	"SUB_LOG_WRITE", "SUB_MERGE_READ", "SUB_MERGE_WRITE"
+};
+
 /* Send to Monitor  */
 int64_t log_read_page_val;
 int64_t log_read_request_val;
@@ -179,9 +201,27 @@ void INIT_PERF_CHECKER(void){
 	/* IO Latency */
 	io_request_nb = 0;
 	io_request_seq_nb = 0;
+	io_request_drop_nb = 0;
 
-	io_request_start = NULL;
-	io_request_end = NULL;
+	/* Alloc io request ring and the time slab of the slots */
+	io_request_ring = (io_request*)calloc(IO_REQUEST_RING_SIZE, sizeof(io_request));
+	io_request_time_slab = (int64_t*)calloc(IO_REQUEST_RING_SIZE * IO_REQUEST_SLAB_PAGE_NB * 2, sizeof(int64_t));
+	if(io_request_ring == NULL || io_request_time_slab == NULL){
+		printf("ERROR[%s] Calloc io request ring fail\n", __FUNCTION__);
+		return;
+	}
+	for(i=0; i<IO_REQUEST_RING_SIZE; i++){
+		io_request_ring[i].slab_time = io_request_time_slab + (int64_t)i * IO_REQUEST_SLAB_PAGE_NB * 2;
+	}
+
+	/* The queued GC & WL commands hold their n_io_info */
+	i = PLANES_PER_FLASH + NAND_IO_INFO_POOL_MARGIN;
+	if(IO_SCHEDULER != SCHED_FIFO){
+		i += FLASH_NB * PLANES_PER_FLASH * SCHED_QUEUE_DEPTH;
+	}
+	if(INIT_POOL(&nand_io_info_pool, "nand_io_info", sizeof(nand_io_info), i) == FAIL){
+		return;
+	}
 
 	read_latency_count = 0;
 	write_latency_count = 0;
@@ -194,6 +234,18 @@ void INIT_PERF_CHECKER(void){
 
 	ssd_util = 0;
 
+	/* Alloc latency histograms, the other threads alloc theirs at the first record */
+	total_histogram = (latency_histogram*)calloc(HIST_CLASS_NB, sizeof(latency_histogram));
+	if(total_histogram == NULL){
+		printf("ERROR[%s] Calloc latency histogram fail\n", __FUNCTION__);
+		return;
+	}
+	for(i=0; i<HIST_CLASS_NB; i++){
+		RESET_LATENCY_HISTOGRAM(&total_histogram[i]);
+	}
+	thread_histogram_nb = 0;
+	ALLOC_THREAD_HISTOGRAM();
+
 	/* Alloc latency array */
 	arr_read_latency = (int64_t*)calloc(LATENCY_WINDOW, sizeof(int64_t));
 	arr_write_latency = (int64_t*)calloc(LATENCY_WINDOW, sizeof(int64_t));
@@ -244,12 +296,39 @@ void INIT_PERF_CHECKER(void){
 
 void TERM_PERF_CHECKER(void){
 
+	int i;
+
 	printf("Average Read Latency	%.3lf us\n", avg_read_latency);
 	printf("Average Write Latency	%.3lf us\n", avg_write_latency);
 
+	/* Dump the latency distribution of the whole run, the other threads are joined */
+	ROTATE_ALL_LATENCY_HISTOGRAM();
+	PRINT_LATENCY_HISTOGRAM(stdout);
+	DUMP_LATENCY_HISTOGRAM("./data/latency_histogram.txt");
+	for(i=0; i<thread_histogram_nb; i++){
+		free(thread_histogram_list[i]);
+	}
+	thread_histogram_nb = 0;
+	interval_histogram = NULL;
+	free(total_histogram);
+
 	free(arr_read_latency);
 	free(arr_write_latency);
 
+	if(io_request_drop_nb != 0){
+		printf("ERROR[%s] %lld io requests were not completed\n", __FUNCTION__, (long long)io_request_drop_nb);
+	}
+	for(i=0; i<IO_REQUEST_RING_SIZE; i++){
+		if(io_request_ring[i].in_use == 1){
+			FREE_IO_REQUEST(&io_request_ring[i]);
+		}
+		free(io_request_ring[i].big_time);
+	}
+	free(io_request_ring);
+	free(io_request_time_slab);
+
+	TERM_POOL(&nand_io_info_pool);
+
 	FILE* fp_perf_term = fopen("./data/perf_manager.dat","w");
 	if(fp_perf_term==NULL){
 		printf("ERROR[%s] File open fail\n", __FUNCTION__);
@@ -285,6 +364,11 @@ void SEND_TO_PERF_CHECKER(int op_type, int64_t op_delay, int type){
 
 	double delay = (double)op_delay;
 
+	/* Host READ, WRITE latency is recorded by CALC_IO_LATENCY */
+	if(type == REG_OP){
+		RECORD_OP_LATENCY(GET_HIST_CLASS(op_type), op_delay);
+	}
+
 	if(type == CH_OP){
 		switch(op_type){
 			case READ:
@@ -504,6 +588,13 @@ void SEND_TO_PERF_CHECKER(int op_type, int64_t op_delay, int type){
 				break;
 
 			case MAP_WRITE:
+				/* Calc SSD Util */
+				written_page_nb++;
+				break;
+
+			case WL_WRITE:
+				/* Calc SSD Util */
+				written_page_nb++;
 				break;
 
 			default:
@@ -575,11 +666,7 @@ int64_t ALLOC_IO_REQUEST(int32_t sector_nb, unsigned int length, int io_type, in
 	unsigned int right_skip;
 	unsigned int sects;
 
-	io_request* curr_io_request = (io_request*)calloc(1, sizeof(io_request));
-	if(curr_io_request == NULL){
-		printf("ERROR[%s] Calloc io_request fail\n", __FUNCTION__);
-		return 0;
-	}
+	io_request* curr_io_request = &io_request_ring[io_request_seq_nb & (IO_REQUEST_RING_SIZE - 1)];
 
 	while(remain > 0){
 		if(remain > SECTORS_PER_PAGE - left_skip){
@@ -596,17 +683,41 @@ int64_t ALLOC_IO_REQUEST(int32_t sector_nb, unsigned int length, int io_type, in
 	}
 
 	*page_nb = io_page_nb;
-	int64_t* start_time_arr = (int64_t*)calloc(io_page_nb, sizeof(int64_t));
-	int64_t* end_time_arr = (int64_t*)calloc(io_page_nb, sizeof(int64_t));
 
-	if(start_time_arr == NULL || end_time_arr == NULL){
-		printf("ERROR[%s] Calloc time array fail\n", __FUNCTION__);
+	/* Preconditioning, the request is not completed by the SSD module */
+	if(ssd_timing_off == 1){
 		return 0;
 	}
+
+	/* The request of the slot has not completed in the last ring round */
+	if(curr_io_request->in_use == 1){
+		FREE_IO_REQUEST(curr_io_request);
+		io_request_drop_nb++;
+	}
+
+	/* Use the slab of the slot for the time arrays */
+	if(io_page_nb <= IO_REQUEST_SLAB_PAGE_NB){
+		curr_io_request->start_time = curr_io_request->slab_time;
+		curr_io_request->end_time = curr_io_request->slab_time + IO_REQUEST_SLAB_PAGE_NB;
+	}
 	else{
-		memset(start_time_arr, 0, io_page_nb);
-		memset(end_time_arr, 0, io_page_nb);
+		/* The time arrays of the slot grow to its biggest request, and are kept */
+		if(curr_io_request->big_page_nb < io_page_nb){
+			free(curr_io_request->big_time);
+			curr_io_request->big_time = (int64_t*)malloc(io_page_nb * 2 * sizeof(int64_t));
+			if(curr_io_request->big_time == NULL){
+				printf("ERROR[%s] Malloc time array fail\n", __FUNCTION__);
+				curr_io_request->big_page_nb = 0;
+				return 0;
+			}
+			curr_io_request->big_page_nb = io_page_nb;
+			COUNT_IO_PATH_MALLOC();
+		}
+		curr_io_request->start_time = curr_io_request->big_time;
+		curr_io_request->end_time = curr_io_request->big_time + io_page_nb;
 	}
+	memset(curr_io_request->start_time, 0, io_page_nb * sizeof(int64_t));
+	memset(curr_io_request->end_time, 0, io_page_nb * sizeof(int64_t));
 
 	curr_io_request->request_nb = io_request_seq_nb;
 	
@@ -614,18 +725,8 @@ int64_t ALLOC_IO_REQUEST(int32_t sector_nb, unsigned int length, int io_type, in
 	curr_io_request->request_size = io_page_nb;
 	curr_io_request->start_count = 0;
 	curr_io_request->end_count = 0;
-	curr_io_request->start_time = start_time_arr;
-	curr_io_request->end_time = end_time_arr;
-	curr_io_request->next = NULL;
+	curr_io_request->in_use = 1;
 
-	if(io_request_start == NULL){
-		io_request_start = curr_io_request;
-		io_request_end = curr_io_request;
-	}
-	else{
-		io_request_end->next = curr_io_request;
-		io_request_end = curr_io_request;
-	}
 	io_request_nb++;
 
 	int64_t end = get_usec();
@@ -638,100 +739,31 @@ int64_t ALLOC_IO_REQUEST(int32_t sector_nb, unsigned int length, int io_type, in
 
 void FREE_DUMMY_IO_REQUEST(int type)
 {
-	int i;
-	int success = 0;
-	io_request* prev_request = io_request_start;
-
 	io_request* request = LOOKUP_IO_REQUEST(io_request_seq_nb, type);
 
-
-	if(io_request_nb == 1){
-		io_request_start = NULL;
-		io_request_end = NULL;
-		success = 1;
-	}
-	else if(prev_request == request){
-		io_request_start = request->next;
-		success = 1;
-	}
-	else{
-		for(i=0;i<(io_request_nb-1);i++){
-			if(prev_request->next == request && request == io_request_end){
-				prev_request->next = NULL;
-				io_request_end = prev_request;
-				success = 1;
-				break;
-			}
-			else if(prev_request->next == request){
-				prev_request->next = request->next;
-				success = 1;
-				break;
-			}
-			else{
-				prev_request = prev_request->next;
-			}
-		}
-	}
-
-
-	if(success == 0){
+	if(request == NULL){
 		printf("ERROR[%s] There is no such io request\n", __FUNCTION__);
 		return;
 	}
 
-	free(request->start_time);
-	free(request->end_time);
-	free(request);
-
-	io_request_nb--;
+	FREE_IO_REQUEST(request);
 }
 
 void FREE_IO_REQUEST(io_request* request)
 {
-	int i;
-	int success = 0;
-	io_request* prev_request = io_request_start;
-
 #ifdef FTL_PERF_DEBUG
 	printf("\t\t[%s] %d\n",__FUNCTION__, request->request_nb);
 #endif	
 
-	if(io_request_nb == 1){
-		io_request_start = NULL;
-		io_request_end = NULL;
-		success = 1;
-	}
-	else if(prev_request == request){
-		io_request_start = request->next;
-		success = 1;
-	}
-	else{
-		for(i=0;i<(io_request_nb-1);i++){
-			if(prev_request->next == request && request == io_request_end){
-				prev_request->next = NULL;
-				io_request_end = prev_request;
-				success = 1;
-				break;
-			}
-			else if(prev_request->next == request){
-				prev_request->next = request->next;
-				success = 1;
-				break;
-			}
-			else{
-				prev_request = prev_request->next;
-			}
-		}
-	}
-
-	if(success == 0){
+	if(request->in_use == 0){
 		printf("ERROR[%s] There is no such io request\n", __FUNCTION__);
 		return;
 	}
 
-	free(request->start_time);
-	free(request->end_time);
-	free(request);
+	/* The slab & the big time arrays stay with the slot */
+	request->start_time = NULL;
+	request->end_time = NULL;
+	request->in_use = 0;
 
 	io_request_nb--;
 }
@@ -789,39 +821,13 @@ void INCREASE_IO_REQUEST_SEQ_NB(void)
 
 io_request* LOOKUP_IO_REQUEST(int request_nb, int type)
 {
-	int i;
-	int total_request=0;
-	io_request* curr_request = NULL;
-
-//	PRINT_ALL_IO_REQUEST();
-
-	if(io_request_start != NULL){
-		curr_request = io_request_start;
-		total_request = io_request_nb;
-	}
-	else{
-		printf("ERROR[%s] There is no request. total_request:%d\n", __FUNCTION__, io_request_nb);
-		return NULL;
-	}
+	io_request* curr_request = &io_request_ring[(unsigned int)request_nb & (IO_REQUEST_RING_SIZE - 1)];
 
-	for(i=0;i<total_request;i++){
-		if(curr_request->request_nb == request_nb){
-#ifdef FTL_PERF_DEBUG
-			printf("[%s] hit! %d %d\n",__FUNCTION__, curr_request->request_nb, request_nb);
-#endif
-			return curr_request;
-		}
-
-		if(curr_request->next != NULL){
-			curr_request = curr_request->next;
-		}
-		else{
+	if(curr_request->in_use == 1 && curr_request->request_nb == (unsigned int)request_nb){
 #ifdef FTL_PERF_DEBUG
-			printf("[%s] end\n", __FUNCTION__);
+		printf("[%s] hit! %u %d\n",__FUNCTION__, curr_request->request_nb, request_nb);
 #endif
-
-			return NULL;
-		}	
+		return curr_request;
 	}
 
 	return NULL;
@@ -867,6 +873,14 @@ int64_t CALC_IO_LATENCY(io_request* request)
 	
 	latency = (max_end_time - min_start_time)/(request->request_size);
 
+	/* Tail latency of the whole request, not of a page */
+	if(type == READ){
+		RECORD_OP_LATENCY(HIST_READ, max_end_time - min_start_time);
+	}
+	else if(type == WRITE){
+		RECORD_OP_LATENCY(HIST_WRITE, max_end_time - min_start_time);
+	}
+
 	if(type == READ){
 		arr_read_latency[idx_read_latency] = latency;
 
@@ -898,18 +912,30 @@ int64_t CALC_IO_LATENCY(io_request* request)
 
 nand_io_info* CREATE_NAND_IO_INFO(int offset, int type, int io_page_nb, int io_seq_nb)
 {
-	nand_io_info* n_io_info = (nand_io_info*)calloc(1, sizeof(nand_io_info));
+	nand_io_info* n_io_info = (nand_io_info*)POOL_ALLOC(&nand_io_info_pool);
 	if(n_io_info == NULL){
 		printf("ERROR[%s] Alloc memory fail. \n", __FUNCTION__);
 		return NULL;
 	}
 
+	INIT_NAND_IO_INFO(n_io_info, offset, type, io_page_nb, io_seq_nb);
+
+	return n_io_info;
+}
+
+void FREE_NAND_IO_INFO(nand_io_info* n_io_info)
+{
+	POOL_FREE(&nand_io_info_pool, n_io_info);
+}
+
+/* n_io_info of a vectored IO page, no allocation */
+void INIT_NAND_IO_INFO(nand_io_info* n_io_info, int offset, int type, int io_page_nb, int io_seq_nb)
+{
 	n_io_info->offset = offset;
 	n_io_info->type = type;
 	n_io_info->io_page_nb = io_page_nb;
 	n_io_info->io_seq_nb = io_seq_nb;
-
-	return n_io_info;
+	n_io_info->issue_time = get_usec();
 }
 
 void PRINT_IO_REQUEST(io_request* request)
@@ -942,16 +968,303 @@ void PRINT_ALL_IO_REQUEST(void)
 {
 	int i;
 
-	io_request* curr_io_request = io_request_start;
-	for(i=0; i<io_request_nb; i++)
+	for(i=0; i<IO_REQUEST_RING_SIZE; i++)
 	{
-		PRINT_IO_REQUEST(curr_io_request);
-		curr_io_request = curr_io_request->next;
+		if(io_request_ring[i].in_use == 1){
+			PRINT_IO_REQUEST(&io_request_ring[i]);
+		}
 	}
 
 	return;
 }
 
+void RESET_LATENCY_HISTOGRAM(latency_histogram* hist)
+{
+	memset(hist, 0, sizeof(latency_histogram));
+	hist->min_value = -1;
+}
+
+static inline int GET_HIST_BUCKET_INDEX(int64_t value)
+{
+	int exp;
+	int64_t top;
+
+	if(value < HIST_SUB_BUCKET_NB){
+		return (int)value;
+	}
+	if(value >= (1LL << HIST_MAX_VALUE_BITS)){
+		return HIST_BUCKET_NB - 1;
+	}
+
+	/* value = top << exp, HIST_SUB_BUCKET_NB/2 <= top < HIST_SUB_BUCKET_NB */
+	exp = 63 - __builtin_clzll((uint64_t)value) - HIST_SUB_BUCKET_BITS + 1;
+	top = value >> exp;
+
+	return HIST_SUB_BUCKET_NB + (exp - 1) * (HIST_SUB_BUCKET_NB / 2) \
+		+ (int)(top - HIST_SUB_BUCKET_NB / 2);
+}
+
+/* The biggest value which falls into the bucket */
+static inline int64_t GET_HIST_BUCKET_VALUE(int index)
+{
+	int exp;
+	int64_t top;
+
+	if(index < HIST_SUB_BUCKET_NB){
+		return index;
+	}
+
+	index -= HIST_SUB_BUCKET_NB;
+	exp = index / (HIST_SUB_BUCKET_NB / 2) + 1;
+	top = HIST_SUB_BUCKET_NB / 2 + index % (HIST_SUB_BUCKET_NB / 2);
+
+	return ((top + 1) << exp) - 1;
+}
+
+void RECORD_LATENCY(latency_histogram* hist, int64_t value)
+{
+	if(value < 0){
+		value = 0;
+	}
+
+	hist->count[GET_HIST_BUCKET_INDEX(value)]++;
+	hist->total_count++;
+	hist->total_value += (double)value;
+
+	if(hist->min_value == -1 || hist->min_value > value){
+		hist->min_value = value;
+	}
+	if(hist->max_value < value){
+		hist->max_value = value;
+	}
+}
+
+/* Add src to dst, ex) the histograms of each thread */
+void MERGE_LATENCY_HISTOGRAM(latency_histogram* dst, latency_histogram* src)
+{
+	int i;
+
+	if(src->total_count == 0){
+		return;
+	}
+
+	for(i=0; i<HIST_BUCKET_NB; i++){
+		dst->count[i] += src->count[i];
+	}
+	dst->total_count += src->total_count;
+	dst->total_value += src->total_value;
+
+	if(dst->min_value == -1 || dst->min_value > src->min_value){
+		dst->min_value = src->min_value;
+	}
+	if(dst->max_value < src->max_value){
+		dst->max_value = src->max_value;
+	}
+}
+
+/* percentile : 0 ~ 100, return -1 if the histogram is empty */
+int64_t GET_LATENCY_PERCENTILE(latency_histogram* hist, double percentile)
+{
+	int i;
+	int64_t target;
+	int64_t count = 0;
+	int64_t value;
+
+	if(hist->total_count == 0){
+		return -1;
+	}
+
+	target = (int64_t)(percentile / 100 * hist->total_count + 0.5);
+	if(target < 1){
+		target = 1;
+	}
+	else if(target > hist->total_count){
+		target = hist->total_count;
+	}
+
+	for(i=0; i<HIST_BUCKET_NB; i++){
+		count += hist->count[i];
+		if(count >= target){
+			break;
+		}
+	}
+
+	value = GET_HIST_BUCKET_VALUE(i);
+	if(value > hist->max_value){
+		value = hist->max_value;
+	}
+
+	return value;
+}
+
+/* Return -1 if the op type has no histogram */
+int GET_HIST_CLASS(int op_type)
+{
+	switch(op_type){
+		case GC_READ:
+			return HIST_GC_READ;
+		case GC_WRITE:
+			return HIST_GC_WRITE;
+		case SEQ_MERGE_READ:
+			return HIST_SEQ_MERGE_READ;
+		case RAN_MERGE_READ:
+		case RAN_COLD_MERGE_READ:
+		case RAN_HOT_MERGE_READ:
+			return HIST_RAN_MERGE_READ;
+		case SEQ_MERGE_WRITE:
+			return HIST_SEQ_MERGE_WRITE;
+		case RAN_MERGE_WRITE:
+		case RAN_COLD_MERGE_WRITE:
+		case RAN_HOT_MERGE_WRITE:
+			return HIST_RAN_MERGE_WRITE;
+		case MAP_READ:
+			return HIST_MAP_READ;
+		case MAP_WRITE:
+			return HIST_MAP_WRITE;
+		case ERASE:
+			return HIST_ERASE;
+		case WL_READ:
+			return HIST_WL_READ;
+		case WL_WRITE:
+			return HIST_WL_WRITE;
+		case SUB_LOG_WRITE:
+			return HIST_SUB_LOG_WRITE;
+		case SUB_MERGE_READ:
+			return HIST_SUB_MERGE_READ;
+		case SUB_MERGE_WRITE:
+			return HIST_SUB_MERGE_WRITE;
+		default:
+			return -1;
+	}
+}
+
+/* The interval histograms of the calling thread, NULL if the list is full */
+latency_histogram* ALLOC_THREAD_HISTOGRAM(void)
+{
+	int i;
+	latency_histogram* hist;
+
+	hist = (latency_histogram*)calloc(HIST_CLASS_NB, sizeof(latency_histogram));
+	if(hist == NULL){
+		printf("ERROR[%s] Calloc latency histogram fail\n", __FUNCTION__);
+		return NULL;
+	}
+	for(i=0; i<HIST_CLASS_NB; i++){
+		RESET_LATENCY_HISTOGRAM(&hist[i]);
+	}
+
+	pthread_mutex_lock(&histogram_lock);
+	if(thread_histogram_nb == HIST_THREAD_NB){
+		pthread_mutex_unlock(&histogram_lock);
+		printf("ERROR[%s] More than %d threads record latencies\n", __FUNCTION__, HIST_THREAD_NB);
+		free(hist);
+		return NULL;
+	}
+	thread_histogram_list[thread_histogram_nb++] = hist;
+	pthread_mutex_unlock(&histogram_lock);
+
+	interval_histogram = hist;
+	return hist;
+}
+
+void RECORD_OP_LATENCY(int hist_class, int64_t latency)
+{
+	if(hist_class < 0 || hist_class >= HIST_CLASS_NB){
+		return;
+	}
+	if(interval_histogram == NULL && ALLOC_THREAD_HISTOGRAM() == NULL){
+		return;
+	}
+
+	RECORD_LATENCY(&interval_histogram[hist_class], latency);
+}
+
+/* Move the latencies of the current interval of the calling thread to the total histograms */
+void ROTATE_LATENCY_HISTOGRAM(void)
+{
+	int i;
+
+	if(interval_histogram == NULL){
+		return;
+	}
+
+	pthread_mutex_lock(&histogram_lock);
+	for(i=0; i<HIST_CLASS_NB; i++){
+		MERGE_LATENCY_HISTOGRAM(&total_histogram[i], &interval_histogram[i]);
+		RESET_LATENCY_HISTOGRAM(&interval_histogram[i]);
+	}
+	pthread_mutex_unlock(&histogram_lock);
+}
+
+/* Move the interval of every thread, only after the other threads stop recording */
+void ROTATE_ALL_LATENCY_HISTOGRAM(void)
+{
+	int i, j;
+
+	pthread_mutex_lock(&histogram_lock);
+	for(i=0; i<thread_histogram_nb; i++){
+		for(j=0; j<HIST_CLASS_NB; j++){
+			MERGE_LATENCY_HISTOGRAM(&total_histogram[j], &thread_histogram_list[i][j]);
+			RESET_LATENCY_HISTOGRAM(&thread_histogram_list[i][j]);
+		}
+	}
+	pthread_mutex_unlock(&histogram_lock);
+}
+
+/* Percentiles of the rotated latencies */
+void PRINT_LATENCY_HISTOGRAM(FILE* fp)
+{
+	int i;
+	latency_histogram* hist;
+
+	fprintf(fp, "Latency (us)		count	avg	p50	p99	p99.9	max\n");
+	for(i=0; i<HIST_CLASS_NB; i++){
+		hist = &total_histogram[i];
+
+		if(hist->total_count == 0){
+			continue;
+		}
+
+		fprintf(fp, "%-16s	%lld	%.1lf	%lld	%lld	%lld	%lld\n", hist_class_name[i], \
+				(long long)hist->total_count, \
+				hist->total_value / hist->total_count, \
+				(long long)GET_LATENCY_PERCENTILE(hist, 50), \
+				(long long)GET_LATENCY_PERCENTILE(hist, 99), \
+				(long long)GET_LATENCY_PERCENTILE(hist, 99.9), \
+				(long long)hist->max_value);
+	}
+}
+
+/* Write the non empty buckets of the total histograms */
+void DUMP_LATENCY_HISTOGRAM(char* file_name)
+{
+	int i, j;
+	FILE* fp_hist = fopen(file_name, "w");
+
+	if(fp_hist == NULL){
+		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+		return;
+	}
+
+	PRINT_LATENCY_HISTOGRAM(fp_hist);
+
+	for(i=0; i<HIST_CLASS_NB; i++){
+		if(total_histogram[i].total_count == 0){
+			continue;
+		}
+
+		fprintf(fp_hist, "\n%s\n", hist_class_name[i]);
+		for(j=0; j<HIST_BUCKET_NB; j++){
+			if(total_histogram[i].count[j] != 0){
+				fprintf(fp_hist, "%lld	%lld\n", (long long)GET_HIST_BUCKET_VALUE(j), \
+						(long long)total_histogram[i].count[j]);
+			}
+		}
+	}
+
+	fclose(fp_hist);
+}
+
 void UPDATE_LOG(int log_type, int arg)
 {
 	static int64_t recent_update_time = 0;
@@ -976,30 +1289,32 @@ void UPDATE_LOG(int log_type, int arg)
 			break;
 	}
 
+#ifdef MONITOR_ON
 	/* added to set interval between sending logs to monitor */
 	int64_t current_time = get_usec();
 	if(current_time - recent_update_time >= UPDATE_FREQUENCY){
 		recent_update_time = current_time;
 		SEND_LOG_TO_MONITOR();
 	}
+#endif
 }
 
 void SEND_LOG_TO_MONITOR(void)
 {
 	char szTemp[1024];
-	sprintf(szTemp, "READ PAGE %d ", log_read_page_val);
+	sprintf(szTemp, "READ PAGE %lld ", (long long)log_read_page_val);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "READ REQ %d ", log_read_request_val);
+	sprintf(szTemp, "READ REQ %lld ", (long long)log_read_request_val);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "WRITE PAGE %d ", log_write_page_val);
+	sprintf(szTemp, "WRITE PAGE %lld ", (long long)log_write_page_val);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "WRITE REQ %d ", log_write_request_val);
+	sprintf(szTemp, "WRITE REQ %lld ", (long long)log_write_request_val);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "GC AMP %d", log_gc_amp_val);
+	sprintf(szTemp, "GC AMP %lld", (long long)log_gc_amp_val);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "GC CALL %d", log_gc_call);
+	sprintf(szTemp, "GC CALL %lld", (long long)log_gc_call);
 	WRITE_LOG(szTemp);
-	sprintf(szTemp, "ERASE %d", log_erase_val);
+	sprintf(szTemp, "ERASE %lld", (long long)log_erase_val);
 	WRITE_LOG(szTemp);
 	sprintf(szTemp, "UTIL %lf ", ssd_util);
 	WRITE_LOG(szTemp);
@@ -1007,4 +1322,24 @@ void SEND_LOG_TO_MONITOR(void)
 	WRITE_LOG(szTemp);
 	sprintf(szTemp, "WRITE BW %lf ", GET_IO_BANDWIDTH(avg_write_latency));
 	WRITE_LOG(szTemp);
+
+	/* p50, p99, p99.9 of the requests completed in this interval, by the FTL thread */
+	if(interval_histogram == NULL){
+		return;
+	}
+	if(interval_histogram[HIST_READ].total_count != 0){
+		sprintf(szTemp, "READ LAT %lld %lld %lld ", \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_READ], 50), \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_READ], 99), \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_READ], 99.9));
+		WRITE_LOG(szTemp);
+	}
+	if(interval_histogram[HIST_WRITE].total_count != 0){
+		sprintf(szTemp, "WRITE LAT %lld %lld %lld ", \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_WRITE], 50), \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_WRITE], 99), \
+				(long long)GET_LATENCY_PERCENTILE(&interval_histogram[HIST_WRITE], 99.9));
+		WRITE_LOG(szTemp);
+	}
+	ROTATE_LATENCY_HISTOGRAM();
 } 
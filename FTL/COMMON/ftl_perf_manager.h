@@ -11,12 +11,52 @@
 #define LATENCY_WINDOW  	200
 #define UPDATE_FREQUENCY	10000
 
+/* In-flight io request ring, indexed by io_request_seq_nb */
+#define IO_REQUEST_RING_SIZE	1024	// power of 2
+#define IO_REQUEST_SLAB_PAGE_NB	64	// Bigger requests use the big time arrays of the slot
+
+#define NAND_IO_INFO_POOL_MARGIN	64	// n_io_info in use besides the queued commands
+
+/* Log-linear latency histogram (usec)
+ *	values below HIST_SUB_BUCKET_NB have their own bucket,
+ *	above that every power of 2 is split into HIST_SUB_BUCKET_NB/2 buckets,
+ *	so the relative error of a percentile is below 1/32
+ */
+#define HIST_SUB_BUCKET_BITS	6
+#define HIST_SUB_BUCKET_NB	(1 << HIST_SUB_BUCKET_BITS)
+#define HIST_MAX_VALUE_BITS	40	// Bigger values are counted in the last bucket
+#define HIST_BUCKET_NB		(HIST_SUB_BUCKET_NB + (HIST_MAX_VALUE_BITS - HIST_SUB_BUCKET_BITS) * (HIST_SUB_BUCKET_NB / 2))
+
+/* Histogram Op Class */
+#define HIST_READ		0	// Host read request latency
+#define HIST_WRITE		1	// Host write request latency
+#define HIST_GC_READ		2
+#define HIST_GC_WRITE		3
+#define HIST_SEQ_MERGE_READ	4
+#define HIST_RAN_MERGE_READ	5	// including cold, hot merge read
+#define HIST_SEQ_MERGE_WRITE	6
+#define HIST_RAN_MERGE_WRITE	7	// including cold, hot merge write
+#define HIST_MAP_READ		8
+#define HIST_MAP_WRITE		9
+#define HIST_ERASE		10
+#define HIST_WL_READ		11	// Static wear leveling migration
+#define HIST_WL_WRITE		12
+#define HIST_QUEUE_WAIT		13	// Wait of the GC, WL & erase commands in the die queues
+#define HIST_SUSPEND		14	// A program or an erase stopped for a host read, till it goes on
+#define HIST_SUB_LOG_WRITE	15	// Program of a sector log page
+#define HIST_SUB_MERGE_READ	16	// Data & log page reads of a sector log merge
+#define HIST_SUB_MERGE_WRITE	17
+#define HIST_CLASS_NB		18
+
+#define HIST_THREAD_NB		8	// Threads which record latencies, ex) host, firmware, background GC
+
 typedef struct nand_io_info
 {
 	int offset;
 	int type;
 	int io_page_nb;
 	int io_seq_nb;
+	int64_t issue_time;	// The FTL issued the page
 }nand_io_info;
 
 /* IO Latency */
@@ -27,17 +67,28 @@ typedef struct io_request
 	int	request_size	: 16;
 	int	start_count	: 16;
 	int	end_count	: 16;
+	int	in_use;
 	int64_t* 	start_time;
 	int64_t* 	end_time;
-	struct io_request* next;
+	int64_t*	slab_time;	// start_time, end_time of this slot in the slab
+	int64_t*	big_time;	// start_time, end_time of the requests bigger than the slab
+	int		big_page_nb;
 }io_request;
 
+typedef struct latency_histogram
+{
+	int64_t total_count;
+	int64_t min_value;
+	int64_t max_value;
+	double total_value;
+	int64_t count[HIST_BUCKET_NB];
+}latency_histogram;
+
 /* IO Latency */
 extern unsigned int io_request_nb;
 extern unsigned int io_request_seq_nb;
 
-extern struct io_request* io_request_start;
-extern struct io_request* io_request_end;
+extern struct io_request* io_request_ring;
 
 /* GC Latency */
 extern unsigned int gc_request_nb;
@@ -48,6 +99,10 @@ extern struct io_request* gc_request_end;
 
 extern int64_t written_page_nb;
 
+/* Latency Histogram */
+extern __thread latency_histogram* interval_histogram;
+extern latency_histogram* total_histogram;
+
 double GET_IO_BANDWIDTH(double delay);
 
 void INIT_PERF_CHECKER(void);
@@ -65,10 +120,24 @@ io_request* LOOKUP_IO_REQUEST(int request_nb, int type);
 int64_t CALC_IO_LATENCY(io_request* request);
 
 nand_io_info* CREATE_NAND_IO_INFO(int offset, int type, int io_page_nb, int io_seq_nb);
+void FREE_NAND_IO_INFO(nand_io_info* n_io_info);
+void INIT_NAND_IO_INFO(nand_io_info* n_io_info, int offset, int type, int io_page_nb, int io_seq_nb);
 
 void PRINT_IO_REQUEST(io_request* request);
 void PRINT_ALL_IO_REQUEST(void);
 
+void RESET_LATENCY_HISTOGRAM(latency_histogram* hist);
+void RECORD_LATENCY(latency_histogram* hist, int64_t value);
+void MERGE_LATENCY_HISTOGRAM(latency_histogram* dst, latency_histogram* src);
+int64_t GET_LATENCY_PERCENTILE(latency_histogram* hist, double percentile);
+int GET_HIST_CLASS(int op_type);
+latency_histogram* ALLOC_THREAD_HISTOGRAM(void);
+void RECORD_OP_LATENCY(int hist_class, int64_t latency);
+void ROTATE_LATENCY_HISTOGRAM(void);
+void ROTATE_ALL_LATENCY_HISTOGRAM(void);
+void PRINT_LATENCY_HISTOGRAM(FILE* fp);
+void DUMP_LATENCY_HISTOGRAM(char* file_name);
+
 void UPDATE_LOG(int log_type, int arg);
 void SEND_LOG_TO_MONITOR(void);
 #endif
@@ -0,0 +1,331 @@
+// File: ftl_pool_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Mallocs after SSD_INIT : pool chunks & the big io request time arrays */
+int64_t io_path_malloc_nb;
+int io_path_malloc_count;
+
+int INIT_POOL(obj_pool* pool, const char* name, size_t obj_size, int chunk_obj_nb)
+{
+	/* A free object holds the link of the free list */
+	if(obj_size < sizeof(void*)){
+		obj_size = sizeof(void*);
+	}
+	obj_size = (obj_size + 7) & ~(size_t)7;
+
+	if(chunk_obj_nb <= 0){
+		chunk_obj_nb = 1;
+	}
+
+	pool->name = name;
+	pool->obj_size = obj_size;
+	pool->chunk_obj_nb = chunk_obj_nb;
+	pool->free_list = NULL;
+	pool->chunk_list = NULL;
+	pool->bump = NULL;
+	pool->bump_end = NULL;
+	pool->used_nb = 0;
+	pool->max_used_nb = 0;
+	pool->chunk_nb = 0;
+	pool->io_path_chunk_nb = 0;
+
+	/* The first chunk is sized for the steady state */
+	return GROW_POOL(pool);
+}
+
+void TERM_POOL(obj_pool* pool)
+{
+	void* curr_chunk = pool->chunk_list;
+	void* next_chunk;
+
+	if(pool->io_path_chunk_nb != 0){
+		printf("Pool %s		%lld chunks on the I/O path, max %lld objects in use\n", \
+				pool->name, (long long)pool->io_path_chunk_nb, (long long)pool->max_used_nb);
+	}
+
+	while(curr_chunk != NULL){
+		next_chunk = *(void**)curr_chunk;
+		free(curr_chunk);
+		curr_chunk = next_chunk;
+	}
+
+	pool->free_list = NULL;
+	pool->chunk_list = NULL;
+	pool->bump = NULL;
+	pool->bump_end = NULL;
+	pool->used_nb = 0;
+}
+
+int GROW_POOL(obj_pool* pool)
+{
+	void* new_chunk = malloc(POOL_CHUNK_HEADER + pool->obj_size * pool->chunk_obj_nb);
+
+	if(new_chunk == NULL){
+		printf("ERROR[%s] Malloc %s pool chunk fail\n", __FUNCTION__, pool->name);
+		return FAIL;
+	}
+
+	*(void**)new_chunk = pool->chunk_list;
+	pool->chunk_list = new_chunk;
+
+	/* The objects are not linked, a big chunk is not touched until it is used */
+	pool->bump = (char*)new_chunk + POOL_CHUNK_HEADER;
+	pool->bump_end = pool->bump + pool->obj_size * pool->chunk_obj_nb;
+
+	pool->chunk_nb++;
+	if(io_path_malloc_count == 1){
+		pool->io_path_chunk_nb++;
+		io_path_malloc_nb++;
+	}
+
+	return SUCCESS;
+}
+
+/* Return a zeroed object */
+void* POOL_ALLOC(obj_pool* pool)
+{
+	void* obj;
+
+	if(pool->free_list != NULL){
+		obj = pool->free_list;
+		pool->free_list = *(void**)obj;
+	}
+	else{
+		if(pool->bump == pool->bump_end && GROW_POOL(pool) == FAIL){
+			return NULL;
+		}
+		obj = pool->bump;
+		pool->bump += pool->obj_size;
+	}
+	memset(obj, 0, pool->obj_size);
+
+	pool->used_nb++;
+	if(pool->used_nb > pool->max_used_nb){
+		pool->max_used_nb = pool->used_nb;
+	}
+
+	return obj;
+}
+
+void POOL_FREE(obj_pool* pool, void* obj)
+{
+	if(obj == NULL){
+		return;
+	}
+
+	*(void**)obj = pool->free_list;
+	pool->free_list = obj;
+	pool->used_nb--;
+}
+
+int INIT_ARENA(meta_arena* arena, size_t size)
+{
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	/* Only the touched pages take memory */
+	arena->base = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, \
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(arena->base == MAP_FAILED){
+		printf("ERROR[%s] Mmap %lu byte arena fail\n", __FUNCTION__, (unsigned long)size);
+		arena->base = NULL;
+		return FAIL;
+	}
+
+	arena->dirty_bitmap = (uint64_t*)calloc(BITMAP_WORD_NB(size / ARENA_ALIGN), sizeof(uint64_t));
+	if(arena->dirty_bitmap == NULL){
+		printf("ERROR[%s] Calloc dirty bitmap fail\n", __FUNCTION__);
+		munmap(arena->base, size);
+		arena->base = NULL;
+		return FAIL;
+	}
+
+	arena->size = size;
+	arena->used = 0;
+	arena->table_nb = 0;
+
+	return SUCCESS;
+}
+
+void TERM_ARENA(meta_arena* arena)
+{
+	if(arena->base != NULL){
+		munmap(arena->base, arena->size);
+	}
+	free(arena->dirty_bitmap);
+
+	arena->base = NULL;
+	arena->dirty_bitmap = NULL;
+	arena->size = 0;
+	arena->used = 0;
+	arena->table_nb = 0;
+}
+
+/* Return a zeroed table */
+void* ARENA_ALLOC(meta_arena* arena, size_t size)
+{
+	char* table;
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	if(arena->base == NULL || arena->used + size > arena->size){
+		printf("ERROR[%s] The arena is full\n", __FUNCTION__);
+		return NULL;
+	}
+
+	table = arena->base + arena->used;
+	arena->used += size;
+
+	return table;
+}
+
+/* Return a table which is saved to the file by ARENA_CHECKPOINT. With load, the table
+	has the contents of the file : the file is mapped copy-on-write and its pages are
+	read by the first touch. Otherwise, or if there is no file, the table is zeroed */
+void* ARENA_LOAD(meta_arena* arena, size_t size, const char* path, int load, int* loaded)
+{
+	int fd;
+	struct stat st;
+	size_t map_size;
+	arena_table* curr_table;
+	char* table;
+
+	*loaded = 0;
+	if(arena->table_nb == ARENA_TABLE_NB){
+		printf("ERROR[%s] Too many tables\n", __FUNCTION__);
+		return NULL;
+	}
+
+	table = (char*)ARENA_ALLOC(arena, size);
+	if(table == NULL){
+		return NULL;
+	}
+
+	fd = load ? open(path, O_RDONLY) : -1;
+	if(fd != -1){
+		if(fstat(fd, &st) == 0 && st.st_size > 0){
+			/* The pages past the end of a short file stay zero */
+			map_size = (size_t)st.st_size < size ? (size_t)st.st_size : size;
+			map_size = (map_size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+			if(mmap(table, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED){
+				printf("ERROR[%s] Mmap %s fail\n", __FUNCTION__, path);
+			}
+			else{
+				*loaded = 1;
+			}
+		}
+		close(fd);
+	}
+
+	curr_table = arena->table + arena->table_nb;
+	curr_table->path = path;
+	curr_table->offset = table - arena->base;
+	curr_table->size = size;
+	curr_table->synced = *loaded;
+	arena->table_nb++;
+
+	return table;
+}
+
+/* Write the dirty pages of the tables to their files. A dirty page is a private
+	copy of the mapping, the writes do not change the table. The zero pages of
+	a new file are left as holes */
+int ARENA_CHECKPOINT(meta_arena* arena)
+{
+	int i;
+	int fd;
+	int page_nb;
+	int end_page_nb;
+	size_t offset;
+	size_t len;
+	arena_table* curr_table;
+	int ret = SUCCESS;
+
+	for(i=0;i<arena->table_nb;i++){
+		curr_table = arena->table + i;
+
+		fd = open(curr_table->path, O_WRONLY | O_CREAT | (curr_table->synced ? 0 : O_TRUNC), 0644);
+		if(fd == -1){
+			printf("ERROR[%s] %s open fail\n", __FUNCTION__, curr_table->path);
+			ret = FAIL;
+			continue;
+		}
+		if(curr_table->synced == 0 && ftruncate(fd, curr_table->size) != 0){
+			ret = FAIL;
+		}
+
+		page_nb = curr_table->offset / ARENA_ALIGN;
+		end_page_nb = (curr_table->offset + curr_table->size + ARENA_ALIGN - 1) / ARENA_ALIGN;
+
+		while((page_nb = FIND_NEXT_BIT(arena->dirty_bitmap, end_page_nb, page_nb)) != -1){
+			CLEAR_BIT(arena->dirty_bitmap, page_nb);
+
+			offset = (size_t)page_nb * ARENA_ALIGN - curr_table->offset;
+			len = curr_table->size - offset < ARENA_ALIGN ? curr_table->size - offset : ARENA_ALIGN;
+			if(pwrite(fd, arena->base + curr_table->offset + offset, len, offset) != (ssize_t)len){
+				ret = FAIL;
+			}
+			page_nb++;
+		}
+
+		if(fdatasync(fd) != 0){
+			ret = FAIL;
+		}
+		close(fd);
+
+		if(ret == FAIL){
+			printf("ERROR[%s] Write %s fail\n", __FUNCTION__, curr_table->path);
+		}
+		else{
+			curr_table->synced = 1;
+		}
+	}
+
+	return ret;
+}
+
+/* The pages of [addr, addr + len) are not used any more, their memory is given back
+	and the next checkpoint does not write them. A page of a loaded table has the
+	contents of the file again, the owner rewrites it before the next use */
+void ARENA_RELEASE(meta_arena* arena, void* addr, size_t len)
+{
+	size_t page_nb = ((char*)addr - arena->base) / ARENA_ALIGN;
+	size_t end_page_nb = ((char*)addr + len - arena->base) / ARENA_ALIGN;
+
+	if(madvise(addr, len, MADV_DONTNEED) != 0){
+		printf("ERROR[%s] Madvise fail\n", __FUNCTION__);
+		return;
+	}
+
+	for(;page_nb<end_page_nb;page_nb++){
+		CLEAR_BIT(arena->dirty_bitmap, page_nb);
+	}
+}
+
+void START_IO_PATH_MALLOC_COUNT(void)
+{
+	io_path_malloc_nb = 0;
+	io_path_malloc_count = 1;
+}
+
+void COUNT_IO_PATH_MALLOC(void)
+{
+	if(io_path_malloc_count == 1){
+		io_path_malloc_nb++;
+	}
+}
+
+void PRINT_IO_PATH_MALLOC(void)
+{
+	printf("I/O Path Malloc		%lld\n", (long long)io_path_malloc_nb);
+	io_path_malloc_count = 0;
+}
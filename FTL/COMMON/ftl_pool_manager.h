@@ -0,0 +1,86 @@
+// File: ftl_pool_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _POOL_MANAGER_H_
+#define _POOL_MANAGER_H_
+
+#define POOL_CHUNK_HEADER	16	// Link of the chunk list, keeps the objects aligned
+#define ARENA_ALIGN		4096	// Each table of an arena starts on its own page
+#define ARENA_TABLE_NB		8	// Saved tables of an arena
+
+/* Fixed size object pool : the objects are cut out of the chunks and
+	recycled through the free list. A pool has no lock, it is used by the
+	thread of its subsystem only (the firmware thread, with FIRM_BUFFER_THREAD) */
+typedef struct obj_pool
+{
+	const char* name;
+	size_t obj_size;
+	int chunk_obj_nb;	// Objects of a chunk
+	void* free_list;	// The first word of a free object links the next one
+	void* chunk_list;
+	char* bump;		// The objects of the last chunk are cut out on demand
+	char* bump_end;
+	int64_t used_nb;
+	int64_t max_used_nb;
+	int64_t chunk_nb;
+	int64_t io_path_chunk_nb;	// Chunks allocated after SSD_INIT
+}obj_pool;
+
+/* A table of the arena which is saved to its file */
+typedef struct arena_table
+{
+	const char* path;
+	size_t offset;
+	size_t size;
+	int synced;		// The file has the table, only the dirty pages are written
+}arena_table;
+
+/* Metadata arena : an anonymous mapping reserved at INIT. The pages are
+	zero-filled by the first touch, so a table which encodes its initial
+	state as zero costs nothing until it is used */
+typedef struct meta_arena
+{
+	char* base;
+	size_t size;
+	size_t used;
+	uint64_t* dirty_bitmap;	// The pages written since the last checkpoint
+	arena_table table[ARENA_TABLE_NB];
+	int table_nb;
+}meta_arena;
+
+/* The entry of len byte at addr is modified, len is less than a page */
+static inline void ARENA_MARK_DIRTY(meta_arena* arena, void* addr, size_t len)
+{
+	size_t first_page = ((char*)addr - arena->base) / ARENA_ALIGN;
+	size_t last_page = ((char*)addr + len - 1 - arena->base) / ARENA_ALIGN;
+
+	SET_BIT(arena->dirty_bitmap, first_page);
+	SET_BIT(arena->dirty_bitmap, last_page);
+}
+
+extern int64_t io_path_malloc_nb;
+
+int INIT_POOL(obj_pool* pool, const char* name, size_t obj_size, int chunk_obj_nb);
+void TERM_POOL(obj_pool* pool);
+int GROW_POOL(obj_pool* pool);
+
+void* POOL_ALLOC(obj_pool* pool);
+void POOL_FREE(obj_pool* pool, void* obj);
+
+int INIT_ARENA(meta_arena* arena, size_t size);
+void TERM_ARENA(meta_arena* arena);
+void* ARENA_ALLOC(meta_arena* arena, size_t size);
+void* ARENA_LOAD(meta_arena* arena, size_t size, const char* path, int load, int* loaded);
+int ARENA_CHECKPOINT(meta_arena* arena);
+void ARENA_RELEASE(meta_arena* arena, void* addr, size_t len);
+
+/* Malloc counter of the I/O path, zero in the steady state */
+void START_IO_PATH_MALLOC_COUNT(void);
+void COUNT_IO_PATH_MALLOC(void);
+void PRINT_IO_PATH_MALLOC(void);
+
+#endif
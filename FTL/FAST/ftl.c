@@ -47,7 +47,6 @@ void FTL_INIT(void)
 
 		INIT_DATA_BLOCK_MAPPING();
 		INIT_INVERSE_BLOCK_MAPPING();
-		INIT_VALID_ARRAY();
 
 		INIT_EMPTY_BLOCK_LIST();
 
@@ -112,9 +111,12 @@ void FTL_TERM(void)
 
 #ifdef SSD_WRITE_BUFFER
 	TERM_WRITE_BUFFER();	
+#endif
+#ifdef VIRTUAL_TIME
+	TERM_SCHED_MANAGER();
+	TERM_TIME_MANAGER();
 #endif
 	TERM_DATA_BLOCK_MAPPING();
-	TERM_VALID_ARRAY();
 	TERM_INVERSE_BLOCK_MAPPING();
 
 	TERM_EMPTY_BLOCK_LIST();
@@ -186,6 +188,22 @@ void FTL_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 }
 
+void FTL_TRIM(trim_range* range, int range_nb)
+{
+	int i;
+	int trimmed_page_nb = 0;
+
+	for(i=0;i<range_nb;i++){
+		trimmed_page_nb += _FTL_TRIM(range[i].sector_nb, range[i].length);
+	}
+
+#ifdef MONITOR_ON
+	char szTemp[1024];
+	sprintf(szTemp, "TRIM INVALID %d ", trimmed_page_nb);
+	WRITE_LOG(szTemp);
+#endif
+}
+
 int _FTL_READ(int32_t sector_nb, unsigned int length)
 {
 	if(sector_nb + length > SECTOR_NB){
@@ -416,3 +434,62 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 	return ret;
 }
+
+/* Invalidate the pages which are all in the trimmed sectors, in the logs and
+	in the data block. The merges do not copy them */
+int _FTL_TRIM(int32_t sector_nb, unsigned int length)
+{
+	int32_t lpn;
+	int32_t end_lpn;
+	int32_t lba;
+	int trimmed_page_nb = 0;
+	int trimmed;
+
+	unsigned int log_flash_nb;
+	unsigned int log_block_nb;
+	unsigned int log_page_nb;
+
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+	unsigned int phy_page_nb;
+
+	inverse_block_mapping_entry* inverse_block_entry;
+
+	if((int64_t)sector_nb + length > SECTOR_NB){
+		printf("ERROR[%s] Exceed Sector number\n", __FUNCTION__);
+		return 0;
+	}
+
+	lpn = (int32_t)(((int64_t)sector_nb + SECTORS_PER_PAGE - 1) / SECTORS_PER_PAGE);
+	end_lpn = (int32_t)(((int64_t)sector_nb + length) / SECTORS_PER_PAGE);
+
+	for(;lpn<end_lpn;lpn++){
+		lba = lpn * (int32_t)SECTORS_PER_PAGE;
+		trimmed = 0;
+
+		log_flash_nb = (unsigned int)(lpn / (int32_t)PAGE_NB / (int32_t)BLOCK_NB);
+		log_block_nb = (unsigned int)(lpn / (int32_t)PAGE_NB % (int32_t)BLOCK_NB);
+		log_page_nb = (unsigned int)(lpn % (int32_t)PAGE_NB);
+
+		if(FIND_PAGE_IN_SEQ_LOG(lba, &phy_flash_nb, &phy_block_nb, &phy_page_nb) == SUCCESS){
+			UPDATE_INVERSE_BLOCK_VALIDITY(phy_flash_nb, phy_block_nb, phy_page_nb, INVALID);
+			trimmed = 1;
+		}
+		if(FIND_PAGE_IN_RAN_LOG(lba, &phy_flash_nb, &phy_block_nb, &phy_page_nb) == SUCCESS){
+			UPDATE_RAN_LOG_MAPPING_VALID(log_flash_nb, log_block_nb, log_page_nb, -1);
+			trimmed = 1;
+		}
+		if(FIND_PAGE_IN_DATA_BLOCK(lba, &phy_flash_nb, &phy_block_nb, &phy_page_nb) == SUCCESS){
+			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(phy_flash_nb, phy_block_nb);
+
+			if(TEST_BIT(VALID_BITMAP(inverse_block_entry->page_bitmap), phy_page_nb)){
+				UPDATE_INVERSE_BLOCK_VALIDITY(phy_flash_nb, phy_block_nb, phy_page_nb, INVALID);
+				trimmed = 1;
+			}
+		}
+
+		trimmed_page_nb += trimmed;
+	}
+
+	return trimmed_page_nb;
+}
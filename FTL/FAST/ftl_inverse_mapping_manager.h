@@ -16,9 +16,13 @@ typedef struct inverse_block_mapping_entry
 	unsigned int log_block_nb;
 	int valid_page_nb;
 	int type;
-	char* valid_array;
+
+	/* Valid & written page bitmap (PAGE_BITMAP_SIZE byte) */
+	uint64_t page_bitmap[];
 }inverse_block_mapping_entry;
 
+extern int inverse_block_mapping_entry_size;
+
 typedef struct empty_block_root
 {
 	struct empty_block_entry* next;
@@ -35,11 +39,9 @@ typedef struct empty_block_entry
 }empty_block_entry;
 
 void INIT_INVERSE_BLOCK_MAPPING(void);
-void INIT_VALID_ARRAY(void);
 void INIT_EMPTY_BLOCK_LIST(void);
 
 void TERM_INVERSE_BLOCK_MAPPING(void);
-void TERM_VALID_ARRAY(void);
 void TERM_EMPTY_BLOCK_LIST(void);
 
 void CAL_NEW_EMPTY_BLOCK_ADDR(int64_t count, unsigned int* phy_flash_nb, unsigned int* phy_block_nb);
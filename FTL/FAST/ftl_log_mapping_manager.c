@@ -747,7 +747,7 @@ int MERGE_SEQ_BLOCK(void)
 	unsigned int log_flash_nb;
 	unsigned int log_block_nb;
 
-	char* valid_array;
+	uint64_t* valid_bitmap;
 
 	double seq_block_util = 0;
 
@@ -819,20 +819,18 @@ int MERGE_SEQ_BLOCK(void)
 			}
 			else if(inverse_block_entry->valid_page_nb != 0){
 
-				valid_array = inverse_block_entry->valid_array;
+				valid_bitmap = VALID_BITMAP(inverse_block_entry->page_bitmap);
 
 				/* Partial Merge */
-				for(j=0;j<PAGE_NB;j++){
-					if(valid_array[j]=='V'){
-						ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, j, SEQ_MERGE_READ);
-						ret = SSD_PAGE_WRITE(seq_flash_nb, seq_block_nb, j, j, SEQ_MERGE_WRITE);
-						UPDATE_INVERSE_BLOCK_VALIDITY(seq_flash_nb, seq_block_nb, j, VALID);
+				for(j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); j != -1; j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, j+1)){
+					ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, j, SEQ_MERGE_READ);
+					ret = SSD_PAGE_WRITE(seq_flash_nb, seq_block_nb, j, j, SEQ_MERGE_WRITE);
+					UPDATE_INVERSE_BLOCK_VALIDITY(seq_flash_nb, seq_block_nb, j, VALID);
 
-						copy_page_nb++;
+					copy_page_nb++;
 #ifdef DEBUG_MODE8
-						seq_data_dbg8++;
+					seq_data_dbg8++;
 #endif
-					}
 				}
 				UPDATE_INVERSE_BLOCK_MAPPING(seq_flash_nb, seq_block_nb, log_flash_nb, log_block_nb, DATA_BLOCK);
 				UPDATE_INVERSE_BLOCK_MAPPING(data_flash_nb, data_block_nb, FLASH_NB, 0, EMPTY_BLOCK);
@@ -933,7 +931,7 @@ int MERGE_RAN_BLOCK(void)
 
 	unsigned int new_phy_flash_nb;
 	unsigned int new_phy_block_nb;
-	char* valid_array;
+	uint64_t* valid_bitmap;
 
 	unsigned int curr_phy_page_nb;
 
@@ -978,20 +976,18 @@ int MERGE_RAN_BLOCK(void)
 		if(data_flash_nb != FLASH_NB){
 
 			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(data_flash_nb, data_block_nb);
-			valid_array = inverse_block_entry->valid_array;
+			valid_bitmap = VALID_BITMAP(inverse_block_entry->page_bitmap);
 
-			for(j=0;j<PAGE_NB;j++){
-				if(valid_array[j]=='V'){
-					ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, j, RAN_MERGE_READ);
-					ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, j, RAN_MERGE_WRITE);
-					UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
+			for(j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); j != -1; j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, j+1)){
+				ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, j, RAN_MERGE_READ);
+				ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, j, RAN_MERGE_WRITE);
+				UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
 
-					copy_page_nb++;
+				copy_page_nb++;
 #ifdef DEBUG_MODE8
-					ran_data_dbg8++;
-					ran_total_dbg8++;
+				ran_data_dbg8++;
+				ran_total_dbg8++;
 #endif
-				}
 			}
 			UPDATE_INVERSE_BLOCK_MAPPING(data_flash_nb, data_block_nb, FLASH_NB, 0, EMPTY_BLOCK);
 
@@ -1180,7 +1176,7 @@ int FIND_PAGE_IN_SEQ_LOG(int32_t sector_nb, unsigned int* phy_flash_nb, unsigned
 
 			seq_block_entry = GET_SEQ_BLOCK_MAPPING_ENTRY(i);
 			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(seq_block_entry->phy_flash_nb, seq_block_entry->phy_block_nb);
-			if(inverse_block_entry->valid_array[log_page_nb_r] == 'V'){
+			if(TEST_BIT(VALID_BITMAP(inverse_block_entry->page_bitmap), log_page_nb_r)){
 
 				*phy_flash_nb = seq_block_entry->phy_flash_nb;
 				*phy_block_nb = seq_block_entry->phy_block_nb;
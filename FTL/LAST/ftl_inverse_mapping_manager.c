@@ -10,6 +10,7 @@
 #include "common.h"
 
 void* inverse_block_mapping_table_start;
+int inverse_block_mapping_entry_size;
 
 void* empty_block_table_start;
 unsigned int empty_block_table_index;
@@ -17,8 +18,11 @@ int64_t total_empty_block_nb;
 
 void INIT_INVERSE_BLOCK_MAPPING(void)
 {
+	/* The page bitmap is stored inline, after each mapping entry */
+	inverse_block_mapping_entry_size = sizeof(inverse_block_mapping_entry) + PAGE_BITMAP_SIZE;
+
 	/* Allocation Memory for Data Block Mapping Table */
-	inverse_block_mapping_table_start = (void*)calloc(BLOCK_MAPPING_ENTRY_NB, sizeof(inverse_block_mapping_entry));
+	inverse_block_mapping_table_start = (void*)calloc(BLOCK_MAPPING_ENTRY_NB, inverse_block_mapping_entry_size);
 	if(inverse_block_mapping_table_start == NULL){
 		printf("ERROR[INIT_INVERSE_BLOCK_MAPPING_TABLE] Calloc mapping table fail\n");
 		return;
@@ -27,53 +31,20 @@ void INIT_INVERSE_BLOCK_MAPPING(void)
 	/* Initialization Data Block Mapping Table */
 	FILE* fp = fopen("./data/inverse_block_mapping.dat","r");
 	if(fp != NULL){
-		fread(inverse_block_mapping_table_start, sizeof(inverse_block_mapping_entry), BLOCK_MAPPING_ENTRY_NB, fp);
+		fread(inverse_block_mapping_table_start, inverse_block_mapping_entry_size, BLOCK_MAPPING_ENTRY_NB, fp);
+		fclose(fp);
 	}
 	else{
 		int i;
-		inverse_block_mapping_entry* curr_mapping_entry = (inverse_block_mapping_entry*)inverse_block_mapping_table_start;
-		char* valid_array;
+		inverse_block_mapping_entry* curr_mapping_entry;
 
 		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			if(valid_array == NULL){
-				printf("ERROR[INIT_INVERSE_BLOCK_MAPPING] Calloc valid array fail\n");
-			}
-			memset(valid_array, 0, PAGE_NB);
+			curr_mapping_entry = (inverse_block_mapping_entry*)((char*)inverse_block_mapping_table_start + (int64_t)i * inverse_block_mapping_entry_size);
 
 			curr_mapping_entry->log_flash_nb 	= FLASH_NB;
 			curr_mapping_entry->log_block_nb 	= 0;
 			curr_mapping_entry->type		= EMPTY_BLOCK;
 			curr_mapping_entry->valid_page_nb	= 0;
-			curr_mapping_entry->valid_array		= valid_array;
-			curr_mapping_entry += 1;
-		}
-	}
-}
-
-void INIT_VALID_ARRAY(void)
-{
-	int i;
-	inverse_block_mapping_entry* curr_mapping_entry = (inverse_block_mapping_entry*)inverse_block_mapping_table_start;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","r");
-	if(fp != NULL){
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			fread(valid_array, sizeof(char), PAGE_NB, fp);
-			curr_mapping_entry->valid_array = valid_array;
-
-			curr_mapping_entry += 1;
-		}
-	}
-	else{
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			memset(valid_array,0,PAGE_NB);
-			curr_mapping_entry->valid_array = valid_array;
-
-			curr_mapping_entry += 1;
 		}
 	}
 }
@@ -178,32 +149,14 @@ void TERM_INVERSE_BLOCK_MAPPING(void)
 		return;
 	}
 
-	/* Write The inverse block table to file */
-	fwrite(inverse_block_mapping_table_start, sizeof(inverse_block_mapping_entry), BLOCK_MAPPING_ENTRY_NB, fp);
+	/* Write The inverse block table with the page bitmaps to file */
+	fwrite(inverse_block_mapping_table_start, inverse_block_mapping_entry_size, BLOCK_MAPPING_ENTRY_NB, fp);
+	fclose(fp);
 
 	/* Free The inverse block table memory */
 	free(inverse_block_mapping_table_start);
 }
 
-void TERM_VALID_ARRAY(void)
-{
-	int i;
-	inverse_block_mapping_entry* curr_mapping_entry = (inverse_block_mapping_entry*)inverse_block_mapping_table_start;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","w");
-	if(fp == NULL){
-		printf("ERROR[TERM_VALID_ARRAY] File open fail\n");
-		return;
-	}
-
-	for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-		valid_array = curr_mapping_entry->valid_array;
-		fwrite(valid_array, sizeof(char), PAGE_NB, fp);
-		curr_mapping_entry += 1;
-	}
-}
-
 void TERM_EMPTY_BLOCK_LIST(void)
 {
 	int i, j, k;
@@ -323,16 +276,15 @@ int INSERT_EMPTY_BLOCK(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 
 inverse_block_mapping_entry* GET_INVERSE_BLOCK_MAPPING_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_nb){
 
-	int64_t mapping_index = phy_flash_nb * BLOCK_NB + phy_block_nb;
+	int64_t mapping_index = (int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb;
 
-	inverse_block_mapping_entry* mapping_entry = (inverse_block_mapping_entry*)inverse_block_mapping_table_start + mapping_index;
+	inverse_block_mapping_entry* mapping_entry = (inverse_block_mapping_entry*)((char*)inverse_block_mapping_table_start + mapping_index * inverse_block_mapping_entry_size);
 
 	return mapping_entry;
 }
 
 int UPDATE_INVERSE_BLOCK_MAPPING(unsigned int phy_flash_nb, unsigned int phy_block_nb, unsigned int log_flash_nb, unsigned int log_block_nb, int type)
 {
-	int i;
 	inverse_block_mapping_entry* mapping_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(phy_flash_nb, phy_block_nb);
 
 	mapping_entry->log_flash_nb 	= log_flash_nb;
@@ -340,9 +292,8 @@ int UPDATE_INVERSE_BLOCK_MAPPING(unsigned int phy_flash_nb, unsigned int phy_blo
 	mapping_entry->type		= type;
 
 	if(type == EMPTY_BLOCK || type == EMPTY_DATA_BLOCK || type == EMPTY_SEQ_BLOCK || type == EMPTY_RAN_COLD_BLOCK || type == EMPTY_RAN_HOT_BLOCK){
-		for(i=0;i<PAGE_NB;i++){
-			UPDATE_INVERSE_BLOCK_VALIDITY(phy_flash_nb, phy_block_nb, i, 0);
-		}
+		CLEAR_PAGE_BITMAP(mapping_entry->page_bitmap);
+		mapping_entry->valid_page_nb = 0;
 	}
 
 	return SUCCESS;
@@ -355,32 +306,31 @@ int UPDATE_INVERSE_BLOCK_VALIDITY(unsigned int phy_flash_nb, unsigned int phy_bl
 		return FAIL;
 	}
 
-	int i;
-	int valid_count = 0;
 	inverse_block_mapping_entry* mapping_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(phy_flash_nb, phy_block_nb);
 
-	char* valid_array = mapping_entry->valid_array;
+	uint64_t* page_bitmap = mapping_entry->page_bitmap;
+	int old_valid = TEST_BIT(VALID_BITMAP(page_bitmap), phy_page_nb);
 
 	if(valid == VALID){
-		valid_array[phy_page_nb] = 'V';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, 'V');
 	}
 	else if(valid == INVALID){
-		valid_array[phy_page_nb] = 'I';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, 'I');
 	}
 	else if(valid == 0){
-		valid_array[phy_page_nb] = '0';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, '0');
 	}
 	else{
 		printf("ERROR[UPDATE_INVERSE_BLOCK_VALIDITY] Wrong valid value\n");
 	}
 
 	/* Update valid_page_nb */
-	for(i=0;i<PAGE_NB;i++){
-		if(valid_array[i] == 'V'){
-			valid_count++;
-		}
+	if(old_valid == 1 && valid != VALID){
+		mapping_entry->valid_page_nb--;
+	}
+	else if(old_valid == 0 && valid == VALID){
+		mapping_entry->valid_page_nb++;
 	}
-	mapping_entry->valid_page_nb = valid_count;
 
 	return SUCCESS;
 }
@@ -393,7 +343,7 @@ void PRINT_VALID_ARRAY(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 
 	printf("Type %d [%d][%d]valid array:\n",inverse_block_entry->type,  phy_flash_nb, phy_block_nb);
 	for(i=0;i<PAGE_NB;i++){
-		printf("%c ",inverse_block_entry->valid_array[i]);
+		printf("%c ",GET_BITMAP_PAGE_STATE(inverse_block_entry->page_bitmap, i));
 		cnt++;
 		if(cnt == 10){
 			printf("\n");
@@ -53,6 +53,9 @@ hot_page_entry* hot_page_list_head;
 hot_page_entry* hot_page_list_tail;
 unsigned int hot_page_nb;
 
+/* The window of the last HOT_PAGE_NB_THRESHOLD random writes */
+obj_pool hot_page_pool;
+
 unsigned int alloc_seq_block_index;
 unsigned int alloc_ran_cold_block_index;
 unsigned int alloc_ran_hot_block_index;
@@ -400,6 +403,9 @@ void INIT_HOT_PAGE_LIST(void)
 	hot_page_nb = 0;
 	hot_page_list_head = NULL;
 	hot_page_list_tail = NULL;
+
+	/* The new entry is inserted before the oldest one is freed */
+	INIT_POOL(&hot_page_pool, "hot_page", sizeof(hot_page_entry), HOT_PAGE_NB_THRESHOLD + 1);
 }
 
 void TERM_SEQ_BLOCK_MAPPING(void)
@@ -509,15 +515,11 @@ void TERM_RAN_HOT_LOG_MAPPING(void)
 
 void TERM_HOT_PAGE_LIST(void)
 {
-	int i;
+	TERM_POOL(&hot_page_pool);
 
-	hot_page_entry* curr_entry = hot_page_list_head;
-	hot_page_entry* prev_entry;
-	for(i=0;i<hot_page_nb;i++){
-		prev_entry = curr_entry;
-		curr_entry = curr_entry->next;
-		free(prev_entry);
-	}
+	hot_page_nb = 0;
+	hot_page_list_head = NULL;
+	hot_page_list_tail = NULL;
 }
 
 int SET_WRITE_TYPE(int32_t sector_nb, unsigned int length)
@@ -578,11 +580,11 @@ int FIND_IN_HOT_PAGE_LIST(int32_t sector_nb)
 
 void INSERT_HOT_PAGE(int32_t log_page_nb)
 {
-	hot_page_entry* curr_entry = (hot_page_entry*)calloc(1, sizeof(hot_page_entry));
+	hot_page_entry* curr_entry = (hot_page_entry*)POOL_ALLOC(&hot_page_pool);
 	hot_page_entry* prev_entry;
 
 	if(curr_entry == NULL){
-		printf("ERROR[INSERT_HOT_PAGE] Calloc fail\n");
+		printf("ERROR[INSERT_HOT_PAGE] Alloc fail\n");
 		return;
 	}
 
@@ -605,7 +607,7 @@ void INSERT_HOT_PAGE(int32_t log_page_nb)
 
 		prev_entry = hot_page_list_head;
 		hot_page_list_head = hot_page_list_head->next;
-		free(prev_entry);
+		POOL_FREE(&hot_page_pool, prev_entry);
 	}
 }
 
@@ -1125,7 +1127,7 @@ int MERGE_SEQ_BLOCK(void)
 	unsigned int log_flash_nb;
 	unsigned int log_block_nb;
 
-	char* valid_array;
+	uint64_t* valid_bitmap;
 
 	int copy_page_nb = 0;
 
@@ -1194,21 +1196,19 @@ int MERGE_SEQ_BLOCK(void)
 			}
 			else if(inverse_block_entry->valid_page_nb != 0){
 
-				valid_array = inverse_block_entry->valid_array;
+				valid_bitmap = VALID_BITMAP(inverse_block_entry->page_bitmap);
 
 				/* Partial Merge */
-				for(j=0;j<PAGE_NB;j++){
-					if(valid_array[j]=='V'){
-						ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, SEQ_MERGE_READ, -1);
-						ret = SSD_PAGE_WRITE(seq_flash_nb, seq_block_nb, j, 0, SEQ_MERGE_WRITE, -1);
-
-						UPDATE_INVERSE_BLOCK_VALIDITY(seq_flash_nb, seq_block_nb, j, VALID);
-						copy_page_nb++;
-						write_amp_pages++;
+				for(j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); j != -1; j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, j+1)){
+					ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, SEQ_MERGE_READ, -1);
+					ret = SSD_PAGE_WRITE(seq_flash_nb, seq_block_nb, j, 0, SEQ_MERGE_WRITE, -1);
+
+					UPDATE_INVERSE_BLOCK_VALIDITY(seq_flash_nb, seq_block_nb, j, VALID);
+					copy_page_nb++;
+					write_amp_pages++;
 #ifdef DEBUG_MODE8
-						seq_data_dbg8++;
+					seq_data_dbg8++;
 #endif
-					}
 				}
 				UPDATE_INVERSE_BLOCK_MAPPING(seq_flash_nb, seq_block_nb, log_flash_nb, log_block_nb, DATA_BLOCK);
 				UPDATE_INVERSE_BLOCK_MAPPING(data_flash_nb, data_block_nb, FLASH_NB, 0, EMPTY_BLOCK);
@@ -1305,7 +1305,7 @@ int MERGE_RAN_COLD_BLOCK(void)
 
 	unsigned int new_phy_flash_nb;
 	unsigned int new_phy_block_nb;
-	char* valid_array;
+	uint64_t* valid_bitmap;
 
 	unsigned int curr_phy_page_nb;
 
@@ -1352,20 +1352,18 @@ int MERGE_RAN_COLD_BLOCK(void)
 		if(data_flash_nb != FLASH_NB){
 
 			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(data_flash_nb, data_block_nb);
-			valid_array = inverse_block_entry->valid_array;
+			valid_bitmap = VALID_BITMAP(inverse_block_entry->page_bitmap);
 
-			for(j=0;j<PAGE_NB;j++){
-				if(valid_array[j]=='V'){
-					ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, RAN_COLD_MERGE_READ, -1);
-					ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, 0, RAN_COLD_MERGE_WRITE, -1);
+			for(j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); j != -1; j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, j+1)){
+				ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, RAN_COLD_MERGE_READ, -1);
+				ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, 0, RAN_COLD_MERGE_WRITE, -1);
 				
-					UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
-					copy_page_nb++;
+				UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
+				copy_page_nb++;
 #ifdef DEBUG_MODE8
-					ran_data_dbg8++;
-					ran_total_dbg8++;
+				ran_data_dbg8++;
+				ran_total_dbg8++;
 #endif
-				}
 			}
 			UPDATE_INVERSE_BLOCK_MAPPING(data_flash_nb, data_block_nb, FLASH_NB, 0, EMPTY_BLOCK);
 
@@ -1557,7 +1555,7 @@ int MERGE_RAN_HOT_BLOCK(void)
 
 	unsigned int new_phy_flash_nb;
 	unsigned int new_phy_block_nb;
-	char* valid_array;
+	uint64_t* valid_bitmap;
 
 	unsigned int curr_phy_page_nb;
 
@@ -1606,20 +1604,18 @@ int MERGE_RAN_HOT_BLOCK(void)
 		if(data_flash_nb != FLASH_NB){
 
 			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(data_flash_nb, data_block_nb);
-			valid_array = inverse_block_entry->valid_array;
-
-			for(j=0;j<PAGE_NB;j++){
-				if(valid_array[j]=='V'){
-					ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, RAN_HOT_MERGE_READ, -1);
-					ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, 0, RAN_HOT_MERGE_WRITE, -1);
-					
-					UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
-					copy_page_nb++;
+			valid_bitmap = VALID_BITMAP(inverse_block_entry->page_bitmap);
+
+			for(j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); j != -1; j=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, j+1)){
+				ret = SSD_PAGE_READ(data_flash_nb, data_block_nb, j, 0, RAN_HOT_MERGE_READ, -1);
+				ret = SSD_PAGE_WRITE(new_phy_flash_nb, new_phy_block_nb, j, 0, RAN_HOT_MERGE_WRITE, -1);
+				
+				UPDATE_INVERSE_BLOCK_VALIDITY(new_phy_flash_nb, new_phy_block_nb, j, VALID);
+				copy_page_nb++;
 #ifdef DEBUG_MODE8
-					ran_data_dbg8++;
-					ran_total_dbg8++;
+				ran_data_dbg8++;
+				ran_total_dbg8++;
 #endif
-				}
 			}
 			UPDATE_INVERSE_BLOCK_MAPPING(data_flash_nb, data_block_nb, FLASH_NB, 0, EMPTY_BLOCK);
 
@@ -1819,7 +1815,7 @@ int FIND_PAGE_IN_SEQ_LOG(int32_t sector_nb, unsigned int* phy_flash_nb, unsigned
 
 			seq_block_entry = GET_SEQ_BLOCK_MAPPING_ENTRY(i);
 			inverse_block_entry = GET_INVERSE_BLOCK_MAPPING_ENTRY(seq_block_entry->phy_flash_nb, seq_block_entry->phy_block_nb);
-			if(inverse_block_entry->valid_array[log_page_nb_r] == 'V'){
+			if(TEST_BIT(VALID_BITMAP(inverse_block_entry->page_bitmap), log_page_nb_r)){
 
 				*phy_flash_nb = seq_block_entry->phy_flash_nb;
 				*phy_block_nb = seq_block_entry->phy_block_nb;
@@ -27,16 +27,29 @@ void FTL_INIT(void)
         	printf("[%s] start\n", __FUNCTION__);
 
 		INIT_SSD_CONFIG();
+		INIT_META_ARENA();
+		INIT_META_JOURNAL();
 
+#ifndef FTL_MAP_CACHE
 		INIT_MAPPING_TABLE();
+#endif
 		INIT_INVERSE_MAPPING_TABLE();
 		INIT_BLOCK_STATE_TABLE();
-		INIT_VALID_ARRAY();
+		RECOVER_META_JOURNAL();
+		INIT_SUB_PAGE_MANAGER();
 		INIT_EMPTY_BLOCK_LIST();
 		INIT_VICTIM_BLOCK_LIST();
+		INIT_WEAR_LEVELING();
+#ifdef FTL_MULTI_STREAM
+		INIT_STREAM_MANAGER();
+#endif
+#ifdef FTL_MULTI_PLANE
+		INIT_STRIPE_BLOCK_TABLE();
+#endif
 		INIT_PERF_CHECKER();
 		
 #ifdef FTL_MAP_CACHE
+		/* The mapping table is paged in from the translation pages */
 		INIT_CACHE();
 #endif
 #ifdef FIRM_IO_BUFFER
@@ -66,12 +79,34 @@ void FTL_TERM(void)
 #ifdef FIRM_IO_BUFFER
 	TERM_FIRM_IO_BUFFER();
 #endif
+#ifdef GC_BACKGROUND
+	TERM_BACKGROUND_GC();
+#endif
+	TERM_SUB_PAGE_MANAGER();
+#ifdef FTL_MULTI_STREAM
+	TERM_STREAM_MANAGER();
+#endif
+#ifdef FTL_MULTI_PLANE
+	TERM_STRIPE_BLOCK_TABLE();
+#endif
+#ifdef FTL_MAP_CACHE
+	TERM_CACHE();
+#endif
+#ifdef VIRTUAL_TIME
+	TERM_SCHED_MANAGER();
+	TERM_TIME_MANAGER();
+#endif
+	PRINT_WRITE_AMPLIFICATION();
+#ifndef FTL_MAP_CACHE
 	TERM_MAPPING_TABLE();
+#endif
+	TERM_WEAR_LEVELING();
 	TERM_INVERSE_MAPPING_TABLE();
-	TERM_VALID_ARRAY();
 	TERM_BLOCK_STATE_TABLE();
 	TERM_EMPTY_BLOCK_LIST();
 	TERM_VICTIM_BLOCK_LIST();
+	TERM_META_JOURNAL();
+	TERM_META_ARENA();
 	TERM_PERF_CHECKER();
 
 #ifdef MONITOR_ON
@@ -106,6 +141,7 @@ void FTL_READ(int32_t sector_nb, unsigned int length)
 	start_ftl_r = get_usec();
 #endif
 	ret = _FTL_READ(sector_nb, length);
+	COMMIT_META_JOURNAL();
 #ifdef FTL_IO_LATENCY
 	end_ftl_r = get_usec();
 	if(length >= 128)
@@ -134,6 +170,7 @@ void FTL_WRITE(int32_t sector_nb, unsigned int length)
 	start_ftl_w = get_usec();
 #endif
 	ret = _FTL_WRITE(sector_nb, length);
+	COMMIT_META_JOURNAL();
 #ifdef FTL_IO_LATENCY
 	end_ftl_w = get_usec();
 	if(length >= 128)
@@ -141,6 +178,24 @@ void FTL_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 }
 
+/* The ranges of the trims are applied as one update of the metadata */
+void FTL_TRIM(trim_range* range, int range_nb)
+{
+	int i;
+	int trimmed_page_nb = 0;
+
+	for(i=0;i<range_nb;i++){
+		trimmed_page_nb += _FTL_TRIM(range[i].sector_nb, range[i].length);
+	}
+	COMMIT_META_JOURNAL();
+
+#ifdef MONITOR_ON
+	char szTemp[1024];
+	sprintf(szTemp, "TRIM INVALID %d ", trimmed_page_nb);
+	WRITE_LOG(szTemp);
+#endif
+}
+
 int _FTL_READ(int32_t sector_nb, unsigned int length)
 {
 #ifdef FTL_DEBUG
@@ -163,8 +218,17 @@ int _FTL_READ(int32_t sector_nb, unsigned int length)
 	unsigned int ret = FAIL;
 	int read_page_nb = 0;
 	int io_page_nb;
+	int log_read_nb = 0;
+
+	/* The pages are read at once after the mapping lookups */
+	nand_io_vec* io_vec;
+	nand_io_vec* curr_vec;
+	int vec_nb = 0;
 
-	nand_io_info* n_io_info = NULL;
+#ifdef FTL_MULTI_PLANE
+	int32_t last_lpn = (sector_nb + length - 1) / (int32_t)SECTORS_PER_PAGE;
+	int32_t stripe_end;
+#endif
 
 #ifdef FIRM_IO_BUFFER
 	INCREASE_RB_FTL_POINTER(length);
@@ -183,7 +247,15 @@ int _FTL_READ(int32_t sector_nb, unsigned int length)
 		lpn = lba / (int32_t)SECTORS_PER_PAGE;
 		ppn = GET_MAPPING_INFO(lpn);
 
+#ifdef FTL_SUB_PAGE
+		/* A page written in part has the sectors in the log only */
+		if(sub_page_log_table != NULL && GET_SUB_PAGE_ENTRY(lpn) != NULL){
+			log_read_nb += SUB_PAGE_READ(lpn, ppn, left_skip, read_sects, NULL, 0, 0);
+		}
+		else if(ppn == -1){
+#else
 		if(ppn == -1){
+#endif
 #ifdef FIRM_IO_BUFFER
 			INCREASE_RB_LIMIT_POINTER();
 #endif
@@ -197,6 +269,14 @@ int _FTL_READ(int32_t sector_nb, unsigned int length)
 
 	io_alloc_overhead = ALLOC_IO_REQUEST(sector_nb, length, READ, &io_page_nb);
 
+	io_vec = SSD_GET_IO_VEC(io_page_nb + log_read_nb);
+	if(io_vec == NULL){
+#ifdef FIRM_IO_BUFFER
+		INCREASE_RB_LIMIT_POINTER();
+#endif
+		return FAIL;
+	}
+
 	remain = length;
 	lba = sector_nb;
 	left_skip = sector_nb % SECTORS_PER_PAGE;
@@ -225,19 +305,56 @@ int _FTL_READ(int32_t sector_nb, unsigned int length)
 #endif
 		}
 
-		/* Read data from NAND page */
-                n_io_info = CREATE_NAND_IO_INFO(read_page_nb, READ, io_page_nb, io_request_seq_nb);
+#ifdef FTL_MULTI_PLANE
+		/* The pages on the planes of a flash, read them at once */
+		if(PLANES_PER_FLASH > 1 && last_lpn - lpn >= PLANES_PER_FLASH - 1 \
+				&& _FTL_STRIPE_READ(lpn, io_page_nb, read_page_nb) == SUCCESS){
+
+			stripe_end = (lpn + PLANES_PER_FLASH) * (int32_t)SECTORS_PER_PAGE;
+			if(stripe_end > sector_nb + (int32_t)length){
+				stripe_end = sector_nb + (int32_t)length;
+			}
+
+			ret = SUCCESS;
+			read_page_nb += PLANES_PER_FLASH;
+			remain -= stripe_end - lba;
+			lba = stripe_end;
+			left_skip = 0;
+			continue;
+		}
+#endif
+
+#ifdef FTL_SUB_PAGE
+		/* The data page & the log pages of the sectors */
+		if(sub_page_log_table != NULL && GET_SUB_PAGE_ENTRY(lpn) != NULL){
+			log_read_nb = SUB_PAGE_READ(lpn, ppn, left_skip, read_sects, io_vec + vec_nb, read_page_nb, io_page_nb);
 
-		ret = SSD_PAGE_READ(CALC_FLASH(ppn), CALC_BLOCK(ppn), CALC_PAGE(ppn), n_io_info);
+			/* All the sectors are in the open log page */
+			if(log_read_nb == 0){
+				UPDATE_IO_REQUEST(io_request_seq_nb, read_page_nb, get_usec(), UPDATE_START_TIME);
+				UPDATE_IO_REQUEST(io_request_seq_nb, read_page_nb, get_usec(), UPDATE_END_TIME);
+			}
+			vec_nb += log_read_nb;
+			ret = SUCCESS;
 
-#ifdef FTL_DEBUG
-		if(ret == SUCCESS){
-			printf("\t read complete [%u]\n",ppn);
-		}
-		else if(ret == FAIL){
-			printf("ERROR[%s] %u page read fail \n",__FUNCTION__, ppn);
+			read_page_nb++;
+
+			lba += read_sects;
+			remain -= read_sects;
+			left_skip = 0;
+			continue;
 		}
 #endif
+
+		/* Read data from NAND page, with the other pages of the request */
+		curr_vec = io_vec + vec_nb;
+		curr_vec->flash_nb = CALC_FLASH(ppn);
+		curr_vec->block_nb = CALC_BLOCK(ppn);
+		curr_vec->page_nb = CALC_PAGE(ppn);
+		curr_vec->old_flash_nb = -1;
+		INIT_NAND_IO_INFO(&curr_vec->io_info, read_page_nb, READ, io_page_nb, io_request_seq_nb);
+		vec_nb++;
+
 		read_page_nb++;
 
 		lba += read_sects;
@@ -246,6 +363,14 @@ int _FTL_READ(int32_t sector_nb, unsigned int length)
 
 	}
 
+	if(vec_nb != 0){
+		SSD_PAGE_READV(io_vec, vec_nb);
+		ret = SUCCESS;
+#ifdef FTL_DEBUG
+		printf("\t read complete [%d pages]\n", vec_nb);
+#endif
+	}
+
 	INCREASE_IO_REQUEST_SEQ_NB();
 
 #ifdef FIRM_IO_BUFFER
@@ -281,11 +406,12 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
         }
 	else{
 		io_alloc_overhead = ALLOC_IO_REQUEST(sector_nb, length, WRITE, &io_page_nb);
+		COUNT_HOST_WRITE(sector_nb, length);
 	}
 
 	int32_t lba = sector_nb;
 	int32_t lpn;
-	int32_t new_ppn;
+	int32_t new_ppn = -1;
 	int32_t old_ppn;
 
 	unsigned int remain = length;
@@ -295,7 +421,28 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
 
 	unsigned int ret = FAIL;
 	int write_page_nb=0;
-	nand_io_info* n_io_info = NULL;
+#ifdef FTL_SUB_PAGE
+	int64_t sub_page_start_time;
+#endif
+
+	/* The pages are written at once after the mapping updates */
+	nand_io_vec* io_vec = SSD_GET_IO_VEC(io_page_nb);
+	nand_io_vec* curr_vec;
+	int vec_nb = 0;
+
+	if(io_vec == NULL){
+		if(ssd_timing_off == 0){
+			FREE_DUMMY_IO_REQUEST(WRITE);
+		}
+		INCREASE_IO_REQUEST_SEQ_NB();
+#ifdef FIRM_IO_BUFFER
+		if(ssd_timing_off == 0){
+			INCREASE_WB_FTL_POINTER(length);
+			INCREASE_WB_LIMIT_POINTER();
+		}
+#endif
+		return FAIL;
+	}
 
 	while(remain > 0){
 
@@ -308,61 +455,143 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
 
 		write_sects = SECTORS_PER_PAGE - left_skip - right_skip;
 
+#if defined FTL_MULTI_PLANE && !defined FTL_MULTI_STREAM
+		/* Full pages for all the planes, program them at once.
+			With FTL_MULTI_STREAM, the host pages go to the open blocks of their stream */
+		if(PLANES_PER_FLASH > 1 && left_skip == 0 \
+				&& remain >= SECTORS_PER_PAGE * PLANES_PER_FLASH){
+
+			lpn = lba / (int32_t)SECTORS_PER_PAGE;
+			if(_FTL_STRIPE_WRITE(lpn, io_page_nb, write_page_nb, &new_ppn) == SUCCESS){
 #ifdef FIRM_IO_BUFFER
-		INCREASE_WB_FTL_POINTER(write_sects);
+				if(ssd_timing_off == 0){
+					INCREASE_WB_FTL_POINTER(SECTORS_PER_PAGE * PLANES_PER_FLASH);
+				}
+#endif
+				ret = SUCCESS;
+				write_page_nb += PLANES_PER_FLASH;
+				lba += SECTORS_PER_PAGE * PLANES_PER_FLASH;
+				remain -= SECTORS_PER_PAGE * PLANES_PER_FLASH;
+				continue;
+			}
+		}
 #endif
 
-#ifdef WRITE_NOPARAL
+#ifdef FIRM_IO_BUFFER
+		/* The preconditioning writes are not in the write buffer */
+		if(ssd_timing_off == 0){
+			INCREASE_WB_FTL_POINTER(write_sects);
+		}
+#endif
+
+		lpn = lba / (int32_t)SECTORS_PER_PAGE;
+
+#ifdef FTL_SUB_PAGE
+		/* A part of the page goes to the sector log, without the read-modify-write */
+		if((left_skip || right_skip) && sub_page_log_table != NULL && SUB_PAGE_ADMIT(lpn, left_skip, write_sects) == SUCCESS){
+			sub_page_start_time = get_usec();
+			ret = SUB_PAGE_WRITE(lpn, left_skip, write_sects, &new_ppn);
+			if(ret == FAIL){
+				printf("ERROR[%s] Sub page write fail\n", __FUNCTION__);
+				break;
+			}
+
+			/* The page is in the DRAM, done with the log program & the merges it made */
+			if(ssd_timing_off == 0){
+				UPDATE_IO_REQUEST(io_request_seq_nb, write_page_nb, sub_page_start_time, UPDATE_START_TIME);
+				UPDATE_IO_REQUEST(io_request_seq_nb, write_page_nb, \
+						sub_page_due_time > get_usec() ? sub_page_due_time : get_usec(), UPDATE_END_TIME);
+			}
+			write_page_nb++;
+
+			lba += write_sects;
+			remain -= write_sects;
+			left_skip = 0;
+			continue;
+		}
+		if(sub_page_log_table != NULL){
+			DROP_SUB_PAGE(lpn);
+		}
+#endif
+
+#ifdef FTL_MULTI_STREAM
+		ret = GET_NEW_STREAM_PAGE(CLASSIFY_WRITE_STREAM(lpn), VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
+#elif defined WRITE_NOPARAL
 		ret = GET_NEW_PAGE(VICTIM_NOPARAL, empty_block_table_index, &new_ppn);
 #else
 		ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
 #endif
 		if(ret == FAIL){
 			printf("ERROR[%s] Get new page fail \n", __FUNCTION__);
-			return FAIL;
+			break;
 		}
-
-		lpn = lba / (int32_t)SECTORS_PER_PAGE;
 		old_ppn = GET_MAPPING_INFO(lpn);
 
-		n_io_info = CREATE_NAND_IO_INFO(write_page_nb, WRITE, io_page_nb, io_request_seq_nb);
+		curr_vec = io_vec + vec_nb;
+		curr_vec->flash_nb = CALC_FLASH(new_ppn);
+		curr_vec->block_nb = CALC_BLOCK(new_ppn);
+		curr_vec->page_nb = CALC_PAGE(new_ppn);
+		INIT_NAND_IO_INFO(&curr_vec->io_info, write_page_nb, WRITE, io_page_nb, io_request_seq_nb);
 
+		/* A part of the page, the rest is read from the old page */
 		if((left_skip || right_skip) && (old_ppn != -1)){
-			ret = SSD_PAGE_PARTIAL_WRITE(
-				CALC_FLASH(old_ppn), CALC_BLOCK(old_ppn), CALC_PAGE(old_ppn),
-				CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn),
-				n_io_info);
+			curr_vec->old_flash_nb = CALC_FLASH(old_ppn);
+			curr_vec->old_block_nb = CALC_BLOCK(old_ppn);
+			curr_vec->old_page_nb = CALC_PAGE(old_ppn);
 		}
 		else{
-			ret = SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
+			curr_vec->old_flash_nb = -1;
 		}
+		vec_nb++;
 		
 		write_page_nb++;
 
 		UPDATE_OLD_PAGE_MAPPING(lpn);
 		UPDATE_NEW_PAGE_MAPPING(lpn, new_ppn);
 
-#ifdef FTL_DEBUG
-                if(ret == SUCCESS){
-                        printf("\twrite complete [%d, %d, %d]\n",CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn),CALC_PAGE(new_ppn));
-                }
-                else if(ret == FAIL){
-                        printf("ERROR[%s] %d page write fail \n",__FUNCTION__, new_ppn);
-                }
-#endif
 		lba += write_sects;
 		remain -= write_sects;
 		left_skip = 0;
 
 	}
 
+	/* The mappings of the pages before a failed page are updated, write them */
+	if(vec_nb != 0){
+		SSD_PAGE_WRITEV(io_vec, vec_nb);
+		ret = SUCCESS;
+#ifdef FTL_DEBUG
+		printf("\twrite complete [%d pages]\n", vec_nb);
+#endif
+	}
+
+	/* The pages from the failed one are not written,
+		the request completes with the written pages */
+	if(remain > 0){
+		if(ssd_timing_off == 0){
+			for(;write_page_nb<io_page_nb;write_page_nb++){
+				UPDATE_IO_REQUEST(io_request_seq_nb, write_page_nb, get_usec(), UPDATE_START_TIME);
+				UPDATE_IO_REQUEST(io_request_seq_nb, write_page_nb, get_usec(), UPDATE_END_TIME);
+			}
+		}
+#ifdef FIRM_IO_BUFFER
+		if(ssd_timing_off == 0){
+			INCREASE_WB_FTL_POINTER(remain - write_sects);
+		}
+#endif
+		ret = FAIL;
+	}
+
 	INCREASE_IO_REQUEST_SEQ_NB();
 #ifdef GC_ON
-	GC_CHECK(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn));
+	if(new_ppn != -1){
+		GC_CHECK(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn));
+	}
 #endif
 
 #ifdef FIRM_IO_BUFFER
-	INCREASE_WB_LIMIT_POINTER();
+	if(ssd_timing_off == 0){
+		INCREASE_WB_LIMIT_POINTER();
+	}
 #endif
 
 #ifdef MONITOR_ON
@@ -374,3 +603,129 @@ int _FTL_WRITE(int32_t sector_nb, unsigned int length)
 #endif
 	return ret;
 }
+
+/* Unmap the pages which are all in the trimmed sectors, the pages partly in them
+	keep the data. Return the number of the invalidated pages */
+int _FTL_TRIM(int32_t sector_nb, unsigned int length)
+{
+	int32_t lpn;
+	int32_t end_lpn;
+	int trimmed_page_nb = 0;
+
+	if((int64_t)sector_nb + length > SECTOR_NB){
+		printf("ERROR[%s] Exceed Sector number\n", __FUNCTION__);
+		return 0;
+	}
+
+	lpn = (int32_t)(((int64_t)sector_nb + SECTORS_PER_PAGE - 1) / SECTORS_PER_PAGE);
+	end_lpn = (int32_t)(((int64_t)sector_nb + length) / SECTORS_PER_PAGE);
+
+	for(;lpn<end_lpn;lpn++){
+#ifdef FTL_SUB_PAGE
+		DROP_SUB_PAGE(lpn);
+#endif
+		if(GET_MAPPING_INFO(lpn) == -1){
+			continue;
+		}
+
+		REMOVE_PAGE_MAPPING(lpn);
+		trimmed_page_nb++;
+	}
+
+	return trimmed_page_nb;
+}
+
+#ifdef FTL_MULTI_PLANE
+/* Read PLANES_PER_FLASH pages from the lpn with one multi-plane read,
+	FAIL if they are not on the different planes of a flash at the same page offset */
+int _FTL_STRIPE_READ(int32_t lpn, int io_page_nb, int read_page_nb)
+{
+	int i;
+	int32_t ppn;
+	int32_t* ppn_list = stripe_ppn_list;
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		stripe_block_list[i] = -1;
+	}
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		ppn = GET_MAPPING_INFO(lpn + i);
+		if(ppn == -1){
+			return FAIL;
+		}
+#ifdef FTL_SUB_PAGE
+		/* The sectors in the log are read by SUB_PAGE_READ */
+		if(sub_page_log_table != NULL && GET_SUB_PAGE_ENTRY(lpn + i) != NULL){
+			return FAIL;
+		}
+#endif
+		if(i != 0 && (CALC_FLASH(ppn) != CALC_FLASH(ppn_list[0]) || CALC_PAGE(ppn) != CALC_PAGE(ppn_list[0]))){
+			return FAIL;
+		}
+		if(stripe_block_list[CALC_BLOCK(ppn) % PLANES_PER_FLASH] != -1){
+			return FAIL;
+		}
+
+		ppn_list[i] = ppn;
+		stripe_block_list[CALC_BLOCK(ppn) % PLANES_PER_FLASH] = CALC_BLOCK(ppn);
+	}
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		stripe_io_info_list[CALC_BLOCK(ppn_list[i]) % PLANES_PER_FLASH] = \
+			CREATE_NAND_IO_INFO(read_page_nb + i, READ, io_page_nb, io_request_seq_nb);
+	}
+
+	if(SSD_MULTI_PLANE_READ(CALC_FLASH(ppn_list[0]), stripe_block_list, CALC_PAGE(ppn_list[0]), stripe_io_info_list) == FAIL){
+		printf("ERROR[%s] Multi-plane read fail\n", __FUNCTION__);
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			FREE_NAND_IO_INFO(stripe_io_info_list[i]);
+			stripe_io_info_list[i] = NULL;
+		}
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+/* Write PLANES_PER_FLASH pages from the lpn with one multi-plane program,
+	FAIL if there is no stripe, then the pages are written one by one */
+int _FTL_STRIPE_WRITE(int32_t lpn, int io_page_nb, int write_page_nb, int32_t* last_ppn)
+{
+	int i;
+	int32_t* ppn_list = stripe_ppn_list;
+
+	if(GET_NEW_STRIPE_PAGE(ppn_list) == FAIL){
+		return FAIL;
+	}
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		stripe_block_list[i] = CALC_BLOCK(ppn_list[i]);
+		stripe_io_info_list[i] = CREATE_NAND_IO_INFO(write_page_nb + i, WRITE, io_page_nb, io_request_seq_nb);
+	}
+
+	/* The pages of the stripe are not mapped, GC reclaims them.
+		The lpns are written by the single page writes */
+	if(SSD_MULTI_PLANE_WRITE(CALC_FLASH(ppn_list[0]), stripe_block_list, CALC_PAGE(ppn_list[0]), stripe_io_info_list) == FAIL){
+		printf("ERROR[%s] Multi-plane write fail\n", __FUNCTION__);
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			FREE_NAND_IO_INFO(stripe_io_info_list[i]);
+			stripe_io_info_list[i] = NULL;
+		}
+		return FAIL;
+	}
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+#ifdef FTL_SUB_PAGE
+		if(sub_page_log_table != NULL){
+			DROP_SUB_PAGE(lpn + i);
+		}
+#endif
+		UPDATE_OLD_PAGE_MAPPING(lpn + i);
+		UPDATE_NEW_PAGE_MAPPING(lpn + i, ppn_list[i]);
+	}
+
+	*last_ppn = ppn_list[PLANES_PER_FLASH - 1];
+
+	return SUCCESS;
+}
+#endif
@@ -15,7 +15,14 @@ void FTL_TERM(void);
 
 void FTL_READ(int32_t sector_nb, unsigned int length);
 void FTL_WRITE(int32_t sector_nb, unsigned int length);
+void FTL_TRIM(trim_range* range, int range_nb);
 
 int _FTL_READ(int32_t sector_nb, unsigned int length);
 int _FTL_WRITE(int32_t sector_nb, unsigned int length);
+int _FTL_TRIM(int32_t sector_nb, unsigned int length);
+
+#ifdef FTL_MULTI_PLANE
+int _FTL_STRIPE_READ(int32_t lpn, int io_page_nb, int read_page_nb);
+int _FTL_STRIPE_WRITE(int32_t lpn, int io_page_nb, int write_page_nb, int32_t* last_ppn);
+#endif
 #endif
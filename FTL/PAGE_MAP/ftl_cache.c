@@ -9,142 +9,418 @@
 
 #ifdef FTL_MAP_CACHE
 
-struct map_data* cache_map_data_start;
-struct map_data* cache_map_data_end;
+/* Demand-based page mapping (DFTL)
+ *	- The translation pages are stored in the translation blocks (MAP_BLOCK),
+ *	  their contents are kept in ./data/map_page.dat instead of DRAM
+ *	- map_state_table (GTD) has the ppn of every translation page
+ *	- cache_idx_table (CMT) caches CACHE_IDX_SIZE translation pages,
+ *	  a dirty translation page is written back when it is evicted
+ *	- The GTD & the translation pages are saved by TERM_CACHE only,
+ *	  after a crash they are rebuilt from the replayed inverse mapping
+ */
 
-uint32_t cache_map_data_nb;
 cache_idx_entry* cache_idx_table;
 map_state_entry* map_state_table;
 static uint32_t clock_hand;
+static uint32_t cache_entry_nb;
+
+/* Translation page contents in the simulated flash */
+FILE* fp_map_page;
+void* map_page_buf;
+
+/* Current translation block */
+empty_block_entry* map_block;
+
+/* Batch update of the translation pages which are not cached (GC) */
+int batch_update;
+int32_t* batch_lpn;
+int32_t* batch_ppn;
+int batch_update_nb;
+
+/* Map cache statistics */
+int64_t cache_hit_nb;
+int64_t cache_miss_nb;
+int64_t map_read_nb;
+int64_t map_write_nb;
+
+/* GC for the translation block, or the GC of a translation block is running */
+static int map_gc;
+
+int FLUSH_BATCH_UPDATE(void);
 
 void INIT_CACHE(void)
 {
 	int i;
-	FILE* fp = fopen("./data/cache_map_data.dat","r");
 	cache_idx_entry* curr_idx_entry;
 	map_state_entry* curr_map_entry;
 
-	if(fp != NULL){
+	/* Initialize cache index table (CMT) */
+	cache_idx_table = (cache_idx_entry*)calloc(CACHE_IDX_SIZE, sizeof(cache_idx_entry));
+	if(cache_idx_table == NULL){
+		printf("ERROR[%s] calloc fail\n",__FUNCTION__);
+		return;
 	}
-	else{
 
-		/* Initialize cache index table */
-		cache_idx_table = (cache_idx_entry*)calloc(CACHE_IDX_SIZE, sizeof(cache_idx_entry));
-		if(cache_idx_table == NULL){
+	curr_idx_entry = (cache_idx_entry *)cache_idx_table;
+	for(i=0; i<CACHE_IDX_SIZE;i++){
+		curr_idx_entry->map_num = 0;
+		curr_idx_entry->clock_bit = 0;
+		curr_idx_entry->in_use = 0;
+		curr_idx_entry->update_bit = 0;
+
+		curr_idx_entry->data = (void*)calloc(1, PAGE_SIZE);
+		if(curr_idx_entry->data == NULL){
 			printf("ERROR[%s] calloc fail\n",__FUNCTION__);
 			return;
 		}
 
-		curr_idx_entry = (cache_idx_entry *)cache_idx_table;
-		for(i=0; i<CACHE_IDX_SIZE;i++){
-			curr_idx_entry->map_num = 0;
-			curr_idx_entry->clock_bit = 0;
-			curr_idx_entry->map_type = 0;
-			curr_idx_entry->update_bit = 0;
-			
-			curr_idx_entry->data = (void*)calloc(1, PAGE_SIZE);
-
-			curr_idx_entry += 1;
-		}
+		curr_idx_entry += 1;
+	}
 
-		clock_hand = 0;
+	clock_hand = 0;
+	cache_entry_nb = 0;
+
+	/* Initialize map state table (GTD) */
+	map_state_table = (map_state_entry*)calloc(MAP_ENTRY_NB, sizeof(map_state_entry));
+	map_page_buf = (void*)calloc(1, PAGE_SIZE);
+	batch_lpn = (int32_t*)calloc(PAGE_NB, sizeof(int32_t));
+	batch_ppn = (int32_t*)calloc(PAGE_NB, sizeof(int32_t));
+	if(map_state_table == NULL || map_page_buf == NULL || batch_lpn == NULL || batch_ppn == NULL){
+		printf("ERROR[%s] calloc fail\n",__FUNCTION__);
+		return;
+	}
 
-		/* Initialize map state table */
-		map_state_table = (map_state_entry*)calloc(MAP_ENTRY_NB, sizeof(map_state_entry));
-		if(map_state_table == NULL){
-			printf("ERROR[%s] calloc fail\n",__FUNCTION__);
-			return;
+	/* The GTD of a crash or of an older SSD is not loaded */
+	FILE* fp = NULL;
+	if(meta_state == META_CLEAN){
+		fp = fopen("./data/map_state_table.dat","r");
+	}
+	if(fp != NULL){
+		curr_map_entry = map_state_table;
+		for(i=0; i<MAP_ENTRY_NB;i++){
+			fread(&curr_map_entry->ppn, sizeof(int32_t), 1, fp);
+			curr_map_entry += 1;
 		}
+		fclose(fp);
 
-		int32_t new_ppn;
-		int ret;
+		fp_map_page = fopen("./data/map_page.dat","r+");
+	}
+	else{
+		/* No translation page is written yet */
 		curr_map_entry = map_state_table;
 		for(i=0; i<MAP_ENTRY_NB;i++){
-#ifdef WRITE_NOPARAL
-	                ret = GET_NEW_PAGE(VICTIM_NOPARAL, empty_block_table_index, &new_ppn);
-#else
-	                ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
-#endif
-			curr_map_entry->ppn = new_ppn;
-			curr_map_entry->is_cached = 0;
-			curr_map_entry->cache_entry = NULL;
-
+			curr_map_entry->ppn = MAP_PAGE_NONE;
 			curr_map_entry += 1;
 		}
 
-		cache_map_data_start = NULL;
-		cache_map_data_end = NULL;
-		cache_map_data_nb = 0;
+		fp_map_page = fopen("./data/map_page.dat","w+");
+	}
+	if(fp_map_page == NULL){
+		printf("ERROR[%s] map page file open fail\n",__FUNCTION__);
+		return;
+	}
+
+	curr_map_entry = map_state_table;
+	for(i=0; i<MAP_ENTRY_NB;i++){
+		curr_map_entry->is_cached = 0;
+		curr_map_entry->cache_entry = NULL;
+		curr_map_entry += 1;
+	}
+
+	map_block = NULL;
+	map_gc = 0;
+
+	batch_update = 0;
+	batch_update_nb = 0;
+
+	cache_hit_nb = 0;
+	cache_miss_nb = 0;
+	map_read_nb = 0;
+	map_write_nb = 0;
+
+	/* The journal does not have the mapping updates of the cache */
+	if(meta_state == META_CRASH){
+		REBUILD_MAP_PAGE();
 	}
 }
 
-int32_t CACHE_GET_PPN(int32_t lpn)
+void TERM_CACHE(void)
 {
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] start\n",__FUNCTION__);
-#endif
-	uint32_t map_index = lpn / MAP_ENTRIES_PER_PAGE;
-	int32_t* map_data = NULL;
+	int i;
+	cache_idx_entry* curr_idx_entry = cache_idx_table;
+
+	/* Write back the dirty translation pages */
+	for(i=0; i<CACHE_IDX_SIZE; i++){
+		if(curr_idx_entry->in_use && curr_idx_entry->update_bit){
+			if(WRITE_MAP(curr_idx_entry->map_num, curr_idx_entry->data) == FAIL){
+				printf("ERROR[%s] The updates of map %u are lost\n", __FUNCTION__, curr_idx_entry->map_num);
+			}
+			else{
+				curr_idx_entry->update_bit = 0;
+			}
+		}
+		curr_idx_entry += 1;
+	}
+
+	/* Return the current translation block to the block lists */
+	if(map_block != NULL){
+		if(map_block->curr_phy_page_nb == 0){
+			INSERT_EMPTY_BLOCK(map_block->phy_flash_nb, map_block->phy_block_nb);
+			POOL_FREE(&empty_block_pool, map_block);
+		}
+		else{
+			INSERT_VICTIM_BLOCK(map_block);
+		}
+		map_block = NULL;
+	}
+
+	printf("Map Cache Hit		%lld\n", (long long)cache_hit_nb);
+	printf("Map Cache Miss		%lld\n", (long long)cache_miss_nb);
+	printf("Map Page Read		%lld\n", (long long)map_read_nb);
+	printf("Map Page Write		%lld\n", (long long)map_write_nb);
+
+	SAVE_MAP_STATE_TABLE();
+
+	if(fp_map_page != NULL){
+		fclose(fp_map_page);
+		fp_map_page = NULL;
+	}
+
+	curr_idx_entry = cache_idx_table;
+	for(i=0; i<CACHE_IDX_SIZE; i++){
+		free(curr_idx_entry->data);
+		curr_idx_entry += 1;
+	}
+	free(cache_idx_table);
+	free(map_state_table);
+	free(map_page_buf);
+	free(batch_lpn);
+	free(batch_ppn);
+}
+
+int SAVE_MAP_STATE_TABLE(void)
+{
+	int i;
+	map_state_entry* curr_map_entry = map_state_table;
+	FILE* fp = fopen("./data/map_state_table.dat","w");
+
+	if(fp == NULL){
+		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	for(i=0; i<MAP_ENTRY_NB; i++){
+		fwrite(&curr_map_entry->ppn, sizeof(int32_t), 1, fp);
+		curr_map_entry += 1;
+	}
+	fclose(fp);
+
+	return SUCCESS;
+}
+
+/* The valid pages of the replayed page states & inverse mapping are the
+	mapping at the last commit: the data pages make the translation pages,
+	the translation pages of the MAP_BLOCKs make the GTD */
+int REBUILD_MAP_PAGE(void)
+{
+	int i, j;
+	int32_t lpn;
 	int32_t ppn;
+	int64_t block_nb;
+	int64_t rebuilt_nb = 0;
+	int32_t* map_data;
+	int32_t* page_data;
+	block_state_entry* b_s_entry;
+	map_state_entry* curr_map_entry;
 
-	CACHE_GET_MAP(map_index, MAP, map_data);
+	map_data = (int32_t*)malloc((size_t)MAP_ENTRY_NB * PAGE_SIZE);
+	if(map_data == NULL){
+		printf("ERROR[%s] Malloc map fail, the mapping is lost\n", __FUNCTION__);
+		return FAIL;
+	}
+	memset(map_data, 0xff, (size_t)MAP_ENTRY_NB * PAGE_SIZE);
 
-	ppn = GET_MAPPING_INFO(lpn);
+	for(block_nb=0; block_nb<BLOCK_MAPPING_ENTRY_NB; block_nb++){
+		b_s_entry = GET_BLOCK_STATE_ENTRY(block_nb / BLOCK_NB, block_nb % BLOCK_NB);
+		if(b_s_entry->valid_page_nb == 0){
+			continue;
+		}
 
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] end\n",__FUNCTION__);
-#endif
-	return ppn;
+		for(i=0; i<PAGE_NB; i++){
+			if(GET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, i) != 'V'){
+				continue;
+			}
+			ppn = (int32_t)(block_nb * PAGE_NB + i);
+			lpn = GET_INVERSE_MAPPING_INFO(ppn);
+
+			if(lpn >= 0 && lpn < PAGE_MAPPING_ENTRY_NB){
+				map_data[lpn] = ppn;
+			}
+			else if(b_s_entry->type == MAP_BLOCK && IS_MAP_PAGE_LPN(lpn) \
+					&& GET_MAP_PAGE_INDEX(lpn) < MAP_ENTRY_NB){
+				map_state_table[GET_MAP_PAGE_INDEX(lpn)].ppn = ppn;
+			}
+		}
+	}
+
+	/* The updates in the flash copy of a translation page are lost,
+		so every page with an entry is written to the file */
+	curr_map_entry = map_state_table;
+	for(i=0; i<MAP_ENTRY_NB; i++){
+		page_data = map_data + (int64_t)i * MAP_ENTRIES_PER_PAGE;
+
+		if(curr_map_entry->ppn == MAP_PAGE_NONE){
+			for(j=0; j<MAP_ENTRIES_PER_PAGE; j++){
+				if(page_data[j] != -1){
+					break;
+				}
+			}
+			if(j == MAP_ENTRIES_PER_PAGE){
+				curr_map_entry += 1;
+				continue;
+			}
+			curr_map_entry->ppn = MAP_PAGE_REBUILT;
+		}
+
+		fseeko(fp_map_page, (off_t)i * PAGE_SIZE, SEEK_SET);
+		fwrite(page_data, PAGE_SIZE, 1, fp_map_page);
+		rebuilt_nb++;
+		curr_map_entry += 1;
+	}
+	fflush(fp_map_page);
+	free(map_data);
+
+	printf("[%s] %lld translation pages are rebuilt\n", __FUNCTION__, (long long)rebuilt_nb);
+
+	return SAVE_MAP_STATE_TABLE();
 }
 
-int32_t CACHE_GET_LPN(int32_t ppn)
+int32_t CACHE_GET_PPN(int32_t lpn)
 {
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] start\n",__FUNCTION__);
 #endif
-	uint32_t map_index = ppn / MAP_ENTRIES_PER_PAGE;
-	int32_t* map_data = NULL;
-	int32_t lpn;
-
-	CACHE_GET_MAP(map_index, INV_MAP, map_data);
+	uint32_t map_index = lpn / MAP_ENTRIES_PER_PAGE;
+	cache_idx_entry* cache_entry;
+	int32_t ppn;
 
-	lpn = GET_INVERSE_MAPPING_INFO(ppn);
+	cache_entry = CACHE_GET_MAP(map_index);
+	if(cache_entry == NULL){
+		printf("ERROR[%s] Get map %u fail\n", __FUNCTION__, map_index);
+		return -1;
+	}
+	ppn = ((int32_t*)cache_entry->data)[lpn % MAP_ENTRIES_PER_PAGE];
 
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] end\n",__FUNCTION__);
 #endif
-	return lpn;
+	return ppn;
 }
 
 int CACHE_UPDATE_PPN(int32_t lpn, int32_t ppn)
 {
 	cache_idx_entry* cache_entry = NULL;
 	uint32_t map_index = lpn / MAP_ENTRIES_PER_PAGE;
-	int32_t* map_data = NULL;
 
-	cache_entry = CACHE_GET_MAP(map_index, MAP, map_data);
+	/* Do not load the translation page, it is updated at the end of the batch */
+	if(batch_update == 1 && LOOKUP_CACHE(map_index) == NULL){
+		if(batch_update_nb == PAGE_NB && FLUSH_BATCH_UPDATE() == FAIL){
+			return FAIL;
+		}
+		batch_lpn[batch_update_nb] = lpn;
+		batch_ppn[batch_update_nb] = ppn;
+		batch_update_nb++;
+
+		return SUCCESS;
+	}
+
+	cache_entry = CACHE_GET_MAP(map_index);
+	if(cache_entry == NULL){
+		printf("ERROR[%s] Get map %u fail\n", __FUNCTION__, map_index);
+		return FAIL;
+	}
 	cache_entry->update_bit = 1;
 
-	mapping_table[lpn] = ppn;
+	((int32_t*)cache_entry->data)[lpn % MAP_ENTRIES_PER_PAGE] = ppn;
 
 	return SUCCESS;
 }
 
-int CACHE_UPDATE_LPN(int32_t lpn, int32_t ppn)
+void CACHE_BEGIN_BATCH_UPDATE(void)
 {
-	cache_idx_entry* cache_entry = NULL;
-	uint32_t map_index = ppn / MAP_ENTRIES_PER_PAGE;
-	int32_t* map_data = NULL;
+	batch_update = 1;
+	batch_update_nb = 0;
+}
 
-	cache_entry = CACHE_GET_MAP(map_index, INV_MAP, map_data);
-	cache_entry->update_bit = 1;
+int CACHE_END_BATCH_UPDATE(void)
+{
+	int ret = FLUSH_BATCH_UPDATE();
 
-	inverse_page_mapping_table[ppn] = lpn;
+	batch_update = 0;
+	return ret;
+}
 
-	return SUCCESS;
+/* Read-modify-write each translation page of the batch only once.
+	A translation page which can not be written back is kept dirty in the cache */
+int FLUSH_BATCH_UPDATE(void)
+{
+	int i, j;
+	int ret = SUCCESS;
+	uint32_t map_index;
+	cache_idx_entry* cache_entry;
+	int32_t* map_data;
+
+	for(i=0; i<batch_update_nb; i++){
+		if(batch_lpn[i] == -1){
+			continue;
+		}
+
+		map_index = batch_lpn[i] / MAP_ENTRIES_PER_PAGE;
+
+		cache_entry = LOOKUP_CACHE(map_index);
+		if(cache_entry != NULL){
+			map_data = (int32_t*)cache_entry->data;
+			cache_entry->update_bit = 1;
+		}
+		else if(READ_MAP(map_index, map_page_buf) == SUCCESS){
+			map_data = (int32_t*)map_page_buf;
+		}
+		else{
+			printf("ERROR[%s] The updates of map %u are lost\n", __FUNCTION__, map_index);
+			map_data = NULL;
+			ret = FAIL;
+		}
+
+		for(j=i; j<batch_update_nb; j++){
+			if(batch_lpn[j] != -1 && batch_lpn[j] / MAP_ENTRIES_PER_PAGE == map_index){
+				if(map_data != NULL){
+					map_data[batch_lpn[j] % MAP_ENTRIES_PER_PAGE] = batch_ppn[j];
+				}
+				batch_lpn[j] = -1;
+			}
+		}
+
+		if(cache_entry != NULL || map_data == NULL){
+			continue;
+		}
+
+		if(WRITE_MAP(map_index, map_page_buf) == FAIL){
+			cache_entry = CACHE_GET_MAP(map_index);
+			if(cache_entry == NULL){
+				printf("ERROR[%s] The updates of map %u are lost\n", __FUNCTION__, map_index);
+				ret = FAIL;
+				continue;
+			}
+			memcpy(cache_entry->data, map_page_buf, PAGE_SIZE);
+			cache_entry->update_bit = 1;
+		}
+	}
+
+	batch_update_nb = 0;
+	return ret;
 }
 
-cache_idx_entry* CACHE_GET_MAP(uint32_t map_index, uint32_t map_type, int32_t* map_data)
+cache_idx_entry* CACHE_GET_MAP(uint32_t map_index)
 {
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] start\n",__FUNCTION__);
@@ -152,15 +428,18 @@ cache_idx_entry* CACHE_GET_MAP(uint32_t map_index, uint32_t map_type, int32_t* m
 	cache_idx_entry* curr_idx_entry = NULL;
 	uint32_t victim_index;
 
-	curr_idx_entry = LOOKUP_CACHE(map_index, map_type);
+	curr_idx_entry = LOOKUP_CACHE(map_index);
 	if(curr_idx_entry != NULL){
-		map_data = (int32_t*)curr_idx_entry->data;
 		curr_idx_entry->clock_bit = 1;
+		cache_hit_nb++;
 	}
 	else{
 		victim_index = CACHE_EVICT_MAP();
-		curr_idx_entry = CACHE_INSERT_MAP(map_index, map_type, victim_index);
-		map_data = (int32_t*)curr_idx_entry->data;
+		if(victim_index == CACHE_IDX_SIZE){
+			return NULL;
+		}
+		curr_idx_entry = CACHE_INSERT_MAP(map_index, victim_index);
+		cache_miss_nb++;
 	}
 
 #ifdef FTL_CACHE_DEBUG
@@ -169,63 +448,32 @@ cache_idx_entry* CACHE_GET_MAP(uint32_t map_index, uint32_t map_type, int32_t* m
 	return curr_idx_entry;
 }
 
-cache_idx_entry* LOOKUP_CACHE(uint32_t map_index, uint32_t map_type)
+cache_idx_entry* LOOKUP_CACHE(uint32_t map_index)
 {
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] start\n",__FUNCTION__);
-#endif
 	map_state_entry* curr_map_entry = (map_state_entry*)map_state_table + map_index;
-	cache_idx_entry* curr_idx_entry;
 
 	if(curr_map_entry->is_cached){
-
-		curr_idx_entry = curr_map_entry->cache_entry;
-
-		if(map_type == MAP){
-			if(curr_idx_entry->map_type == MAP && curr_idx_entry->map_num == map_index)
-				return curr_idx_entry;
-		}
-		else if(map_type == INV_MAP){
-			if(curr_idx_entry->map_type == INV_MAP && curr_idx_entry->map_num == map_index)
-				return curr_idx_entry;
-		}
+		return curr_map_entry->cache_entry;
 	}
 
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] end\n",__FUNCTION__);
-#endif
 	return NULL;
 }
 
-cache_idx_entry* CACHE_INSERT_MAP(uint32_t map_index, uint32_t map_type, uint32_t victim_index)
+cache_idx_entry* CACHE_INSERT_MAP(uint32_t map_index, uint32_t victim_index)
 {
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] start\n",__FUNCTION__);
 #endif
-	int32_t* map_data;
-	int index = map_index * MAP_ENTRIES_PER_PAGE;
-	int ppn;
-
 	cache_idx_entry* curr_idx_entry = (cache_idx_entry*)cache_idx_table + victim_index;
 	map_state_entry* curr_map_entry = (map_state_entry*)map_state_table + map_index;
-	ppn = curr_map_entry->ppn;
 
-	if(map_type == MAP){
-		map_data = (int32_t*)mapping_table + index;
-		memcpy(curr_idx_entry->data, map_data, MAP_ENTRIES_PER_PAGE*sizeof(int32_t));
-		curr_idx_entry->map_type = MAP;
-	}
-	else if(map_type == INV_MAP){
-		map_data = (int32_t*)inverse_page_mapping_table + index;
-		memcpy(curr_idx_entry->data, map_data, MAP_ENTRIES_PER_PAGE*sizeof(int32_t));
-		curr_idx_entry->map_type = INV_MAP;
+	if(READ_MAP(map_index, curr_idx_entry->data) == FAIL){
+		return NULL;
 	}
 
-//	READ_MAP();
-	CELL_READ(CALC_FLASH(ppn), CALC_BLOCK(ppn), CALC_PAGE(ppn), 0, MAP_READ);
-
 	curr_idx_entry->map_num = map_index;
 	curr_idx_entry->clock_bit = 1;
+	curr_idx_entry->in_use = 1;
 	curr_idx_entry->update_bit = 0;
 
 	curr_map_entry->is_cached = 1;
@@ -237,36 +485,43 @@ cache_idx_entry* CACHE_INSERT_MAP(uint32_t map_index, uint32_t map_type, uint32_
 	return curr_idx_entry;
 }
 
+/* CACHE_IDX_SIZE : no entry can be evicted */
 uint32_t CACHE_EVICT_MAP(void)
 {
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] start\n",__FUNCTION__);
 #endif
-	int ret;
-	int32_t new_ppn;
-
 	uint32_t victim_index = CACHE_SELECT_VICTIM();
 	cache_idx_entry* curr_idx_entry = (cache_idx_entry*)cache_idx_table + victim_index;
+	map_state_entry* curr_map_entry;
 
-	int map_index = curr_idx_entry->map_num;
-	map_state_entry* curr_map_entry = (map_state_entry*)map_state_table + map_index;
+	if(curr_idx_entry->in_use == 0){
+		return victim_index;
+	}
 
-	if(curr_idx_entry->update_bit){
-#ifdef WRITE_NOPARAL
-		ret = GET_NEW_PAGE(VICTIM_NOPARAL, empty_block_table_index, &new_ppn);
-#else
-		ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
-#endif
-		WRITE_MAP(new_ppn, curr_idx_entry->data);
-	
-		curr_map_entry->ppn = new_ppn;
+	/* Write back all the updates of the translation page at once,
+		if it fails the page stays dirty in the cache & a clean one is evicted */
+	if(curr_idx_entry->update_bit && WRITE_MAP(curr_idx_entry->map_num, curr_idx_entry->data) == FAIL){
+		for(victim_index=0; victim_index<CACHE_IDX_SIZE; victim_index++){
+			if(cache_idx_table[victim_index].update_bit == 0){
+				break;
+			}
+		}
+		if(victim_index == CACHE_IDX_SIZE){
+			printf("ERROR[%s] All the cached maps are dirty\n", __FUNCTION__);
+			return CACHE_IDX_SIZE;
+		}
+		curr_idx_entry = (cache_idx_entry*)cache_idx_table + victim_index;
 	}
 
+	curr_map_entry = (map_state_entry*)map_state_table + curr_idx_entry->map_num;
+
 	curr_map_entry->is_cached = 0;
 	curr_map_entry->cache_entry = NULL;
 
 	curr_idx_entry->map_num = 0;
 	curr_idx_entry->clock_bit = 0;
+	curr_idx_entry->in_use = 0;
 	curr_idx_entry->update_bit = 0;
 
 #ifdef FTL_CACHE_DEBUG
@@ -275,20 +530,18 @@ uint32_t CACHE_EVICT_MAP(void)
 	return victim_index;
 }
 
+/* CLOCK, the empty entries are used first */
 uint32_t CACHE_SELECT_VICTIM(void)
 {
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] start\n",__FUNCTION__);
-#endif
 	uint32_t idx;
-	uint32_t evict_cache_num = -1;
+
+	if(cache_entry_nb < CACHE_IDX_SIZE){
+		return cache_entry_nb++;
+	}
 
 	while(1)
 	{
 		idx = clock_hand;
-		
-		if (idx == CACHE_IDX_SIZE)
-			idx = 0;
 
 		if (++clock_hand == CACHE_IDX_SIZE)
 			clock_hand = 0;
@@ -299,44 +552,86 @@ uint32_t CACHE_SELECT_VICTIM(void)
 		}
 		else
 		{
-			cache_idx_table[idx].clock_bit = 1;
-			evict_cache_num = idx;
-			return evict_cache_num;
+			return idx;
 		}
 	}
-#ifdef FTL_CACHE_DEBUG
-	printf("[%s] end\n",__FUNCTION__);
-#endif
 }
 
-int WRITE_MAP(uint32_t page_nb, void* buf)
+/* Translation pages are written to their own block, apart from the data pages */
+int GET_NEW_MAP_PAGE(int32_t* ppn)
+{
+	int i;
+
+	/* The translation block is in the GC reserve, GC makes an empty block first.
+		Not in the GC of the data blocks, it has the pending map updates.
+		The GC may write translation pages too */
+	if((map_block == NULL || map_block->curr_phy_page_nb == PAGE_NB) \
+			&& map_gc == 0 && batch_update == 0){
+		map_gc++;
+		for(i=0; i<EMPTY_TABLE_ENTRY_NB && total_empty_block_nb <= GC_RESERVE_BLOCK_NB; i++){
+			GARBAGE_COLLECTION(i);
+		}
+		map_gc--;
+	}
+
+	if(map_block != NULL && map_block->curr_phy_page_nb == PAGE_NB){
+		INSERT_VICTIM_BLOCK(map_block);
+		map_block = NULL;
+	}
+
+	if(map_block == NULL){
+		map_block = EJECT_EMPTY_BLOCK();
+		if(map_block == NULL){
+			printf("ERROR[%s] There is no empty block for translation pages\n", __FUNCTION__);
+			return FAIL;
+		}
+		UPDATE_BLOCK_STATE(map_block->phy_flash_nb, map_block->phy_block_nb, MAP_BLOCK);
+	}
+
+	*ppn = map_block->phy_flash_nb*BLOCK_NB*PAGE_NB \
+	       + map_block->phy_block_nb*PAGE_NB \
+	       + map_block->curr_phy_page_nb;
+
+	map_block->curr_phy_page_nb += 1;
+
+	return SUCCESS;
+}
+
+int WRITE_MAP(uint32_t map_index, void* buf)
 {
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] start\n",__FUNCTION__);
 #endif
-	map_data* curr_map_data_entry;
-//	pm_map* curr_pm_map = LOOKUP_PM_MAP_ENTRY(page_nb);
+	int ret;
+	int32_t new_ppn;
+	int32_t old_ppn;
+	nand_io_info* n_io_info = NULL;
+	map_state_entry* curr_map_entry = (map_state_entry*)map_state_table + map_index;
+
+	ret = GET_NEW_MAP_PAGE(&new_ppn);
+	if(ret == FAIL){
+		printf("ERROR[%s] Get new map page fail\n", __FUNCTION__);
+		return FAIL;
+	}
 
-//	if(curr_pm_map != NULL){
-//		memcpy(curr_pm_map->map_data, buf, PAGE_SIZE);
-//		printf("ERROR[WRITE_MAP] hit?\n");
-//	}
-//	else{
-		curr_map_data_entry = (map_data*)calloc(1, sizeof(map_data));
-		curr_map_data_entry->data = (void*)calloc(1, PAGE_SIZE);
+	/* Invalidate the old translation page */
+	old_ppn = curr_map_entry->ppn;
+	if(old_ppn >= 0){
+		UPDATE_BLOCK_STATE_ENTRY(CALC_FLASH(old_ppn), CALC_BLOCK(old_ppn), CALC_PAGE(old_ppn), INVALID);
+		UPDATE_INVERSE_MAPPING(old_ppn, -1);
+	}
 
-		curr_map_data_entry->ppn = page_nb;
-		curr_map_data_entry->prev = NULL;
-		curr_map_data_entry->next = NULL;
+	n_io_info = CREATE_NAND_IO_INFO(0, MAP_WRITE, -1, io_request_seq_nb);
+	SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
 
-		memcpy(curr_map_data_entry->data, buf, PAGE_SIZE);
+	UPDATE_BLOCK_STATE_ENTRY(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), VALID);
+	UPDATE_INVERSE_MAPPING(new_ppn, MAP_PAGE_LPN(map_index));
+	curr_map_entry->ppn = new_ppn;
 
-		cache_map_data_nb++;
-	
-		REARRANGE_MAP_DATA_ENTRY(curr_map_data_entry);
-//	}
+	fseeko(fp_map_page, (off_t)map_index * PAGE_SIZE, SEEK_SET);
+	fwrite(buf, PAGE_SIZE, 1, fp_map_page);
 
-	CELL_WRITE(CALC_FLASH(page_nb), CALC_BLOCK(page_nb), CALC_PAGE(page_nb), 0, MAP_WRITE);
+	map_write_nb++;
 
 #ifdef FTL_CACHE_DEBUG
 	printf("[%s] end\n",__FUNCTION__);
@@ -344,51 +639,59 @@ int WRITE_MAP(uint32_t page_nb, void* buf)
 	return SUCCESS;
 }
 
-void* READ_MAP(uint32_t page_nb)
+int READ_MAP(uint32_t map_index, void* buf)
 {
-	map_data* curr_map_data_entry = LOOKUP_MAP_DATA_ENTRY(page_nb);
+	nand_io_info* n_io_info = NULL;
+	map_state_entry* curr_map_entry = (map_state_entry*)map_state_table + map_index;
+	int32_t ppn = curr_map_entry->ppn;
 
-	if(curr_map_data_entry == NULL){
-		printf("ERROR[READ_MAP] There is no such map \n");
-		return NULL;
+	/* The translation page was never written */
+	if(ppn == MAP_PAGE_NONE){
+		memset(buf, 0xff, PAGE_SIZE);
+		return SUCCESS;
 	}
-	else{
-		return curr_map_data_entry->data;
+
+	/* A rebuilt page is not in the flash, it is read from the file only */
+	if(ppn != MAP_PAGE_REBUILT){
+		n_io_info = CREATE_NAND_IO_INFO(0, MAP_READ, -1, io_request_seq_nb);
+		SSD_PAGE_READ(CALC_FLASH(ppn), CALC_BLOCK(ppn), CALC_PAGE(ppn), n_io_info);
 	}
-}
 
-map_data* LOOKUP_MAP_DATA_ENTRY(uint32_t page_nb)
-{
-	map_data* curr_map_data_entry = cache_map_data_start;
-	int i;
+	fseeko(fp_map_page, (off_t)map_index * PAGE_SIZE, SEEK_SET);
+	if(fread(buf, PAGE_SIZE, 1, fp_map_page) != 1){
+		printf("ERROR[%s] There is no such map %u\n", __FUNCTION__, map_index);
+		return FAIL;
+	}
 
-	if(cache_map_data_nb <= 0 || curr_map_data_entry == NULL)
-		printf("ERROR[LOOKUP_MAP_DATA_ENTRY] %d \n", cache_map_data_nb);
+	map_read_nb++;
 
-	for(i=0; i<cache_map_data_nb; i++){
-		if( curr_map_data_entry->ppn == page_nb){
-			return curr_map_data_entry;
-		}
-		else{
-			curr_map_data_entry = curr_map_data_entry->next;
-		}
-	}
-	return NULL;
+	return SUCCESS;
 }
 
-int REARRANGE_MAP_DATA_ENTRY(struct map_data* new_entry)
+/* GC of a translation block, the new translation block is from the GC reserve */
+int MOVE_MAP_PAGE(uint32_t map_index)
 {
-	if(cache_map_data_start == NULL){
-		cache_map_data_start = new_entry;
-		cache_map_data_end = new_entry;
+	int ret;
+	cache_idx_entry* cache_entry = LOOKUP_CACHE(map_index);
+
+	map_gc++;
+
+	/* The cached translation page is the latest one */
+	if(cache_entry != NULL){
+		ret = WRITE_MAP(map_index, cache_entry->data);
+		if(ret == SUCCESS){
+			cache_entry->update_bit = 0;
+		}
 	}
 	else{
-		cache_map_data_end->next = new_entry;
-		new_entry->prev = cache_map_data_end;
-		cache_map_data_end = new_entry;
+		ret = READ_MAP(map_index, map_page_buf);
+		if(ret == SUCCESS){
+			ret = WRITE_MAP(map_index, map_page_buf);
+		}
 	}
 
-	return SUCCESS;
+	map_gc--;
+	return ret;
 }
 
 #endif
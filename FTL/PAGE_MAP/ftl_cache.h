@@ -8,54 +8,57 @@
 #ifndef _VSSIM_CACHE_H_
 #define _VSSIM_CACHE_H_
 
-#define CACHE_MAP_SIZE	(PASE_SIZE * CACHE_IDX_SIZE)
+#define CACHE_MAP_SIZE	(PAGE_SIZE * CACHE_IDX_SIZE)
 
-#define MAP	0
-#define INV_MAP	1
-
-extern struct map_data* cache_map_data_start;
-extern struct map_data* cache_map_data_end;
-extern uint32_t cache_map_data_nb; 
-
-typedef struct map_data
-{
-	uint32_t ppn;
-	void* data;
-	struct map_data* prev;
-	struct map_data* next;
-}map_data;
+/* The inverse mapping (OOB) of a translation page keeps its map index */
+#define MAP_PAGE_LPN(map_index)		(-2 - (int32_t)(map_index))
+#define GET_MAP_PAGE_INDEX(lpn)		((uint32_t)(-2 - (lpn)))
+#define IS_MAP_PAGE_LPN(lpn)		((lpn) <= -2)
 
+/* Cached Mapping Table (CMT) entry, a translation page in DRAM */
 typedef struct cache_idx_entry
 {
 	uint32_t map_num	:29;
 	uint32_t clock_bit	:1;
-	uint32_t map_type	:1;	// map (0), inv_map(1)
-	uint32_t update_bit	:1;
+	uint32_t in_use		:1;
+	uint32_t update_bit	:1;	// dirty
 	void* data;
 }cache_idx_entry;
 
+/* GTD ppn of a translation page which is not in the flash */
+#define MAP_PAGE_NONE		-1	// Never written, all the entries are -1
+#define MAP_PAGE_REBUILT	-2	// Only in the map page file, made by REBUILD_MAP_PAGE
+
+/* Global Translation Directory (GTD) entry */
 typedef struct map_state_entry
 {
-	int32_t ppn;
-	uint32_t is_cached; // cached (1) not cached(0)
+	int32_t ppn;		// MAP_PAGE_NONE, MAP_PAGE_REBUILT or the ppn of the translation page
+	uint32_t is_cached;	// cached (1) not cached(0)
 	cache_idx_entry* cache_entry;
 }map_state_entry;
 
+extern cache_idx_entry* cache_idx_table;
+extern map_state_entry* map_state_table;
+
 void INIT_CACHE(void);
+void TERM_CACHE(void);
+int SAVE_MAP_STATE_TABLE(void);
+int REBUILD_MAP_PAGE(void);
 
 int32_t CACHE_GET_PPN(int32_t lpn);
-int32_t CACHE_GET_LPN(int32_t ppn);
 int CACHE_UPDATE_PPN(int32_t lpn, int32_t ppn);
-int CACHE_UPDATE_LPN(int32_t lpn, int32_t ppn);
 
-cache_idx_entry* CACHE_GET_MAP(uint32_t map_index, uint32_t map_type, int32_t* map_data);
-cache_idx_entry* LOOKUP_CACHE(uint32_t map_index, uint32_t map_type);
-cache_idx_entry* CACHE_INSERT_MAP(uint32_t map_index, uint32_t map_type, uint32_t victim_index);
-uint32_t CACHE_EVICT_MAP(void); 
+void CACHE_BEGIN_BATCH_UPDATE(void);
+int CACHE_END_BATCH_UPDATE(void);
+
+cache_idx_entry* CACHE_GET_MAP(uint32_t map_index);
+cache_idx_entry* LOOKUP_CACHE(uint32_t map_index);
+cache_idx_entry* CACHE_INSERT_MAP(uint32_t map_index, uint32_t victim_index);
+uint32_t CACHE_EVICT_MAP(void);
 uint32_t CACHE_SELECT_VICTIM(void);
 
-int WRITE_MAP(uint32_t page_nb, void* buf);
-void* READ_MAP(uint32_t page_nb);
-map_data* LOOKUP_MAP_DATA_ENTRY(uint32_t page_nb);
-int REARRANGE_MAP_DATA_ENTRY(struct map_data* new_entry);
+int GET_NEW_MAP_PAGE(int32_t* ppn);
+int WRITE_MAP(uint32_t map_index, void* buf);
+int READ_MAP(uint32_t map_index, void* buf);
+int MOVE_MAP_PAGE(uint32_t map_index);
 #endif
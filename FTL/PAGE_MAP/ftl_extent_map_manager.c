@@ -0,0 +1,367 @@
+// File: ftl_extent_map_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+#ifdef FTL_EXTENT_MAP
+/* Extent compressed mapping tables : the entries of a segment are kept as
+	a few arithmetic runs while the segment is written in order, 12 byte a run
+	instead of an arena page of entries. A write which breaks a run expands the
+	segment to its page array, the array is compressed again when the segment
+	is rewritten in order or unmapped. The page arrays of the compressed
+	segments are never touched, they cost no memory */
+extent_table mapping_extent_table;
+extent_table inverse_extent_table;
+
+size_t EXTENT_TABLE_SIZE(int64_t entry_nb, int column_nb)
+{
+	int64_t segment_nb = (entry_nb + EXTENT_SEGMENT_ENTRY_NB - 1) / EXTENT_SEGMENT_ENTRY_NB;
+
+	if(column_nb > EXTENT_COLUMN_MAX){
+		column_nb = EXTENT_COLUMN_MAX;
+	}
+
+	/* Each table is rounded up to ARENA_ALIGN */
+	return segment_nb * ARENA_ALIGN + ARENA_ALIGN \
+		+ segment_nb * (sizeof(extent_segment) + column_nb * sizeof(extent_column)) + ARENA_ALIGN;
+}
+
+int INIT_EXTENT_TABLE(extent_table* table, const char* name, int64_t entry_nb, int run, int column_nb, \
+		const char* segment_path, const char* page_path, int load)
+{
+	int64_t i;
+	int loaded;
+
+	if(column_nb > EXTENT_COLUMN_MAX){
+		column_nb = EXTENT_COLUMN_MAX;
+	}
+
+	table->name = name;
+	table->entry_nb = entry_nb;
+	table->segment_nb = (entry_nb + EXTENT_SEGMENT_ENTRY_NB - 1) / EXTENT_SEGMENT_ENTRY_NB;
+	table->segment_size = sizeof(extent_segment) + column_nb * sizeof(extent_column);
+	table->run = run;
+	table->column_nb = column_nb;
+
+	table->array_nb = 0;
+	table->max_array_nb = 0;
+	table->expand_nb = 0;
+	table->compress_nb = 0;
+
+	/* The page arrays are saved before the segments, a checkpoint cut in the
+		middle has no segment which points to an array of an older checkpoint */
+	table->page_table = (int32_t*)ARENA_LOAD(&ftl_meta_arena, table->segment_nb * ARENA_ALIGN, \
+				page_path, load, &loaded);
+	table->segment_table = (char*)ARENA_LOAD(&ftl_meta_arena, table->segment_nb * table->segment_size, \
+				segment_path, load, &loaded);
+	if(table->page_table == NULL || table->segment_table == NULL){
+		printf("ERROR[%s] Alloc %s extent table fail\n", __FUNCTION__, name);
+		return FAIL;
+	}
+
+	/* The page arrays of the loaded segments are counted again */
+	if(loaded == 1){
+		for(i=0;i<table->segment_nb;i++){
+			if(GET_EXTENT_SEGMENT(table, i)->page_array == 1){
+				table->array_nb++;
+			}
+		}
+		table->max_array_nb = table->array_nb;
+	}
+
+	return SUCCESS;
+}
+
+void TERM_EXTENT_TABLE(extent_table* table)
+{
+	printf("Extent Map %s	%lld segments, %lld expanded, %lld compressed, max %lld page arrays\n", \
+			table->name, (long long)table->segment_nb, (long long)table->expand_nb, \
+			(long long)table->compress_nb, (long long)table->max_array_nb);
+
+	/* The tables are written by the last checkpoint, the memory is released with the arena */
+	table->page_table = NULL;
+	table->segment_table = NULL;
+}
+
+extent_segment* GET_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb)
+{
+	return (extent_segment*)(table->segment_table + segment_nb * table->segment_size);
+}
+
+int32_t EXTENT_GET(extent_table* table, int64_t index)
+{
+	int j;
+	int i = (int)(index % EXTENT_SEGMENT_ENTRY_NB);
+	extent_segment* segment = GET_EXTENT_SEGMENT(table, index / EXTENT_SEGMENT_ENTRY_NB);
+
+	if(segment->page_array == 1){
+		return table->page_table[index] - 1;
+	}
+
+	for(j=0;j<segment->patch_nb;j++){
+		if(segment->patch[j].index == i){
+			return segment->patch[j].value;
+		}
+	}
+
+	return GET_EXTENT_COLUMN_VALUE(segment->column + (i / table->run) % table->column_nb, \
+			(i / (table->run * table->column_nb)) * table->run + i % table->run);
+}
+
+void EXTENT_SET(extent_table* table, int64_t index, int32_t value)
+{
+	int j;
+	int i = (int)(index % EXTENT_SEGMENT_ENTRY_NB);
+	int k;
+	int64_t segment_nb = index / EXTENT_SEGMENT_ENTRY_NB;
+	extent_segment* segment = GET_EXTENT_SEGMENT(table, segment_nb);
+	extent_column* column;
+	int32_t* entry;
+	int32_t old_value;
+
+	if(segment->page_array == 0){
+		column = segment->column + (i / table->run) % table->column_nb;
+		k = (i / (table->run * table->column_nb)) * table->run + i % table->run;
+
+		for(j=0;j<segment->patch_nb;j++){
+			if(segment->patch[j].index != i){
+				continue;
+			}
+
+			/* Back on the run, the last patch fills the hole */
+			if(GET_EXTENT_COLUMN_VALUE(column, k) == value){
+				segment->patch_nb--;
+				segment->patch[j] = segment->patch[segment->patch_nb];
+			}
+			else{
+				segment->patch[j].value = value;
+			}
+			ARENA_MARK_DIRTY(&ftl_meta_arena, segment, table->segment_size);
+			return;
+		}
+
+		if(UPDATE_EXTENT_COLUMN(column, k, value) == SUCCESS \
+				|| ADD_EXTENT_PATCH(segment, i, value) == SUCCESS){
+			ARENA_MARK_DIRTY(&ftl_meta_arena, segment, table->segment_size);
+			return;
+		}
+
+		/* Too many entries off the runs */
+		EXPAND_EXTENT_SEGMENT(table, segment_nb);
+	}
+
+	entry = table->page_table + index;
+	old_value = *entry - 1;
+	if(old_value == value){
+		return;
+	}
+
+	*entry = value + 1;
+	ARENA_MARK_DIRTY(&ftl_meta_arena, entry, sizeof(int32_t));
+
+	if(old_value == -1){
+		segment->mapped_nb++;
+	}
+	else if(value == -1){
+		segment->mapped_nb--;
+	}
+	segment->update_nb++;
+	ARENA_MARK_DIRTY(&ftl_meta_arena, segment, table->segment_size);
+
+	/* A try costs a pass over the array : at the end of the segment,
+		or once per EXTENT_SEGMENT_ENTRY_NB updates */
+	if(segment->mapped_nb == 0 || i == (int)EXTENT_SEGMENT_ENTRY_NB - 1 \
+			|| segment->update_nb >= (int32_t)EXTENT_SEGMENT_ENTRY_NB){
+		COMPRESS_EXTENT_SEGMENT(table, segment_nb);
+	}
+}
+
+int32_t GET_EXTENT_COLUMN_VALUE(extent_column* column, int k)
+{
+	if(k < column->first || k >= column->end){
+		return -1;
+	}
+
+	return (int32_t)((int64_t)column->base + (int64_t)(k - column->first) * column->step);
+}
+
+/* Put entry k of the column on its run, FAIL if the run can not have it */
+int UPDATE_EXTENT_COLUMN(extent_column* column, int k, int32_t value)
+{
+	int length = column->end - column->first;
+	int64_t step;
+
+	if(length == 0){
+		if(value != -1){
+			column->base = value;
+			column->step = 0;
+			column->first = (uint16_t)k;
+			column->end = (uint16_t)(k + 1);
+		}
+		return SUCCESS;
+	}
+
+	if(k >= column->first && k < column->end){
+		if(GET_EXTENT_COLUMN_VALUE(column, k) == value){
+			return SUCCESS;
+		}
+
+		/* Unmapped at an end of the run */
+		if(value == -1 && k == column->first){
+			column->first++;
+			column->base += column->step;
+			return SUCCESS;
+		}
+		if(value == -1 && k == column->end - 1){
+			column->end--;
+			return SUCCESS;
+		}
+
+		if(length == 1 && value != -1){
+			column->base = value;
+			return SUCCESS;
+		}
+		return FAIL;
+	}
+
+	if(value == -1){
+		return SUCCESS;
+	}
+
+	/* The run grows at one of its ends */
+	if(k == column->end){
+		step = length == 1 ? (int64_t)value - column->base : column->step;
+
+		if(step <= INT32_MAX && step >= INT32_MIN \
+				&& (int64_t)column->base + (int64_t)length * step == value){
+			column->step = (int32_t)step;
+			column->end++;
+			return SUCCESS;
+		}
+	}
+	else if(k == column->first - 1){
+		step = length == 1 ? (int64_t)column->base - value : column->step;
+
+		if(step <= INT32_MAX && step >= INT32_MIN \
+				&& (int64_t)column->base - step == value){
+			column->step = (int32_t)step;
+			column->base = value;
+			column->first--;
+			return SUCCESS;
+		}
+	}
+
+	return FAIL;
+}
+
+int ADD_EXTENT_PATCH(extent_segment* segment, int i, int32_t value)
+{
+	if(segment->patch_nb == EXTENT_PATCH_NB){
+		return FAIL;
+	}
+
+	segment->patch[segment->patch_nb].index = i;
+	segment->patch[segment->patch_nb].value = value;
+	segment->patch_nb++;
+
+	return SUCCESS;
+}
+
+/* The entries go to the page array of the segment */
+void EXPAND_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb)
+{
+	int i;
+	int32_t value;
+	int32_t mapped_nb = 0;
+	int64_t index = segment_nb * EXTENT_SEGMENT_ENTRY_NB;
+	int32_t* page_array = table->page_table + index;
+	extent_segment* segment = GET_EXTENT_SEGMENT(table, segment_nb);
+
+	for(i=0;i<(int)EXTENT_SEGMENT_ENTRY_NB;i++){
+		value = EXTENT_GET(table, index + i);
+
+		page_array[i] = value + 1;
+		if(value != -1){
+			mapped_nb++;
+		}
+	}
+	ARENA_MARK_DIRTY(&ftl_meta_arena, page_array, EXTENT_SEGMENT_ENTRY_NB * sizeof(int32_t));
+
+	memset(segment->patch, 0, sizeof(segment->patch));
+	memset(segment->column, 0, table->column_nb * sizeof(extent_column));
+	segment->patch_nb = 0;
+	segment->page_array = 1;
+	segment->mapped_nb = mapped_nb;
+	segment->update_nb = 0;
+	ARENA_MARK_DIRTY(&ftl_meta_arena, segment, table->segment_size);
+
+	table->expand_nb++;
+	table->array_nb++;
+	if(table->array_nb > table->max_array_nb){
+		table->max_array_nb = table->array_nb;
+	}
+}
+
+/* Make the runs of the columns from the page array, an entry off the run of
+	its column is patched. FAIL if there are too many, otherwise the page
+	array is given back */
+int COMPRESS_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb)
+{
+	int i, c, k;
+	int32_t value;
+	int32_t* page_array = table->page_table + segment_nb * EXTENT_SEGMENT_ENTRY_NB;
+	extent_segment* segment = GET_EXTENT_SEGMENT(table, segment_nb);
+	extent_column* column;
+
+	for(c=0;c<table->column_nb;c++){
+		column = segment->column + c;
+
+		for(k=0;;k++){
+			i = (k / table->run) * table->run * table->column_nb + c * table->run + k % table->run;
+			if(i >= (int)EXTENT_SEGMENT_ENTRY_NB){
+				break;
+			}
+
+			value = page_array[i] - 1;
+			if(value == -1){
+				continue;
+			}
+
+			/* Only the next entry of the run, the unmapped entries are at its ends */
+			if((column->end == column->first || k == column->end) \
+					&& UPDATE_EXTENT_COLUMN(column, k, value) == SUCCESS){
+				continue;
+			}
+
+			if(ADD_EXTENT_PATCH(segment, i, value) == FAIL){
+				memset(segment->patch, 0, sizeof(segment->patch));
+				memset(segment->column, 0, table->column_nb * sizeof(extent_column));
+				segment->patch_nb = 0;
+				segment->update_nb = 0;
+				return FAIL;
+			}
+
+			/* The run goes on over the patched entry */
+			if(k == column->end){
+				column->end++;
+			}
+		}
+	}
+
+	segment->page_array = 0;
+	segment->mapped_nb = 0;
+	segment->update_nb = 0;
+	ARENA_MARK_DIRTY(&ftl_meta_arena, segment, table->segment_size);
+
+	ARENA_RELEASE(&ftl_meta_arena, page_array, EXTENT_SEGMENT_ENTRY_NB * sizeof(int32_t));
+
+	table->compress_nb++;
+	table->array_nb--;
+
+	return SUCCESS;
+}
+#endif
@@ -0,0 +1,85 @@
+// File: ftl_extent_map_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _EXTENT_MAP_MANAGER_H_
+#define _EXTENT_MAP_MANAGER_H_
+
+#define EXTENT_SEGMENT_ENTRY_NB	(ARENA_ALIGN / sizeof(int32_t))	// The page array of a segment is an arena page
+#define EXTENT_COLUMN_MAX	256	// A wider stripe is kept in the page arrays
+#define EXTENT_PATCH_NB		4	// Entries off the runs, a random write does not expand the segment
+
+/* An arithmetic run of a column : entry k is base + (k - first) * step
+	for first <= k < end, the other entries are unmapped */
+typedef struct extent_column
+{
+	int32_t base;
+	int32_t step;
+	uint16_t first;
+	uint16_t end;
+}extent_column;
+
+/* Entry i of the segment, it overrides the column */
+typedef struct extent_patch
+{
+	int32_t index;
+	int32_t value;
+}extent_patch;
+
+/* A zero segment has empty columns, all its entries are unmapped */
+typedef struct extent_segment
+{
+	int32_t page_array;	// 1 : the entries are in the page array of the segment
+	int32_t mapped_nb;	// Page array : the mapped entries
+	int32_t update_nb;	// Page array : the updates since the last compression try
+	int32_t patch_nb;	// The first patch_nb patches are used
+	extent_patch patch[EXTENT_PATCH_NB];
+	extent_column column[];
+}extent_segment;
+
+/* Two level table of int32_t entries, -1 is unmapped. Entry i of a segment is
+	entry k of the column c, the writes of the stripe go round the columns :
+	run entries in a row go to a column, c = (i / run) % column_nb */
+typedef struct extent_table
+{
+	const char* name;
+	int64_t entry_nb;
+	int64_t segment_nb;
+	size_t segment_size;
+	int run;
+	int column_nb;
+
+	char* segment_table;
+	int32_t* page_table;	// EXTENT_SEGMENT_ENTRY_NB entries per segment, entries keep value + 1
+
+	/* Statistics */
+	int64_t array_nb;
+	int64_t max_array_nb;
+	int64_t expand_nb;
+	int64_t compress_nb;
+}extent_table;
+
+#ifdef FTL_EXTENT_MAP
+extern extent_table mapping_extent_table;
+extern extent_table inverse_extent_table;
+
+size_t EXTENT_TABLE_SIZE(int64_t entry_nb, int column_nb);
+int INIT_EXTENT_TABLE(extent_table* table, const char* name, int64_t entry_nb, int run, int column_nb, \
+		const char* segment_path, const char* page_path, int load);
+void TERM_EXTENT_TABLE(extent_table* table);
+
+int32_t EXTENT_GET(extent_table* table, int64_t index);
+void EXTENT_SET(extent_table* table, int64_t index, int32_t value);
+
+extent_segment* GET_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb);
+int32_t GET_EXTENT_COLUMN_VALUE(extent_column* column, int k);
+int UPDATE_EXTENT_COLUMN(extent_column* column, int k, int32_t value);
+int ADD_EXTENT_PATCH(extent_segment* segment, int i, int32_t value);
+void EXPAND_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb);
+int COMPRESS_EXTENT_SEGMENT(extent_table* table, int64_t segment_nb);
+#endif
+
+#endif
@@ -13,38 +13,76 @@ unsigned int gc_count = 0;
 int fail_cnt = 0;
 extern double ssd_util;
 
+#ifdef GC_BACKGROUND
+/* Victim block of the background GC, reclaimed a page at a time */
+int bg_gc_in_progress = 0;
+unsigned int bg_victim_phy_flash_nb;
+unsigned int bg_victim_phy_block_nb;
+int bg_gc_mapping_index = 0;
+int64_t bg_gc_count = 0;
+#endif
+
 void GC_CHECK(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 {
 	int i, ret;
 	int plane_nb = phy_block_nb % PLANES_PER_FLASH;
 	int mapping_index = plane_nb * FLASH_NB + phy_flash_nb;
+	unsigned int prev_gc_count = gc_count;
 	
-#ifdef GC_TRIGGER_OVERALL
+#ifdef GC_BACKGROUND
+	/* The blocks down to the soft watermark are reclaimed when idle,
+		foreground GC starts only at the hard watermark */
+	if(total_empty_block_nb <= GC_THRESHOLD_BLOCK_NB_HARD)
+	{
+		for(i=0; i<GC_VICTIM_NB; i++){
+			ret = GARBAGE_COLLECTION(mapping_index);
+			if(ret == FAIL){
+				break;
+			}
+		}
+	}
+#elif defined GC_TRIGGER_OVERALL
 //	if(total_empty_block_nb < GC_THRESHOLD_BLOCK_NB)
-	if(total_empty_block_nb <= FLASH_NB * PLANES_PER_FLASH)
+	if(total_empty_block_nb <= GC_RESERVE_BLOCK_NB)
 	{
 		for(i=0; i<GC_VICTIM_NB; i++){
-			ret = GARBAGE_COLLECTION();
+			ret = GARBAGE_COLLECTION(mapping_index);
 			if(ret == FAIL){
 				break;
 			}
 		}
 	}
 #else
+	/* A plane reclaims its share of GC_VICTIM_NB, the victims of the plane only */
 	empty_block_root* curr_root_entry = (empty_block_root*)empty_block_list + mapping_index;
+	int victim_nb = GC_VICTIM_NB / VICTIM_TABLE_ENTRY_NB;
+
+	if(victim_nb == 0){
+		victim_nb = 1;
+	}
 
 	if(curr_root_entry->empty_block_nb < GC_THRESHOLD_BLOCK_NB_EACH){
-		for(i=0; i<GC_VICTIM_NB; i++){
-			ret = GARBAGE_COLLECTION();
+		for(i=0; i<victim_nb; i++){
+			ret = GARBAGE_COLLECTION(mapping_index);
 			if(ret == FAIL){
 				break;
 			}
 		}
 	}
 #endif
+
+#ifdef FTL_MULTI_PLANE
+	if(gc_count != prev_gc_count){
+		CLOSE_IDLE_STRIPE_BLOCK();
+	}
+#endif
+
+#ifdef FTL_WEAR_LEVELING
+	WEAR_LEVELING_CHECK();
+#endif
 }
 
-int GARBAGE_COLLECTION(void)
+int GARBAGE_COLLECTION(int mapping_index)
 {
 #ifdef FTL_DEBUG
 	printf("[%s] Start\n", __FUNCTION__);
@@ -53,18 +91,20 @@ int GARBAGE_COLLECTION(void)
 	int ret;
 	int32_t lpn;
 	int32_t old_ppn;
-	int32_t new_ppn;
 
 	unsigned int victim_phy_flash_nb = FLASH_NB;
 	unsigned int victim_phy_block_nb = 0;
 
-	char* valid_array;
+	uint64_t* valid_bitmap;
+	int valid_page_nb;
 	int copy_page_nb = 0;
 
-	nand_io_info* n_io_info = NULL;
 	block_state_entry* b_s_entry;
+#ifdef FTL_MULTI_PLANE
+	int stripe_block_nb = 1;
+#endif
 
-	ret = SELECT_VICTIM_BLOCK(&victim_phy_flash_nb, &victim_phy_block_nb);
+	ret = SELECT_VICTIM_BLOCK(mapping_index, &victim_phy_flash_nb, &victim_phy_block_nb);
 	if(ret == FAIL){
 #ifdef FTL_DEBUG
 		printf("[%s] There is no available victim block\n", __FUNCTION__);
@@ -73,47 +113,60 @@ int GARBAGE_COLLECTION(void)
 	}
 
 	int plane_nb = victim_phy_block_nb % PLANES_PER_FLASH;
-	int mapping_index = plane_nb * FLASH_NB + victim_phy_flash_nb;
+	mapping_index = plane_nb * FLASH_NB + victim_phy_flash_nb;
 
 	b_s_entry = GET_BLOCK_STATE_ENTRY(victim_phy_flash_nb, victim_phy_block_nb);
-	valid_array = b_s_entry->valid_array;
+	valid_bitmap = VALID_BITMAP(b_s_entry->page_bitmap);
+	valid_page_nb = b_s_entry->valid_page_nb;
 
-	for(i=0;i<PAGE_NB;i++){
-		if(valid_array[i]=='V'){
-#ifdef GC_VICTIM_OVERALL
-			ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
-#else
-			ret = GET_NEW_PAGE(VICTIM_INCHIP, mapping_index, &new_ppn);
-#endif
+#ifdef FTL_MAP_CACHE
+	/* Translation block, move the valid translation pages to the current translation block */
+	if(b_s_entry->type == MAP_BLOCK){
+		for(i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); i != -1; i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, i+1)){
+			old_ppn = victim_phy_flash_nb*PAGES_PER_FLASH + victim_phy_block_nb*PAGE_NB + i;
+			lpn = GET_INVERSE_MAPPING_INFO(old_ppn);
+
+			ret = MOVE_MAP_PAGE(GET_MAP_PAGE_INDEX(lpn));
 			if(ret == FAIL){
-				printf("ERROR[%s] Get new page fail\n", __FUNCTION__);
+				printf("ERROR[%s] Move map page fail\n", __FUNCTION__);
 				return FAIL;
 			}
+			copy_page_nb++;
+		}
+	}
+	else{
+		/* The translation pages which are not cached are updated once, after the copy */
+		CACHE_BEGIN_BATCH_UPDATE();
+#endif
 
-		
-			/* Read a Valid Page from the Victim NAND Block */
-			n_io_info = CREATE_NAND_IO_INFO(i, GC_READ, -1, io_request_seq_nb);
-			SSD_PAGE_READ(victim_phy_flash_nb, victim_phy_block_nb, i, n_io_info);
-
-			/* Write the Valid Page*/
-			n_io_info = CREATE_NAND_IO_INFO(i, GC_WRITE, -1, io_request_seq_nb);
-			SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
+	/* Copy the valid pages only, found by the valid bitmap */
+	for(i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); i != -1; i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, i+1)){
+		ret = COPY_VALID_PAGE(victim_phy_flash_nb, victim_phy_block_nb, i, mapping_index, GC_READ, GC_WRITE);
+		if(ret == FAIL){
+			return FAIL;
+		}
 
-			old_ppn = victim_phy_flash_nb*PAGES_PER_FLASH + victim_phy_block_nb*PAGE_NB + i;
+		copy_page_nb++;
+	}
 
-//			lpn = inverse_page_mapping_table[old_ppn];
-#ifdef FTL_MAP_CACHE
-			lpn = CACHE_GET_LPN(old_ppn);
-#else
-			lpn = GET_INVERSE_MAPPING_INFO(old_ppn);
+#ifdef FTL_MULTI_PLANE
+	/* The other blocks of the stripe, with no more valid pages than the victim */
+	if(GET_STRIPE_PEER(victim_phy_flash_nb, victim_phy_block_nb) != -1){
+		stripe_block_nb = COLLECT_STRIPE_PEER_BLOCK(victim_phy_flash_nb, victim_phy_block_nb, valid_page_nb);
+		if(stripe_block_nb == -1){
+			return FAIL;
+		}
+	}
 #endif
-			UPDATE_NEW_PAGE_MAPPING(lpn, new_ppn);
 
-			copy_page_nb++;
+#ifdef FTL_MAP_CACHE
+		if(CACHE_END_BATCH_UPDATE() == FAIL){
+			printf("ERROR[%s] Map update fail\n", __FUNCTION__);
 		}
 	}
+#endif
 
-	if(copy_page_nb != b_s_entry->valid_page_nb){
+	if(copy_page_nb != valid_page_nb){
 		printf("ERROR[%s] The number of valid page is not correct\n", __FUNCTION__);
 		return FAIL;
 	}
@@ -122,7 +175,31 @@ int GARBAGE_COLLECTION(void)
 	printf("[%s] [f: %d, b: %d] Copy Page : %d, total victim : %ld, total empty : %ld \n",__FUNCTION__, victim_phy_flash_nb, victim_phy_block_nb,  copy_page_nb, total_victim_block_nb, total_empty_block_nb);
 #endif
 
+#ifdef FTL_MULTI_PLANE
+	/* The blocks of the stripe are erased at once */
+	if(stripe_block_nb > 1){
+		SSD_MULTI_PLANE_ERASE(victim_phy_flash_nb, stripe_erase_block_list);
+		stripe_erase_nb++;
+
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(stripe_erase_block_list[i] == -1 || stripe_erase_block_list[i] == (int32_t)victim_phy_block_nb){
+				continue;
+			}
+			CLEAR_STRIPE_PEER(victim_phy_flash_nb, stripe_erase_block_list[i]);
+			COUNT_BLOCK_ERASE(victim_phy_flash_nb, stripe_erase_block_list[i]);
+			UPDATE_BLOCK_STATE(victim_phy_flash_nb, stripe_erase_block_list[i], EMPTY_BLOCK);
+			INSERT_EMPTY_BLOCK(victim_phy_flash_nb, stripe_erase_block_list[i]);
+			gc_count++;
+		}
+	}
+	else{
+		SSD_BLOCK_ERASE(victim_phy_flash_nb, victim_phy_block_nb);
+	}
+	CLEAR_STRIPE_PEER(victim_phy_flash_nb, victim_phy_block_nb);
+#else
 	SSD_BLOCK_ERASE(victim_phy_flash_nb, victim_phy_block_nb);
+#endif
+	COUNT_BLOCK_ERASE(victim_phy_flash_nb, victim_phy_block_nb);
 	UPDATE_BLOCK_STATE(victim_phy_flash_nb, victim_phy_block_nb, EMPTY_BLOCK);
 	INSERT_EMPTY_BLOCK(victim_phy_flash_nb, victim_phy_block_nb);
 
@@ -138,84 +215,237 @@ int GARBAGE_COLLECTION(void)
 	return SUCCESS;
 }
 
-/* Greedy Garbage Collection Algorithm */
-int SELECT_VICTIM_BLOCK(unsigned int* phy_flash_nb, unsigned int* phy_block_nb)
+#ifdef FTL_MULTI_PLANE
+/* Copy the valid pages of the other blocks in the stripe of the victim, which are GC victims
+	with no more valid pages than max_valid_page_nb. stripe_erase_block_list[plane_nb] gets
+	the victim & them. Return the number of the blocks, -1 if a copy fails */
+int COLLECT_STRIPE_PEER_BLOCK(unsigned int phy_flash_nb, unsigned int victim_phy_block_nb, int max_valid_page_nb)
 {
-	int i, j;
-	int entry_nb = 0;
-
-	victim_block_root* curr_v_b_root;
-	victim_block_entry* curr_v_b_entry;
-	victim_block_entry* victim_block = NULL;
+	int i;
+	int ret;
+	int block_nb = 1;
+	int mapping_index;
+	int32_t peer_block_nb;
 
+	uint64_t* valid_bitmap;
+	victim_block_entry* v_b_entry;
 	block_state_entry* b_s_entry;
-	int curr_valid_page_nb;
 
-	if(total_victim_block_nb == 0){
-		printf("ERROR[%s] There is no victim block\n", __FUNCTION__);
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		stripe_erase_block_list[i] = -1;
+	}
+	stripe_erase_block_list[victim_phy_block_nb % PLANES_PER_FLASH] = victim_phy_block_nb;
+
+	peer_block_nb = GET_STRIPE_PEER(phy_flash_nb, victim_phy_block_nb);
+	while(peer_block_nb != -1 && peer_block_nb != (int32_t)victim_phy_block_nb){
+		v_b_entry = GET_VICTIM_BLOCK_ENTRY(phy_flash_nb, peer_block_nb);
+		b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, peer_block_nb);
+
+		if(v_b_entry != NULL && b_s_entry->valid_page_nb <= max_valid_page_nb){
+			EJECT_VICTIM_BLOCK(v_b_entry);
+			mapping_index = (peer_block_nb % PLANES_PER_FLASH) * FLASH_NB + phy_flash_nb;
+
+			valid_bitmap = VALID_BITMAP(b_s_entry->page_bitmap);
+			for(i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); i != -1; i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, i+1)){
+				ret = COPY_VALID_PAGE(phy_flash_nb, peer_block_nb, i, mapping_index, GC_READ, GC_WRITE);
+				if(ret == FAIL){
+					return -1;
+				}
+			}
+
+			stripe_erase_block_list[peer_block_nb % PLANES_PER_FLASH] = peer_block_nb;
+			block_nb++;
+		}
+
+		peer_block_nb = GET_STRIPE_PEER(phy_flash_nb, peer_block_nb);
+	}
+
+	return block_nb;
+}
+#endif
+
+/* Copy a valid page of the victim block and update its mapping,
+	read_type & write_type : GC_READ & GC_WRITE, or WL_READ & WL_WRITE */
+int COPY_VALID_PAGE(unsigned int victim_phy_flash_nb, unsigned int victim_phy_block_nb, int page_nb, int mapping_index, int read_type, int write_type)
+{
+	int ret;
+	int32_t lpn;
+	int32_t old_ppn;
+	int32_t new_ppn;
+
+	nand_io_info* n_io_info = NULL;
+
+	old_ppn = victim_phy_flash_nb*PAGES_PER_FLASH + victim_phy_block_nb*PAGE_NB + page_nb;
+	lpn = GET_INVERSE_MAPPING_INFO(old_ppn);
+
+#ifdef FTL_SUB_PAGE
+	/* A log page, its live sectors are moved to the open log page */
+	if(IS_SUB_PAGE_LOG_LPN(lpn)){
+		return COMPACT_SUB_PAGE_LOG(old_ppn, GET_SUB_PAGE_LOG_NB(lpn), read_type);
+	}
+#endif
+
+#if defined FTL_MULTI_STREAM && defined GC_VICTIM_OVERALL
+	ret = GET_NEW_STREAM_PAGE(GET_PAGE_STREAM(lpn), VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
+#elif defined FTL_MULTI_STREAM
+	ret = GET_NEW_STREAM_PAGE(GET_PAGE_STREAM(lpn), VICTIM_INCHIP, mapping_index, &new_ppn);
+#elif defined GC_VICTIM_OVERALL
+	ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
+#else
+	ret = GET_NEW_PAGE(VICTIM_INCHIP, mapping_index, &new_ppn);
+#endif
+	if(ret == FAIL){
+		printf("ERROR[%s] Get new page fail\n", __FUNCTION__);
 		return FAIL;
 	}
 
-	/* if GC_TRIGGER_OVERALL is defined, then */
-#ifdef GC_TRIGGER_OVERALL
-	curr_v_b_root = (victim_block_root*)victim_block_list;
+	/* Read a Valid Page from the Victim NAND Block */
+	n_io_info = CREATE_NAND_IO_INFO(page_nb, read_type, -1, io_request_seq_nb);
+	SSD_PAGE_READ(victim_phy_flash_nb, victim_phy_block_nb, page_nb, n_io_info);
 
-	for(i=0;i<VICTIM_TABLE_ENTRY_NB;i++){
+	/* Write the Valid Page*/
+	n_io_info = CREATE_NAND_IO_INFO(page_nb, write_type, -1, io_request_seq_nb);
+	SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
 
-		if(curr_v_b_root->victim_block_nb != 0){
+	UPDATE_NEW_PAGE_MAPPING(lpn, new_ppn);
 
-			entry_nb = curr_v_b_root->victim_block_nb;
-			curr_v_b_entry = curr_v_b_root->head;
-			if(victim_block == NULL){
-				victim_block = curr_v_b_root->head;
-				b_s_entry = GET_BLOCK_STATE_ENTRY(victim_block->phy_flash_nb, victim_block->phy_block_nb);
-				curr_valid_page_nb = b_s_entry->valid_page_nb;
-			}
+#ifdef FTL_MULTI_STREAM
+	COUNT_STREAM_COPY(victim_phy_flash_nb, victim_phy_block_nb);
+#endif
+	return SUCCESS;
+}
+
+#ifdef GC_BACKGROUND
+/* One step of the idle time GC : copy a valid page or erase the victim block.
+	Return FAIL if there is nothing to do, the caller stops when the host IO arrives */
+int BACKGROUND_GARBAGE_COLLECTION(void)
+{
+	int ret;
+	int page_nb;
+	int32_t old_ppn;
+	int plane_nb;
+	int mapping_index;
+	block_state_entry* b_s_entry;
+
+	if(bg_gc_in_progress == 0){
+
+		/* Reclaim blocks up to the soft watermark */
+		if(total_empty_block_nb >= GC_THRESHOLD_BLOCK_NB || total_victim_block_nb == 0){
+			return FAIL;
 		}
-		else{
-			entry_nb = 0;
+
+		ret = SELECT_VICTIM_BLOCK(bg_gc_mapping_index, &bg_victim_phy_flash_nb, &bg_victim_phy_block_nb);
+
+		bg_gc_mapping_index++;
+		if(bg_gc_mapping_index == VICTIM_TABLE_ENTRY_NB){
+			bg_gc_mapping_index = 0;
 		}
 
-		for(j=0;j<entry_nb;j++){
-			b_s_entry = GET_BLOCK_STATE_ENTRY(curr_v_b_entry->phy_flash_nb, curr_v_b_entry->phy_block_nb);
-	
-			if(curr_valid_page_nb > b_s_entry->valid_page_nb){
-				victim_block = curr_v_b_entry;
-				curr_valid_page_nb = b_s_entry->valid_page_nb;
-			}
-			curr_v_b_entry = curr_v_b_entry->next;
+		if(ret == FAIL){
+			return FAIL;
 		}
-		curr_v_b_root += 1;
+		bg_gc_in_progress = 1;
 	}
-#else
-	/* if GC_TREGGER_OVERALL is not defined, then */
-	curr_v_b_root = (victim_block_root*)victim_block_list + mapping_index;
-
-	if(curr_v_b_root->victim_block_nb != 0){
-		entry_nb = curr_v_b_root->victim_block_nb;
-		curr_v_b_entry = curr_v_b_root->head;
-		if(victim_block == NULL){
-			victim_block = curr_v_b_root->head;
-			b_s_entry = GET_BLOCK_STATE_ENTRY(curr_v_b_entry->phy_flash_nb, curr_v_b_entry->phy_block_nb);
-			curr_valid_page_nb = b_s_entry->valid_page_nb;
-		}
+
+	plane_nb = bg_victim_phy_block_nb % PLANES_PER_FLASH;
+	mapping_index = plane_nb * FLASH_NB + bg_victim_phy_flash_nb;
+
+	b_s_entry = GET_BLOCK_STATE_ENTRY(bg_victim_phy_flash_nb, bg_victim_phy_block_nb);
+	page_nb = FIND_NEXT_BIT(VALID_BITMAP(b_s_entry->page_bitmap), PAGE_NB, 0);
+
+	/* All valid pages are copied */
+	if(page_nb == -1){
+		SSD_BLOCK_ERASE(bg_victim_phy_flash_nb, bg_victim_phy_block_nb);
+#ifdef FTL_MULTI_PLANE
+		CLEAR_STRIPE_PEER(bg_victim_phy_flash_nb, bg_victim_phy_block_nb);
+#endif
+		COUNT_BLOCK_ERASE(bg_victim_phy_flash_nb, bg_victim_phy_block_nb);
+		UPDATE_BLOCK_STATE(bg_victim_phy_flash_nb, bg_victim_phy_block_nb, EMPTY_BLOCK);
+		INSERT_EMPTY_BLOCK(bg_victim_phy_flash_nb, bg_victim_phy_block_nb);
+
+		bg_gc_in_progress = 0;
+		bg_gc_count++;
+		gc_count++;
+
+		COMMIT_META_JOURNAL();
+		return SUCCESS;
+	}
+
+	old_ppn = bg_victim_phy_flash_nb*PAGES_PER_FLASH + bg_victim_phy_block_nb*PAGE_NB + page_nb;
+
+#ifdef FTL_MAP_CACHE
+	if(b_s_entry->type == MAP_BLOCK){
+		ret = MOVE_MAP_PAGE(GET_MAP_PAGE_INDEX(GET_INVERSE_MAPPING_INFO(old_ppn)));
 	}
 	else{
-		printf("ERROR[%s] There is no victim entry\n", __FUNCTION__);
+		ret = COPY_VALID_PAGE(bg_victim_phy_flash_nb, bg_victim_phy_block_nb, page_nb, mapping_index, GC_READ, GC_WRITE);
 	}
+#else
+	ret = COPY_VALID_PAGE(bg_victim_phy_flash_nb, bg_victim_phy_block_nb, page_nb, mapping_index, GC_READ, GC_WRITE);
+#endif
+	if(ret == FAIL){
+		return FAIL;
+	}
+
+	/* The host may stop the GC here, the copied page is not valid any more */
+	UPDATE_BLOCK_STATE_ENTRY(bg_victim_phy_flash_nb, bg_victim_phy_block_nb, page_nb, INVALID);
+	UPDATE_INVERSE_MAPPING(old_ppn, -1);
+	COMMIT_META_JOURNAL();
 
-	for(i=0;i<entry_nb;i++){
+#ifdef MONITOR_ON
+	UPDATE_LOG(LOG_GC_AMP, 1);
+#endif
+	return SUCCESS;
+}
 
-		b_s_entry = GET_BLOCK_STATE_ENTRY(curr_v_b_entry->phy_flash_nb, curr_v_b_entry->phy_block_nb);
+/* Return the victim block being reclaimed to the victim list */
+void TERM_BACKGROUND_GC(void)
+{
+	empty_block_entry* full_block;
 
-		if(curr_valid_page_nb > b_s_entry->valid_page_nb){
-			victim_block = curr_v_b_entry;
-			curr_valid_page_nb = b_s_entry->valid_page_nb;
-		}
-		curr_v_b_entry = curr_v_b_entry->next;
+	printf("Background GC		%lld blocks\n", (long long)bg_gc_count);
+
+	if(bg_gc_in_progress == 0){
+		return;
+	}
+
+	full_block = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+	if(full_block == NULL){
+		printf("ERROR[%s] Alloc fail\n", __FUNCTION__);
+		return;
 	}
+	full_block->phy_flash_nb = bg_victim_phy_flash_nb;
+	full_block->phy_block_nb = bg_victim_phy_block_nb;
+	full_block->curr_phy_page_nb = PAGE_NB;
+
+	INSERT_VICTIM_BLOCK(full_block);
+	bg_gc_in_progress = 0;
+}
 #endif
-	if(curr_valid_page_nb == PAGE_NB){
+
+/* Greedy Garbage Collection Algorithm */
+int SELECT_VICTIM_BLOCK(int mapping_index, unsigned int* phy_flash_nb, unsigned int* phy_block_nb)
+{
+	victim_block_entry* victim_block;
+	block_state_entry* b_s_entry;
+
+	if(total_victim_block_nb == 0){
+		printf("ERROR[%s] There is no victim block\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	/* The victim buckets are kept for the whole SSD if GC_TRIGGER_OVERALL
+	   is defined, otherwise for each plane (mapping_index) */
+	victim_block = GET_MIN_VALID_VICTIM_BLOCK(mapping_index);
+	if(victim_block == NULL){
+#ifndef GC_TRIGGER_OVERALL
+		printf("ERROR[%s] There is no victim entry\n", __FUNCTION__);
+#endif
+		return FAIL;
+	}
+
+	b_s_entry = GET_BLOCK_STATE_ENTRY(victim_block->phy_flash_nb, victim_block->phy_block_nb);
+	if(b_s_entry->valid_page_nb == PAGE_NB){
 		fail_cnt++;
 	//	printf(" Fail Count : %d\n", fail_cnt);
 		return FAIL;
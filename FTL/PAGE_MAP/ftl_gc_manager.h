@@ -8,11 +8,28 @@
 #ifndef _GC_MANAGER_H_
 #define _GC_MANAGER_H_
 
+/* Foreground GC keeps an empty block in each plane and one for the translation block.
+	The host streams do not open the last unwritten block of a plane */
+#ifdef FTL_MAP_CACHE
+#define GC_MAP_BLOCK_NB		1
+#else
+#define GC_MAP_BLOCK_NB		0
+#endif
+#define GC_RESERVE_BLOCK_NB	(FLASH_NB * PLANES_PER_FLASH + GC_MAP_BLOCK_NB)
+
 extern unsigned int gc_count;
 
 void GC_CHECK(unsigned int phy_flash_nb, unsigned int phy_block_nb);
 
-int GARBAGE_COLLECTION(void);
-int SELECT_VICTIM_BLOCK(unsigned int* phy_flash_nb, unsigned int* phy_block_nb);
+int GARBAGE_COLLECTION(int mapping_index);
+#ifdef FTL_MULTI_PLANE
+int COLLECT_STRIPE_PEER_BLOCK(unsigned int phy_flash_nb, unsigned int victim_phy_block_nb, int max_valid_page_nb);
+#endif
+int COPY_VALID_PAGE(unsigned int victim_phy_flash_nb, unsigned int victim_phy_block_nb, int page_nb, int mapping_index, int read_type, int write_type);
+#ifdef GC_BACKGROUND
+int BACKGROUND_GARBAGE_COLLECTION(void);
+void TERM_BACKGROUND_GC(void);
+#endif
+int SELECT_VICTIM_BLOCK(int mapping_index, unsigned int* phy_flash_nb, unsigned int* phy_block_nb);
 
 #endif
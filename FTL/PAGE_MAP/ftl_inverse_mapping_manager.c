@@ -9,6 +9,11 @@
 
 int32_t* inverse_mapping_table;
 void* block_state_table;
+int block_state_entry_size;
+int block_state_table_loaded;
+
+/* The block lists are made from the block state table, not loaded */
+int block_list_rebuilt;
 
 void* empty_block_list;
 void* victim_block_list;
@@ -18,364 +23,460 @@ int64_t total_victim_block_nb;
 
 unsigned int empty_block_table_index;
 
+/* Entries of the empty & victim block lists, one per block at most */
+obj_pool empty_block_pool;
+obj_pool victim_block_pool;
+
+/* Victim Bucket */
+victim_bucket_root* victim_bucket_list;
+victim_block_entry** victim_entry_table;
+int victim_bucket_nb;
+
 void INIT_INVERSE_MAPPING_TABLE(void)
 {
-	/* Allocation Memory for Inverse Page Mapping Table */
-	inverse_mapping_table = (void*)calloc(PAGE_MAPPING_ENTRY_NB, sizeof(int32_t));
+#ifdef FTL_EXTENT_MAP
+	/* A block is written in order, a column for each block of the segment */
+	INIT_EXTENT_TABLE(&inverse_extent_table, "inverse", PAGE_MAPPING_ENTRY_NB, \
+			PAGE_NB < (int)EXTENT_SEGMENT_ENTRY_NB ? PAGE_NB : (int)EXTENT_SEGMENT_ENTRY_NB, \
+			(EXTENT_SEGMENT_ENTRY_NB + PAGE_NB - 1) / PAGE_NB, \
+			"./data/inverse_segment.dat", "./data/inverse_array.dat", meta_state != META_FRESH);
+#else
+	int loaded;
+
+	/* The entries keep lpn + 1, like the mapping table */
+	inverse_mapping_table = (int32_t*)ARENA_LOAD(&ftl_meta_arena, PAGE_MAPPING_ENTRY_NB * sizeof(int32_t), \
+				"./data/inverse_mapping.dat", meta_state != META_FRESH, &loaded);
 	if(inverse_mapping_table == NULL){
-		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
+		printf("ERROR[%s] Alloc mapping table fail\n", __FUNCTION__);
 		return;
 	}
-
-	/* Initialization Inverse Page Mapping Table */
-	FILE* fp = fopen("./data/inverse_mapping.dat","r");
-	if(fp != NULL){
-		fread(inverse_mapping_table, sizeof(int32_t), PAGE_MAPPING_ENTRY_NB, fp);
-	}
-	else{
-		int i;
-		for(i=0;i<PAGE_MAPPING_ENTRY_NB;i++){
-			inverse_mapping_table[i] = -1;
-		}
-	}
+#endif
 }
 
 void INIT_BLOCK_STATE_TABLE(void)
 {
-	/* Allocation Memory for Inverse Block Mapping Table */
-	block_state_table = (void*)calloc(BLOCK_MAPPING_ENTRY_NB, sizeof(block_state_entry));
+	/* The page bitmap is stored inline, after each block state entry */
+	block_state_entry_size = sizeof(block_state_entry) + PAGE_BITMAP_SIZE;
+
+	/* A zero entry is a never erased block without valid page, the type
+		is only tested for DATA_BLOCK & MAP_BLOCK */
+	block_state_table = ARENA_LOAD(&ftl_meta_arena, BLOCK_MAPPING_ENTRY_NB * block_state_entry_size, \
+				"./data/block_state_table.dat", meta_state != META_FRESH, &block_state_table_loaded);
 	if(block_state_table == NULL){
+		printf("ERROR[%s] Alloc mapping table fail\n", __FUNCTION__);
+		return;
+	}
+}
+
+void INIT_EMPTY_BLOCK_LIST(void)
+{
+	int i, j;
+
+	empty_block_entry* curr_entry;
+	empty_block_root* curr_root;
+
+	empty_block_list = (void*)calloc(PLANES_PER_FLASH * FLASH_NB, sizeof(empty_block_root));
+	if(empty_block_list == NULL){
 		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
 		return;
 	}
 
-	/* Initialization Inverse Block Mapping Table */
-	FILE* fp = fopen("./data/block_state_table.dat","r");
-	if(fp != NULL){
-		fread(block_state_table, sizeof(block_state_entry), BLOCK_MAPPING_ENTRY_NB, fp);
+	/* The open blocks keep their entries too */
+	if(INIT_POOL(&empty_block_pool, "empty_block", sizeof(empty_block_entry), \
+				BLOCK_MAPPING_ENTRY_NB + EMPTY_TABLE_ENTRY_NB) == FAIL){
+		return;
 	}
-	else{
-		int i;
-		block_state_entry* curr_b_s_entry = (block_state_entry*)block_state_table;
-
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			curr_b_s_entry->type		= EMPTY_BLOCK;
-			curr_b_s_entry->valid_page_nb	= 0;
-			curr_b_s_entry->erase_count		= 0;
-			curr_b_s_entry += 1;
+
+	empty_block_table_index = 0;
+	block_list_rebuilt = 0;
+
+	if(meta_state == META_CLEAN && LOAD_EMPTY_BLOCK_LIST() == SUCCESS){
+		return;
+	}
+	else if(meta_state != META_FRESH){
+		/* The lists are not saved by the crash */
+		REBUILD_EMPTY_BLOCK_LIST();
+		return;
+	}
+
+	curr_root = (empty_block_root*)empty_block_list;		
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+
+		for(j=0;j<FLASH_NB;j++){
+
+			/* Only the head has an entry, the other blocks of the plane
+				are taken in order by ALLOC_FRESH_EMPTY_BLOCK */
+			curr_entry = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+			if(curr_entry == NULL){
+				printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
+				return;
+			}
+			curr_entry->phy_flash_nb = j;
+			curr_entry->phy_block_nb = i;
+			curr_entry->curr_phy_page_nb = 0;
+
+			curr_root->head = curr_entry;
+			curr_root->tail = curr_entry;
+			curr_root->empty_block_nb = (unsigned int)EACH_EMPTY_TABLE_ENTRY_NB;
+			curr_root->fresh_block_nb = (unsigned int)EACH_EMPTY_TABLE_ENTRY_NB - 1;
+			curr_root += 1;
 		}
 	}
+	total_empty_block_nb = (int64_t)BLOCK_MAPPING_ENTRY_NB;
 }
 
-void INIT_VALID_ARRAY(void)
+void INIT_VICTIM_BLOCK_LIST(void)
 {
-	int i;
-	block_state_entry* curr_b_s_entry = (block_state_entry*)block_state_table;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","r");
-	if(fp != NULL){
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			fread(valid_array, sizeof(char), PAGE_NB, fp);
-			curr_b_s_entry->valid_array = valid_array;
+	victim_block_list = (void*)calloc(PLANES_PER_FLASH * FLASH_NB, sizeof(victim_block_root));
+	if(victim_block_list == NULL){
+		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
+		return;
+	}
 
-			curr_b_s_entry += 1;
-		}
+	if(INIT_POOL(&victim_block_pool, "victim_block", sizeof(victim_block_entry), BLOCK_MAPPING_ENTRY_NB) == FAIL){
+		return;
 	}
-	else{
-		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-			valid_array = (char*)calloc(PAGE_NB, sizeof(char));
-			memset(valid_array,0,PAGE_NB);
-			curr_b_s_entry->valid_array = valid_array;
 
-			curr_b_s_entry += 1;
-		}			
+	INIT_VICTIM_BUCKET();
+
+	total_victim_block_nb = 0;
+
+	if(block_list_rebuilt == 1){
+		REBUILD_VICTIM_BLOCK_LIST();
+	}
+	else if(meta_state == META_CLEAN && LOAD_VICTIM_BLOCK_LIST() == FAIL){
+		REBUILD_VICTIM_BLOCK_LIST();
 	}
 }
 
-void INIT_EMPTY_BLOCK_LIST(void)
+/* The lists are saved as the block addresses, the roots have the counts */
+int LOAD_EMPTY_BLOCK_LIST(void)
 {
-	int i, j, k;
+	int i, k;
+	int listed_nb;
+	unsigned int root_info[2];
+	block_list_record record;
 
 	empty_block_entry* curr_entry;
-	empty_block_root* curr_root;
+	empty_block_root* curr_root = (empty_block_root*)empty_block_list;
 
-	empty_block_list = (void*)calloc(PLANES_PER_FLASH * FLASH_NB, sizeof(empty_block_root));
-	if(empty_block_list == NULL){
-		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
-		return;
+	FILE* fp = fopen("./data/empty_block_list.dat","r");
+	if(fp == NULL){
+		return FAIL;
 	}
 
-	FILE* fp = fopen("./data/empty_block_list.dat","r");
-	if(fp != NULL){
-		total_empty_block_nb = 0;
-		fread(empty_block_list,sizeof(empty_block_root),PLANES_PER_FLASH*FLASH_NB, fp);
-		curr_root = (empty_block_root*)empty_block_list;
-
-		for(i=0;i<PLANES_PER_FLASH;i++){
-
-			for(j=0;j<FLASH_NB;j++){
-
-				total_empty_block_nb += curr_root->empty_block_nb;
-				k = curr_root->empty_block_nb;
-				while(k > 0){
-					curr_entry = (empty_block_entry*)calloc(1, sizeof(empty_block_entry));
-					if(curr_entry == NULL){
-						printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
-						break;
-					}
+	total_empty_block_nb = 0;
+	for(i=0;i<EMPTY_TABLE_ENTRY_NB;i++){
 
-					fread(curr_entry, sizeof(empty_block_entry), 1, fp);
-					curr_entry->next = NULL;
+		if(fread(root_info, sizeof(unsigned int), 2, fp) != 2 || root_info[1] > root_info[0]){
+			goto load_fail;
+		}
+		curr_root->empty_block_nb = root_info[0];
+		curr_root->fresh_block_nb = root_info[1];
+		total_empty_block_nb += curr_root->empty_block_nb;
+
+		/* The fresh blocks are not in the file */
+		listed_nb = curr_root->empty_block_nb - curr_root->fresh_block_nb;
+		for(k=0;k<listed_nb;k++){
+			if(fread(&record, sizeof(block_list_record), 1, fp) != 1){
+				goto load_fail;
+			}
 
-					if(k == curr_root->empty_block_nb){
-						curr_root->head = curr_entry;
-						curr_root->tail = curr_entry;
-					}					
-					else{
-						curr_root->tail->next = curr_entry;
-						curr_root->tail = curr_entry;
-					}
-					k--;
-				}
-				curr_root += 1;
+			curr_entry = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+			if(curr_entry == NULL){
+				printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
+				goto load_fail;
 			}
+			curr_entry->phy_flash_nb = record.phy_flash_nb;
+			curr_entry->phy_block_nb = record.phy_block_nb;
+			curr_entry->curr_phy_page_nb = record.curr_phy_page_nb;
+			curr_entry->next = NULL;
+
+			if(k == 0){
+				curr_root->head = curr_entry;
+			}
+			else{
+				curr_root->tail->next = curr_entry;
+			}
+			curr_root->tail = curr_entry;
 		}
-		empty_block_table_index = 0;
+		curr_root += 1;
 	}
-	else{
-		curr_root = (empty_block_root*)empty_block_list;		
 
-		for(i=0;i<PLANES_PER_FLASH;i++){
+	fclose(fp);
+	return SUCCESS;
 
-			for(j=0;j<FLASH_NB;j++){
+load_fail:
+	/* The entries taken so far stay in the pool */
+	printf("ERROR[%s] ./data/empty_block_list.dat is broken, the lists are rebuilt\n", __FUNCTION__);
+	memset(empty_block_list, 0, EMPTY_TABLE_ENTRY_NB * sizeof(empty_block_root));
+	fclose(fp);
+	return FAIL;
+}
 
-				for(k=i;k<BLOCK_NB;k+=PLANES_PER_FLASH){
+int LOAD_VICTIM_BLOCK_LIST(void)
+{
+	int i, k;
+	unsigned int victim_block_nb;
+	block_list_record record;
 
-					curr_entry = (empty_block_entry*)calloc(1, sizeof(empty_block_entry));	
-					if(curr_entry == NULL){
-						printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
-						break;
-					}
-	
-					if(k==i){
-						curr_root->head = curr_entry;
-						curr_root->tail = curr_entry;
+	victim_block_entry* curr_entry;
+	victim_block_root* curr_root = (victim_block_root*)victim_block_list;
+	block_state_entry* b_s_entry;
 
-						curr_root->tail->phy_flash_nb = j;
-						curr_root->tail->phy_block_nb = k;
-						curr_root->tail->curr_phy_page_nb = 0;
-					}
-					else{
-						curr_root->tail->next = curr_entry;
-						curr_root->tail = curr_entry;
+	FILE* fp = fopen("./data/victim_block_list.dat","r");
+	if(fp == NULL){
+		return FAIL;
+	}
 
-						curr_root->tail->phy_flash_nb = j;
-						curr_root->tail->phy_block_nb = k;
-						curr_root->tail->curr_phy_page_nb = 0;
-					}
-					UPDATE_BLOCK_STATE(j, k, EMPTY_BLOCK);
-				}
-				curr_root->empty_block_nb = (unsigned int)EACH_EMPTY_TABLE_ENTRY_NB;
-				curr_root += 1;
+	for(i=0;i<VICTIM_TABLE_ENTRY_NB;i++){
+
+		if(fread(&victim_block_nb, sizeof(unsigned int), 1, fp) != 1){
+			goto load_fail;
+		}
+
+		for(k=0;k<victim_block_nb;k++){
+			if(fread(&record, sizeof(block_list_record), 1, fp) != 1){
+				goto load_fail;
+			}
+
+			curr_entry = (victim_block_entry*)POOL_ALLOC(&victim_block_pool);
+			if(curr_entry == NULL){
+				printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
+				goto load_fail;
 			}
+			curr_entry->phy_flash_nb = record.phy_flash_nb;
+			curr_entry->phy_block_nb = record.phy_block_nb;
+			curr_entry->next = NULL;
+			curr_entry->prev = curr_root->tail;
+
+			b_s_entry = GET_BLOCK_STATE_ENTRY(curr_entry->phy_flash_nb, curr_entry->phy_block_nb);
+			INSERT_VICTIM_BUCKET(curr_entry, b_s_entry->valid_page_nb);
+
+			if(k == 0){
+				curr_root->head = curr_entry;
+			}
+			else{
+				curr_root->tail->next = curr_entry;
+			}
+			curr_root->tail = curr_entry;
+			curr_root->victim_block_nb++;
+			total_victim_block_nb++;
 		}
-		total_empty_block_nb = (int64_t)BLOCK_MAPPING_ENTRY_NB;
-		empty_block_table_index = 0;
+		curr_root += 1;
+	}
+
+	fclose(fp);
+	return SUCCESS;
+
+load_fail:
+	/* Start again from the block state table, the entries taken so far stay in the pool */
+	printf("ERROR[%s] ./data/victim_block_list.dat is broken, the list is rebuilt\n", __FUNCTION__);
+	fclose(fp);
+
+	for(i=0;i<victim_bucket_nb;i++){
+		memset(victim_bucket_list[i].head, 0, (PAGE_NB + 1) * sizeof(victim_block_entry*));
+		memset(victim_bucket_list[i].tail, 0, (PAGE_NB + 1) * sizeof(victim_block_entry*));
+		victim_bucket_list[i].min_valid_page_nb = PAGE_NB + 1;
 	}
+	memset(victim_entry_table, 0, BLOCK_MAPPING_ENTRY_NB * sizeof(victim_block_entry*));
+	memset(victim_block_list, 0, VICTIM_TABLE_ENTRY_NB * sizeof(victim_block_root));
+	total_victim_block_nb = 0;
+
+	return FAIL;
 }
 
-void INIT_VICTIM_BLOCK_LIST(void)
+/* After a crash : the unwritten blocks are empty, the first partly written
+	block of each plane is written on, the other written blocks are victims */
+void REBUILD_EMPTY_BLOCK_LIST(void)
 {
-	int i, j, k;
+	int mapping_index;
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+	int written_page_nb;
 
-	victim_block_entry* curr_entry;
-	victim_block_root* curr_root;
+	empty_block_entry* curr_entry;
+	empty_block_entry* head_entry;
+	empty_block_root* curr_root = (empty_block_root*)empty_block_list;
+	block_state_entry* b_s_entry;
 
-	victim_block_list = (void*)calloc(PLANES_PER_FLASH * FLASH_NB, sizeof(victim_block_root));
-	if(victim_block_list == NULL){
-		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
-		return;
-	}
+	block_list_rebuilt = 1;
+	total_empty_block_nb = 0;
 
-	FILE* fp = fopen("./data/victim_block_list.dat","r");
-	if(fp != NULL){
-		total_victim_block_nb = 0;
-		fread(victim_block_list, sizeof(victim_block_root), PLANES_PER_FLASH*FLASH_NB, fp);
-		curr_root = (victim_block_root*)victim_block_list;
-
-		for(i=0;i<PLANES_PER_FLASH;i++){
-
-			for(j=0;j<FLASH_NB;j++){
-
-				total_victim_block_nb += curr_root->victim_block_nb;
-				k = curr_root->victim_block_nb;
-				while(k > 0){
-					curr_entry = (victim_block_entry*)calloc(1, sizeof(victim_block_entry));
-					if(curr_entry == NULL){
-						printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
-						break;
-					}
+	for(mapping_index=0;mapping_index<EMPTY_TABLE_ENTRY_NB;mapping_index++){
+		phy_flash_nb = mapping_index % FLASH_NB;
+		head_entry = NULL;
 
-					fread(curr_entry, sizeof(victim_block_entry), 1, fp);
-					curr_entry->next = NULL;
-					curr_entry->prev = NULL;
-
-					if(k == curr_root->victim_block_nb){
-						curr_root->head = curr_entry;
-						curr_root->tail = curr_entry;
-					}					
-					else{
-						curr_root->tail->next = curr_entry;
-						curr_entry->prev = curr_root->tail;
-						curr_root->tail = curr_entry;
-					}
-					k--;
+		for(phy_block_nb=mapping_index/FLASH_NB;phy_block_nb<BLOCK_NB;phy_block_nb+=PLANES_PER_FLASH){
+			b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+			written_page_nb = COUNT_BITMAP(WRITTEN_BITMAP(b_s_entry->page_bitmap), PAGE_BITMAP_WORD_NB);
+
+			if(written_page_nb == PAGE_NB || (written_page_nb != 0 && head_entry != NULL)){
+				continue;
+			}
+
+			curr_entry = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+			if(curr_entry == NULL){
+				printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
+				return;
+			}
+			curr_entry->phy_flash_nb = phy_flash_nb;
+			curr_entry->phy_block_nb = phy_block_nb;
+			curr_entry->curr_phy_page_nb = written_page_nb;
+			curr_entry->next = NULL;
+
+			/* The pages of a block are written in order */
+			if(written_page_nb != 0){
+				head_entry = curr_entry;
+				curr_entry->next = curr_root->head;
+				curr_root->head = curr_entry;
+				if(curr_root->tail == NULL){
+					curr_root->tail = curr_entry;
 				}
-				curr_root += 1;
 			}
+			else if(curr_root->tail == NULL){
+				curr_root->head = curr_entry;
+				curr_root->tail = curr_entry;
+			}
+			else{
+				curr_root->tail->next = curr_entry;
+				curr_root->tail = curr_entry;
+			}
+			curr_root->empty_block_nb++;
 		}
+
+		curr_root->fresh_block_nb = 0;
+		total_empty_block_nb += curr_root->empty_block_nb;
+		curr_root += 1;
 	}
-	else{
-		curr_root = (victim_block_root*)victim_block_list;		
+}
 
-		for(i=0;i<PLANES_PER_FLASH;i++){
+void REBUILD_VICTIM_BLOCK_LIST(void)
+{
+	int mapping_index;
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+
+	empty_block_entry* full_block;
+	empty_block_entry* head_entry;
+	block_state_entry* b_s_entry;
 
-			for(j=0;j<FLASH_NB;j++){
+	for(mapping_index=0;mapping_index<EMPTY_TABLE_ENTRY_NB;mapping_index++){
+		phy_flash_nb = mapping_index % FLASH_NB;
+		head_entry = ((empty_block_root*)empty_block_list + mapping_index)->head;
+
+		for(phy_block_nb=mapping_index/FLASH_NB;phy_block_nb<BLOCK_NB;phy_block_nb+=PLANES_PER_FLASH){
+			if(head_entry != NULL && head_entry->phy_block_nb == phy_block_nb){
+				continue;
+			}
 
-				curr_root->head = NULL;
-				curr_root->tail = NULL;
-				curr_root->victim_block_nb = 0;
+			b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+			if(COUNT_BITMAP(WRITTEN_BITMAP(b_s_entry->page_bitmap), PAGE_BITMAP_WORD_NB) == 0){
+				continue;
+			}
 
-				curr_root += 1;
+			/* The entry is released by INSERT_VICTIM_BLOCK */
+			full_block = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+			if(full_block == NULL){
+				printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
+				return;
 			}
+			full_block->phy_flash_nb = phy_flash_nb;
+			full_block->phy_block_nb = phy_block_nb;
+
+			INSERT_VICTIM_BLOCK(full_block);
 		}
-		total_victim_block_nb = 0;
 	}
 }
 
 void TERM_INVERSE_MAPPING_TABLE(void)
 {
-	FILE* fp = fopen("./data/inverse_mapping.dat", "w");
-	if(fp==NULL){
-		printf("ERROR[%s] File open fail\n", __FUNCTION__);
-		return;
-	}
-
-	/* Write The inverse page table to file */
-	fwrite(inverse_mapping_table, sizeof(int32_t), PAGE_MAPPING_ENTRY_NB, fp);
-
-	/* Free the inverse page table memory */
-	free(inverse_mapping_table);
+#ifdef FTL_EXTENT_MAP
+	TERM_EXTENT_TABLE(&inverse_extent_table);
+#else
+	/* The table is written by the last checkpoint, the memory is released with the arena */
+	inverse_mapping_table = NULL;
+#endif
 }
 
 void TERM_BLOCK_STATE_TABLE(void)
 {
-	FILE* fp = fopen("./data/block_state_table.dat","w");
-	if(fp==NULL){
-		printf("ERROR[%s] File open fail\n", __FUNCTION__);
-		return;
-	}
-
-	/* Write The inverse block table to file */
-	fwrite(block_state_table, sizeof(block_state_entry), BLOCK_MAPPING_ENTRY_NB, fp);
-
-	/* Free The inverse block table memory */
-	free(block_state_table);
-}
-
-void TERM_VALID_ARRAY(void)
-{
-	int i;
-	block_state_entry* curr_b_s_entry = (block_state_entry*)block_state_table;
-	char* valid_array;
-
-	FILE* fp = fopen("./data/valid_array.dat","w");
-        if(fp == NULL){
-		printf("ERROR[%s] File open fail\n", __FUNCTION__);
-		return;
-	}
- 
-	for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
-		valid_array = curr_b_s_entry->valid_array;
-		fwrite(valid_array, sizeof(char), PAGE_NB, fp);
-		curr_b_s_entry += 1;
-	}
+	block_state_table = NULL;
 }
 
 void TERM_EMPTY_BLOCK_LIST(void)
 {
-	int i, j, k;
+	int i, k;
+	int listed_nb;
+	unsigned int root_info[2];
+	block_list_record record;
 
 	empty_block_entry* curr_entry;
-	empty_block_root* curr_root;
+	empty_block_root* curr_root = (empty_block_root*)empty_block_list;
 
 	FILE* fp = fopen("./data/empty_block_list.dat","w");
 	if(fp==NULL){
 		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+		TERM_POOL(&empty_block_pool);
+		return;
 	}
 
-	fwrite(empty_block_list,sizeof(empty_block_root),PLANES_PER_FLASH*FLASH_NB, fp);
-
-	curr_root = (empty_block_root*)empty_block_list;
-	for(i=0;i<PLANES_PER_FLASH;i++){
-
-		for(j=0;j<FLASH_NB;j++){
-
-			k = curr_root->empty_block_nb;
-			if(k != 0){
-				curr_entry = (empty_block_entry*)curr_root->head;
-			}
-			while(k > 0){
-
-				fwrite(curr_entry, sizeof(empty_block_entry), 1, fp);
-
-				if(k != 1){
-					curr_entry = curr_entry->next;
-				}
-				k--;
-			}
-			curr_root += 1;
+	for(i=0;i<EMPTY_TABLE_ENTRY_NB;i++){
+		root_info[0] = curr_root->empty_block_nb;
+		root_info[1] = curr_root->fresh_block_nb;
+		fwrite(root_info, sizeof(unsigned int), 2, fp);
+
+		/* The fresh blocks are restored from the root */
+		listed_nb = curr_root->empty_block_nb - curr_root->fresh_block_nb;
+		curr_entry = curr_root->head;
+		for(k=0;k<listed_nb;k++){
+			record.phy_flash_nb = curr_entry->phy_flash_nb;
+			record.phy_block_nb = curr_entry->phy_block_nb;
+			record.curr_phy_page_nb = curr_entry->curr_phy_page_nb;
+			fwrite(&record, sizeof(block_list_record), 1, fp);
+
+			curr_entry = curr_entry->next;
 		}
+		curr_root += 1;
 	}
+	fclose(fp);
+
+	TERM_POOL(&empty_block_pool);
 }
 
 void TERM_VICTIM_BLOCK_LIST(void)
 {
-	int i, j, k;
+	int i, k;
+	block_list_record record;
 
 	victim_block_entry* curr_entry;
-	victim_block_root* curr_root;
+	victim_block_root* curr_root = (victim_block_root*)victim_block_list;
 
 	FILE* fp = fopen("./data/victim_block_list.dat","w");
 	if(fp==NULL){
 		printf("ERROR[%s] File open fail\n", __FUNCTION__);
 	}
+	else{
+		for(i=0;i<VICTIM_TABLE_ENTRY_NB;i++){
+			fwrite(&curr_root->victim_block_nb, sizeof(unsigned int), 1, fp);
 
-	fwrite(victim_block_list, sizeof(victim_block_root), PLANES_PER_FLASH*FLASH_NB, fp);
-
-	curr_root = (victim_block_root*)victim_block_list;
-	for(i=0;i<PLANES_PER_FLASH;i++){
-
-		for(j=0;j<FLASH_NB;j++){
+			curr_entry = curr_root->head;
+			for(k=0;k<curr_root->victim_block_nb;k++){
+				record.phy_flash_nb = curr_entry->phy_flash_nb;
+				record.phy_block_nb = curr_entry->phy_block_nb;
+				record.curr_phy_page_nb = PAGE_NB;
+				fwrite(&record, sizeof(block_list_record), 1, fp);
 
-			k = curr_root->victim_block_nb;
-			if(k != 0){
-				curr_entry = (victim_block_entry*)curr_root->head;
-			}
-			while(k > 0){
-
-				fwrite(curr_entry, sizeof(victim_block_entry), 1, fp);
-
-				if(k != 1){
-					curr_entry = curr_entry->next;
-				}
-				k--;
+				curr_entry = curr_entry->next;
 			}
 			curr_root += 1;
 		}
+		fclose(fp);
 	}
+
+	TERM_VICTIM_BUCKET();
+	TERM_POOL(&victim_block_pool);
 }
 
 empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index)
@@ -407,14 +508,7 @@ empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index)
 				if(curr_empty_block->curr_phy_page_nb == PAGE_NB){
 
 					/* Update Empty Block List */
-					if(curr_root_entry->empty_block_nb == 1){
-						curr_root_entry->head = NULL;
-						curr_root_entry->empty_block_nb = 0;
-					}
-					else{
-						curr_root_entry->head = curr_empty_block->next;
-						curr_root_entry->empty_block_nb -= 1;
-					}
+					REMOVE_EMPTY_BLOCK_HEAD(curr_root_entry);
 				
 					/* Eject Empty Block from the list */
 					INSERT_VICTIM_BLOCK(curr_empty_block);
@@ -439,14 +533,17 @@ empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index)
 			curr_root_entry = (empty_block_root*)empty_block_list + mapping_index;
 			if(curr_root_entry->empty_block_nb == 0){
 
-				/* If the flash memory has multiple planes, move index */
+				/* If the flash memory has multiple planes, move index
+					to the next plane of the same flash : plane_nb * FLASH_NB + flash_nb */
                                 if(PLANES_PER_FLASH != 1){
-                                        mapping_index++;
-                                        if(mapping_index % PLANES_PER_FLASH == 0){
-                                                mapping_index = mapping_index - (PLANES_PER_FLASH-1);
+                                        mapping_index += FLASH_NB;
+                                        if(mapping_index >= EMPTY_TABLE_ENTRY_NB){
+                                                mapping_index -= EMPTY_TABLE_ENTRY_NB;
                                         }
                                         if(mapping_index == input_mapping_index){
-                                                printf("ERROR[%s] There is no empty block\n",__FUNCTION__);
+#ifdef FTL_DEBUG
+                                                printf("ERROR[%s]-INCHIP There is no empty block\n",__FUNCTION__);
+#endif
                                                 return NULL;
                                         }
                                 }
@@ -465,14 +562,7 @@ empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index)
 				if(curr_empty_block->curr_phy_page_nb == PAGE_NB){
 					
 					/* Update Empty Block List */
-					if(curr_root_entry->empty_block_nb == 1){
-						curr_root_entry->head = NULL;
-						curr_root_entry->empty_block_nb = 0;
-					}
-					else{
-						curr_root_entry->head = curr_empty_block->next;
-						curr_root_entry->empty_block_nb -= 1;
-					}
+					REMOVE_EMPTY_BLOCK_HEAD(curr_root_entry);
 
 					/* Eject Empty Block from the list */
 					INSERT_VICTIM_BLOCK(curr_empty_block);
@@ -507,14 +597,7 @@ empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index)
 				if(curr_empty_block->curr_phy_page_nb == PAGE_NB){
 					
 					/* Update Empty Block List */
-					if(curr_root_entry->empty_block_nb == 1){
-						curr_root_entry->head = NULL;
-						curr_root_entry->empty_block_nb = 0;
-					}
-					else{
-						curr_root_entry->head = curr_empty_block->next;
-						curr_root_entry->empty_block_nb -= 1;
-					}
+					REMOVE_EMPTY_BLOCK_HEAD(curr_root_entry);
 
 					/* Eject Empty Block from the list */
 					INSERT_VICTIM_BLOCK(curr_empty_block);
@@ -545,7 +628,7 @@ int INSERT_EMPTY_BLOCK(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 	empty_block_root* curr_root_entry;
 	empty_block_entry* new_empty_block;
 
-	new_empty_block = (empty_block_entry*)calloc(1, sizeof(empty_block_entry));
+	new_empty_block = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
 	if(new_empty_block == NULL){
 		printf("ERROR[%s] Alloc new empty block fail\n", __FUNCTION__);
 		return FAIL;
@@ -568,8 +651,15 @@ int INSERT_EMPTY_BLOCK(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 		curr_root_entry->empty_block_nb = 1;
 	}
 	else{
+#ifdef FTL_WEAR_LEVELING
+		if(PUSH_EMPTY_BLOCK_HEAP(mapping_index, new_empty_block) == FAIL){
+			POOL_FREE(&empty_block_pool, new_empty_block);
+			return FAIL;
+		}
+#else
 		curr_root_entry->tail->next = new_empty_block;
 		curr_root_entry->tail = new_empty_block;
+#endif
 		curr_root_entry->empty_block_nb++;
 	}
 	total_empty_block_nb++;
@@ -577,6 +667,135 @@ int INSERT_EMPTY_BLOCK(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 	return SUCCESS;
 }
 
+/* Take an unwritten block out of the empty block list */
+empty_block_entry* EJECT_EMPTY_BLOCK(void)
+{
+	int i;
+	static int eject_index = 0;
+
+	empty_block_entry* curr_empty_block;
+
+	for(i=0; i<EMPTY_TABLE_ENTRY_NB; i++){
+		curr_empty_block = EJECT_PLANE_EMPTY_BLOCK(eject_index);
+
+		eject_index++;
+		if(eject_index == EMPTY_TABLE_ENTRY_NB){
+			eject_index = 0;
+		}
+
+		if(curr_empty_block != NULL){
+			return curr_empty_block;
+		}
+	}
+
+	printf("ERROR[%s] There is no empty block\n", __FUNCTION__);
+	return NULL;
+}
+
+/* Take an unwritten block of the plane, NULL if there is not */
+empty_block_entry* EJECT_PLANE_EMPTY_BLOCK(int mapping_index)
+{
+	empty_block_entry* curr_empty_block;
+	empty_block_root* curr_root_entry = (empty_block_root*)empty_block_list + mapping_index;
+
+	if(curr_root_entry->empty_block_nb == 0){
+		return NULL;
+	}
+
+	/* The head block may be written by GET_NEW_PAGE already */
+	curr_empty_block = curr_root_entry->head;
+	if(curr_empty_block->curr_phy_page_nb == 0){
+		REMOVE_EMPTY_BLOCK_HEAD(curr_root_entry);
+	}
+	else if(curr_root_entry->empty_block_nb > 1){
+		if(curr_root_entry->fresh_block_nb != 0){
+			curr_empty_block = ALLOC_FRESH_EMPTY_BLOCK(curr_root_entry);
+			if(curr_empty_block == NULL){
+				return NULL;
+			}
+		}
+		else{
+#ifdef FTL_WEAR_LEVELING
+			curr_empty_block = POP_EMPTY_BLOCK_HEAP(mapping_index);
+#else
+			curr_empty_block = curr_root_entry->head->next;
+			curr_root_entry->head->next = curr_empty_block->next;
+			if(curr_root_entry->tail == curr_empty_block){
+				curr_root_entry->tail = curr_root_entry->head;
+			}
+#endif
+		}
+		curr_root_entry->empty_block_nb--;
+	}
+	else{
+		return NULL;
+	}
+
+	total_empty_block_nb--;
+
+	curr_empty_block->next = NULL;
+	return curr_empty_block;
+}
+
+/* Remove the head block from the empty block list, the next block is written next */
+void REMOVE_EMPTY_BLOCK_HEAD(empty_block_root* curr_root_entry)
+{
+	if(curr_root_entry->empty_block_nb == 1){
+		curr_root_entry->head = NULL;
+		curr_root_entry->tail = NULL;
+		curr_root_entry->empty_block_nb = 0;
+	}
+	else if(curr_root_entry->fresh_block_nb != 0){
+		/* A never erased block goes first, the listed blocks stay after it */
+		empty_block_entry* new_head = ALLOC_FRESH_EMPTY_BLOCK(curr_root_entry);
+		if(new_head == NULL){
+			return;
+		}
+
+		new_head->next = curr_root_entry->head->next;
+		if(curr_root_entry->tail == curr_root_entry->head){
+			curr_root_entry->tail = new_head;
+		}
+		curr_root_entry->head = new_head;
+		curr_root_entry->empty_block_nb -= 1;
+	}
+	else{
+#ifdef FTL_WEAR_LEVELING
+		/* The least erased block of the plane */
+		curr_root_entry->head = POP_EMPTY_BLOCK_HEAP(curr_root_entry - (empty_block_root*)empty_block_list);
+		curr_root_entry->tail = curr_root_entry->head;
+#else
+		curr_root_entry->head = curr_root_entry->head->next;
+#endif
+		curr_root_entry->empty_block_nb -= 1;
+	}
+}
+
+/* Make the entry of the next never used block of the plane, the blocks of a plane
+	are taken in the block number order. The caller updates empty_block_nb */
+empty_block_entry* ALLOC_FRESH_EMPTY_BLOCK(empty_block_root* curr_root_entry)
+{
+	int mapping_index = curr_root_entry - (empty_block_root*)empty_block_list;
+	int plane_nb = mapping_index / FLASH_NB;
+	empty_block_entry* new_empty_block;
+
+	new_empty_block = (empty_block_entry*)POOL_ALLOC(&empty_block_pool);
+	if(new_empty_block == NULL){
+		printf("ERROR[%s] Alloc new empty block fail\n", __FUNCTION__);
+		return NULL;
+	}
+
+	new_empty_block->phy_flash_nb = mapping_index % FLASH_NB;
+	new_empty_block->phy_block_nb = plane_nb \
+		+ PLANES_PER_FLASH * (unsigned int)(EACH_EMPTY_TABLE_ENTRY_NB - curr_root_entry->fresh_block_nb);
+	new_empty_block->curr_phy_page_nb = 0;
+	new_empty_block->next = NULL;
+
+	curr_root_entry->fresh_block_nb--;
+
+	return new_empty_block;
+}
+
 int INSERT_VICTIM_BLOCK(empty_block_entry* full_block){
 
 	int mapping_index;
@@ -584,9 +803,10 @@ int INSERT_VICTIM_BLOCK(empty_block_entry* full_block){
 
 	victim_block_root* curr_v_b_root;
 	victim_block_entry* new_v_b_entry;
+	block_state_entry* b_s_entry;
 
 	/* Alloc New victim block entry */
-	new_v_b_entry = (victim_block_entry*)calloc(1, sizeof(victim_block_entry));
+	new_v_b_entry = (victim_block_entry*)POOL_ALLOC(&victim_block_pool);
 	if(new_v_b_entry == NULL){
 		printf("ERROR[%s] Calloc fail\n", __FUNCTION__);
 		return FAIL;
@@ -616,8 +836,12 @@ int INSERT_VICTIM_BLOCK(empty_block_entry* full_block){
 		curr_v_b_root->victim_block_nb++;
 	}
 
+	/* Insert to the bucket of its valid page number */
+	b_s_entry = GET_BLOCK_STATE_ENTRY(new_v_b_entry->phy_flash_nb, new_v_b_entry->phy_block_nb);
+	INSERT_VICTIM_BUCKET(new_v_b_entry, b_s_entry->valid_page_nb);
+
 	/* Free the full empty block entry */
-	free(full_block);
+	POOL_FREE(&empty_block_pool, full_block);
 
 	/* Update the total number of victim block */
 	total_victim_block_nb++;
@@ -631,6 +855,7 @@ int EJECT_VICTIM_BLOCK(victim_block_entry* victim_block){
 	int plane_nb;
 
 	victim_block_root* curr_v_b_root;
+	block_state_entry* b_s_entry;
 
 	plane_nb = victim_block->phy_block_nb % PLANES_PER_FLASH;
 	mapping_index = plane_nb * FLASH_NB + victim_block->phy_flash_nb;
@@ -660,51 +885,222 @@ int EJECT_VICTIM_BLOCK(victim_block_entry* victim_block){
 	curr_v_b_root->victim_block_nb--;
 	total_victim_block_nb--;
 
+	/* Remove from the victim bucket */
+	b_s_entry = GET_BLOCK_STATE_ENTRY(victim_block->phy_flash_nb, victim_block->phy_block_nb);
+	REMOVE_VICTIM_BUCKET(victim_block, b_s_entry->valid_page_nb);
+
 	/* Free the victim block */
-	free(victim_block);
+	POOL_FREE(&victim_block_pool, victim_block);
 
 	return SUCCESS;
 }
 
+void INIT_VICTIM_BUCKET(void)
+{
+	int i;
+	victim_bucket_root* curr_bucket;
+
+	/* One bucket set for the whole SSD, or one for each plane */
+#ifdef GC_TRIGGER_OVERALL
+	victim_bucket_nb = 1;
+#else
+	victim_bucket_nb = VICTIM_TABLE_ENTRY_NB;
+#endif
+
+	victim_bucket_list = (victim_bucket_root*)calloc(victim_bucket_nb, sizeof(victim_bucket_root));
+	victim_entry_table = (victim_block_entry**)ARENA_ALLOC(&ftl_meta_arena, BLOCK_MAPPING_ENTRY_NB * sizeof(victim_block_entry*));
+	if(victim_bucket_list == NULL || victim_entry_table == NULL){
+		printf("ERROR[%s] Calloc victim bucket fail\n", __FUNCTION__);
+		return;
+	}
+
+	curr_bucket = victim_bucket_list;
+	for(i=0;i<victim_bucket_nb;i++){
+		curr_bucket->head = (victim_block_entry**)calloc(PAGE_NB + 1, sizeof(victim_block_entry*));
+		curr_bucket->tail = (victim_block_entry**)calloc(PAGE_NB + 1, sizeof(victim_block_entry*));
+		if(curr_bucket->head == NULL || curr_bucket->tail == NULL){
+			printf("ERROR[%s] Calloc victim bucket fail\n", __FUNCTION__);
+			return;
+		}
+		curr_bucket->min_valid_page_nb = PAGE_NB + 1;
+
+		curr_bucket += 1;
+	}
+}
+
+void TERM_VICTIM_BUCKET(void)
+{
+	int i;
+	victim_bucket_root* curr_bucket = victim_bucket_list;
+
+	for(i=0;i<victim_bucket_nb;i++){
+		free(curr_bucket->head);
+		free(curr_bucket->tail);
+		curr_bucket += 1;
+	}
+
+	free(victim_bucket_list);
+	victim_bucket_list = NULL;
+	victim_entry_table = NULL;
+}
+
+void INSERT_VICTIM_BUCKET(victim_block_entry* v_b_entry, int valid_page_nb)
+{
+	victim_bucket_root* curr_bucket;
+
+#ifdef GC_TRIGGER_OVERALL
+	curr_bucket = victim_bucket_list;
+#else
+	int plane_nb = v_b_entry->phy_block_nb % PLANES_PER_FLASH;
+	curr_bucket = victim_bucket_list + plane_nb * FLASH_NB + v_b_entry->phy_flash_nb;
+#endif
+
+	/* Append to the tail, the oldest block is selected first */
+	v_b_entry->bucket_next = NULL;
+	v_b_entry->bucket_prev = curr_bucket->tail[valid_page_nb];
+
+	if(curr_bucket->tail[valid_page_nb] == NULL){
+		curr_bucket->head[valid_page_nb] = v_b_entry;
+	}
+	else{
+		curr_bucket->tail[valid_page_nb]->bucket_next = v_b_entry;
+	}
+	curr_bucket->tail[valid_page_nb] = v_b_entry;
+
+	if(valid_page_nb < curr_bucket->min_valid_page_nb){
+		curr_bucket->min_valid_page_nb = valid_page_nb;
+	}
+
+	victim_entry_table[v_b_entry->phy_flash_nb * BLOCK_NB + v_b_entry->phy_block_nb] = v_b_entry;
+}
+
+void REMOVE_VICTIM_BUCKET(victim_block_entry* v_b_entry, int valid_page_nb)
+{
+	victim_bucket_root* curr_bucket;
+
+#ifdef GC_TRIGGER_OVERALL
+	curr_bucket = victim_bucket_list;
+#else
+	int plane_nb = v_b_entry->phy_block_nb % PLANES_PER_FLASH;
+	curr_bucket = victim_bucket_list + plane_nb * FLASH_NB + v_b_entry->phy_flash_nb;
+#endif
+
+	if(v_b_entry->bucket_prev == NULL){
+		curr_bucket->head[valid_page_nb] = v_b_entry->bucket_next;
+	}
+	else{
+		v_b_entry->bucket_prev->bucket_next = v_b_entry->bucket_next;
+	}
+
+	if(v_b_entry->bucket_next == NULL){
+		curr_bucket->tail[valid_page_nb] = v_b_entry->bucket_prev;
+	}
+	else{
+		v_b_entry->bucket_next->bucket_prev = v_b_entry->bucket_prev;
+	}
+
+	v_b_entry->bucket_prev = NULL;
+	v_b_entry->bucket_next = NULL;
+
+	victim_entry_table[v_b_entry->phy_flash_nb * BLOCK_NB + v_b_entry->phy_block_nb] = NULL;
+}
+
+victim_block_entry* GET_MIN_VALID_VICTIM_BLOCK(int mapping_index)
+{
+	victim_bucket_root* curr_bucket;
+
+#ifdef GC_TRIGGER_OVERALL
+	curr_bucket = victim_bucket_list;
+#else
+	curr_bucket = victim_bucket_list + mapping_index;
+#endif
+
+	/* Skip the buckets emptied since the last selection */
+	while(curr_bucket->min_valid_page_nb <= PAGE_NB \
+			&& curr_bucket->head[curr_bucket->min_valid_page_nb] == NULL){
+		curr_bucket->min_valid_page_nb++;
+	}
+
+	if(curr_bucket->min_valid_page_nb > PAGE_NB){
+		return NULL;
+	}
+
+	return curr_bucket->head[curr_bucket->min_valid_page_nb];
+}
+
+/* Return NULL if the block is not in the victim block list */
+victim_block_entry* GET_VICTIM_BLOCK_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	if(victim_entry_table == NULL){
+		return NULL;
+	}
+
+	return victim_entry_table[(int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb];
+}
+
 block_state_entry* GET_BLOCK_STATE_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_nb){
 
-	int64_t mapping_index = phy_flash_nb * BLOCK_NB + phy_block_nb;
+	int64_t mapping_index = (int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb;
 
-	block_state_entry* mapping_entry = (block_state_entry*)block_state_table + mapping_index;
+	block_state_entry* mapping_entry = (block_state_entry*)((char*)block_state_table + mapping_index * block_state_entry_size);
 
 	return mapping_entry;
 }
 
+char GET_PAGE_STATE(unsigned int phy_flash_nb, unsigned int phy_block_nb, unsigned int phy_page_nb)
+{
+	block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+
+	return GET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, phy_page_nb);
+}
+
 int32_t GET_INVERSE_MAPPING_INFO(int32_t ppn)
 {
-	int32_t lpn = inverse_mapping_table[ppn];
+#ifdef FTL_EXTENT_MAP
+	int32_t lpn = EXTENT_GET(&inverse_extent_table, ppn);
+#else
+	int32_t lpn = inverse_mapping_table[ppn] - 1;
+#endif
 
 	return lpn;
 }
 
-// NEED MODIFY
+/* The inverse mapping models the OOB area of the page, it is not cached */
 int UPDATE_INVERSE_MAPPING(int32_t ppn,  int32_t lpn)
 {
-#ifdef FTL_MAP_CACHE
-	CACHE_UPDATE_LPN(lpn, ppn);
+#ifdef FTL_EXTENT_MAP
+	EXTENT_SET(&inverse_extent_table, ppn, lpn);
 #else
-	inverse_mapping_table[ppn] = lpn;
+	inverse_mapping_table[ppn] = lpn + 1;
 #endif
+	JOURNAL_APPEND(JOURNAL_INVERSE, ppn, 0, lpn);
 
 	return SUCCESS;
 }
 
 int UPDATE_BLOCK_STATE(unsigned int phy_flash_nb, unsigned int phy_block_nb, int type)
 {
-        int i;
         block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+	victim_block_entry* v_b_entry = NULL;
 
-	b_s_entry->type = type;
+	/* Every page write sets the type, only the changes are journaled */
+	if(b_s_entry->type != type || type == EMPTY_BLOCK){
+		b_s_entry->type = type;
+		JOURNAL_APPEND(JOURNAL_BLOCK_TYPE, phy_flash_nb * BLOCK_NB + phy_block_nb, 0, type);
+	}
 	
         if(type == EMPTY_BLOCK){
-                for(i=0;i<PAGE_NB;i++){
-                        UPDATE_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb, i, 0);
-                }
+		/* Move the victim block to the bucket of zero valid page */
+		if(victim_entry_table != NULL){
+			v_b_entry = victim_entry_table[(int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb];
+		}
+		if(v_b_entry != NULL && b_s_entry->valid_page_nb != 0){
+			REMOVE_VICTIM_BUCKET(v_b_entry, b_s_entry->valid_page_nb);
+			INSERT_VICTIM_BUCKET(v_b_entry, 0);
+		}
+
+		CLEAR_PAGE_BITMAP(b_s_entry->page_bitmap);
+		b_s_entry->valid_page_nb = 0;
         }
 
         return SUCCESS;
@@ -717,32 +1113,48 @@ int UPDATE_BLOCK_STATE_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_n
 		return FAIL;
 	}
 
-	int i;
-	int valid_count = 0;
 	block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+	victim_block_entry* v_b_entry = NULL;
 
-	char* valid_array = b_s_entry->valid_array;
+	uint64_t* page_bitmap = b_s_entry->page_bitmap;
+	int old_valid = TEST_BIT(VALID_BITMAP(page_bitmap), phy_page_nb);
+	int valid_count = b_s_entry->valid_page_nb;
 
 	if(valid == VALID){
-		valid_array[phy_page_nb] = 'V';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, 'V');
 	}
 	else if(valid == INVALID){
-		valid_array[phy_page_nb] = 'I';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, 'I');
 	}
 	else if(valid == 0){
-		valid_array[phy_page_nb] = '0';
+		SET_BITMAP_PAGE_STATE(page_bitmap, phy_page_nb, '0');
 	}
 	else{
 		printf("ERROR[%s] Wrong valid value\n", __FUNCTION__);
+		return FAIL;
 	}
+	JOURNAL_APPEND(JOURNAL_PAGE_STATE, phy_flash_nb * BLOCK_NB + phy_block_nb, phy_page_nb, valid);
 
 	/* Update valid_page_nb */
-	for(i=0;i<PAGE_NB;i++){
-		if(valid_array[i] == 'V'){
-			valid_count++;
+	if(old_valid == 1 && valid != VALID){
+		valid_count--;
+	}
+	else if(old_valid == 0 && valid == VALID){
+		valid_count++;
+	}
+
+	if(valid_count != b_s_entry->valid_page_nb){
+
+		/* Move the victim block to the bucket of new valid page number */
+		if(victim_entry_table != NULL){
+			v_b_entry = victim_entry_table[phy_flash_nb * BLOCK_NB + phy_block_nb];
+		}
+		if(v_b_entry != NULL){
+			REMOVE_VICTIM_BUCKET(v_b_entry, b_s_entry->valid_page_nb);
+			INSERT_VICTIM_BUCKET(v_b_entry, valid_count);
 		}
+		b_s_entry->valid_page_nb = valid_count;
 	}
-	b_s_entry->valid_page_nb = valid_count;
 
 	return SUCCESS;
 }
@@ -755,7 +1167,7 @@ void PRINT_VALID_ARRAY(unsigned int phy_flash_nb, unsigned int phy_block_nb)
 
 	printf("Type %d [%d][%d]valid array:\n", b_s_entry->type,  phy_flash_nb, phy_block_nb);
 	for(i=0;i<PAGE_NB;i++){
-		printf("%c ",b_s_entry->valid_array[i]);
+		printf("%c ",GET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, i));
 		cnt++;
 		if(cnt == 10){
 			printf("\n");
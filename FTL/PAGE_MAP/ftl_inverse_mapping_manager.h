@@ -17,22 +17,27 @@ extern int64_t total_victim_block_nb;
 extern void* empty_block_list;
 extern void* victim_block_list;
 
-extern unsigned int empty_block_list_index;
+extern unsigned int empty_block_table_index;
 
 typedef struct block_state_entry
 {
 	int valid_page_nb;
 	int type;
 	unsigned int erase_count;
-	char* valid_array;
 
+	/* Valid & written page bitmap (PAGE_BITMAP_SIZE byte) */
+	uint64_t page_bitmap[];
 }block_state_entry;
 
+extern int block_state_entry_size;
+extern int block_state_table_loaded;
+
 typedef struct empty_block_root
 {
 	struct empty_block_entry* head;
 	struct empty_block_entry* tail;
 	unsigned int empty_block_nb;
+	unsigned int fresh_block_nb;	// Never used blocks after the head, they have no entry yet
 }empty_block_root;
 
 typedef struct empty_block_entry
@@ -44,6 +49,14 @@ typedef struct empty_block_entry
 
 }empty_block_entry;
 
+/* Saved entry of the empty & victim block lists */
+typedef struct block_list_record
+{
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+	unsigned int curr_phy_page_nb;
+}block_list_record;
+
 typedef struct victim_block_root
 {
 	struct victim_block_entry* head;
@@ -57,8 +70,23 @@ typedef struct victim_block_entry
 	unsigned int phy_block_nb;
 	struct victim_block_entry* prev;
 	struct victim_block_entry* next;
+
+	/* Victim bucket of the same valid page number */
+	struct victim_block_entry* bucket_prev;
+	struct victim_block_entry* bucket_next;
 }victim_block_entry;
 
+/* Victim blocks bucketed by valid_page_nb (0 ~ PAGE_NB) */
+typedef struct victim_bucket_root
+{
+	struct victim_block_entry** head;
+	struct victim_block_entry** tail;
+	int min_valid_page_nb;
+}victim_bucket_root;
+
+extern obj_pool empty_block_pool;
+extern obj_pool victim_block_pool;
+
 extern victim_block_entry* victim_block_list_head;
 extern victim_block_entry* victim_block_list_tail;
 
@@ -66,21 +94,36 @@ void INIT_INVERSE_MAPPING_TABLE(void);
 void INIT_BLOCK_STATE_TABLE(void);
 void INIT_EMPTY_BLOCK_LIST(void);
 void INIT_VICTIM_BLOCK_LIST(void);
-void INIT_VALID_ARRAY(void);
+
+int LOAD_EMPTY_BLOCK_LIST(void);
+int LOAD_VICTIM_BLOCK_LIST(void);
+void REBUILD_EMPTY_BLOCK_LIST(void);
+void REBUILD_VICTIM_BLOCK_LIST(void);
 
 void TERM_INVERSE_MAPPING_TABLE(void);
 void TERM_BLOCK_STATE_TABLE(void);
 void TERM_EMPTY_BLOCK_LIST(void);
 void TERM_VICTIM_BLOCK_LIST(void);
-void TERM_VALID_ARRAY(void);
 
 empty_block_entry* GET_EMPTY_BLOCK(int mode, int mapping_index);
 int INSERT_EMPTY_BLOCK(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+empty_block_entry* EJECT_EMPTY_BLOCK(void);
+empty_block_entry* EJECT_PLANE_EMPTY_BLOCK(int mapping_index);
+void REMOVE_EMPTY_BLOCK_HEAD(empty_block_root* curr_root_entry);
+empty_block_entry* ALLOC_FRESH_EMPTY_BLOCK(empty_block_root* curr_root_entry);
 
 int INSERT_VICTIM_BLOCK(empty_block_entry* full_block);
 int EJECT_VICTIM_BLOCK(victim_block_entry* victim_block);
 
+void INIT_VICTIM_BUCKET(void);
+void TERM_VICTIM_BUCKET(void);
+void INSERT_VICTIM_BUCKET(victim_block_entry* v_b_entry, int valid_page_nb);
+void REMOVE_VICTIM_BUCKET(victim_block_entry* v_b_entry, int valid_page_nb);
+victim_block_entry* GET_MIN_VALID_VICTIM_BLOCK(int mapping_index);
+victim_block_entry* GET_VICTIM_BLOCK_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+
 block_state_entry* GET_BLOCK_STATE_ENTRY(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+char GET_PAGE_STATE(unsigned int phy_flash_nb, unsigned int phy_block_nb, unsigned int phy_page_nb);
 
 int32_t GET_INVERSE_MAPPING_INFO(int32_t lpn);
 int UPDATE_INVERSE_MAPPING(int32_t ppn, int32_t lpn);
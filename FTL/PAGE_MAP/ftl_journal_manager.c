@@ -0,0 +1,452 @@
+// File: ftl_journal_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define META_CHECKPOINT_MAGIC	"VSSIMCKP"
+#define META_JOURNAL_MAGIC	"VSSIMJNL"
+
+#define META_CHECKPOINT_PATH	"./data/meta_checkpoint.dat"
+#define META_JOURNAL_PATH	"./data/meta_journal.dat"
+
+/* The mapping, inverse mapping & block state tables are mapped from their files.
+	A checkpoint writes the dirty pages of the tables, the journal has the
+	updates since the last checkpoint. A crash loses the uncommitted requests */
+int meta_state;
+
+/* The last checkpoint, the tables on the disk are of this */
+meta_header meta_checkpoint;
+
+/* Journal */
+int journal_fd = -1;
+off_t journal_offset;
+journal_record* journal_buffer;
+int journal_buffer_nb;
+int journal_active;
+int journal_pending;		// Records after the last commit
+int64_t journal_record_nb;	// Records since the last checkpoint
+
+/* Statistics */
+int64_t checkpoint_nb;
+int64_t replay_record_nb;
+
+void INIT_META_JOURNAL(void)
+{
+	int fd;
+	struct stat st;
+	meta_header journal_header;
+
+	journal_buffer = (journal_record*)malloc(JOURNAL_BUFFER_NB * sizeof(journal_record));
+	if(journal_buffer == NULL){
+		printf("ERROR[%s] Malloc journal buffer fail\n", __FUNCTION__);
+		return;
+	}
+	journal_buffer_nb = 0;
+	journal_active = 0;
+	journal_pending = 0;
+	journal_record_nb = 0;
+	checkpoint_nb = 0;
+	replay_record_nb = 0;
+
+	/* Without a checkpoint of this SSD, the saved tables are not loaded */
+	meta_state = META_FRESH;
+	memset(&meta_checkpoint, 0, sizeof(meta_header));
+
+	fd = open(META_CHECKPOINT_PATH, O_RDONLY);
+	if(fd != -1){
+		if(read(fd, &meta_checkpoint, sizeof(meta_header)) == sizeof(meta_header) \
+				&& CHECK_META_HEADER(&meta_checkpoint, META_CHECKPOINT_MAGIC) == SUCCESS){
+			meta_state = META_CLEAN;
+		}
+		else{
+			printf("[%s] The checkpoint is not of this SSD, start from an empty SSD\n", __FUNCTION__);
+			memset(&meta_checkpoint, 0, sizeof(meta_header));
+		}
+		close(fd);
+	}
+
+	journal_fd = open(META_JOURNAL_PATH, O_RDWR | O_CREAT, 0644);
+	if(journal_fd == -1){
+		printf("ERROR[%s] %s open fail\n", __FUNCTION__, META_JOURNAL_PATH);
+		return;
+	}
+
+	/* The journal of an older checkpoint is stale */
+	journal_offset = sizeof(meta_header);
+	if(meta_state != META_FRESH \
+			&& pread(journal_fd, &journal_header, sizeof(meta_header), 0) == sizeof(meta_header) \
+			&& CHECK_META_HEADER(&journal_header, META_JOURNAL_MAGIC) == SUCCESS \
+			&& journal_header.checkpoint_seq == meta_checkpoint.checkpoint_seq \
+			&& fstat(journal_fd, &st) == 0 && st.st_size > (off_t)sizeof(meta_header)){
+		journal_offset = st.st_size;
+	}
+
+	/* Updated after the last checkpoint */
+	if(meta_state == META_CLEAN \
+			&& (meta_checkpoint.clean == 0 || journal_offset != sizeof(meta_header))){
+		meta_state = META_CRASH;
+	}
+}
+
+/* Called after the tables are loaded, before the block lists */
+void RECOVER_META_JOURNAL(void)
+{
+	if(journal_fd == -1){
+		return;
+	}
+
+	if(meta_state == META_CRASH){
+		REPLAY_META_JOURNAL();
+	}
+
+	journal_active = 1;
+
+	/* The replayed tables and a new SSD start a checkpoint of their own,
+		the block lists of the last clean checkpoint stay valid */
+	if(meta_state == META_CLEAN){
+		RESET_META_JOURNAL();
+	}
+	else{
+		CHECKPOINT_META(0);
+	}
+}
+
+void TERM_META_JOURNAL(void)
+{
+	if(journal_fd == -1){
+		return;
+	}
+
+	/* The block lists are saved, no journal is needed at the next start */
+	journal_pending = 0;
+	CHECKPOINT_META(1);
+
+	printf("Metadata Checkpoint	%lld checkpoints, %lld records replayed\n", \
+			(long long)checkpoint_nb, (long long)replay_record_nb);
+
+	journal_active = 0;
+	close(journal_fd);
+	journal_fd = -1;
+
+	free(journal_buffer);
+	journal_buffer = NULL;
+}
+
+void MAKE_META_HEADER(meta_header* header, const char* magic, uint64_t checkpoint_seq, int clean)
+{
+	memset(header, 0, sizeof(meta_header));
+	memcpy(header->magic, magic, sizeof(header->magic));
+
+	header->version = META_VERSION;
+	header->clean = clean;
+	header->checkpoint_seq = checkpoint_seq;
+	header->flash_nb = FLASH_NB;
+	header->block_nb = BLOCK_NB;
+	header->page_nb = PAGE_NB;
+	header->planes_per_flash = PLANES_PER_FLASH;
+	header->map_format = META_MAP_FORMAT;
+}
+
+int CHECK_META_HEADER(meta_header* header, const char* magic)
+{
+	if(memcmp(header->magic, magic, sizeof(header->magic)) != 0 \
+			|| header->version != META_VERSION \
+			|| header->flash_nb != FLASH_NB \
+			|| header->block_nb != BLOCK_NB \
+			|| header->page_nb != PAGE_NB \
+			|| header->planes_per_flash != PLANES_PER_FLASH \
+			|| header->map_format != META_MAP_FORMAT){
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+/* The new checkpoint replaces the old one at once */
+int WRITE_META_HEADER(meta_header* header)
+{
+	int fd;
+	int ret = SUCCESS;
+
+	fd = open(META_CHECKPOINT_PATH ".tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd == -1){
+		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	if(write(fd, header, sizeof(meta_header)) != sizeof(meta_header) || fdatasync(fd) != 0){
+		ret = FAIL;
+	}
+	close(fd);
+
+	if(ret == FAIL || rename(META_CHECKPOINT_PATH ".tmp", META_CHECKPOINT_PATH) != 0){
+		printf("ERROR[%s] Write %s fail\n", __FUNCTION__, META_CHECKPOINT_PATH);
+		return FAIL;
+	}
+
+	return SUCCESS;
+}
+
+/* Start the journal of the last checkpoint */
+void RESET_META_JOURNAL(void)
+{
+	meta_header journal_header;
+
+	MAKE_META_HEADER(&journal_header, META_JOURNAL_MAGIC, meta_checkpoint.checkpoint_seq, 0);
+
+	if(ftruncate(journal_fd, 0) != 0 \
+			|| pwrite(journal_fd, &journal_header, sizeof(meta_header), 0) != sizeof(meta_header)){
+		printf("ERROR[%s] Write %s fail\n", __FUNCTION__, META_JOURNAL_PATH);
+	}
+
+	journal_offset = sizeof(meta_header);
+	journal_buffer_nb = 0;
+	journal_record_nb = 0;
+}
+
+/* The page of the table entry is written by the next checkpoint */
+void MARK_META_DIRTY(int type, uint32_t index)
+{
+	switch(type){
+		/* EXTENT_SET marks the pages it changes */
+#ifndef FTL_EXTENT_MAP
+#ifndef FTL_MAP_CACHE
+		case JOURNAL_MAPPING:
+			ARENA_MARK_DIRTY(&ftl_meta_arena, mapping_table + index, sizeof(int32_t));
+			break;
+#endif
+		case JOURNAL_INVERSE:
+			ARENA_MARK_DIRTY(&ftl_meta_arena, inverse_mapping_table + index, sizeof(int32_t));
+			break;
+#endif
+		case JOURNAL_PAGE_STATE:
+		case JOURNAL_BLOCK_TYPE:
+		case JOURNAL_ERASE_COUNT:
+			ARENA_MARK_DIRTY(&ftl_meta_arena, (char*)block_state_table \
+					+ (int64_t)index * block_state_entry_size, block_state_entry_size);
+			break;
+		default:
+			break;
+	}
+}
+
+/* The table entry is updated already */
+void JOURNAL_APPEND(int type, uint32_t index, int page, int32_t value)
+{
+	journal_record* curr_record;
+
+	if(journal_active == 0){
+		return;
+	}
+
+	MARK_META_DIRTY(type, index);
+
+	/* The preconditioning is saved by the checkpoint at its end */
+	if(ssd_timing_off == 1){
+		return;
+	}
+
+	curr_record = journal_buffer + journal_buffer_nb;
+	curr_record->type = (uint16_t)type;
+	curr_record->page = (uint16_t)page;
+	curr_record->index = index;
+	curr_record->value = value;
+
+	journal_buffer_nb++;
+	journal_record_nb++;
+	journal_pending = 1;
+
+	if(journal_buffer_nb == JOURNAL_BUFFER_NB){
+		FLUSH_META_JOURNAL();
+	}
+}
+
+/* The updates of a request are replayed all or nothing */
+void COMMIT_META_JOURNAL(void)
+{
+	if(journal_pending == 0){
+		return;
+	}
+
+	JOURNAL_APPEND(JOURNAL_COMMIT, 0, 0, 0);
+	journal_pending = 0;
+
+	if(journal_record_nb >= CHECKPOINT_INTERVAL){
+		CHECKPOINT_META(0);
+	}
+}
+
+/* The records go to the page cache, they survive the crash of the process */
+int FLUSH_META_JOURNAL(void)
+{
+	ssize_t len = journal_buffer_nb * sizeof(journal_record);
+
+	if(journal_buffer_nb == 0){
+		return SUCCESS;
+	}
+
+	if(pwrite(journal_fd, journal_buffer, len, journal_offset) != len){
+		printf("ERROR[%s] Write %s fail\n", __FUNCTION__, META_JOURNAL_PATH);
+		return FAIL;
+	}
+
+	journal_offset += len;
+	journal_buffer_nb = 0;
+
+	return SUCCESS;
+}
+
+int CHECKPOINT_META(int clean)
+{
+	meta_header new_checkpoint;
+
+	/* The journal keeps the records until the new checkpoint is complete,
+		they are replayed on the partly written tables again */
+	if(FLUSH_META_JOURNAL() == FAIL || ARENA_CHECKPOINT(&ftl_meta_arena) == FAIL){
+		printf("ERROR[%s] Checkpoint fail\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	MAKE_META_HEADER(&new_checkpoint, META_CHECKPOINT_MAGIC, meta_checkpoint.checkpoint_seq + 1, clean);
+	if(WRITE_META_HEADER(&new_checkpoint) == FAIL){
+		return FAIL;
+	}
+	meta_checkpoint = new_checkpoint;
+
+	/* The records of the old checkpoint are not replayed any more */
+	RESET_META_JOURNAL();
+	checkpoint_nb++;
+
+	return SUCCESS;
+}
+
+/* Replay the records up to the last commit */
+void REPLAY_META_JOURNAL(void)
+{
+	int i;
+	int record_nb;
+	ssize_t len;
+	off_t offset;
+	off_t commit_offset = sizeof(meta_header);
+	size_t buffer_size = JOURNAL_BUFFER_NB * sizeof(journal_record);
+
+	for(offset = sizeof(meta_header); offset < journal_offset; offset += len){
+		len = pread(journal_fd, journal_buffer, buffer_size, offset);
+		if(len <= 0){
+			break;
+		}
+
+		/* A torn record at the end is dropped */
+		record_nb = len / sizeof(journal_record);
+		for(i=0;i<record_nb;i++){
+			if(journal_buffer[i].type == JOURNAL_COMMIT){
+				commit_offset = offset + (off_t)(i + 1) * sizeof(journal_record);
+			}
+		}
+
+		len = record_nb * sizeof(journal_record);
+		if(len == 0){
+			break;
+		}
+	}
+
+	for(offset = sizeof(meta_header); offset < commit_offset; offset += len){
+		len = commit_offset - offset < (off_t)buffer_size ? commit_offset - offset : (off_t)buffer_size;
+		len = pread(journal_fd, journal_buffer, len, offset);
+		if(len <= 0){
+			break;
+		}
+
+		record_nb = len / sizeof(journal_record);
+		for(i=0;i<record_nb;i++){
+			REPLAY_JOURNAL_RECORD(journal_buffer + i);
+		}
+		replay_record_nb += record_nb;
+
+		len = record_nb * sizeof(journal_record);
+		if(len == 0){
+			break;
+		}
+	}
+
+	printf("[%s] %lld records are replayed\n", __FUNCTION__, (long long)replay_record_nb);
+}
+
+void REPLAY_JOURNAL_RECORD(journal_record* record)
+{
+	block_state_entry* b_s_entry = NULL;
+
+	switch(record->type){
+		case JOURNAL_MAPPING:
+		case JOURNAL_INVERSE:
+			if(record->index >= PAGE_MAPPING_ENTRY_NB){
+				printf("ERROR[%s] Wrong page %u\n", __FUNCTION__, record->index);
+				return;
+			}
+			break;
+		case JOURNAL_PAGE_STATE:
+		case JOURNAL_BLOCK_TYPE:
+		case JOURNAL_ERASE_COUNT:
+			if(record->index >= BLOCK_MAPPING_ENTRY_NB || record->page >= PAGE_NB){
+				printf("ERROR[%s] Wrong block %u\n", __FUNCTION__, record->index);
+				return;
+			}
+			b_s_entry = (block_state_entry*)((char*)block_state_table \
+					+ (int64_t)record->index * block_state_entry_size);
+			break;
+		case JOURNAL_COMMIT:
+			return;
+		default:
+			printf("ERROR[%s] Wrong record type %u\n", __FUNCTION__, record->type);
+			return;
+	}
+
+	switch(record->type){
+		case JOURNAL_MAPPING:
+#ifdef FTL_MAP_CACHE
+#elif defined FTL_EXTENT_MAP
+			EXTENT_SET(&mapping_extent_table, record->index, record->value);
+#else
+			mapping_table[record->index] = record->value + 1;
+#endif
+			break;
+		case JOURNAL_INVERSE:
+#ifdef FTL_EXTENT_MAP
+			EXTENT_SET(&inverse_extent_table, record->index, record->value);
+#else
+			inverse_mapping_table[record->index] = record->value + 1;
+#endif
+			break;
+		case JOURNAL_PAGE_STATE:
+			if(record->value == VALID){
+				SET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, record->page, 'V');
+			}
+			else if(record->value == INVALID){
+				SET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, record->page, 'I');
+			}
+			else{
+				SET_BITMAP_PAGE_STATE(b_s_entry->page_bitmap, record->page, '0');
+			}
+			b_s_entry->valid_page_nb = COUNT_BITMAP(VALID_BITMAP(b_s_entry->page_bitmap), PAGE_BITMAP_WORD_NB);
+			break;
+		case JOURNAL_BLOCK_TYPE:
+			b_s_entry->type = record->value;
+			if(record->value == EMPTY_BLOCK){
+				CLEAR_PAGE_BITMAP(b_s_entry->page_bitmap);
+				b_s_entry->valid_page_nb = 0;
+			}
+			break;
+		case JOURNAL_ERASE_COUNT:
+			b_s_entry->erase_count = (unsigned int)record->value;
+			break;
+	}
+
+	MARK_META_DIRTY(record->type, record->index);
+}
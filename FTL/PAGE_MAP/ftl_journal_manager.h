@@ -0,0 +1,80 @@
+// File: ftl_journal_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _JOURNAL_MANAGER_H_
+#define _JOURNAL_MANAGER_H_
+
+#define META_VERSION		2
+#define JOURNAL_BUFFER_NB	4096	// Records written to the journal at once
+
+/* Start state of the metadata */
+#define META_FRESH		0	// No checkpoint, an empty SSD
+#define META_CLEAN		1	// Saved by FTL_TERM, the block lists are loaded
+#define META_CRASH		2	// The journal is replayed, the block lists are rebuilt
+
+/* Layout of the saved mapping tables */
+#define META_MAP_FLAT		0
+#define META_MAP_EXTENT		1	// FTL_EXTENT_MAP
+
+#ifdef FTL_EXTENT_MAP
+#define META_MAP_FORMAT		META_MAP_EXTENT
+#else
+#define META_MAP_FORMAT		META_MAP_FLAT
+#endif
+
+/* Journal record types, a record has the new value of the entry */
+#define JOURNAL_MAPPING		1	// index : lpn, value : ppn
+#define JOURNAL_INVERSE		2	// index : ppn, value : lpn
+#define JOURNAL_PAGE_STATE	3	// index : block, page, value : VALID, INVALID or 0
+#define JOURNAL_BLOCK_TYPE	4	// index : block, value : type, EMPTY_BLOCK clears the pages
+#define JOURNAL_ERASE_COUNT	5	// index : block, value : erase count
+#define JOURNAL_COMMIT		6	// The records up to here are replayed
+
+/* Header of the checkpoint & the journal file */
+typedef struct meta_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t clean;		// The block lists are saved
+	uint64_t checkpoint_seq;
+	int32_t flash_nb;
+	int32_t block_nb;
+	int32_t page_nb;
+	int32_t planes_per_flash;
+	int32_t map_format;	// META_MAP_FLAT or META_MAP_EXTENT, the files of the mapping tables
+	int32_t reserved;
+}meta_header;
+
+typedef struct journal_record
+{
+	uint16_t type;
+	uint16_t page;
+	uint32_t index;
+	int32_t value;
+}journal_record;
+
+extern int meta_state;
+
+void INIT_META_JOURNAL(void);
+void RECOVER_META_JOURNAL(void);
+void TERM_META_JOURNAL(void);
+
+void MAKE_META_HEADER(meta_header* header, const char* magic, uint64_t checkpoint_seq, int clean);
+int CHECK_META_HEADER(meta_header* header, const char* magic);
+int WRITE_META_HEADER(meta_header* header);
+void RESET_META_JOURNAL(void);
+
+void MARK_META_DIRTY(int type, uint32_t index);
+void JOURNAL_APPEND(int type, uint32_t index, int page, int32_t value);
+void COMMIT_META_JOURNAL(void);
+int FLUSH_META_JOURNAL(void);
+int CHECKPOINT_META(int clean);
+
+void REPLAY_META_JOURNAL(void);
+void REPLAY_JOURNAL_RECORD(journal_record* record);
+
+#endif
@@ -10,48 +10,99 @@
 int32_t* mapping_table;
 void* block_table_start;
 
+/* The page & block tables, a table entry of zero is the initial state */
+meta_arena ftl_meta_arena;
+
+#ifdef FTL_MULTI_PLANE
+/* Open blocks of the planes of each flash, [flash_nb * PLANES_PER_FLASH + plane_nb].
+	They are written in lockstep, a stripe has the same page offset on every plane */
+empty_block_entry** stripe_block_table;
+int stripe_open_nb;
+int64_t stripe_write_nb;
+
+/* [flash_nb], 1 : no stripe write since the last GC. An idle stripe is closed,
+	or its open blocks would keep their stale pages from GC for good */
+int* stripe_idle_table;
+int64_t stripe_close_nb;
+
+/* [flash_nb * BLOCK_NB + block_nb], the block of the next plane in the stripe of the block,
+	-1 if the block is not written as a stripe. GC erases the blocks of a stripe at once */
+int32_t* stripe_peer_table;
+int32_t* stripe_erase_block_list;
+int64_t stripe_erase_nb;
+
+/* Multi-plane IO of a stripe, indexed by the plane */
+int32_t* stripe_ppn_list;
+int32_t* stripe_block_list;
+nand_io_info** stripe_io_info_list;
+#endif
+
+void INIT_META_ARENA(void)
+{
+	size_t arena_size = 0;
+
+	/* Each table is rounded up to ARENA_ALIGN */
+#ifdef FTL_EXTENT_MAP
+#ifndef FTL_MAP_CACHE
+	arena_size += EXTENT_TABLE_SIZE(PAGE_MAPPING_ENTRY_NB, EMPTY_TABLE_ENTRY_NB);
+#endif
+	arena_size += EXTENT_TABLE_SIZE(PAGE_MAPPING_ENTRY_NB, (EXTENT_SEGMENT_ENTRY_NB + PAGE_NB - 1) / PAGE_NB);
+#else
+#ifndef FTL_MAP_CACHE
+	arena_size += PAGE_MAPPING_ENTRY_NB * sizeof(int32_t) + ARENA_ALIGN;
+#endif
+	arena_size += PAGE_MAPPING_ENTRY_NB * sizeof(int32_t) + ARENA_ALIGN;
+#endif
+	arena_size += BLOCK_MAPPING_ENTRY_NB * (sizeof(block_state_entry) + PAGE_BITMAP_SIZE) + ARENA_ALIGN;
+	arena_size += BLOCK_MAPPING_ENTRY_NB * sizeof(victim_block_entry*) + ARENA_ALIGN;
+
+	INIT_ARENA(&ftl_meta_arena, arena_size);
+}
+
+void TERM_META_ARENA(void)
+{
+	TERM_ARENA(&ftl_meta_arena);
+}
+
 void INIT_MAPPING_TABLE(void)
 {
-	/* Allocation Memory for Mapping Table */
-	mapping_table = (int32_t*)calloc(PAGE_MAPPING_ENTRY_NB, sizeof(int32_t));
+#ifdef FTL_EXTENT_MAP
+	/* The sequential writes go round the planes of all flashes, a column for each */
+	INIT_EXTENT_TABLE(&mapping_extent_table, "mapping", PAGE_MAPPING_ENTRY_NB, 1, EMPTY_TABLE_ENTRY_NB, \
+			"./data/mapping_segment.dat", "./data/mapping_array.dat", meta_state != META_FRESH);
+#else
+	int loaded;
+
+	/* The entries keep ppn + 1, the zero page of the arena is unmapped.
+		A saved table is paged in by the accesses */
+	mapping_table = (int32_t*)ARENA_LOAD(&ftl_meta_arena, PAGE_MAPPING_ENTRY_NB * sizeof(int32_t), \
+				"./data/mapping_table.dat", meta_state != META_FRESH, &loaded);
 	if(mapping_table == NULL){
-		printf("ERROR[%s] Calloc mapping table fail\n", __FUNCTION__);
+		printf("ERROR[%s] Alloc mapping table fail\n", __FUNCTION__);
 		return;
 	}
-
-	/* Initialization Mapping Table */
-	
-	/* If mapping_table.dat file exists */
-	FILE* fp = fopen("./data/mapping_table.dat","r");
-	if(fp != NULL){
-		fread(mapping_table, sizeof(int32_t), PAGE_MAPPING_ENTRY_NB, fp);
-	}
-	else{	
-		int i;	
-		for(i=0;i<PAGE_MAPPING_ENTRY_NB;i++){
-			mapping_table[i] = -1;
-		}
-	}
+#endif
 }
 
 void TERM_MAPPING_TABLE(void)
 {
-	FILE* fp = fopen("./data/mapping_table.dat","w");
-	if(fp==NULL){
-		printf("ERROR[%s] File open fail\n", __FUNCTION__);
-		return;
-	}
-
-	/* Write the mapping table to file */
-	fwrite(mapping_table, sizeof(int32_t),PAGE_MAPPING_ENTRY_NB,fp);
-
-	/* Free memory for mapping table */
-	free(mapping_table);
+#ifdef FTL_EXTENT_MAP
+	TERM_EXTENT_TABLE(&mapping_extent_table);
+#else
+	/* The table is written by the last checkpoint, the memory is released with the arena */
+	mapping_table = NULL;
+#endif
 }
 
 int32_t GET_MAPPING_INFO(int32_t lpn)
 {
-	int32_t ppn = mapping_table[lpn];
+#ifdef FTL_MAP_CACHE
+	int32_t ppn = CACHE_GET_PPN(lpn);
+#elif defined FTL_EXTENT_MAP
+	int32_t ppn = EXTENT_GET(&mapping_extent_table, lpn);
+#else
+	int32_t ppn = mapping_table[lpn] - 1;
+#endif
 
 	return ppn;
 }
@@ -74,6 +125,12 @@ int GET_NEW_PAGE(int mode, int mapping_index, int32_t* ppn)
 		return FAIL;
 	}
 
+#ifdef FTL_MULTI_STREAM
+	if(curr_empty_block->curr_phy_page_nb == 0){
+		SET_BLOCK_STREAM(curr_empty_block->phy_flash_nb, curr_empty_block->phy_block_nb, STREAM_GC);
+	}
+#endif
+
 	*ppn = curr_empty_block->phy_flash_nb*BLOCK_NB*PAGE_NB \
 	       + curr_empty_block->phy_block_nb*PAGE_NB \
 	       + curr_empty_block->curr_phy_page_nb;
@@ -83,6 +140,208 @@ int GET_NEW_PAGE(int mode, int mapping_index, int32_t* ppn)
 	return SUCCESS;
 }
 
+#ifdef FTL_MULTI_PLANE
+void INIT_STRIPE_BLOCK_TABLE(void)
+{
+	stripe_block_table = (empty_block_entry**)calloc(FLASH_NB * PLANES_PER_FLASH, sizeof(empty_block_entry*));
+	stripe_ppn_list = (int32_t*)calloc(PLANES_PER_FLASH, sizeof(int32_t));
+	stripe_block_list = (int32_t*)calloc(PLANES_PER_FLASH, sizeof(int32_t));
+	stripe_io_info_list = (nand_io_info**)calloc(PLANES_PER_FLASH, sizeof(nand_io_info*));
+	stripe_idle_table = (int*)calloc(FLASH_NB, sizeof(int));
+	stripe_peer_table = (int32_t*)malloc(BLOCK_MAPPING_ENTRY_NB * sizeof(int32_t));
+	stripe_erase_block_list = (int32_t*)calloc(PLANES_PER_FLASH, sizeof(int32_t));
+
+	if(stripe_block_table == NULL || stripe_ppn_list == NULL || stripe_block_list == NULL \
+			|| stripe_io_info_list == NULL || stripe_idle_table == NULL \
+			|| stripe_peer_table == NULL || stripe_erase_block_list == NULL){
+		printf("ERROR[%s] Calloc stripe table fail\n", __FUNCTION__);
+		return;
+	}
+	memset(stripe_peer_table, 0xff, BLOCK_MAPPING_ENTRY_NB * sizeof(int32_t));
+
+	stripe_open_nb = 0;
+	stripe_write_nb = 0;
+	stripe_close_nb = 0;
+	stripe_erase_nb = 0;
+}
+
+void TERM_STRIPE_BLOCK_TABLE(void)
+{
+	int i;
+
+	printf("Multi-plane Write	%lld stripes, %lld idle stripes closed\n", \
+			(long long)stripe_write_nb, (long long)stripe_close_nb);
+	printf("Multi-plane Erase	%lld stripes\n", (long long)stripe_erase_nb);
+
+	/* Return the open blocks, the empty & victim block lists are saved */
+	for(i=0;i<FLASH_NB;i++){
+		CLOSE_STRIPE_BLOCK(i);
+	}
+
+	free(stripe_block_table);
+	free(stripe_ppn_list);
+	free(stripe_block_list);
+	free(stripe_io_info_list);
+	free(stripe_idle_table);
+	free(stripe_peer_table);
+	free(stripe_erase_block_list);
+}
+
+/* Get a page of every plane of a flash, at the same page offset.
+	ppn_list[plane_nb], FAIL if no flash has an empty block on all its planes */
+int GET_NEW_STRIPE_PAGE(int32_t* ppn_list)
+{
+	int i, j;
+	unsigned int flash_nb;
+	empty_block_entry** curr_stripe;
+
+	for(i=0;i<FLASH_NB;i++){
+		/* Take the flash in turn with the single page writes of VICTIM_OVERALL */
+		flash_nb = empty_block_table_index % FLASH_NB;
+
+		empty_block_table_index++;
+		if(empty_block_table_index == EMPTY_TABLE_ENTRY_NB){
+			empty_block_table_index = 0;
+		}
+
+		/* The open blocks of the stripes are out of the GC headroom,
+			a new stripe is opened on STRIPE_OPEN_NB flashes at most */
+		if(stripe_block_table[flash_nb * PLANES_PER_FLASH] == NULL && stripe_open_nb >= STRIPE_OPEN_NB){
+			continue;
+		}
+		if(OPEN_STRIPE_BLOCK(flash_nb) == FAIL){
+			continue;
+		}
+
+		curr_stripe = stripe_block_table + flash_nb * PLANES_PER_FLASH;
+		for(j=0;j<PLANES_PER_FLASH;j++){
+			ppn_list[j] = curr_stripe[j]->phy_flash_nb*BLOCK_NB*PAGE_NB \
+				+ curr_stripe[j]->phy_block_nb*PAGE_NB \
+				+ curr_stripe[j]->curr_phy_page_nb;
+
+			curr_stripe[j]->curr_phy_page_nb += 1;
+		}
+
+		/* The blocks of the stripe are full together */
+		if(curr_stripe[0]->curr_phy_page_nb == PAGE_NB){
+			for(j=0;j<PLANES_PER_FLASH;j++){
+				INSERT_VICTIM_BLOCK(curr_stripe[j]);
+				curr_stripe[j] = NULL;
+			}
+			stripe_open_nb--;
+		}
+
+		stripe_idle_table[flash_nb] = 0;
+		stripe_write_nb++;
+		return SUCCESS;
+	}
+
+	return FAIL;
+}
+
+/* Open an empty block on every plane of the flash, or none of them */
+int OPEN_STRIPE_BLOCK(unsigned int flash_nb)
+{
+	int j;
+	empty_block_entry** curr_stripe = stripe_block_table + flash_nb * PLANES_PER_FLASH;
+
+	if(curr_stripe[0] != NULL){
+		return SUCCESS;
+	}
+
+	for(j=0;j<PLANES_PER_FLASH;j++){
+		curr_stripe[j] = EJECT_PLANE_EMPTY_BLOCK(j * FLASH_NB + flash_nb);
+		if(curr_stripe[j] != NULL){
+			continue;
+		}
+
+		/* Give back the blocks of the other planes */
+		while(j > 0){
+			j--;
+			INSERT_EMPTY_BLOCK(curr_stripe[j]->phy_flash_nb, curr_stripe[j]->phy_block_nb);
+			POOL_FREE(&empty_block_pool, curr_stripe[j]);
+			curr_stripe[j] = NULL;
+		}
+		return FAIL;
+	}
+
+	for(j=0;j<PLANES_PER_FLASH;j++){
+		stripe_peer_table[flash_nb * BLOCK_NB + curr_stripe[j]->phy_block_nb] \
+			= curr_stripe[(j + 1) % PLANES_PER_FLASH]->phy_block_nb;
+	}
+	stripe_open_nb++;
+
+	return SUCCESS;
+}
+
+/* Return the open blocks of the flash : an unwritten block to the empty block list,
+	the others to the victim block list, their unwritten pages are reclaimed by GC */
+void CLOSE_STRIPE_BLOCK(unsigned int flash_nb)
+{
+	int j;
+	empty_block_entry** curr_stripe = stripe_block_table + flash_nb * PLANES_PER_FLASH;
+
+	if(curr_stripe[0] != NULL){
+		stripe_open_nb--;
+	}
+
+	for(j=0;j<PLANES_PER_FLASH;j++){
+		if(curr_stripe[j] == NULL){
+			continue;
+		}
+
+		if(curr_stripe[j]->curr_phy_page_nb == 0){
+			CLEAR_STRIPE_PEER(curr_stripe[j]->phy_flash_nb, curr_stripe[j]->phy_block_nb);
+			INSERT_EMPTY_BLOCK(curr_stripe[j]->phy_flash_nb, curr_stripe[j]->phy_block_nb);
+			POOL_FREE(&empty_block_pool, curr_stripe[j]);
+		}
+		else{
+			INSERT_VICTIM_BLOCK(curr_stripe[j]);
+		}
+		curr_stripe[j] = NULL;
+	}
+}
+
+/* Return the block of the next plane in the stripe of the block, -1 if there is not */
+int32_t GET_STRIPE_PEER(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	return stripe_peer_table[phy_flash_nb * BLOCK_NB + phy_block_nb];
+}
+
+/* The block is erased, the other blocks of its stripe are not a stripe any more */
+void CLEAR_STRIPE_PEER(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	int32_t peer_block_nb;
+	int32_t* curr_entry = stripe_peer_table + phy_flash_nb * BLOCK_NB + phy_block_nb;
+
+	while(*curr_entry != -1){
+		peer_block_nb = *curr_entry;
+		*curr_entry = -1;
+		curr_entry = stripe_peer_table + phy_flash_nb * BLOCK_NB + peer_block_nb;
+	}
+}
+
+/* Called after a GC, close the stripes which were not written since the last GC */
+void CLOSE_IDLE_STRIPE_BLOCK(void)
+{
+	unsigned int i;
+
+	for(i=0;i<FLASH_NB;i++){
+		if(stripe_block_table[i * PLANES_PER_FLASH] == NULL){
+			continue;
+		}
+
+		if(stripe_idle_table[i] == 1){
+			CLOSE_STRIPE_BLOCK(i);
+			stripe_close_nb++;
+		}
+		else{
+			stripe_idle_table[i] = 1;
+		}
+	}
+}
+#endif
+
 int UPDATE_OLD_PAGE_MAPPING(int32_t lpn)
 {
 	int32_t old_ppn;
@@ -113,7 +372,12 @@ int UPDATE_NEW_PAGE_MAPPING(int32_t lpn, int32_t ppn)
 #ifdef FTL_MAP_CACHE
 	CACHE_UPDATE_PPN(lpn, ppn);
 #else
-	mapping_table[lpn] = ppn;
+#ifdef FTL_EXTENT_MAP
+	EXTENT_SET(&mapping_extent_table, lpn, ppn);
+#else
+	mapping_table[lpn] = ppn + 1;
+#endif
+	JOURNAL_APPEND(JOURNAL_MAPPING, lpn, 0, ppn);
 #endif
 
 	/* Update Inverse Page Mapping Table */
@@ -124,6 +388,25 @@ int UPDATE_NEW_PAGE_MAPPING(int32_t lpn, int32_t ppn)
 	return SUCCESS;
 }
 
+/* The lpn is trimmed, it is not mapped any more */
+int REMOVE_PAGE_MAPPING(int32_t lpn)
+{
+	UPDATE_OLD_PAGE_MAPPING(lpn);
+
+#ifdef FTL_MAP_CACHE
+	CACHE_UPDATE_PPN(lpn, -1);
+#else
+#ifdef FTL_EXTENT_MAP
+	EXTENT_SET(&mapping_extent_table, lpn, -1);
+#else
+	mapping_table[lpn] = 0;
+#endif
+	JOURNAL_APPEND(JOURNAL_MAPPING, lpn, 0, -1);
+#endif
+
+	return SUCCESS;
+}
+
 unsigned int CALC_FLASH(int32_t ppn)
 {
 	unsigned int flash_nb = (ppn/PAGE_NB)/BLOCK_NB;
@@ -10,19 +10,45 @@
 
 extern int32_t* mapping_table;
 extern void* block_table_start;
+extern meta_arena ftl_meta_arena;
 
 extern unsigned int flash_index;
 extern unsigned int* plane_index;
 extern unsigned int* block_index;
 
+#ifdef FTL_MULTI_PLANE
+/* Flashes with an open stripe */
+#define STRIPE_OPEN_NB	((FLASH_NB + 1) / 2)
+
+extern int32_t* stripe_ppn_list;
+extern int32_t* stripe_block_list;
+extern nand_io_info** stripe_io_info_list;
+extern int32_t* stripe_erase_block_list;
+extern int64_t stripe_erase_nb;
+#endif
+
+void INIT_META_ARENA(void);
+void TERM_META_ARENA(void);
 void INIT_MAPPING_TABLE(void);
 void TERM_MAPPING_TABLE(void);
 
 int32_t GET_MAPPING_INFO(int32_t lpn);
 int GET_NEW_PAGE(int mode, int mapping_index, int32_t* ppn);
 
+#ifdef FTL_MULTI_PLANE
+void INIT_STRIPE_BLOCK_TABLE(void);
+void TERM_STRIPE_BLOCK_TABLE(void);
+int GET_NEW_STRIPE_PAGE(int32_t* ppn_list);
+int OPEN_STRIPE_BLOCK(unsigned int flash_nb);
+void CLOSE_STRIPE_BLOCK(unsigned int flash_nb);
+void CLOSE_IDLE_STRIPE_BLOCK(void);
+int32_t GET_STRIPE_PEER(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+void CLEAR_STRIPE_PEER(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+#endif
+
 int UPDATE_OLD_PAGE_MAPPING(int32_t lpn);
 int UPDATE_NEW_PAGE_MAPPING(int32_t lpn, int32_t ppn);
+int REMOVE_PAGE_MAPPING(int32_t lpn);
 
 unsigned int CALC_FLASH(int32_t ppn);
 unsigned int CALC_BLOCK(int32_t ppn);
@@ -0,0 +1,152 @@
+// File: ftl_precondition_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+extern int64_t written_page_nb;
+
+/* Preconditioning : the writes go to _FTL_WRITE while the SSD module is off,
+	GC & wear leveling run as usual but the NAND operations take no time.
+	The virtual clock and the perf checker do not see the writes */
+uint64_t precond_random_state;
+int64_t precond_sector_nb;
+
+int GET_PRECONDITION_PATTERN(char* pattern_name)
+{
+	if(strcmp(pattern_name, "seq") == 0){
+		return PRECOND_SEQ;
+	}
+	else if(strcmp(pattern_name, "rand") == 0){
+		return PRECOND_RAN;
+	}
+	else if(strcmp(pattern_name, "trace") == 0){
+		return PRECOND_TRACE;
+	}
+
+	return -1;
+}
+
+void START_PRECONDITION(void)
+{
+	printf("[%s] start\n", __FUNCTION__);
+
+	precond_random_state = PRECOND_SEED;
+	precond_sector_nb = 0;
+
+	ssd_timing_off = 1;
+}
+
+/* The preconditioned SSD is saved by a checkpoint, a later run starts from it */
+void END_PRECONDITION(void)
+{
+	ssd_timing_off = 0;
+
+	/* SSD util, the writes were not counted by the perf checker */
+	written_page_nb = COUNT_WRITTEN_PAGE();
+	RESET_WRITE_AMPLIFICATION();
+
+	CHECKPOINT_META(0);
+
+	printf("Precondition		%lld sectors written, %lld pages in use\n", \
+			(long long)precond_sector_nb, (long long)written_page_nb);
+	printf("[%s] complete\n", __FUNCTION__);
+}
+
+int PRECONDITION_WRITE(int32_t sector_nb, unsigned int length, int stream_id)
+{
+#ifdef FTL_MULTI_STREAM
+	/* Stream ID 0 means no hint */
+	if(stream_id != 0){
+		SET_STREAM_HINT(sector_nb, length, stream_id);
+	}
+#endif
+	precond_sector_nb += length;
+
+	return _FTL_WRITE(sector_nb, length);
+}
+
+/* Write the user capacity once in order, and for PRECOND_RAN overwrite_nb
+	times more at random io_sector_nb aligned offsets */
+int FTL_PRECONDITION(int pattern, int overwrite_nb, unsigned int io_sector_nb)
+{
+	int i;
+	int ovp = OVP != 0 ? OVP : PRECOND_OVP;
+	int64_t user_sector_nb;
+	int64_t sector_nb;
+	int64_t io_nb;
+	int64_t slot_nb;
+	unsigned int length;
+
+	/* SECTOR_NB is the whole flash, the overprovisioned space is left for GC */
+	user_sector_nb = SECTOR_NB - SECTOR_NB * ovp / 100;
+
+	if(io_sector_nb == 0 || io_sector_nb > user_sector_nb){
+		io_sector_nb = SECTORS_PER_PAGE;
+	}
+
+	for(sector_nb=0;sector_nb<user_sector_nb;sector_nb+=io_sector_nb){
+		length = io_sector_nb;
+		if(sector_nb + length > user_sector_nb){
+			length = user_sector_nb - sector_nb;
+		}
+
+		if(PRECONDITION_WRITE((int32_t)sector_nb, length, 0) == FAIL){
+			printf("ERROR[%s] Sequential fill fail at sector %lld\n", __FUNCTION__, (long long)sector_nb);
+			return FAIL;
+		}
+	}
+	printf("[%s] Sequential fill complete\n", __FUNCTION__);
+
+	if(pattern != PRECOND_RAN){
+		return SUCCESS;
+	}
+
+	slot_nb = user_sector_nb / io_sector_nb;
+	for(i=0;i<overwrite_nb;i++){
+		for(io_nb=0;io_nb<slot_nb;io_nb++){
+			sector_nb = PRECONDITION_RANDOM(slot_nb) * io_sector_nb;
+
+			if(PRECONDITION_WRITE((int32_t)sector_nb, io_sector_nb, 0) == FAIL){
+				printf("ERROR[%s] Random overwrite fail at sector %lld\n", __FUNCTION__, (long long)sector_nb);
+				return FAIL;
+			}
+		}
+		printf("[%s] Random overwrite %d/%d complete\n", __FUNCTION__, i + 1, overwrite_nb);
+	}
+
+	return SUCCESS;
+}
+
+/* xorshift64*, the sequence does not depend on the libc */
+int64_t PRECONDITION_RANDOM(int64_t range)
+{
+	uint64_t x = precond_random_state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	precond_random_state = x;
+
+	return (int64_t)((x * 0x2545f4914f6cdd1dULL) % (uint64_t)range);
+}
+
+int64_t COUNT_WRITTEN_PAGE(void)
+{
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+	int64_t page_nb = 0;
+	block_state_entry* b_s_entry;
+
+	for(phy_flash_nb=0;phy_flash_nb<FLASH_NB;phy_flash_nb++){
+		for(phy_block_nb=0;phy_block_nb<BLOCK_NB;phy_block_nb++){
+			b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+			page_nb += COUNT_BITMAP(WRITTEN_BITMAP(b_s_entry->page_bitmap), PAGE_BITMAP_WORD_NB);
+		}
+	}
+
+	return page_nb;
+}
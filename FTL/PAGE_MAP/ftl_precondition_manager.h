@@ -0,0 +1,30 @@
+// File: ftl_precondition_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _PRECONDITION_MANAGER_H_
+#define _PRECONDITION_MANAGER_H_
+
+/* Preconditioning Pattern */
+#define PRECOND_SEQ		0	// Sequential fill of the SSD
+#define PRECOND_RAN		1	// Sequential fill, then random overwrites of the SSD
+#define PRECOND_TRACE		2	// The writes of a trace prefix, by PRECONDITION_WRITE
+
+#define PRECOND_OVP		10	// Overprovisioning % of the fill with OVP 0
+#define PRECOND_SEED		0x9e3779b97f4a7c15ULL	// The random overwrites are the same every time
+
+int GET_PRECONDITION_PATTERN(char* pattern_name);
+
+void START_PRECONDITION(void);
+void END_PRECONDITION(void);
+
+int PRECONDITION_WRITE(int32_t sector_nb, unsigned int length, int stream_id);
+int FTL_PRECONDITION(int pattern, int overwrite_nb, unsigned int io_sector_nb);
+
+int64_t PRECONDITION_RANDOM(int64_t range);
+int64_t COUNT_WRITTEN_PAGE(void);
+
+#endif
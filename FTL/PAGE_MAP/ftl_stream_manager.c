@@ -0,0 +1,310 @@
+// File: ftl_stream_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+#ifdef FTL_MULTI_STREAM
+
+/* Open block of each stream & plane, [stream_id * EMPTY_TABLE_ENTRY_NB + mapping_index] */
+empty_block_entry** stream_block_table;
+int* stream_table_index;
+
+/* Stream of each block, the block was opened by */
+uint8_t* block_stream_table;
+
+/* Heat tracker */
+stream_extent_entry* stream_extent_table;
+int64_t stream_extent_nb;
+int64_t heat_write_nb;
+
+/* Write Amplification */
+int64_t* stream_host_page_nb;
+int64_t* stream_copy_page_nb;
+
+void INIT_STREAM_MANAGER(void)
+{
+	stream_extent_nb = (PAGE_MAPPING_ENTRY_NB + HEAT_EXTENT_PAGE_NB - 1) / HEAT_EXTENT_PAGE_NB;
+
+	stream_block_table = (empty_block_entry**)calloc(STREAM_NB * EMPTY_TABLE_ENTRY_NB, sizeof(empty_block_entry*));
+	stream_table_index = (int*)calloc(STREAM_NB, sizeof(int));
+	block_stream_table = (uint8_t*)calloc(BLOCK_MAPPING_ENTRY_NB, sizeof(uint8_t));
+	stream_extent_table = (stream_extent_entry*)calloc(stream_extent_nb, sizeof(stream_extent_entry));
+	stream_host_page_nb = (int64_t*)calloc(STREAM_NB, sizeof(int64_t));
+	stream_copy_page_nb = (int64_t*)calloc(STREAM_NB, sizeof(int64_t));
+
+	if(stream_block_table == NULL || stream_table_index == NULL || block_stream_table == NULL \
+			|| stream_extent_table == NULL || stream_host_page_nb == NULL || stream_copy_page_nb == NULL){
+		printf("ERROR[%s] Calloc stream table fail\n", __FUNCTION__);
+		return;
+	}
+
+	/* The heat and the hints are kept across the runs, like the mapping table */
+	FILE* fp = fopen("./data/stream_table.dat","r");
+	if(fp != NULL){
+		fread(stream_extent_table, sizeof(stream_extent_entry), stream_extent_nb, fp);
+		fread(block_stream_table, sizeof(uint8_t), BLOCK_MAPPING_ENTRY_NB, fp);
+		fclose(fp);
+	}
+
+	heat_write_nb = 0;
+}
+
+void TERM_STREAM_MANAGER(void)
+{
+	int i;
+	empty_block_entry* curr_block;
+
+	PRINT_STREAM_WAF();
+
+	/* Return the open blocks, the empty & victim block lists are saved */
+	for(i=0;i<STREAM_NB * EMPTY_TABLE_ENTRY_NB;i++){
+		curr_block = stream_block_table[i];
+		if(curr_block == NULL){
+			continue;
+		}
+
+		if(curr_block->curr_phy_page_nb == 0){
+			INSERT_EMPTY_BLOCK(curr_block->phy_flash_nb, curr_block->phy_block_nb);
+			POOL_FREE(&empty_block_pool, curr_block);
+		}
+		else{
+			INSERT_VICTIM_BLOCK(curr_block);
+		}
+		stream_block_table[i] = NULL;
+	}
+
+	FILE* fp = fopen("./data/stream_table.dat","w");
+	if(fp == NULL){
+		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+	}
+	else{
+		fwrite(stream_extent_table, sizeof(stream_extent_entry), stream_extent_nb, fp);
+		fwrite(block_stream_table, sizeof(uint8_t), BLOCK_MAPPING_ENTRY_NB, fp);
+		fclose(fp);
+	}
+
+	free(stream_block_table);
+	free(stream_table_index);
+	free(block_stream_table);
+	free(stream_extent_table);
+	free(stream_host_page_nb);
+	free(stream_copy_page_nb);
+}
+
+/* The host writes the sectors to the stream_id, 0 : no hint */
+void SET_STREAM_HINT(int32_t sector_nb, unsigned int length, int stream_id)
+{
+	int64_t start;
+	int64_t end;
+	int64_t i;
+
+	if(length == 0 || stream_id < 0 || stream_id > 0xff){
+		return;
+	}
+
+	start = sector_nb / SECTORS_PER_PAGE / HEAT_EXTENT_PAGE_NB;
+	end = (sector_nb + length - 1) / SECTORS_PER_PAGE / HEAT_EXTENT_PAGE_NB;
+	if(end >= stream_extent_nb){
+		end = stream_extent_nb - 1;
+	}
+
+	for(i=start;i<=end;i++){
+		stream_extent_table[i].hint = (uint8_t)stream_id;
+	}
+}
+
+/* Return the stream of a host page write and count it */
+int CLASSIFY_WRITE_STREAM(int32_t lpn)
+{
+	int stream_id;
+	stream_extent_entry* curr_extent = stream_extent_table + lpn / HEAT_EXTENT_PAGE_NB;
+
+	if(curr_extent->heat != HEAT_MAX){
+		curr_extent->heat++;
+	}
+
+	/* Halve the heats once the whole logical space could be written */
+	heat_write_nb++;
+	if(heat_write_nb == PAGE_MAPPING_ENTRY_NB){
+		AGE_STREAM_HEAT();
+		heat_write_nb = 0;
+	}
+
+	stream_id = GET_PAGE_STREAM(lpn);
+	stream_host_page_nb[stream_id]++;
+
+	return stream_id;
+}
+
+/* Stream of the page by the hint or the heat of its extent,
+	GC & wear leveling copy the valid pages to it too */
+int GET_PAGE_STREAM(int32_t lpn)
+{
+	int host_stream_nb = STREAM_NB - 1;
+	int level = 0;
+	unsigned int update_nb;
+	stream_extent_entry* curr_extent = stream_extent_table + lpn / HEAT_EXTENT_PAGE_NB;
+
+	/* Too few spare blocks for a host stream, the single stream FTL */
+	if(host_stream_nb == 0){
+		return STREAM_GC;
+	}
+
+	if(curr_extent->hint != 0){
+		return 1 + (curr_extent->hint - 1) % host_stream_nb;
+	}
+
+	/* Heat level : log2 of the writes per page of the extent */
+	update_nb = curr_extent->heat / HEAT_EXTENT_PAGE_NB;
+	while(update_nb != 0 && level < host_stream_nb - 1){
+		update_nb >>= 1;
+		level++;
+	}
+
+	return 1 + level;
+}
+
+void AGE_STREAM_HEAT(void)
+{
+	int64_t i;
+
+	for(i=0;i<stream_extent_nb;i++){
+		stream_extent_table[i].heat >>= 1;
+	}
+}
+
+int GET_NEW_STREAM_PAGE(int stream_id, int mode, int mapping_index, int32_t* ppn)
+{
+	empty_block_entry* curr_block;
+
+	if(stream_id == STREAM_GC){
+		return GET_NEW_PAGE(mode, mapping_index, ppn);
+	}
+
+	/* No block can be opened for the stream when the SSD is almost full,
+		the page goes to the stream 0 like the single stream FTL */
+	curr_block = GET_STREAM_BLOCK(stream_id, mode, mapping_index);
+	if(curr_block == NULL){
+		return GET_NEW_PAGE(mode, mapping_index, ppn);
+	}
+
+	*ppn = curr_block->phy_flash_nb*BLOCK_NB*PAGE_NB \
+	       + curr_block->phy_block_nb*PAGE_NB \
+	       + curr_block->curr_phy_page_nb;
+
+	curr_block->curr_phy_page_nb += 1;
+
+	/* The full block is a GC victim from now */
+	if(curr_block->curr_phy_page_nb == PAGE_NB){
+		mapping_index = (curr_block->phy_block_nb % PLANES_PER_FLASH) * FLASH_NB + curr_block->phy_flash_nb;
+		stream_block_table[stream_id * EMPTY_TABLE_ENTRY_NB + mapping_index] = NULL;
+
+		INSERT_VICTIM_BLOCK(curr_block);
+	}
+
+	return SUCCESS;
+}
+
+/* Return the open block of the stream, open a new one if there is not */
+empty_block_entry* GET_STREAM_BLOCK(int stream_id, int mode, int mapping_index)
+{
+	int i;
+	int unwritten_block_nb;
+	empty_block_entry** curr_slot;
+	empty_block_root* curr_root_entry;
+
+	if(mode == VICTIM_OVERALL || mapping_index >= EMPTY_TABLE_ENTRY_NB){
+		/* Round robin over the planes, like the stream 0 */
+		mapping_index = stream_table_index[stream_id];
+
+		stream_table_index[stream_id]++;
+		if(stream_table_index[stream_id] == EMPTY_TABLE_ENTRY_NB){
+			stream_table_index[stream_id] = 0;
+		}
+	}
+
+	for(i=0;i<EMPTY_TABLE_ENTRY_NB;i++){
+		curr_slot = stream_block_table + stream_id * EMPTY_TABLE_ENTRY_NB + mapping_index;
+
+		if(*curr_slot == NULL){
+			/* The last unwritten empty block of the plane is kept for the GC copies,
+				the head block may be the open block of the stream 0 */
+			curr_root_entry = (empty_block_root*)empty_block_list + mapping_index;
+			unwritten_block_nb = curr_root_entry->empty_block_nb;
+			if(unwritten_block_nb != 0 && curr_root_entry->head->curr_phy_page_nb != 0){
+				unwritten_block_nb--;
+			}
+
+			if(unwritten_block_nb > 1){
+				*curr_slot = EJECT_PLANE_EMPTY_BLOCK(mapping_index);
+			}
+			if(*curr_slot != NULL){
+				SET_BLOCK_STREAM((*curr_slot)->phy_flash_nb, (*curr_slot)->phy_block_nb, stream_id);
+			}
+		}
+		if(*curr_slot != NULL){
+			return *curr_slot;
+		}
+
+		/* No empty block in the plane, try the next one */
+		mapping_index++;
+		if(mapping_index == EMPTY_TABLE_ENTRY_NB){
+			mapping_index = 0;
+		}
+	}
+
+	return NULL;
+}
+
+void SET_BLOCK_STREAM(unsigned int phy_flash_nb, unsigned int phy_block_nb, int stream_id)
+{
+	block_stream_table[(int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb] = (uint8_t)stream_id;
+}
+
+/* A valid page of the block is copied by GC or wear leveling */
+void COUNT_STREAM_COPY(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	int stream_id = block_stream_table[(int64_t)phy_flash_nb * BLOCK_NB + phy_block_nb];
+
+	if(stream_id < STREAM_NB){
+		stream_copy_page_nb[stream_id]++;
+	}
+}
+
+/* WAF of a stream : (host writes + copies out of its blocks) / host writes.
+	A page is copied to the stream of its heat, the stream 0 gets the copies
+	when the stream can open no block */
+void PRINT_STREAM_WAF(void)
+{
+	int i;
+	int64_t total_host_page_nb = 0;
+	int64_t total_copy_page_nb = 0;
+
+	printf("Stream		host page	copy page	WAF\n");
+	for(i=0;i<STREAM_NB;i++){
+		total_host_page_nb += stream_host_page_nb[i];
+		total_copy_page_nb += stream_copy_page_nb[i];
+
+		if(stream_host_page_nb[i] == 0){
+			printf("%d		%lld		%lld		-\n", i, \
+				(long long)stream_host_page_nb[i], (long long)stream_copy_page_nb[i]);
+		}
+		else{
+			printf("%d		%lld		%lld		%.3lf\n", i, \
+				(long long)stream_host_page_nb[i], (long long)stream_copy_page_nb[i], \
+				(double)(stream_host_page_nb[i] + stream_copy_page_nb[i]) / stream_host_page_nb[i]);
+		}
+	}
+
+	if(total_host_page_nb != 0){
+		printf("Total		%lld		%lld		%.3lf\n", (long long)total_host_page_nb, \
+			(long long)total_copy_page_nb, \
+			(double)(total_host_page_nb + total_copy_page_nb) / total_host_page_nb);
+	}
+}
+
+#endif
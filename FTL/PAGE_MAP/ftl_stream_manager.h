@@ -0,0 +1,44 @@
+// File: ftl_stream_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _STREAM_MANAGER_H_
+#define _STREAM_MANAGER_H_
+
+/* Stream 0 is the frontier of GET_NEW_PAGE, the fallback of the other streams.
+	The host data & its GC copies are written to the stream 1 (cold) ~ STREAM_NB-1 (hot) */
+#define STREAM_GC		0
+
+#define HEAT_EXTENT_PAGE_NB	16	// Pages sharing a heat counter and a stream hint
+#define HEAT_MAX		0xffff
+
+/* Heat & stream hint of an LPN extent */
+typedef struct stream_extent_entry
+{
+	uint16_t heat;		// Page writes, halved at every aging
+	uint8_t hint;		// Stream ID from the host, 0 if there is not
+}stream_extent_entry;
+
+extern int64_t* stream_host_page_nb;
+extern int64_t* stream_copy_page_nb;
+
+void INIT_STREAM_MANAGER(void);
+void TERM_STREAM_MANAGER(void);
+
+void SET_STREAM_HINT(int32_t sector_nb, unsigned int length, int stream_id);
+int CLASSIFY_WRITE_STREAM(int32_t lpn);
+int GET_PAGE_STREAM(int32_t lpn);
+void AGE_STREAM_HEAT(void);
+
+int GET_NEW_STREAM_PAGE(int stream_id, int mode, int mapping_index, int32_t* ppn);
+empty_block_entry* GET_STREAM_BLOCK(int stream_id, int mode, int mapping_index);
+
+void SET_BLOCK_STREAM(unsigned int phy_flash_nb, unsigned int phy_block_nb, int stream_id);
+void COUNT_STREAM_COPY(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+
+void PRINT_STREAM_WAF(void);
+
+#endif
@@ -0,0 +1,842 @@
+// File: ftl_sub_page_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+/* Host writes, the write amplification is reported with & without FTL_SUB_PAGE */
+int64_t host_write_sector_nb;
+int64_t host_partial_page_nb;
+
+sub_page_log_entry* sub_page_log_table = NULL;
+
+#ifdef FTL_SUB_PAGE
+/* Sector log : the sectors of the partial page writes are gathered in the open
+	log page (DRAM) instead of the read-modify-write of the page. The log has
+	SUB_PAGE_LOG_NB pages, when it is full the lpns of the oldest log page are
+	merged to full pages. GC moves the live sectors of a log page to the open one.
+	A full log is not compacted : the live sectors of the oldest page are hot ones
+	mostly, they are written again soon & the compaction costs more than the merge.
+	The log pays off only for the pages written in part again before their merge
+	(small sequential writes, rewrites of a hot set that fits the log), a page
+	written in part once costs a log program & a merge instead of a RMW.
+	So the first partial write of a page is RMW & its lpn is kept in the ghost
+	table, the next one within SUB_PAGE_GHOST_RATIO * the log sectors goes to the log.
+	A write from sector 0 after the tail of the previous page in the log goes to the
+	log too, the small sequential writes skip the RMW of their first pages.
+	The skewed random partial writes on a hot set larger than the log are RMW mostly,
+	a larger SUB_PAGE_LOG_NB catches more of their rewrites for the space of the log */
+sub_page_slot* sub_page_slot_table;
+sub_page_entry** sub_page_hash_table;
+int64_t sub_page_hash_mask;
+obj_pool sub_page_entry_pool;
+
+int32_t sub_page_table_nb;	// SUB_PAGE_LOG_NB + 1, a compaction may open a page on a full log
+int32_t sub_page_free_log;
+int32_t sub_page_oldest_log;
+int32_t sub_page_newest_log;
+int32_t sub_page_used_log_nb;	// With the open page
+
+int32_t sub_page_open_log;	// -1 : no open page
+int sub_page_open_slot_nb;
+
+int32_t* sub_page_read_list;	// The pages of an lpn, [SECTORS_PER_PAGE + 1]
+
+int32_t* sub_page_ghost_table;	// The lpns written in part, [lpn & sub_page_ghost_mask]
+int64_t sub_page_ghost_mask;
+int32_t sub_page_tail_lpn;	// The last sector of the lpn went to the log, -2 : none
+
+/* The end of the log programs & merges of the current host page, -1 : none */
+int64_t sub_page_due_time;
+
+int64_t sub_page_log_write_nb;
+int64_t sub_page_merge_nb;
+int64_t sub_page_merge_read_nb;	// The data page is read for the merge
+int64_t sub_page_compact_sector_nb;	// The sectors moved by GC
+int64_t sub_page_rmw_nb;	// The first partial writes, not in the log
+#endif
+
+void INIT_SUB_PAGE_MANAGER(void)
+{
+#ifdef FTL_SUB_PAGE
+	int i;
+	int64_t hash_nb = 1;
+	int64_t ghost_nb = 1;
+#endif
+
+	RESET_WRITE_AMPLIFICATION();
+
+#ifdef FTL_SUB_PAGE
+	if(SECTORS_PER_PAGE > SUB_PAGE_MAX_SECTOR_NB){
+		printf("ERROR[%s] %d sectors per page, the partial writes are read-modify-write\n", \
+				__FUNCTION__, SECTORS_PER_PAGE);
+		DROP_SUB_PAGE_LOG();
+		return;
+	}
+
+	sub_page_table_nb = SUB_PAGE_LOG_NB + 1;
+	while(hash_nb < (int64_t)sub_page_table_nb * SECTORS_PER_PAGE){
+		hash_nb <<= 1;
+	}
+	sub_page_hash_mask = hash_nb - 1;
+	while(ghost_nb < (int64_t)sub_page_table_nb * SECTORS_PER_PAGE * SUB_PAGE_GHOST_RATIO){
+		ghost_nb <<= 1;
+	}
+	sub_page_ghost_mask = ghost_nb - 1;
+
+	sub_page_log_table = (sub_page_log_entry*)calloc(sub_page_table_nb, sizeof(sub_page_log_entry));
+	sub_page_slot_table = (sub_page_slot*)calloc((int64_t)sub_page_table_nb * SECTORS_PER_PAGE, sizeof(sub_page_slot));
+	sub_page_hash_table = (sub_page_entry**)calloc(hash_nb, sizeof(sub_page_entry*));
+	sub_page_read_list = (int32_t*)calloc(SECTORS_PER_PAGE + 1, sizeof(int32_t));
+	sub_page_ghost_table = (int32_t*)malloc(sizeof(int32_t) * ghost_nb);
+	if(sub_page_log_table == NULL || sub_page_slot_table == NULL || sub_page_hash_table == NULL \
+			|| sub_page_read_list == NULL || sub_page_ghost_table == NULL){
+		printf("ERROR[%s] Calloc sub page table fail\n", __FUNCTION__);
+		return;
+	}
+	for(i=0;i<ghost_nb;i++){
+		sub_page_ghost_table[i] = -1;
+	}
+	sub_page_tail_lpn = -2;
+
+	/* An lpn has a sector in the log at least */
+	if(INIT_POOL(&sub_page_entry_pool, "sub_page_entry", sizeof(sub_page_entry), \
+				(int)((int64_t)sub_page_table_nb * SECTORS_PER_PAGE)) == FAIL){
+		return;
+	}
+
+	sub_page_open_log = -1;
+	sub_page_open_slot_nb = 0;
+
+	if(meta_state == META_CLEAN && LOAD_SUB_PAGE_LOG() == SUCCESS){
+		return;
+	}
+
+	for(i=0;i<sub_page_table_nb;i++){
+		sub_page_log_table[i].ppn = -1;
+		sub_page_log_table[i].live_slot_nb = 0;
+		sub_page_log_table[i].prev = -1;
+		sub_page_log_table[i].next = i + 1 < sub_page_table_nb ? i + 1 : -1;
+	}
+	for(i=0;i<sub_page_table_nb * SECTORS_PER_PAGE;i++){
+		sub_page_slot_table[i].lpn = -1;
+	}
+	sub_page_free_log = 0;
+	sub_page_oldest_log = -1;
+	sub_page_newest_log = -1;
+	sub_page_used_log_nb = 0;
+
+	/* The log pages of the crash are not known, the lpns are back to their data pages */
+	if(meta_state != META_FRESH){
+		DROP_SUB_PAGE_LOG();
+	}
+#endif
+}
+
+/* The open log page is programmed, the log is saved for the next run.
+	PRINT_WRITE_AMPLIFICATION is called after the scheduled IOs are done */
+void TERM_SUB_PAGE_MANAGER(void)
+{
+#ifdef FTL_SUB_PAGE
+	int32_t last_ppn = -1;
+
+	if(sub_page_log_table == NULL){
+		return;
+	}
+
+	if(sub_page_open_log != -1){
+		PROGRAM_SUB_PAGE_LOG(&last_ppn);
+	}
+	SAVE_SUB_PAGE_LOG();
+
+	free(sub_page_log_table);
+	free(sub_page_slot_table);
+	free(sub_page_hash_table);
+	free(sub_page_read_list);
+	free(sub_page_ghost_table);
+	TERM_POOL(&sub_page_entry_pool);
+	sub_page_log_table = NULL;
+#endif
+}
+
+/* The preconditioning writes are not counted */
+void RESET_WRITE_AMPLIFICATION(void)
+{
+	host_write_sector_nb = 0;
+	host_partial_page_nb = 0;
+
+#ifdef FTL_SUB_PAGE
+	sub_page_log_write_nb = 0;
+	sub_page_merge_nb = 0;
+	sub_page_merge_read_nb = 0;
+	sub_page_compact_sector_nb = 0;
+	sub_page_rmw_nb = 0;
+#endif
+}
+
+/* Host sectors & the pages written in part, the preconditioning is not counted */
+void COUNT_HOST_WRITE(int32_t sector_nb, unsigned int length)
+{
+	int32_t first_lpn = sector_nb / (int32_t)SECTORS_PER_PAGE;
+	int32_t last_lpn = (sector_nb + (int32_t)length - 1) / (int32_t)SECTORS_PER_PAGE;
+	int right_skip = (sector_nb + length) % SECTORS_PER_PAGE != 0;
+
+	if(ssd_timing_off == 1){
+		return;
+	}
+	host_write_sector_nb += length;
+
+	if(sector_nb % SECTORS_PER_PAGE != 0 || (first_lpn == last_lpn && right_skip)){
+		host_partial_page_nb++;
+	}
+	if(first_lpn != last_lpn && right_skip){
+		host_partial_page_nb++;
+	}
+}
+
+/* WAF : page programs / host pages. RMW : the partial pages which read the old page,
+	at the write or at the merge of the sector log */
+void PRINT_WRITE_AMPLIFICATION(void)
+{
+	double host_page_nb = (double)host_write_sector_nb / SECTORS_PER_PAGE;
+	int64_t rmw_nb = ssd_partial_write_nb;
+
+#ifdef FTL_SUB_PAGE
+	rmw_nb += sub_page_merge_read_nb;
+#endif
+	printf("Host Write		%.0lf pages, %lld partial\n", host_page_nb, (long long)host_partial_page_nb);
+	printf("RMW			%lld pages\n", (long long)rmw_nb);
+	if(host_page_nb != 0){
+		printf("NAND Program		%lld pages, WAF %.3lf\n", (long long)ssd_program_page_nb, \
+				(double)ssd_program_page_nb / host_page_nb);
+	}
+	else{
+		printf("NAND Program		%lld pages, WAF -\n", (long long)ssd_program_page_nb);
+	}
+#ifdef FTL_SUB_PAGE
+	printf("Sub-page Log		%lld pages, %lld merges, %lld sectors moved by GC, %lld first writes RMW\n", \
+			(long long)sub_page_log_write_nb, (long long)sub_page_merge_nb, \
+			(long long)sub_page_compact_sector_nb, (long long)sub_page_rmw_nb);
+#endif
+}
+
+#ifdef FTL_SUB_PAGE
+/* The log & slot tables are saved at FTL_TERM, the lpn entries are rebuilt from the slots */
+int LOAD_SUB_PAGE_LOG(void)
+{
+	int32_t i;
+	int64_t slot_nb = (int64_t)sub_page_table_nb * SECTORS_PER_PAGE;
+	sub_page_log_header header;
+	sub_page_entry* entry;
+	sub_page_slot* slot;
+
+	FILE* fp = fopen("./data/sub_page_log.dat","r");
+	if(fp == NULL){
+		return FAIL;
+	}
+
+	if(fread(&header, sizeof(sub_page_log_header), 1, fp) != 1 \
+			|| header.log_nb != sub_page_table_nb || header.sectors_per_page != SECTORS_PER_PAGE \
+			|| fread(sub_page_log_table, sizeof(sub_page_log_entry), sub_page_table_nb, fp) != (size_t)sub_page_table_nb \
+			|| fread(sub_page_slot_table, sizeof(sub_page_slot), slot_nb, fp) != (size_t)slot_nb){
+		printf("ERROR[%s] Wrong sub page log file\n", __FUNCTION__);
+		fclose(fp);
+		return FAIL;
+	}
+	fclose(fp);
+
+	/* The file is of this run only, a crash drops the log */
+	remove("./data/sub_page_log.dat");
+
+	sub_page_free_log = header.free_log;
+	sub_page_oldest_log = header.oldest_log;
+	sub_page_newest_log = header.newest_log;
+	sub_page_used_log_nb = header.used_log_nb;
+
+	for(i=0;i<slot_nb;i++){
+		slot = sub_page_slot_table + i;
+		if(slot->lpn == -1){
+			continue;
+		}
+
+		entry = GET_SUB_PAGE_ENTRY(slot->lpn);
+		if(entry == NULL){
+			entry = ADD_SUB_PAGE_ENTRY(slot->lpn);
+			if(entry == NULL){
+				return FAIL;
+			}
+		}
+		slot->next = entry->first_slot;
+		entry->first_slot = i;
+		entry->sector_bitmap |= 1ULL << slot->sector;
+	}
+
+	return SUCCESS;
+}
+
+void SAVE_SUB_PAGE_LOG(void)
+{
+	sub_page_log_header header;
+
+	FILE* fp = fopen("./data/sub_page_log.dat","w");
+	if(fp == NULL){
+		printf("ERROR[%s] File open fail\n", __FUNCTION__);
+		return;
+	}
+
+	header.log_nb = sub_page_table_nb;
+	header.sectors_per_page = SECTORS_PER_PAGE;
+	header.free_log = sub_page_free_log;
+	header.oldest_log = sub_page_oldest_log;
+	header.newest_log = sub_page_newest_log;
+	header.used_log_nb = sub_page_used_log_nb;
+
+	fwrite(&header, sizeof(sub_page_log_header), 1, fp);
+	fwrite(sub_page_log_table, sizeof(sub_page_log_entry), sub_page_table_nb, fp);
+	fwrite(sub_page_slot_table, sizeof(sub_page_slot), (int64_t)sub_page_table_nb * SECTORS_PER_PAGE, fp);
+	fclose(fp);
+}
+
+/* Invalidate the log pages on the flash, before the block lists are built */
+void DROP_SUB_PAGE_LOG(void)
+{
+	int32_t ppn;
+	int64_t drop_nb = 0;
+	block_state_entry* b_s_entry;
+
+	for(ppn=0;ppn<PAGES_IN_SSD;ppn++){
+		if(IS_SUB_PAGE_LOG_LPN(GET_INVERSE_MAPPING_INFO(ppn)) == 0){
+			continue;
+		}
+
+		b_s_entry = GET_BLOCK_STATE_ENTRY(CALC_FLASH(ppn), CALC_BLOCK(ppn));
+		if(b_s_entry->type == MAP_BLOCK){
+			continue;
+		}
+
+		UPDATE_BLOCK_STATE_ENTRY(CALC_FLASH(ppn), CALC_BLOCK(ppn), CALC_PAGE(ppn), INVALID);
+		UPDATE_INVERSE_MAPPING(ppn, -1);
+		drop_nb++;
+	}
+
+	if(drop_nb != 0){
+		printf("[%s] %lld log pages are dropped\n", __FUNCTION__, (long long)drop_nb);
+	}
+}
+
+/* SUCCESS : the partial write of the lpn goes to the log, it has sectors in the log,
+	it was written in part lately or it goes on from the tail of the previous page in the log.
+	FAIL : RMW, the lpn is kept in the ghost table */
+int SUB_PAGE_ADMIT(int32_t lpn, int first_sector, int sector_nb)
+{
+	int32_t* ghost = sub_page_ghost_table + (lpn & sub_page_ghost_mask);
+
+	if(*ghost == lpn || GET_SUB_PAGE_ENTRY(lpn) != NULL \
+			|| (first_sector == 0 && lpn == sub_page_tail_lpn + 1)){
+		*ghost = lpn;
+
+		/* The small sequential writes, the next page goes to the log too */
+		if(first_sector + sector_nb == SECTORS_PER_PAGE){
+			sub_page_tail_lpn = lpn;
+		}
+		return SUCCESS;
+	}
+	*ghost = lpn;
+
+	if(ssd_timing_off == 0){
+		sub_page_rmw_nb++;
+	}
+
+	return FAIL;
+}
+
+sub_page_entry* GET_SUB_PAGE_ENTRY(int32_t lpn)
+{
+	sub_page_entry* entry = sub_page_hash_table[lpn & sub_page_hash_mask];
+
+	while(entry != NULL && entry->lpn != lpn){
+		entry = entry->hash_next;
+	}
+
+	return entry;
+}
+
+sub_page_entry* ADD_SUB_PAGE_ENTRY(int32_t lpn)
+{
+	sub_page_entry** bucket = sub_page_hash_table + (lpn & sub_page_hash_mask);
+	sub_page_entry* entry = (sub_page_entry*)POOL_ALLOC(&sub_page_entry_pool);
+
+	if(entry == NULL){
+		printf("ERROR[%s] Alloc sub page entry fail\n", __FUNCTION__);
+		return NULL;
+	}
+	entry->lpn = lpn;
+	entry->first_slot = -1;
+	entry->sector_bitmap = 0;
+	entry->hash_next = *bucket;
+	*bucket = entry;
+
+	return entry;
+}
+
+void FREE_SUB_PAGE_ENTRY(sub_page_entry* entry)
+{
+	sub_page_entry** link = sub_page_hash_table + (entry->lpn & sub_page_hash_mask);
+
+	while(*link != entry){
+		link = &(*link)->hash_next;
+	}
+	*link = entry->hash_next;
+
+	POOL_FREE(&sub_page_entry_pool, entry);
+}
+
+int32_t FIND_SUB_PAGE_SLOT(sub_page_entry* entry, int sector)
+{
+	int32_t slot_nb = entry->first_slot;
+
+	while(slot_nb != -1 && sub_page_slot_table[slot_nb].sector != sector){
+		slot_nb = sub_page_slot_table[slot_nb].next;
+	}
+
+	return slot_nb;
+}
+
+/* The sector is not in the log any more, the entry is freed with its last sector */
+void REMOVE_SUB_PAGE_SECTOR(sub_page_entry* entry, int sector)
+{
+	int32_t* link = &entry->first_slot;
+	int32_t slot_nb;
+
+	while(*link != -1 && sub_page_slot_table[*link].sector != sector){
+		link = &sub_page_slot_table[*link].next;
+	}
+	if(*link == -1){
+		return;
+	}
+
+	slot_nb = *link;
+	*link = sub_page_slot_table[slot_nb].next;
+	KILL_SUB_PAGE_SLOT(slot_nb);
+
+	entry->sector_bitmap &= ~(1ULL << sector);
+	if(entry->sector_bitmap == 0){
+		FREE_SUB_PAGE_ENTRY(entry);
+	}
+}
+
+/* Put the sector to the next slot of the open log page */
+void LINK_SUB_PAGE_SLOT(sub_page_entry* entry, int32_t lpn, int sector)
+{
+	int32_t slot_nb = sub_page_open_log * SECTORS_PER_PAGE + sub_page_open_slot_nb;
+	sub_page_slot* slot = sub_page_slot_table + slot_nb;
+
+	slot->lpn = lpn;
+	slot->sector = sector;
+	slot->next = entry->first_slot;
+	entry->first_slot = slot_nb;
+	entry->sector_bitmap |= 1ULL << sector;
+
+	sub_page_open_slot_nb++;
+	sub_page_log_table[sub_page_open_log].live_slot_nb++;
+}
+
+/* The slot is unlinked from its lpn, the log page is freed with its last live slot */
+void KILL_SUB_PAGE_SLOT(int32_t slot_nb)
+{
+	int32_t log_nb = slot_nb / SECTORS_PER_PAGE;
+
+	sub_page_slot_table[slot_nb].lpn = -1;
+	sub_page_log_table[log_nb].live_slot_nb--;
+
+	if(sub_page_log_table[log_nb].live_slot_nb == 0 && log_nb != sub_page_open_log){
+		FREE_SUB_PAGE_LOG(log_nb);
+	}
+}
+
+/* The time the NAND IO of the ppn ends, the host page waits for it */
+void UPDATE_SUB_PAGE_DUE_TIME(int32_t ppn)
+{
+	int64_t due_time = SSD_GET_REG_DUE_TIME(CALC_FLASH(ppn)*PLANES_PER_FLASH + CALC_BLOCK(ppn)%PLANES_PER_FLASH);
+
+	if(due_time > sub_page_due_time){
+		sub_page_due_time = due_time;
+	}
+}
+
+/* compact : called by GC, the oldest log page is not merged,
+	the log may be over SUB_PAGE_LOG_NB until the victim log page is freed */
+int OPEN_SUB_PAGE_LOG(int compact, int32_t* last_ppn)
+{
+	int32_t log_nb;
+
+	while(compact == 0 && sub_page_used_log_nb >= SUB_PAGE_LOG_NB && sub_page_oldest_log != -1){
+		if(MERGE_SUB_PAGE_LOG(sub_page_oldest_log, last_ppn) == FAIL){
+			return FAIL;
+		}
+	}
+
+	log_nb = sub_page_free_log;
+	if(log_nb == -1){
+		printf("ERROR[%s] There is no free log page\n", __FUNCTION__);
+		return FAIL;
+	}
+	sub_page_free_log = sub_page_log_table[log_nb].next;
+	sub_page_used_log_nb++;
+
+	sub_page_log_table[log_nb].ppn = -1;
+	sub_page_log_table[log_nb].live_slot_nb = 0;
+	sub_page_log_table[log_nb].prev = -1;
+	sub_page_log_table[log_nb].next = -1;
+
+	sub_page_open_log = log_nb;
+	sub_page_open_slot_nb = 0;
+
+	return SUCCESS;
+}
+
+/* Program the open log page, it is the newest one of the log */
+int PROGRAM_SUB_PAGE_LOG(int32_t* last_ppn)
+{
+	int ret;
+	int32_t log_nb = sub_page_open_log;
+	int32_t new_ppn;
+	sub_page_log_entry* log_entry = sub_page_log_table + log_nb;
+	nand_io_info* n_io_info = NULL;
+
+	sub_page_open_log = -1;
+
+	/* All the sectors are overwritten in the DRAM */
+	if(log_entry->live_slot_nb == 0){
+		FREE_SUB_PAGE_LOG(log_nb);
+		return SUCCESS;
+	}
+
+	ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
+	if(ret == FAIL){
+		printf("ERROR[%s] Get new page fail\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	n_io_info = CREATE_NAND_IO_INFO(0, SUB_LOG_WRITE, -1, -1);
+	SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
+	UPDATE_SUB_PAGE_DUE_TIME(new_ppn);
+
+	UPDATE_BLOCK_STATE_ENTRY(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), VALID);
+	UPDATE_BLOCK_STATE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), DATA_BLOCK);
+	UPDATE_INVERSE_MAPPING(new_ppn, SUB_PAGE_LOG_LPN(log_nb));
+
+	log_entry->ppn = new_ppn;
+	log_entry->prev = sub_page_newest_log;
+	log_entry->next = -1;
+	if(sub_page_newest_log != -1){
+		sub_page_log_table[sub_page_newest_log].next = log_nb;
+	}
+	else{
+		sub_page_oldest_log = log_nb;
+	}
+	sub_page_newest_log = log_nb;
+
+	sub_page_log_write_nb++;
+	*last_ppn = new_ppn;
+
+	return SUCCESS;
+}
+
+/* The log page has no live sector, its flash page is invalid */
+void FREE_SUB_PAGE_LOG(int32_t log_nb)
+{
+	sub_page_log_entry* log_entry = sub_page_log_table + log_nb;
+
+	if(log_entry->ppn != -1){
+		UPDATE_BLOCK_STATE_ENTRY(CALC_FLASH(log_entry->ppn), CALC_BLOCK(log_entry->ppn), \
+				CALC_PAGE(log_entry->ppn), INVALID);
+		UPDATE_INVERSE_MAPPING(log_entry->ppn, -1);
+		EJECT_SUB_PAGE_LOG(log_nb);
+	}
+
+	log_entry->next = sub_page_free_log;
+	sub_page_free_log = log_nb;
+	sub_page_used_log_nb--;
+}
+
+/* Take the programmed log page out of the log order */
+void EJECT_SUB_PAGE_LOG(int32_t log_nb)
+{
+	sub_page_log_entry* log_entry = sub_page_log_table + log_nb;
+
+	if(log_entry->prev != -1){
+		sub_page_log_table[log_entry->prev].next = log_entry->next;
+	}
+	else{
+		sub_page_oldest_log = log_entry->next;
+	}
+	if(log_entry->next != -1){
+		sub_page_log_table[log_entry->next].prev = log_entry->prev;
+	}
+	else{
+		sub_page_newest_log = log_entry->prev;
+	}
+
+	log_entry->ppn = -1;
+	log_entry->prev = -1;
+	log_entry->next = -1;
+}
+
+/* Write the sectors of the lpn to the open log page, the sectors which are
+	already in the open page are overwritten in the DRAM.
+	sub_page_due_time is the end of the log programs & merges of the write */
+int SUB_PAGE_WRITE(int32_t lpn, int first_sector, int sector_nb, int32_t* last_ppn)
+{
+	int sector;
+	int32_t slot_nb;
+	sub_page_entry* entry;
+
+	sub_page_due_time = -1;
+
+	for(sector=first_sector;sector<first_sector+sector_nb;sector++){
+		entry = GET_SUB_PAGE_ENTRY(lpn);
+
+		if(entry != NULL && ((entry->sector_bitmap >> sector) & 1)){
+			slot_nb = FIND_SUB_PAGE_SLOT(entry, sector);
+			if(slot_nb / SECTORS_PER_PAGE == sub_page_open_log){
+				continue;
+			}
+			REMOVE_SUB_PAGE_SECTOR(entry, sector);
+		}
+
+		if(sub_page_open_log != -1 && sub_page_open_slot_nb == SECTORS_PER_PAGE){
+			if(PROGRAM_SUB_PAGE_LOG(last_ppn) == FAIL){
+				return FAIL;
+			}
+		}
+		/* The lpn may be merged for a free log page */
+		if(sub_page_open_log == -1 && OPEN_SUB_PAGE_LOG(0, last_ppn) == FAIL){
+			return FAIL;
+		}
+
+		entry = GET_SUB_PAGE_ENTRY(lpn);
+		if(entry == NULL){
+			entry = ADD_SUB_PAGE_ENTRY(lpn);
+			if(entry == NULL){
+				return FAIL;
+			}
+		}
+		LINK_SUB_PAGE_SLOT(entry, lpn, sector);
+	}
+
+	/* The whole page is in the log, it is written as a data page.
+		The small sequential writes need no merge later */
+	entry = GET_SUB_PAGE_ENTRY(lpn);
+	if(entry != NULL && entry->sector_bitmap == SUB_PAGE_SECTOR_MASK(0, SECTORS_PER_PAGE)){
+		return MERGE_SUB_PAGE(entry, last_ppn);
+	}
+
+	return SUCCESS;
+}
+
+/* The pages to read the sectors of the lpn : the data page for the sectors which are
+	not in the log, and the log pages of the others. The first page is of the host
+	request, the others are read with it. io_vec NULL : count the pages only */
+int SUB_PAGE_READ(int32_t lpn, int32_t ppn, int first_sector, int sector_nb, \
+		nand_io_vec* io_vec, int read_page_nb, int io_page_nb)
+{
+	int i;
+	int read_nb = 0;
+	int32_t slot_nb;
+	int32_t log_ppn;
+	uint64_t read_mask = SUB_PAGE_SECTOR_MASK(first_sector, sector_nb);
+	sub_page_entry* entry = GET_SUB_PAGE_ENTRY(lpn);
+	nand_io_vec* curr_vec;
+
+	if(ppn != -1 && (entry == NULL || (read_mask & ~entry->sector_bitmap) != 0)){
+		sub_page_read_list[read_nb++] = ppn;
+	}
+
+	if(entry != NULL){
+		for(slot_nb=entry->first_slot;slot_nb!=-1;slot_nb=sub_page_slot_table[slot_nb].next){
+			if(((read_mask >> sub_page_slot_table[slot_nb].sector) & 1) == 0){
+				continue;
+			}
+
+			/* The open log page is in the DRAM */
+			log_ppn = sub_page_log_table[slot_nb / SECTORS_PER_PAGE].ppn;
+			if(log_ppn == -1){
+				continue;
+			}
+
+			for(i=0;i<read_nb;i++){
+				if(sub_page_read_list[i] == log_ppn){
+					break;
+				}
+			}
+			if(i == read_nb){
+				sub_page_read_list[read_nb++] = log_ppn;
+			}
+		}
+	}
+
+	if(io_vec == NULL){
+		return read_nb;
+	}
+
+	for(i=0;i<read_nb;i++){
+		curr_vec = io_vec + i;
+		curr_vec->flash_nb = CALC_FLASH(sub_page_read_list[i]);
+		curr_vec->block_nb = CALC_BLOCK(sub_page_read_list[i]);
+		curr_vec->page_nb = CALC_PAGE(sub_page_read_list[i]);
+		curr_vec->old_flash_nb = -1;
+		INIT_NAND_IO_INFO(&curr_vec->io_info, read_page_nb, READ, io_page_nb, i == 0 ? io_request_seq_nb : -1);
+	}
+
+	return read_nb;
+}
+
+/* The lpn is written whole, its sectors in the log are stale */
+void DROP_SUB_PAGE(int32_t lpn)
+{
+	int32_t slot_nb;
+	int32_t next_slot_nb;
+	sub_page_entry* entry = GET_SUB_PAGE_ENTRY(lpn);
+
+	if(entry == NULL){
+		return;
+	}
+
+	for(slot_nb=entry->first_slot;slot_nb!=-1;slot_nb=next_slot_nb){
+		next_slot_nb = sub_page_slot_table[slot_nb].next;
+		KILL_SUB_PAGE_SLOT(slot_nb);
+	}
+	FREE_SUB_PAGE_ENTRY(entry);
+}
+
+/* Read the data page & the log pages of the lpn, and write it to a new page */
+int MERGE_SUB_PAGE(sub_page_entry* entry, int32_t* last_ppn)
+{
+	int i;
+	int ret;
+	int read_nb;
+	int32_t lpn = entry->lpn;
+	int32_t old_ppn = GET_MAPPING_INFO(lpn);
+	int32_t new_ppn;
+	nand_io_info* n_io_info = NULL;
+
+	read_nb = SUB_PAGE_READ(lpn, old_ppn, 0, SECTORS_PER_PAGE, NULL, 0, 0);
+	for(i=0;i<read_nb;i++){
+		if(sub_page_read_list[i] == old_ppn){
+			sub_page_merge_read_nb++;
+		}
+
+		n_io_info = CREATE_NAND_IO_INFO(i, SUB_MERGE_READ, -1, io_request_seq_nb);
+		SSD_PAGE_READ(CALC_FLASH(sub_page_read_list[i]), CALC_BLOCK(sub_page_read_list[i]), \
+				CALC_PAGE(sub_page_read_list[i]), n_io_info);
+		UPDATE_SUB_PAGE_DUE_TIME(sub_page_read_list[i]);
+	}
+
+	ret = GET_NEW_PAGE(VICTIM_OVERALL, EMPTY_TABLE_ENTRY_NB, &new_ppn);
+	if(ret == FAIL){
+		printf("ERROR[%s] Get new page fail\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	n_io_info = CREATE_NAND_IO_INFO(0, SUB_MERGE_WRITE, -1, io_request_seq_nb);
+	SSD_PAGE_WRITE(CALC_FLASH(new_ppn), CALC_BLOCK(new_ppn), CALC_PAGE(new_ppn), n_io_info);
+	UPDATE_SUB_PAGE_DUE_TIME(new_ppn);
+
+	DROP_SUB_PAGE(lpn);
+	UPDATE_OLD_PAGE_MAPPING(lpn);
+	UPDATE_NEW_PAGE_MAPPING(lpn, new_ppn);
+
+	sub_page_merge_nb++;
+	*last_ppn = new_ppn;
+
+	return SUCCESS;
+}
+
+/* Merge the lpns of the log page, the log page is freed by the last one */
+int MERGE_SUB_PAGE_LOG(int32_t log_nb, int32_t* last_ppn)
+{
+	int i;
+	sub_page_slot* slot = sub_page_slot_table + (int64_t)log_nb * SECTORS_PER_PAGE;
+	sub_page_entry* entry;
+
+	for(i=0;i<SECTORS_PER_PAGE;i++){
+		if(slot[i].lpn == -1){
+			continue;
+		}
+
+		entry = GET_SUB_PAGE_ENTRY(slot[i].lpn);
+		if(entry == NULL){
+			printf("ERROR[%s] No sub page entry of lpn %d\n", __FUNCTION__, slot[i].lpn);
+			return FAIL;
+		}
+
+		if(MERGE_SUB_PAGE(entry, last_ppn) == FAIL){
+			return FAIL;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/* GC of a log page : the live sectors are moved to the open log page.
+	The victim page is erased or invalidated by the caller, like a copied page */
+int COMPACT_SUB_PAGE_LOG(int32_t old_ppn, int32_t log_nb, int read_type)
+{
+	int i;
+	int sector;
+	int32_t lpn;
+	int32_t last_ppn;
+	int32_t slot_nb;
+	sub_page_entry* entry;
+	nand_io_info* n_io_info = NULL;
+
+	if(log_nb < 0 || log_nb >= sub_page_table_nb || sub_page_log_table[log_nb].ppn != old_ppn){
+		printf("ERROR[%s] Wrong log page %d of ppn %d\n", __FUNCTION__, log_nb, old_ppn);
+		return FAIL;
+	}
+
+	n_io_info = CREATE_NAND_IO_INFO(0, read_type, -1, io_request_seq_nb);
+	SSD_PAGE_READ(CALC_FLASH(old_ppn), CALC_BLOCK(old_ppn), CALC_PAGE(old_ppn), n_io_info);
+
+	/* The sectors are in the DRAM now */
+	EJECT_SUB_PAGE_LOG(log_nb);
+
+	for(i=0;i<SECTORS_PER_PAGE;i++){
+		slot_nb = log_nb * SECTORS_PER_PAGE + i;
+		lpn = sub_page_slot_table[slot_nb].lpn;
+		if(lpn == -1){
+			continue;
+		}
+		sector = sub_page_slot_table[slot_nb].sector;
+
+		if(sub_page_open_log != -1 && sub_page_open_slot_nb == SECTORS_PER_PAGE){
+			if(PROGRAM_SUB_PAGE_LOG(&last_ppn) == FAIL){
+				return FAIL;
+			}
+		}
+		if(sub_page_open_log == -1 && OPEN_SUB_PAGE_LOG(1, &last_ppn) == FAIL){
+			return FAIL;
+		}
+
+		entry = GET_SUB_PAGE_ENTRY(lpn);
+		REMOVE_SUB_PAGE_SECTOR(entry, sector);
+
+		entry = GET_SUB_PAGE_ENTRY(lpn);
+		if(entry == NULL){
+			entry = ADD_SUB_PAGE_ENTRY(lpn);
+			if(entry == NULL){
+				return FAIL;
+			}
+		}
+		LINK_SUB_PAGE_SLOT(entry, lpn, sector);
+
+		sub_page_compact_sector_nb++;
+	}
+
+	return SUCCESS;
+}
+#endif
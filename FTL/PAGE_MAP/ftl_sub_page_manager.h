@@ -0,0 +1,102 @@
+// File: ftl_sub_page_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _SUB_PAGE_MANAGER_H_
+#define _SUB_PAGE_MANAGER_H_
+
+#define SUB_PAGE_MAX_SECTOR_NB	64	// Sectors of a page in the sector bitmap
+#define SUB_PAGE_GHOST_RATIO	1	// The lpns of the first partial writes, per log sector
+
+/* The inverse mapping (OOB) of a log page keeps its log number,
+	told from the translation pages by the block type */
+#define SUB_PAGE_LOG_LPN(log_nb)	(-2 - (int32_t)(log_nb))
+#define GET_SUB_PAGE_LOG_NB(lpn)	(-2 - (lpn))
+#define IS_SUB_PAGE_LOG_LPN(lpn)	((lpn) <= -2)
+
+#define SUB_PAGE_SECTOR_MASK(first, nb) \
+	((nb) >= 64 ? ~0ULL : (((1ULL << (nb)) - 1) << (first)))
+
+/* Log page, [log_nb] */
+typedef struct sub_page_log_entry
+{
+	int32_t ppn;		// -1 : in the DRAM, the open log page or a page being compacted
+	int32_t live_slot_nb;
+	int32_t prev;		// Programmed log pages, the oldest one is merged first
+	int32_t next;		// or the next free log page
+}sub_page_log_entry;
+
+/* A sector of a log page, [log_nb * SECTORS_PER_PAGE + slot] */
+typedef struct sub_page_slot
+{
+	int32_t lpn;		// -1 : overwritten
+	int32_t sector;		// Sector offset in the page
+	int32_t next;		// Next slot of the lpn
+}sub_page_slot;
+
+/* An lpn which has sectors in the log */
+typedef struct sub_page_entry
+{
+	struct sub_page_entry* hash_next;
+	int32_t lpn;
+	int32_t first_slot;
+	uint64_t sector_bitmap;	// The sectors in the log
+}sub_page_entry;
+
+typedef struct sub_page_log_header
+{
+	int32_t log_nb;
+	int32_t sectors_per_page;
+	int32_t free_log;
+	int32_t oldest_log;
+	int32_t newest_log;
+	int32_t used_log_nb;
+}sub_page_log_header;
+
+extern sub_page_log_entry* sub_page_log_table;
+
+#ifdef FTL_SUB_PAGE
+extern int64_t sub_page_due_time;
+#endif
+
+void INIT_SUB_PAGE_MANAGER(void);
+void TERM_SUB_PAGE_MANAGER(void);
+
+void RESET_WRITE_AMPLIFICATION(void);
+void COUNT_HOST_WRITE(int32_t sector_nb, unsigned int length);
+void PRINT_WRITE_AMPLIFICATION(void);
+
+#ifdef FTL_SUB_PAGE
+int LOAD_SUB_PAGE_LOG(void);
+void SAVE_SUB_PAGE_LOG(void);
+void DROP_SUB_PAGE_LOG(void);
+
+int SUB_PAGE_ADMIT(int32_t lpn, int first_sector, int sector_nb);
+sub_page_entry* GET_SUB_PAGE_ENTRY(int32_t lpn);
+sub_page_entry* ADD_SUB_PAGE_ENTRY(int32_t lpn);
+void FREE_SUB_PAGE_ENTRY(sub_page_entry* entry);
+int32_t FIND_SUB_PAGE_SLOT(sub_page_entry* entry, int sector);
+void REMOVE_SUB_PAGE_SECTOR(sub_page_entry* entry, int sector);
+void LINK_SUB_PAGE_SLOT(sub_page_entry* entry, int32_t lpn, int sector);
+void KILL_SUB_PAGE_SLOT(int32_t slot_nb);
+void UPDATE_SUB_PAGE_DUE_TIME(int32_t ppn);
+
+int OPEN_SUB_PAGE_LOG(int compact, int32_t* last_ppn);
+int PROGRAM_SUB_PAGE_LOG(int32_t* last_ppn);
+void FREE_SUB_PAGE_LOG(int32_t log_nb);
+void EJECT_SUB_PAGE_LOG(int32_t log_nb);
+
+int SUB_PAGE_WRITE(int32_t lpn, int first_sector, int sector_nb, int32_t* last_ppn);
+int SUB_PAGE_READ(int32_t lpn, int32_t ppn, int first_sector, int sector_nb, \
+		nand_io_vec* io_vec, int read_page_nb, int io_page_nb);
+void DROP_SUB_PAGE(int32_t lpn);
+
+int MERGE_SUB_PAGE(sub_page_entry* entry, int32_t* last_ppn);
+int MERGE_SUB_PAGE_LOG(int32_t log_nb, int32_t* last_ppn);
+int COMPACT_SUB_PAGE_LOG(int32_t old_ppn, int32_t log_nb, int read_type);
+#endif
+
+#endif
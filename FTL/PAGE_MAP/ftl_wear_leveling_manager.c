@@ -0,0 +1,323 @@
+// File: ftl_wear_leveling_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+/* Erase Count */
+unsigned int max_erase_count;
+unsigned int min_erase_count;
+int64_t total_erase_nb;
+
+#ifdef FTL_WEAR_LEVELING
+empty_block_heap* empty_block_heap_list;
+
+/* Static Wear Leveling */
+int64_t wl_block_nb;
+int64_t wl_page_nb;
+int64_t wl_check_erase_nb;
+
+static inline unsigned int GET_ERASE_COUNT(empty_block_entry* e_b_entry)
+{
+	return GET_BLOCK_STATE_ENTRY(e_b_entry->phy_flash_nb, e_b_entry->phy_block_nb)->erase_count;
+}
+#endif
+
+void INIT_WEAR_LEVELING(void)
+{
+	int64_t i;
+	block_state_entry* b_s_entry;
+
+	/* The erase counts are kept in the block state table,
+		a new table has no erase and is not scanned */
+	max_erase_count = 0;
+	min_erase_count = 0;
+	total_erase_nb = 0;
+
+	if(block_state_table_loaded){
+		min_erase_count = (unsigned int)-1;
+
+		for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
+			b_s_entry = (block_state_entry*)((char*)block_state_table + i * block_state_entry_size);
+
+			if(b_s_entry->erase_count > max_erase_count){
+				max_erase_count = b_s_entry->erase_count;
+			}
+			if(b_s_entry->erase_count < min_erase_count){
+				min_erase_count = b_s_entry->erase_count;
+			}
+			total_erase_nb += b_s_entry->erase_count;
+		}
+	}
+
+#ifdef FTL_WEAR_LEVELING
+	int j;
+	empty_block_root* curr_root;
+	empty_block_entry* curr_entry;
+	empty_block_entry* next_entry;
+
+	empty_block_heap_list = (empty_block_heap*)calloc(EMPTY_TABLE_ENTRY_NB, sizeof(empty_block_heap));
+	if(empty_block_heap_list == NULL){
+		printf("ERROR[%s] Calloc empty block heap fail\n", __FUNCTION__);
+		return;
+	}
+
+	/* Move the listed empty blocks except the head to the heap of each plane,
+		the fresh blocks are taken before the heap */
+	curr_root = (empty_block_root*)empty_block_list;
+	for(j=0;j<EMPTY_TABLE_ENTRY_NB;j++){
+
+		empty_block_heap_list[j].entry = (empty_block_entry**)calloc(EACH_EMPTY_TABLE_ENTRY_NB, sizeof(empty_block_entry*));
+		if(empty_block_heap_list[j].entry == NULL){
+			printf("ERROR[%s] Calloc empty block heap fail\n", __FUNCTION__);
+			return;
+		}
+
+		if(curr_root->empty_block_nb != 0){
+			curr_entry = curr_root->head->next;
+			for(i=1;i<curr_root->empty_block_nb - curr_root->fresh_block_nb;i++){
+				next_entry = curr_entry->next;
+				PUSH_EMPTY_BLOCK_HEAP(j, curr_entry);
+				curr_entry = next_entry;
+			}
+			curr_root->head->next = NULL;
+			curr_root->tail = curr_root->head;
+		}
+		curr_root += 1;
+	}
+
+	wl_block_nb = 0;
+	wl_page_nb = 0;
+	wl_check_erase_nb = total_erase_nb;
+#endif
+}
+
+void TERM_WEAR_LEVELING(void)
+{
+	printf("Erase Count		min %u, max %u, avg %.2lf\n", min_erase_count, max_erase_count, \
+			(double)total_erase_nb / BLOCK_MAPPING_ENTRY_NB);
+
+#ifdef FTL_WEAR_LEVELING
+	int j;
+	empty_block_root* curr_root;
+	empty_block_heap* curr_heap;
+	empty_block_entry* curr_entry;
+
+	printf("Wear Leveling		%lld blocks, %lld pages\n", (long long)wl_block_nb, (long long)wl_page_nb);
+
+	/* Link the heap entries after the head, the empty block list is saved as a list */
+	curr_root = (empty_block_root*)empty_block_list;
+	for(j=0;j<EMPTY_TABLE_ENTRY_NB;j++){
+		curr_heap = empty_block_heap_list + j;
+
+		while((curr_entry = POP_EMPTY_BLOCK_HEAP(j)) != NULL){
+			curr_root->tail->next = curr_entry;
+			curr_root->tail = curr_entry;
+		}
+		free(curr_heap->entry);
+
+		curr_root += 1;
+	}
+	free(empty_block_heap_list);
+	empty_block_heap_list = NULL;
+#endif
+}
+
+void COUNT_BLOCK_ERASE(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+
+	b_s_entry->erase_count++;
+	total_erase_nb++;
+
+	JOURNAL_APPEND(JOURNAL_ERASE_COUNT, phy_flash_nb * BLOCK_NB + phy_block_nb, 0, b_s_entry->erase_count);
+
+	if(b_s_entry->erase_count > max_erase_count){
+		max_erase_count = b_s_entry->erase_count;
+	}
+}
+
+#ifdef FTL_WEAR_LEVELING
+int PUSH_EMPTY_BLOCK_HEAP(int mapping_index, empty_block_entry* e_b_entry)
+{
+	empty_block_heap* curr_heap = empty_block_heap_list + mapping_index;
+	unsigned int index = curr_heap->entry_nb;
+	unsigned int parent;
+	unsigned int erase_count = GET_ERASE_COUNT(e_b_entry);
+
+	if(curr_heap->entry_nb == EACH_EMPTY_TABLE_ENTRY_NB){
+		printf("ERROR[%s] The empty block heap is full\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	e_b_entry->next = NULL;
+
+	/* Sift up */
+	while(index > 0){
+		parent = (index - 1) / 2;
+		if(GET_ERASE_COUNT(curr_heap->entry[parent]) <= erase_count){
+			break;
+		}
+		curr_heap->entry[index] = curr_heap->entry[parent];
+		index = parent;
+	}
+	curr_heap->entry[index] = e_b_entry;
+	curr_heap->entry_nb++;
+
+	return SUCCESS;
+}
+
+/* Return the least erased empty block of the plane, NULL if there is not */
+empty_block_entry* POP_EMPTY_BLOCK_HEAP(int mapping_index)
+{
+	empty_block_heap* curr_heap = empty_block_heap_list + mapping_index;
+	empty_block_entry* min_entry;
+	empty_block_entry* last_entry;
+	unsigned int index = 0;
+	unsigned int child;
+	unsigned int erase_count;
+
+	if(curr_heap->entry_nb == 0){
+		return NULL;
+	}
+
+	min_entry = curr_heap->entry[0];
+	curr_heap->entry_nb--;
+
+	/* Sift down the last entry from the root */
+	if(curr_heap->entry_nb != 0){
+		last_entry = curr_heap->entry[curr_heap->entry_nb];
+		erase_count = GET_ERASE_COUNT(last_entry);
+
+		while((child = 2 * index + 1) < curr_heap->entry_nb){
+			if(child + 1 < curr_heap->entry_nb \
+					&& GET_ERASE_COUNT(curr_heap->entry[child + 1]) < GET_ERASE_COUNT(curr_heap->entry[child])){
+				child++;
+			}
+			if(erase_count <= GET_ERASE_COUNT(curr_heap->entry[child])){
+				break;
+			}
+			curr_heap->entry[index] = curr_heap->entry[child];
+			index = child;
+		}
+		curr_heap->entry[index] = last_entry;
+	}
+
+	min_entry->next = NULL;
+	return min_entry;
+}
+
+/* Move the cold data out of the least erased block,
+	if the erase count spread is bigger than WL_THRESHOLD */
+void WEAR_LEVELING_CHECK(void)
+{
+	int64_t i;
+	unsigned int phy_flash_nb;
+	unsigned int phy_block_nb;
+	unsigned int curr_min_erase_count = (unsigned int)-1;
+	int64_t cold_block_index = -1;
+	unsigned int cold_erase_count = (unsigned int)-1;
+	block_state_entry* b_s_entry;
+
+	/* Bound the migration traffic, the copies cause the erases too */
+	if(total_erase_nb - wl_check_erase_nb < WL_CHECK_INTERVAL){
+		return;
+	}
+	wl_check_erase_nb = total_erase_nb;
+
+	if(max_erase_count - min_erase_count < WL_THRESHOLD){
+		return;
+	}
+
+	/* Leave the empty blocks to the foreground GC */
+	if(total_empty_block_nb <= FLASH_NB * PLANES_PER_FLASH + 1){
+		return;
+	}
+
+	/* Find the least erased full data block */
+	for(i=0;i<BLOCK_MAPPING_ENTRY_NB;i++){
+		b_s_entry = (block_state_entry*)((char*)block_state_table + i * block_state_entry_size);
+
+		if(b_s_entry->erase_count < curr_min_erase_count){
+			curr_min_erase_count = b_s_entry->erase_count;
+		}
+
+		if(b_s_entry->type == DATA_BLOCK && b_s_entry->erase_count < cold_erase_count \
+				&& GET_VICTIM_BLOCK_ENTRY(i / BLOCK_NB, i % BLOCK_NB) != NULL){
+			cold_erase_count = b_s_entry->erase_count;
+			cold_block_index = i;
+		}
+	}
+	min_erase_count = curr_min_erase_count;
+
+	if(cold_block_index == -1 || max_erase_count - cold_erase_count < WL_THRESHOLD){
+		return;
+	}
+
+	phy_flash_nb = (unsigned int)(cold_block_index / BLOCK_NB);
+	phy_block_nb = (unsigned int)(cold_block_index % BLOCK_NB);
+
+	STATIC_WEAR_LEVELING(phy_flash_nb, phy_block_nb);
+}
+
+/* Copy the valid pages of the block, and return it to the empty block list */
+int STATIC_WEAR_LEVELING(unsigned int phy_flash_nb, unsigned int phy_block_nb)
+{
+	int i;
+	int ret;
+	int valid_page_nb;
+	int copy_page_nb = 0;
+	int plane_nb = phy_block_nb % PLANES_PER_FLASH;
+	int mapping_index = plane_nb * FLASH_NB + phy_flash_nb;
+
+	uint64_t* valid_bitmap;
+	block_state_entry* b_s_entry = GET_BLOCK_STATE_ENTRY(phy_flash_nb, phy_block_nb);
+	victim_block_entry* v_b_entry = GET_VICTIM_BLOCK_ENTRY(phy_flash_nb, phy_block_nb);
+
+	if(v_b_entry == NULL){
+		printf("ERROR[%s] The block is not full\n", __FUNCTION__);
+		return FAIL;
+	}
+	EJECT_VICTIM_BLOCK(v_b_entry);
+
+	valid_bitmap = VALID_BITMAP(b_s_entry->page_bitmap);
+	valid_page_nb = b_s_entry->valid_page_nb;
+
+#ifdef FTL_MAP_CACHE
+	CACHE_BEGIN_BATCH_UPDATE();
+#endif
+	for(i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, 0); i != -1; i=FIND_NEXT_BIT(valid_bitmap, PAGE_NB, i+1)){
+		ret = COPY_VALID_PAGE(phy_flash_nb, phy_block_nb, i, mapping_index, WL_READ, WL_WRITE);
+		if(ret == FAIL){
+			return FAIL;
+		}
+		copy_page_nb++;
+	}
+#ifdef FTL_MAP_CACHE
+	if(CACHE_END_BATCH_UPDATE() == FAIL){
+		printf("ERROR[%s] Map update fail\n", __FUNCTION__);
+	}
+#endif
+
+	if(copy_page_nb != valid_page_nb){
+		printf("ERROR[%s] The number of valid page is not correct\n", __FUNCTION__);
+		return FAIL;
+	}
+
+	SSD_BLOCK_ERASE(phy_flash_nb, phy_block_nb);
+#ifdef FTL_MULTI_PLANE
+	CLEAR_STRIPE_PEER(phy_flash_nb, phy_block_nb);
+#endif
+	COUNT_BLOCK_ERASE(phy_flash_nb, phy_block_nb);
+	UPDATE_BLOCK_STATE(phy_flash_nb, phy_block_nb, EMPTY_BLOCK);
+	INSERT_EMPTY_BLOCK(phy_flash_nb, phy_block_nb);
+
+	wl_block_nb++;
+	wl_page_nb += copy_page_nb;
+
+	return SUCCESS;
+}
+#endif
@@ -0,0 +1,44 @@
+// File: ftl_wear_leveling_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _WEAR_LEVELING_MANAGER_H_
+#define _WEAR_LEVELING_MANAGER_H_
+
+extern unsigned int max_erase_count;
+extern unsigned int min_erase_count;
+extern int64_t total_erase_nb;
+
+#ifdef FTL_WEAR_LEVELING
+/* At most one static wear leveling for this number of erases */
+#define WL_CHECK_INTERVAL	(FLASH_NB * PLANES_PER_FLASH)
+
+/* Empty blocks of a plane, min-heap ordered by the erase count.
+	The head of the empty block list (the block being written) is not in the heap */
+typedef struct empty_block_heap
+{
+	struct empty_block_entry** entry;
+	unsigned int entry_nb;
+}empty_block_heap;
+
+extern int64_t wl_block_nb;
+extern int64_t wl_page_nb;
+#endif
+
+void INIT_WEAR_LEVELING(void);
+void TERM_WEAR_LEVELING(void);
+
+void COUNT_BLOCK_ERASE(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+
+#ifdef FTL_WEAR_LEVELING
+int PUSH_EMPTY_BLOCK_HEAP(int mapping_index, empty_block_entry* e_b_entry);
+empty_block_entry* POP_EMPTY_BLOCK_HEAP(int mapping_index);
+
+void WEAR_LEVELING_CHECK(void);
+int STATIC_WEAR_LEVELING(unsigned int phy_flash_nb, unsigned int phy_block_nb);
+#endif
+
+#endif
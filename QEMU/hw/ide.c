@@ -2414,6 +2414,7 @@ if(SSD_IS_SUPPORT_TRIM() == 1)
 			QEMUIOVector iov;
 			void* mem;
 			target_phys_addr_t cur_addr, cur_len, sg_cur_byte;
+			unsigned int trim_len;
 			int sg_cur_index;
 
 			sg_cur_byte = 0;
@@ -2436,7 +2437,23 @@ if(SSD_IS_SUPPORT_TRIM() == 1)
 		 			++sg_cur_index;
 				}
 			}
-		SSD_DSM_TRIM(iov.iov[0].iov_len, iov.iov[0].iov_base);
+			/* The range entries may span several sg entries */
+			trim_len = 0;
+			for(sg_cur_index = 0; sg_cur_index < iov.niov; sg_cur_index++)
+			{
+				cur_len = iov.iov[sg_cur_index].iov_len;
+				if(trim_len + cur_len > IDE_DMA_BUF_SECTORS * 512)
+					cur_len = IDE_DMA_BUF_SECTORS * 512 - trim_len;
+
+				memcpy(s->io_buffer + trim_len, iov.iov[sg_cur_index].iov_base, cur_len);
+				trim_len += cur_len;
+
+				cpu_physical_memory_unmap(iov.iov[sg_cur_index].iov_base,
+						iov.iov[sg_cur_index].iov_len, 0, iov.iov[sg_cur_index].iov_len);
+			}
+			qemu_iovec_destroy(&iov);
+
+		SSD_DSM_TRIM(trim_len, s->io_buffer);
 	}
 }
 #endif
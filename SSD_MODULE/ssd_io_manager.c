@@ -16,25 +16,63 @@ int* reg_io_type;	// SEQ, RAN, MERGE, GC, etc..
 
 int64_t* reg_io_time;
 int64_t* cell_io_time;
+int64_t* reg_issue_time;	// The command was issued to the plane
+
+#ifdef VIRTUAL_TIME
+unsigned int* reg_io_seq;	// Sequence number of the scheduled completion
+#endif
+
+/* Cache register, the previous command still holding the array (WRITE) or the cache register (READ) */
+int* cache_io_cmd;
+int64_t* cache_io_time;
 
 int** access_nb;
 int64_t* io_overhead;
 
+/* Program & erase suspend, the command of the plane stopped by a host read */
+int* suspend_io_cmd;
+int* suspend_io_type;
+int64_t* suspend_io_time;	// Time left of the suspended command
+int64_t* suspend_start_time;	// The array stopped at
+int64_t* suspend_issue_time;
+int** suspend_access_nb;
+int* suspend_nb;		// Suspends of the command in progress
+
 int old_channel_nb;
 int old_channel_cmd;
 int64_t old_channel_time;
 
+/* Channel Bandwidth Model : the bus of each channel is busy until this time */
+int64_t* ch_busy_time;
+
+/* Vectored IO, the buffers are kept across the requests */
+nand_io_vec* io_vec_list;
+int* io_vec_order;		// Issue order of the pages
+int* io_vec_rank_nb;		// Pages of each rank
+int* io_vec_reg_rank;		// [reg] pages of the plane in the vector so far
+int io_vec_size;
+
 int64_t init_diff_reg=0;
 
 int64_t io_alloc_overhead=0;
 int64_t io_update_overhead=0;
 
+/* Preconditioning : the NAND operations take no time and are not recorded */
+int ssd_timing_off=0;
+
+/* Page programs & read-modify-writes, for the write amplification */
+int64_t ssd_program_page_nb=0;
+int64_t ssd_partial_write_nb=0;
+
 char ssd_version[4] = "1.2";
 char ssd_date[9] = "17.11.10";
 
 
 int64_t get_usec(void)
 {
+#ifdef VIRTUAL_TIME
+	return GET_VIRTUAL_TIME();
+#else
 	int64_t t = 0;
 	struct timeval tv;
 	struct timezone tz;
@@ -45,6 +83,7 @@ int64_t get_usec(void)
 	t += tv.tv_usec;
 
 	return t;
+#endif
 }
 
 int SSD_IO_INIT(void){
@@ -59,6 +98,11 @@ int SSD_IO_INIT(void){
 	old_channel_cmd = NOOP;
 	old_channel_time = 0;
 
+	ch_busy_time = (int64_t *)malloc(sizeof(int64_t) * CHANNEL_NB);
+	for(i=0; i< CHANNEL_NB; i++){
+		*(ch_busy_time + i) = 0;
+	}
+
 	/* Init Variable for Time-stamp */
 
 	/* Init Command and Command type */
@@ -82,6 +126,11 @@ int SSD_IO_INIT(void){
 	for(i=0; i< FLASH_NB*PLANES_PER_FLASH; i++){
 		*(cell_io_time + i) = -1;
 	}
+
+	reg_issue_time = (int64_t *)malloc(sizeof(int64_t) * FLASH_NB * PLANES_PER_FLASH);
+	for(i=0; i< FLASH_NB*PLANES_PER_FLASH; i++){
+		*(reg_issue_time + i) = 0;
+	}
   
 	/* Init Access sequence_nb */
 	access_nb = (int **)malloc(sizeof(int*) * FLASH_NB * PLANES_PER_FLASH);
@@ -97,23 +146,97 @@ int SSD_IO_INIT(void){
 		*(io_overhead + i) = 0;
 	}
 
+	/* Init Cache Register */
+	cache_io_cmd = (int *)malloc(sizeof(int) * FLASH_NB * PLANES_PER_FLASH);
+	cache_io_time = (int64_t *)malloc(sizeof(int64_t) * FLASH_NB * PLANES_PER_FLASH);
+	for(i=0; i< FLASH_NB*PLANES_PER_FLASH; i++){
+		cache_io_cmd[i] = NOOP;
+		cache_io_time[i] = -1;
+	}
+
+	/* Init Suspended Command */
+	suspend_io_cmd = (int *)malloc(sizeof(int) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_io_type = (int *)malloc(sizeof(int) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_io_time = (int64_t *)malloc(sizeof(int64_t) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_start_time = (int64_t *)malloc(sizeof(int64_t) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_issue_time = (int64_t *)malloc(sizeof(int64_t) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_access_nb = (int **)malloc(sizeof(int*) * FLASH_NB * PLANES_PER_FLASH);
+	suspend_nb = (int *)malloc(sizeof(int) * FLASH_NB * PLANES_PER_FLASH);
+	for(i=0; i< FLASH_NB*PLANES_PER_FLASH; i++){
+		suspend_io_cmd[i] = NOOP;
+		suspend_io_type[i] = NOOP;
+		suspend_io_time[i] = 0;
+		suspend_start_time[i] = 0;
+		suspend_issue_time[i] = 0;
+		suspend_access_nb[i] = (int*)malloc(sizeof(int)*2);
+		suspend_access_nb[i][0] = -1;
+		suspend_access_nb[i][1] = -1;
+		suspend_nb[i] = 0;
+	}
+
+	/* Init Vectored IO */
+	io_vec_list = NULL;
+	io_vec_order = NULL;
+	io_vec_rank_nb = NULL;
+	io_vec_size = 0;
+	io_vec_reg_rank = (int *)calloc(FLASH_NB * PLANES_PER_FLASH, sizeof(int));
+
+#ifdef VIRTUAL_TIME
+	/* Init Completion Sequence Number */
+	reg_io_seq = (unsigned int *)calloc(FLASH_NB * PLANES_PER_FLASH, sizeof(unsigned int));
+
+	INIT_TIME_MANAGER();
+	INIT_SCHED_MANAGER();
+#endif
+
 	return 0;
 }
 
 int SSD_PAGE_WRITE(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
+{
+#ifdef VIRTUAL_TIME
+	/* GC & WL writes wait in the queue of the plane */
+	if(ssd_timing_off == 0 && SSD_SCHED_SUBMIT(WRITE, flash_nb, block_nb, page_nb, n_io_info) == SUCCESS){
+		return SUCCESS;
+	}
+#endif
+
+	_SSD_PAGE_WRITE(flash_nb, block_nb, page_nb, n_io_info);
+
+	if(n_io_info != NULL){
+		FREE_NAND_IO_INFO(n_io_info);
+	}
+
+	return SUCCESS;
+}
+
+/* Issue the page write, n_io_info is not freed */
+int _SSD_PAGE_WRITE(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
 {
 	int channel, reg;
 	int ret = FAIL;
 	int delay_ret;
 
+	if(ssd_timing_off == 1){
+		return SUCCESS;
+	}
+	ssd_program_page_nb++;
+
 	/* Calculate ch & reg */
 	channel = flash_nb % CHANNEL_NB;
 	reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
 
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, 1);
+#endif
+
 	/* Delay Operation */
 	SSD_CH_ENABLE(channel);	// channel enable	
 
-	if( IO_PARALLELISM == 0 ){
+	if( CACHE_MODE == 1 ){
+		delay_ret = SSD_CACHE_ACCESS(flash_nb, reg, WRITE);
+	}
+	else if( IO_PARALLELISM == 0 ){
 		delay_ret = SSD_FLASH_ACCESS(flash_nb, reg);
 	}
 	else{
@@ -129,6 +252,9 @@ int SSD_PAGE_WRITE(unsigned int flash_nb, unsigned int block_nb, unsigned int pa
 	SSD_CH_RECORD(channel, WRITE, delay_ret, n_io_info);
 	SSD_REG_RECORD(reg, WRITE, channel, n_io_info);
 	SSD_CELL_RECORD(reg, WRITE);
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+#endif
 
 #ifdef O_DIRECT_VSSIM
 	if(offset == (n_io_info->io_page_nb-1)){
@@ -136,14 +262,29 @@ int SSD_PAGE_WRITE(unsigned int flash_nb, unsigned int block_nb, unsigned int pa
 	}
 #endif
 
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, -1);
+#endif
+
+	return SUCCESS;
+}
+
+int SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb, \
+	unsigned int old_page_nb, unsigned int new_flash_nb, unsigned int new_block_nb, \
+	unsigned int new_page_nb, nand_io_info* n_io_info)
+{
+	_SSD_PAGE_PARTIAL_WRITE(old_flash_nb, old_block_nb, old_page_nb, \
+			new_flash_nb, new_block_nb, new_page_nb, n_io_info);
+
 	if(n_io_info != NULL){
-		free(n_io_info);
+		FREE_NAND_IO_INFO(n_io_info);
 	}
 
 	return SUCCESS;
 }
 
-int SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb, \
+/* Issue the read-modify-write of the page, n_io_info is not freed */
+int _SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb, \
 	unsigned int old_page_nb, unsigned int new_flash_nb, unsigned int new_block_nb, \
 	unsigned int new_page_nb, nand_io_info* n_io_info)
 {
@@ -151,12 +292,23 @@ int SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb,
 	int ret = FAIL;
 	int delay_ret;
 
+	if(ssd_timing_off == 1){
+		return SUCCESS;
+	}
+	ssd_program_page_nb++;
+	ssd_partial_write_nb++;
+
 	/* READ Partial Data */
 
 	/* Calculate ch & reg */
 	channel = old_flash_nb % CHANNEL_NB;
 	reg = old_flash_nb*PLANES_PER_FLASH + old_block_nb%PLANES_PER_FLASH;
 
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOST_ACCESS(reg, old_block_nb, READ);
+	SSD_SCHED_HOLD(reg, 1);
+#endif
+
 	/* Delay Operation */
 	SSD_CH_ENABLE(channel);	// channel enable	
 
@@ -174,157 +326,942 @@ int SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb,
 
 	/* Record Time Stamp */
 	SSD_CH_RECORD(channel, READ, delay_ret, n_io_info);
-	SSD_REG_RECORD(reg, READ, channel, n_io_info);
 	SSD_CELL_RECORD(reg, READ);
+	SSD_REG_RECORD(reg, READ, channel, n_io_info);
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+#endif
 
 	SSD_REMAIN_IO_DELAY(reg);
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, -1);
+#endif
 
 	/* Write 1 Page */
 
-	/* Calculate ch & reg */
-	channel = new_flash_nb % CHANNEL_NB;
-	reg = new_flash_nb*PLANES_PER_FLASH + new_block_nb%PLANES_PER_FLASH;
+	/* Calculate ch & reg */
+	channel = new_flash_nb % CHANNEL_NB;
+	reg = new_flash_nb*PLANES_PER_FLASH + new_block_nb%PLANES_PER_FLASH;
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOST_ACCESS(reg, new_block_nb, WRITE);
+	SSD_SCHED_HOLD(reg, 1);
+#endif
+
+	/* Delay Operation */
+	SSD_CH_ENABLE(channel);	// channel enable	
+
+	if( IO_PARALLELISM == 0 ){
+		delay_ret = SSD_FLASH_ACCESS(new_flash_nb, reg);
+	}
+	else{
+		delay_ret = SSD_REG_ACCESS(reg);
+	}	
+	
+	/* Check Channel Operation */
+	while(ret == FAIL){
+		ret = SSD_CH_ACCESS(channel);
+	}
+
+	/* Record Time Stamp */
+	SSD_CH_RECORD(channel, WRITE, delay_ret, n_io_info);
+	SSD_REG_RECORD(reg, WRITE, channel, n_io_info);
+	SSD_CELL_RECORD(reg, WRITE);
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+#endif
+
+#ifdef O_DIRECT_VSSIM
+	if(offset == (n_io_info->io_page_nb-1)){
+		SSD_REMAIN_IO_DELAY(reg);
+	}
+#endif
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, -1);
+#endif
+
+	return SUCCESS;	
+}
+
+int SSD_PAGE_READ(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
+{
+#ifdef VIRTUAL_TIME
+	if(ssd_timing_off == 0 && SSD_SCHED_SUBMIT(READ, flash_nb, block_nb, page_nb, n_io_info) == SUCCESS){
+		return SUCCESS;
+	}
+#endif
+
+	_SSD_PAGE_READ(flash_nb, block_nb, page_nb, n_io_info);
+
+	if(n_io_info != NULL){
+		FREE_NAND_IO_INFO(n_io_info);
+	}
+
+	return SUCCESS;
+}
+
+/* Issue the page read, n_io_info is not freed */
+int _SSD_PAGE_READ(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
+{
+	int channel, reg;
+	int delay_ret;
+
+	if(ssd_timing_off == 1){
+		return SUCCESS;
+	}
+
+	/* Calculate ch & reg */
+	channel = flash_nb % CHANNEL_NB;
+	reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, 1);
+#endif
+
+	/* Delay Operation */
+	SSD_CH_ENABLE(channel);	// channel enable
+
+	/* The host read does not wait for the program or the erase of the plane */
+	if(n_io_info != NULL && n_io_info->type == READ){
+		SSD_SUSPEND(flash_nb, reg);
+	}
+
+	/* Access Register */
+	if( CACHE_MODE == 1 ){
+		delay_ret = SSD_CACHE_ACCESS(flash_nb, reg, READ);
+	}
+	else if( IO_PARALLELISM == 0 ){
+		delay_ret = SSD_FLASH_ACCESS(flash_nb, reg);
+	}
+	else{
+		delay_ret = SSD_REG_ACCESS(reg);
+	}
+
+	/* Record Time Stamp */
+	SSD_CH_RECORD(channel, READ, delay_ret, n_io_info);
+	SSD_CELL_RECORD(reg, READ);
+	SSD_REG_RECORD(reg, READ, channel, n_io_info);
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+#endif
+
+#ifdef O_DIRECT_VSSIM
+	if(offset == (n_io_info->io_page_nb - 1)){
+		SSD_REMAIN_IO_DELAY(reg);
+	}
+#endif
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, -1);
+#endif
+
+	return SUCCESS;
+}
+
+int SSD_BLOCK_ERASE(unsigned int flash_nb, unsigned int block_nb)
+{
+	int channel, reg;
+
+	if(ssd_timing_off == 1){
+		return SUCCESS;
+	}
+
+#ifdef VIRTUAL_TIME
+	if(ssd_timing_off == 0 && SSD_SCHED_SUBMIT(ERASE, flash_nb, block_nb, 0, NULL) == SUCCESS){
+		return SUCCESS;
+	}
+#endif
+
+	/* Calculate ch & reg */
+	channel = flash_nb % CHANNEL_NB;
+	reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHED_HOLD(reg, 1);
+#endif
+
+	/* Delay Operation */
+	if( IO_PARALLELISM == 0 ){
+		SSD_FLASH_ACCESS(flash_nb, reg);
+	}
+	else{
+		SSD_REG_ACCESS(reg);
+	}
+
+       	/* Record Time Stamp */
+	SSD_REG_RECORD(reg, ERASE, channel, NULL);
+	SSD_CELL_RECORD(reg, ERASE);
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+	SSD_SCHED_HOLD(reg, -1);
+#endif
+
+	return SUCCESS;
+}
+
+/* Vectored IO : the pages of a host request are issued in one pass.
+	The descriptors are from SSD_GET_IO_VEC, n_io_info of the pages are in the descriptors */
+nand_io_vec* SSD_GET_IO_VEC(int vec_nb)
+{
+	nand_io_vec* new_list;
+	int* new_order;
+	int* new_rank_nb;
+
+	if(vec_nb <= io_vec_size){
+		return io_vec_list;
+	}
+
+	new_list = (nand_io_vec*)realloc(io_vec_list, sizeof(nand_io_vec) * vec_nb);
+	if(new_list != NULL){
+		io_vec_list = new_list;
+	}
+	new_order = (int*)realloc(io_vec_order, sizeof(int) * vec_nb);
+	if(new_order != NULL){
+		io_vec_order = new_order;
+	}
+	new_rank_nb = (int*)realloc(io_vec_rank_nb, sizeof(int) * (vec_nb + 1));
+	if(new_rank_nb != NULL){
+		io_vec_rank_nb = new_rank_nb;
+	}
+
+	if(new_list == NULL || new_order == NULL || new_rank_nb == NULL){
+		printf("ERROR[%s] Realloc io vector fail\n", __FUNCTION__);
+		return NULL;
+	}
+	io_vec_size = vec_nb;
+
+	return io_vec_list;
+}
+
+/* The plane of the page, the flash without IO_PARALLELISM */
+int SSD_GET_IO_VEC_REG(nand_io_vec* curr_vec)
+{
+	if( IO_PARALLELISM == 0 ){
+		return curr_vec->flash_nb * PLANES_PER_FLASH;
+	}
+
+	return curr_vec->flash_nb * PLANES_PER_FLASH + curr_vec->block_nb % PLANES_PER_FLASH;
+}
+
+/* The first page of every plane goes before the second page of any plane,
+	the pages of a rank keep the order of the vector */
+void SSD_ORDER_IO_VEC(nand_io_vec* io_vec, int vec_nb)
+{
+	int i;
+	int reg;
+	int rank;
+
+	for(i=0;i<vec_nb;i++){
+		io_vec_reg_rank[SSD_GET_IO_VEC_REG(io_vec + i)] = 0;
+	}
+	for(i=0;i<=vec_nb;i++){
+		io_vec_rank_nb[i] = 0;
+	}
+
+	/* Pages of each rank, then the first index of the rank */
+	for(i=0;i<vec_nb;i++){
+		reg = SSD_GET_IO_VEC_REG(io_vec + i);
+		io_vec_rank_nb[io_vec_reg_rank[reg] + 1]++;
+		io_vec_reg_rank[reg]++;
+	}
+	for(i=1;i<=vec_nb;i++){
+		io_vec_rank_nb[i] += io_vec_rank_nb[i-1];
+	}
+
+	for(i=0;i<vec_nb;i++){
+		io_vec_reg_rank[SSD_GET_IO_VEC_REG(io_vec + i)] = 0;
+	}
+	for(i=0;i<vec_nb;i++){
+		reg = SSD_GET_IO_VEC_REG(io_vec + i);
+		rank = io_vec_reg_rank[reg]++;
+		io_vec_order[io_vec_rank_nb[rank]++] = i;
+	}
+}
+
+/* Return the time the last page of the vector is read out */
+int64_t SSD_PAGE_READV(nand_io_vec* io_vec, int vec_nb)
+{
+	int i;
+	int reg;
+	nand_io_vec* curr_vec;
+	int64_t due_time;
+	int64_t end_time = get_usec();
+
+	if(ssd_timing_off == 1){
+		return end_time;
+	}
+
+	SSD_ORDER_IO_VEC(io_vec, vec_nb);
+
+	for(i=0;i<vec_nb;i++){
+		curr_vec = io_vec + io_vec_order[i];
+		reg = curr_vec->flash_nb*PLANES_PER_FLASH + curr_vec->block_nb%PLANES_PER_FLASH;
+
+#ifdef VIRTUAL_TIME
+		SSD_SCHED_HOST_ACCESS(reg, curr_vec->block_nb, READ);
+#endif
+		_SSD_PAGE_READ(curr_vec->flash_nb, curr_vec->block_nb, curr_vec->page_nb, &curr_vec->io_info);
+
+		due_time = SSD_GET_REG_DUE_TIME(reg);
+		if(due_time > end_time){
+			end_time = due_time;
+		}
+	}
+
+	return end_time;
+}
+
+/* Return the time the last page of the vector is programmed.
+	A page with old_flash_nb is a partial write, the old page is read first */
+int64_t SSD_PAGE_WRITEV(nand_io_vec* io_vec, int vec_nb)
+{
+	int i;
+	int reg;
+	nand_io_vec* curr_vec;
+	int64_t due_time;
+	int64_t end_time = get_usec();
+
+	if(ssd_timing_off == 1){
+		return end_time;
+	}
+
+	SSD_ORDER_IO_VEC(io_vec, vec_nb);
+
+	for(i=0;i<vec_nb;i++){
+		curr_vec = io_vec + io_vec_order[i];
+		reg = curr_vec->flash_nb*PLANES_PER_FLASH + curr_vec->block_nb%PLANES_PER_FLASH;
+
+		if(curr_vec->old_flash_nb != -1){
+			_SSD_PAGE_PARTIAL_WRITE(curr_vec->old_flash_nb, curr_vec->old_block_nb, curr_vec->old_page_nb, \
+					curr_vec->flash_nb, curr_vec->block_nb, curr_vec->page_nb, &curr_vec->io_info);
+		}
+		else{
+#ifdef VIRTUAL_TIME
+			SSD_SCHED_HOST_ACCESS(reg, curr_vec->block_nb, WRITE);
+#endif
+			_SSD_PAGE_WRITE(curr_vec->flash_nb, curr_vec->block_nb, curr_vec->page_nb, &curr_vec->io_info);
+		}
+
+		due_time = SSD_GET_REG_DUE_TIME(reg);
+		if(due_time > end_time){
+			end_time = due_time;
+		}
+	}
+
+	return end_time;
+}
+
+/* Multi-plane Operations :
+	block_list[plane_nb] is the block of the plane, -1 if the plane is not in the set.
+	The planes of the set share the page offset and one cell delay */
+int SSD_MULTI_PLANE_WRITE(unsigned int flash_nb, int32_t* block_list, unsigned int page_nb, nand_io_info** n_io_info_list)
+{
+	int i;
+	int channel, reg;
+	int last_reg = -1;
+	int ret = FAIL;
+	int delay_ret = 0;
+
+	if(SSD_CHECK_PLANE_SET(block_list) == 0){
+		return FAIL;
+	}
+
+	if(ssd_timing_off == 1){
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(block_list[i] != -1 && n_io_info_list[i] != NULL){
+				FREE_NAND_IO_INFO(n_io_info_list[i]);
+				n_io_info_list[i] = NULL;
+			}
+		}
+		return SUCCESS;
+	}
+
+#ifdef VIRTUAL_TIME
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_HOST_ACCESS(flash_nb*PLANES_PER_FLASH + i, block_list[i], WRITE);
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, 1);
+		}
+	}
+#endif
+
+	/* Calculate ch */
+	channel = flash_nb % CHANNEL_NB;
+
+	/* Delay Operation */
+	SSD_CH_ENABLE(channel);	// channel enable
+
+	if( IO_PARALLELISM == 0 ){
+		delay_ret = SSD_FLASH_ACCESS(flash_nb, flash_nb*PLANES_PER_FLASH);
+	}
+	else{
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(block_list[i] != -1){
+				delay_ret = SSD_REG_ACCESS(flash_nb*PLANES_PER_FLASH + i);
+			}
+		}
+	}
+
+	/* Check Channel Operation */
+	while(ret == FAIL){
+		ret = SSD_CH_ACCESS(channel);
+	}
+
+	/* Data in of the planes, back to back on the channel */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		reg = flash_nb*PLANES_PER_FLASH + i;
+
+		if(last_reg == -1){
+			SSD_CH_RECORD(channel, WRITE, delay_ret, n_io_info_list[i]);
+		}
+		else{
+			old_channel_time += REG_WRITE_DELAY;
+		}
+		SSD_REG_RECORD(reg, WRITE, channel, n_io_info_list[i]);
+		last_reg = reg;
+		ssd_program_page_nb++;
+	}
+
+	/* The program starts after the last data in, on all the planes */
+	SSD_CELL_RECORD(last_reg, WRITE);
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		reg = flash_nb*PLANES_PER_FLASH + i;
+
+		cell_io_time[reg] = cell_io_time[last_reg];
+#ifdef VIRTUAL_TIME
+		SSD_SCHEDULE_COMPLETION(reg);
+#endif
+		if(n_io_info_list[i] != NULL){
+			FREE_NAND_IO_INFO(n_io_info_list[i]);
+			n_io_info_list[i] = NULL;
+		}
+	}
+
+#ifdef VIRTUAL_TIME
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, -1);
+		}
+	}
+#endif
+	return SUCCESS;
+}
+
+int SSD_MULTI_PLANE_READ(unsigned int flash_nb, int32_t* block_list, unsigned int page_nb, nand_io_info** n_io_info_list)
+{
+	int i;
+	int channel, reg;
+	int first = 1;
+	int host_read = 0;
+	int delay_ret = 0;
+
+	if(SSD_CHECK_PLANE_SET(block_list) == 0){
+		return FAIL;
+	}
+
+	if(ssd_timing_off == 1){
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(block_list[i] != -1 && n_io_info_list[i] != NULL){
+				FREE_NAND_IO_INFO(n_io_info_list[i]);
+				n_io_info_list[i] = NULL;
+			}
+		}
+		return SUCCESS;
+	}
+
+#ifdef VIRTUAL_TIME
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_HOST_ACCESS(flash_nb*PLANES_PER_FLASH + i, block_list[i], READ);
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, 1);
+		}
+	}
+#endif
+
+	/* Calculate ch */
+	channel = flash_nb % CHANNEL_NB;
+
+	/* Delay Operation */
+	SSD_CH_ENABLE(channel);	// channel enable
+
+	/* The host read does not wait for the programs or the erases of the planes */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1 && n_io_info_list[i] != NULL && n_io_info_list[i]->type == READ){
+			host_read = 1;
+		}
+	}
+	if(host_read == 1){
+		if( IO_PARALLELISM == 0 ){
+			SSD_SUSPEND(flash_nb, flash_nb*PLANES_PER_FLASH);
+		}
+		else{
+			for(i=0;i<PLANES_PER_FLASH;i++){
+				if(block_list[i] != -1){
+					SSD_SUSPEND(flash_nb, flash_nb*PLANES_PER_FLASH + i);
+				}
+			}
+		}
+	}
+
+	/* Access Register */
+	if( IO_PARALLELISM == 0 ){
+		delay_ret = SSD_FLASH_ACCESS(flash_nb, flash_nb*PLANES_PER_FLASH);
+	}
+	else{
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(block_list[i] != -1){
+				delay_ret = SSD_REG_ACCESS(flash_nb*PLANES_PER_FLASH + i);
+			}
+		}
+	}
+
+	/* The planes sense the cells together */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		if(first){
+			SSD_CH_RECORD(channel, READ, delay_ret, n_io_info_list[i]);
+			first = 0;
+		}
+		SSD_CELL_RECORD(flash_nb*PLANES_PER_FLASH + i, READ);
+	}
+
+	/* Data out of the planes, one after another on the channel */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		reg = flash_nb*PLANES_PER_FLASH + i;
+
+		SSD_REG_RECORD(reg, READ, channel, n_io_info_list[i]);
+#ifdef VIRTUAL_TIME
+		SSD_SCHEDULE_COMPLETION(reg);
+#endif
+		if(n_io_info_list[i] != NULL){
+			FREE_NAND_IO_INFO(n_io_info_list[i]);
+			n_io_info_list[i] = NULL;
+		}
+	}
+
+#ifdef VIRTUAL_TIME
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, -1);
+		}
+	}
+#endif
+	return SUCCESS;
+}
+
+int SSD_MULTI_PLANE_ERASE(unsigned int flash_nb, int32_t* block_list)
+{
+	int i;
+	int channel, reg;
+
+	if(SSD_CHECK_PLANE_SET(block_list) == 0){
+		return FAIL;
+	}
+
+	if(ssd_timing_off == 1){
+		return SUCCESS;
+	}
+
+#ifdef VIRTUAL_TIME
+	/* The erase of the planes can not wait in the queue of a plane */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_DRAIN(flash_nb*PLANES_PER_FLASH + i);
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, 1);
+		}
+	}
+#endif
+
+	/* Calculate ch */
+	channel = flash_nb % CHANNEL_NB;
+
+	/* Delay Operation */
+	if( IO_PARALLELISM == 0 ){
+		SSD_FLASH_ACCESS(flash_nb, flash_nb*PLANES_PER_FLASH);
+	}
+	else{
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(block_list[i] != -1){
+				SSD_REG_ACCESS(flash_nb*PLANES_PER_FLASH + i);
+			}
+		}
+	}
+
+	/* Record Time Stamp */
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		reg = flash_nb*PLANES_PER_FLASH + i;
+
+		SSD_REG_RECORD(reg, ERASE, channel, NULL);
+		SSD_CELL_RECORD(reg, ERASE);
+#ifdef VIRTUAL_TIME
+		SSD_SCHEDULE_COMPLETION(reg);
+#endif
+	}
+
+#ifdef VIRTUAL_TIME
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] != -1){
+			SSD_SCHED_HOLD(flash_nb*PLANES_PER_FLASH + i, -1);
+		}
+	}
+#endif
+	return SUCCESS;
+}
+
+/* Return the number of the planes in the set, 0 if the set is not valid */
+int SSD_CHECK_PLANE_SET(int32_t* block_list)
+{
+	int i;
+	int plane_nb = 0;
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(block_list[i] == -1){
+			continue;
+		}
+		if(block_list[i] < 0 || block_list[i] >= BLOCK_NB || block_list[i] % PLANES_PER_FLASH != i){
+			printf("ERROR[%s] Block %d is not in the plane %d\n", __FUNCTION__, block_list[i], i);
+			return 0;
+		}
+		plane_nb++;
+	}
+
+	if(plane_nb == 0){
+		printf("ERROR[%s] There is no plane in the set\n", __FUNCTION__);
+	}
+
+	return plane_nb;
+}
+
+int SSD_FLASH_ACCESS(unsigned int flash_nb, int reg)
+{
+	int i;
+	int r_num = flash_nb * PLANES_PER_FLASH;
+	int ret = 0;
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(reg_io_cmd[r_num] == NOOP){
+			/* That's OK */
+		}
+		else{
+			ret = SSD_REG_ACCESS(r_num);
+		}
+	
+		r_num++;
+	}	
+
+	/* The read resumed the suspended commands of the planes which were passed */
+	r_num = flash_nb * PLANES_PER_FLASH;
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(reg_io_cmd[r_num] != NOOP){
+			ret = SSD_REG_ACCESS(r_num);
+		}
+		r_num++;
+	}
+
+	return ret;
+}
+
+int SSD_REG_ACCESS(int reg)
+{
+	int reg_cmd = reg_io_cmd[reg];
+	int ret = 0;
+
+	if( reg_cmd == NOOP ){
+		/* That's OK */
+	}
+	else if( reg_cmd == READ ){
+		ret = SSD_CELL_READ_DELAY(reg);
+		ret = SSD_REG_READ_DELAY(reg);
+	}
+	else if( reg_cmd == WRITE ){
+		ret = SSD_REG_WRITE_DELAY(reg);
+		ret = SSD_CELL_WRITE_DELAY(reg);
+	}
+	else if( reg_cmd == ERASE ){
+		ret = SSD_BLOCK_ERASE_DELAY(reg);
+	}
+	else{
+		printf("ERROR[%s] Command Error! %d\n", __FUNCTION__, reg_io_cmd[reg]);
+	}
+
+	/* The read resumed the suspended command of the plane */
+	if( reg_cmd == READ && reg_io_cmd[reg] != NOOP ){
+		ret = SSD_REG_ACCESS(reg);
+	}
+
+	return ret;
+}
+
+/* A host read suspends the program or the erase of the plane (the flash, without IO_PARALLELISM).
+	The read waits SUSPEND_DELAY instead of the rest of the command */
+int SSD_SUSPEND(unsigned int flash_nb, int reg)
+{
+	int i;
+	int r_num = flash_nb * PLANES_PER_FLASH;
+	int ret = FAIL;
 
-	/* Delay Operation */
-	SSD_CH_ENABLE(channel);	// channel enable	
+	if(PROGRAM_SUSPEND == 0 && ERASE_SUSPEND == 0){
+		return FAIL;
+	}
 
 	if( IO_PARALLELISM == 0 ){
-		delay_ret = SSD_FLASH_ACCESS(new_flash_nb, reg);
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(SSD_SUSPEND_REG(r_num) == SUCCESS){
+				ret = SUCCESS;
+			}
+			r_num++;
+		}
 	}
 	else{
-		delay_ret = SSD_REG_ACCESS(reg);
-	}	
-	
-	/* Check Channel Operation */
-	while(ret == FAIL){
-		ret = SSD_CH_ACCESS(channel);
-	}
-
-	/* Record Time Stamp */
-	SSD_CH_RECORD(channel, WRITE, delay_ret, n_io_info);
-	SSD_REG_RECORD(reg, WRITE, channel, n_io_info);
-	SSD_CELL_RECORD(reg, WRITE);
-
-#ifdef O_DIRECT_VSSIM
-	if(offset == (n_io_info->io_page_nb-1)){
-		SSD_REMAIN_IO_DELAY(reg);
+		ret = SSD_SUSPEND_REG(reg);
 	}
-#endif
 
-	if(n_io_info != NULL){
-		free(n_io_info);
+	if(ret == SUCCESS){
+		SSD_WAIT_UNTIL(get_usec() + SUSPEND_DELAY);
 	}
 
-	return SUCCESS;	
+	return ret;
 }
 
-int SSD_PAGE_READ(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
+int SSD_SUSPEND_REG(int reg)
 {
-	int channel, reg;
-	int delay_ret;
-
-	/* Calculate ch & reg */
-	channel = flash_nb % CHANNEL_NB;
-	reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
-
-	/* Delay Operation */
-	SSD_CH_ENABLE(channel);	// channel enable
+	int reg_cmd;
+	int64_t curr_time;
+	int64_t due_time;
+
+	/* Another read is on the suspended command, the command is resumed after it */
+	if(reg_io_cmd[reg] == READ && suspend_io_cmd[reg] != NOOP){
+		SSD_CELL_READ_DELAY(reg);
+		SSD_REG_READ_DELAY(reg);
+	}
 
-	/* Access Register */
-	if( IO_PARALLELISM == 0 ){
-		delay_ret = SSD_FLASH_ACCESS(flash_nb, reg);
+	reg_cmd = reg_io_cmd[reg];
+	if(reg_cmd == WRITE){
+		if(PROGRAM_SUSPEND == 0){
+			return FAIL;
+		}
+	}
+	else if(reg_cmd == ERASE){
+		if(ERASE_SUSPEND == 0){
+			return FAIL;
+		}
 	}
 	else{
-		delay_ret = SSD_REG_ACCESS(reg);
+		return FAIL;
 	}
 
-	/* Record Time Stamp */
-	SSD_CH_RECORD(channel, READ, delay_ret, n_io_info);
-	SSD_CELL_RECORD(reg, READ);
-	SSD_REG_RECORD(reg, READ, channel, n_io_info);
+	if(suspend_nb[reg] >= SUSPEND_LIMIT){
+		return FAIL;
+	}
 
-#ifdef O_DIRECT_VSSIM
-	if(offset == (n_io_info->io_page_nb - 1)){
-		SSD_REMAIN_IO_DELAY(reg);
+	curr_time = get_usec();
+
+	/* The page is still coming in, or the array programs the previous page of the cache */
+	if(reg_cmd == WRITE){
+		if(reg_io_time[reg] != -1 && reg_io_time[reg] + REG_WRITE_DELAY > curr_time){
+			return FAIL;
+		}
+		if(cache_io_cmd[reg] == WRITE && cache_io_time[reg] > curr_time){
+			return FAIL;
+		}
 	}
-#endif
 
-	if(n_io_info != NULL){
-		free(n_io_info);
+	/* The command ends before it could stop */
+	due_time = SSD_GET_REG_DUE_TIME(reg);
+	if(due_time <= curr_time + SUSPEND_DELAY){
+		return FAIL;
+	}
+
+	if(reg_cmd == WRITE){
+		/* Data in of the page is over */
+		SSD_REG_WRITE_DELAY(reg);
 	}
 
+	suspend_io_cmd[reg] = reg_cmd;
+	suspend_io_type[reg] = reg_io_type[reg];
+	suspend_io_time[reg] = due_time - curr_time - SUSPEND_DELAY;
+	suspend_start_time[reg] = curr_time + SUSPEND_DELAY;
+	suspend_issue_time[reg] = reg_issue_time[reg];
+	suspend_access_nb[reg][0] = access_nb[reg][0];
+	suspend_access_nb[reg][1] = access_nb[reg][1];
+	suspend_nb[reg]++;
+
+	/* The array is free for the read */
+	reg_io_time[reg] = -1;
+	cell_io_time[reg] = -1;
+	reg_io_cmd[reg] = NOOP;
+	reg_io_type[reg] = NOOP;
+	access_nb[reg][0] = -1;
+	access_nb[reg][1] = -1;
+	io_overhead[reg] = 0;
+
 	return SUCCESS;
 }
 
-int SSD_BLOCK_ERASE(unsigned int flash_nb, unsigned int block_nb)
+/* The read of the plane is over at resume_time, the suspended command goes on */
+void SSD_RESUME(int reg, int64_t resume_time)
 {
-	int channel, reg;
+	int64_t end_time = resume_time + RESUME_DELAY + suspend_io_time[reg];
 
-	/* Calculate ch & reg */
-	channel = flash_nb % CHANNEL_NB;
-	reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
+	reg_io_cmd[reg] = suspend_io_cmd[reg];
+	reg_io_type[reg] = suspend_io_type[reg];
+	reg_issue_time[reg] = suspend_issue_time[reg];
+	access_nb[reg][0] = suspend_access_nb[reg][0];
+	access_nb[reg][1] = suspend_access_nb[reg][1];
+	reg_io_time[reg] = -1;
+	io_overhead[reg] = 0;
 
-	/* Delay Operation */
-	if( IO_PARALLELISM == 0 ){
-		SSD_FLASH_ACCESS(flash_nb, reg);
+	if(reg_io_cmd[reg] == WRITE){
+		cell_io_time[reg] = end_time - CELL_PROGRAM_DELAY;
 	}
 	else{
-		SSD_REG_ACCESS(reg);
+		cell_io_time[reg] = end_time - BLOCK_ERASE_DELAY;
 	}
 
-       	/* Record Time Stamp */
-	SSD_REG_RECORD(reg, ERASE, channel, NULL);
-	SSD_CELL_RECORD(reg, ERASE);
+	RECORD_OP_LATENCY(HIST_SUSPEND, resume_time + RESUME_DELAY - suspend_start_time[reg]);
 
-	return SUCCESS;
+	suspend_io_cmd[reg] = NOOP;
+	suspend_io_type[reg] = NOOP;
+
+#ifdef VIRTUAL_TIME
+	SSD_SCHEDULE_COMPLETION(reg);
+#endif
 }
 
-int SSD_FLASH_ACCESS(unsigned int flash_nb, int reg)
+/* Without IO_PARALLELISM, the read suspended all the planes of the flash,
+	their commands go on after the last read of the flash */
+void SSD_RESUME_FLASH(unsigned int flash_nb, int64_t resume_time)
 {
 	int i;
 	int r_num = flash_nb * PLANES_PER_FLASH;
-	int ret = 0;
 
 	for(i=0;i<PLANES_PER_FLASH;i++){
-		if(reg_io_cmd[r_num] == NOOP){
-			/* That's OK */
+		if(reg_io_cmd[r_num + i] == READ){
+			return;
 		}
-		else{
-			ret = SSD_REG_ACCESS(r_num);
+	}
+
+	for(i=0;i<PLANES_PER_FLASH;i++){
+		if(suspend_io_cmd[r_num] != NOOP){
+			SSD_RESUME(r_num, resume_time);
 		}
-	
 		r_num++;
-	}	
-
-	return ret;
+	}
 }
 
-int SSD_REG_ACCESS(int reg)
+/* Cache program & cache read : a command after the same command of the plane
+	waits for the cache register only, the array goes on with the previous page */
+int SSD_CACHE_ACCESS(unsigned int flash_nb, int reg, int cmd)
 {
-	int reg_cmd = reg_io_cmd[reg];
+	int i;
+	int r_num = flash_nb * PLANES_PER_FLASH;
 	int ret = 0;
 
-	if( reg_cmd == NOOP ){
-		/* That's OK */
+	if(reg_io_cmd[reg] != cmd || suspend_io_cmd[reg] != NOOP){
+		if( IO_PARALLELISM == 0 ){
+			return SSD_FLASH_ACCESS(flash_nb, reg);
+		}
+		return SSD_REG_ACCESS(reg);
 	}
-	else if( reg_cmd == READ ){
-		ret = SSD_CELL_READ_DELAY(reg);
-		ret = SSD_REG_READ_DELAY(reg);
+
+	/* The other planes of the flash */
+	if( IO_PARALLELISM == 0 ){
+		for(i=0;i<PLANES_PER_FLASH;i++){
+			if(r_num != reg && reg_io_cmd[r_num] != NOOP){
+				ret = SSD_REG_ACCESS(r_num);
+			}
+			r_num++;
+		}
 	}
-	else if( reg_cmd == WRITE ){
-		ret = SSD_REG_WRITE_DELAY(reg);
-		ret = SSD_CELL_WRITE_DELAY(reg);
+
+	if(cmd == WRITE){
+		ret = SSD_CACHE_WRITE_DELAY(reg);
 	}
-	else if( reg_cmd == ERASE ){
-		ret = SSD_BLOCK_ERASE_DELAY(reg);
+	else if(cmd == READ){
+		ret = SSD_CACHE_READ_DELAY(reg);
 	}
-	else{
-		printf("ERROR[%s] Command Error! %d\n", __FUNCTION__, reg_io_cmd[reg]);
+
+	return ret;
+}
+
+int SSD_CACHE_WRITE_DELAY(int reg)
+{
+	int ret;
+
+	/* Data in of the previous page */
+	ret = SSD_REG_WRITE_DELAY(reg);
+
+	/* The cache register is free when the previous page moves to the data register */
+	if(get_usec() < cell_io_time[reg]){
+		SSD_WAIT_UNTIL(cell_io_time[reg]);
+		ret = 1;
+	}
+
+	/* The previous page is programmed from the data register */
+	cache_io_cmd[reg] = WRITE;
+	cache_io_time[reg] = cell_io_time[reg] + CELL_PROGRAM_DELAY - io_overhead[reg];
+
+	/* The program is not waited for, it ends at cache_io_time */
+	SEND_TO_PERF_CHECKER(reg_io_type[reg], cache_io_time[reg] - reg_issue_time[reg], REG_OP);
+	SSD_CACHE_COMPLETE(reg);
+
+	return ret;
+}
+
+int SSD_CACHE_READ_DELAY(int reg)
+{
+	int ret;
+
+	/* Cell read of the previous page */
+	ret = SSD_CELL_READ_DELAY(reg);
+
+	/* The data register is free when the previous page moves to the cache register */
+	if(get_usec() < reg_io_time[reg]){
+		SSD_WAIT_UNTIL(reg_io_time[reg]);
+		ret = 1;
 	}
 
+	/* The previous page is sent out from the cache register */
+	cache_io_cmd[reg] = READ;
+	cache_io_time[reg] = reg_io_time[reg] + REG_READ_DELAY;
+
+	SSD_CACHE_COMPLETE(reg);
+
 	return ret;
 }
 
+/* The previous command of the plane ends at cache_io_time, free the register for the next one */
+void SSD_CACHE_COMPLETE(int reg)
+{
+	io_update_overhead = UPDATE_IO_REQUEST(access_nb[reg][0], access_nb[reg][1], cache_io_time[reg], UPDATE_END_TIME);
+	SSD_UPDATE_IO_OVERHEAD(reg, io_update_overhead);
+	access_nb[reg][0] = -1;
+
+	/* Update Time Stamp Struct */
+	reg_io_time[reg] = -1;
+	cell_io_time[reg] = -1;
+	reg_io_cmd[reg] = NOOP;
+	reg_io_type[reg] = NOOP;
+
+	/* Update IO Overhead */
+	io_overhead[reg] = 0;
+}
+
 int SSD_CH_ENABLE(int channel)
 {
 	int64_t do_delay = 0;
@@ -332,6 +1269,10 @@ int SSD_CH_ENABLE(int channel)
 	if(CHANNEL_SWITCH_DELAY_R == 0 && CHANNEL_SWITCH_DELAY_W == 0)
 		return SUCCESS;
 
+	/* Each channel has its own bus */
+	if(CHANNEL_RATE != 0)
+		return SUCCESS;
+
 	if(old_channel_nb != channel){
 		do_delay = SSD_CH_SWITCH_DELAY(channel);
 	}
@@ -345,7 +1286,11 @@ int SSD_CH_RECORD(int channel, int cmd, int ret, nand_io_info* n_io_info)
 	old_channel_cmd = cmd;
 	int offset = n_io_info->offset;
 
-	if(cmd == READ && offset != 0 && ret == 0){
+	/* The transfers are queued on the channel by SSD_CH_RESERVE */
+	if(CHANNEL_RATE != 0){
+		old_channel_time = get_usec();
+	}
+	else if(cmd == READ && offset != 0 && ret == 0){
 		old_channel_time += CHANNEL_SWITCH_DELAY_R;
 	}
 	else if(cmd == WRITE && offset != 0 && ret == 0){
@@ -363,6 +1308,7 @@ int SSD_REG_RECORD(int reg, int cmd, int channel, nand_io_info* n_io_info)
 	int type = -1;
 	int offset = -1;
 	int io_seq_nb = -1;
+	int64_t start_time;
 
 	if(n_io_info != NULL){
 		type = n_io_info->type;
@@ -375,16 +1321,36 @@ int SSD_REG_RECORD(int reg, int cmd, int channel, nand_io_info* n_io_info)
 
 	reg_io_cmd[reg] = cmd;
 	reg_io_type[reg] = type;
+	reg_issue_time[reg] = get_usec();
+
+	/* A new program or erase of the plane */
+	if(cmd == WRITE || cmd == ERASE){
+		suspend_nb[reg] = 0;
+	}
 
 	if(cmd == WRITE){
-		reg_io_time[reg] = old_channel_time+CHANNEL_SWITCH_DELAY_W;
-		SSD_UPDATE_CH_ACCESS_TIME(channel, reg_io_time[reg]);
+		if(CHANNEL_RATE != 0){
+			/* Command & address, then the data in */
+			reg_io_time[reg] = SSD_CH_RESERVE(channel, old_channel_time, CHANNEL_CMD_DELAY + REG_WRITE_DELAY) + CHANNEL_CMD_DELAY;
+		}
+		else{
+			reg_io_time[reg] = old_channel_time+CHANNEL_SWITCH_DELAY_W;
+			SSD_UPDATE_CH_ACCESS_TIME(channel, reg_io_time[reg]);
+		}
 
 		/* Update SATA request Info */
 		if(type == WRITE || type == SEQ_WRITE || type == RAN_WRITE || type == RAN_COLD_WRITE || type == RAN_HOT_WRITE){
+			start_time = old_channel_time;
+
+			/* Cache program, the data in overlaps the program of the previous page.
+				The request starts at the data in which its program would wait for */
+			if(cache_io_cmd[reg] == WRITE && cache_io_time[reg] > reg_io_time[reg] + REG_WRITE_DELAY){
+				start_time += cache_io_time[reg] - (reg_io_time[reg] + REG_WRITE_DELAY);
+			}
+
 			access_nb[reg][0] = io_seq_nb;
 			access_nb[reg][1] = offset;
-			io_update_overhead = UPDATE_IO_REQUEST(io_seq_nb, offset, old_channel_time, UPDATE_START_TIME);
+			io_update_overhead = UPDATE_IO_REQUEST(io_seq_nb, offset, start_time, UPDATE_START_TIME);
 			SSD_UPDATE_IO_OVERHEAD(reg, io_update_overhead);
 		}
 		else{
@@ -393,13 +1359,20 @@ int SSD_REG_RECORD(int reg, int cmd, int channel, nand_io_info* n_io_info)
 		}
 	}
 	else if(cmd == READ){
-		reg_io_time[reg] = SSD_GET_CH_ACCESS_TIME_FOR_READ(channel, reg);
+		if(CHANNEL_RATE != 0){
+			/* The data out after the cell read,
+				the bus time of the read command is charged after the data out */
+			reg_io_time[reg] = SSD_CH_RESERVE(channel, cell_io_time[reg] + CELL_READ_DELAY, REG_READ_DELAY + CHANNEL_CMD_DELAY);
+		}
+		else{
+			reg_io_time[reg] = SSD_GET_CH_ACCESS_TIME_FOR_READ(channel, reg);
+		}
 
-		/* Update SATA request Info */
+		/* Update SATA request Info, the host read waits for the plane from the issue */
 		if(type == READ){
 			access_nb[reg][0] = io_seq_nb;
 			access_nb[reg][1] = offset;
-			io_update_overhead = UPDATE_IO_REQUEST(io_seq_nb, offset, old_channel_time, UPDATE_START_TIME);
+			io_update_overhead = UPDATE_IO_REQUEST(io_seq_nb, offset, n_io_info->issue_time, UPDATE_START_TIME);
 			SSD_UPDATE_IO_OVERHEAD(reg, io_update_overhead);
 		}
 		else{
@@ -421,12 +1394,28 @@ int SSD_CELL_RECORD(int reg, int cmd)
 {
 	if(cmd == WRITE){
 		cell_io_time[reg] = reg_io_time[reg] + REG_WRITE_DELAY;
+
+		/* Cache program, the array is busy with the previous page */
+		if(cache_io_cmd[reg] == WRITE && cache_io_time[reg] > cell_io_time[reg]){
+			cell_io_time[reg] = cache_io_time[reg];
+		}
 	}
 	else if(cmd == READ){
-		cell_io_time[reg] = old_channel_time + CHANNEL_SWITCH_DELAY_R;
+		if(CHANNEL_RATE != 0){
+			/* The command does not wait for the data outs queued on the bus */
+			cell_io_time[reg] = old_channel_time + CHANNEL_CMD_DELAY;
+		}
+		else{
+			cell_io_time[reg] = old_channel_time + CHANNEL_SWITCH_DELAY_R;
+		}
 	}
 	else if(cmd == ERASE){
-		cell_io_time[reg] = get_usec();
+		if(CHANNEL_RATE != 0){
+			cell_io_time[reg] = get_usec() + CHANNEL_CMD_DELAY;
+		}
+		else{
+			cell_io_time[reg] = get_usec();
+		}
 	}
 
 	return SUCCESS;
@@ -438,10 +1427,19 @@ int SSD_CH_ACCESS(int channel)
 	int ret = SUCCESS;
 	int r_num;
 
+	/* The channel is not scanned, the transfers are serialized by SSD_CH_RESERVE */
+	if(CHANNEL_RATE != 0){
+		return SUCCESS;
+	}
+
 	for(i=0;i<WAY_NB;i++){
 		r_num = channel*PLANES_PER_FLASH + i*CHANNEL_NB*PLANES_PER_FLASH; 
 		for(j=0;j<PLANES_PER_FLASH;j++){
 			if(reg_io_time[r_num] <= get_usec() && reg_io_time[r_num] != -1){
+#ifdef VIRTUAL_TIME
+				/* The completion of the plane waits for this access */
+				SSD_SCHED_HOLD(r_num, 1);
+#endif
 				if(reg_io_cmd[r_num] == READ){
 					SSD_CELL_READ_DELAY(r_num);
 					SSD_REG_READ_DELAY(r_num);
@@ -451,6 +1449,9 @@ int SSD_CH_ACCESS(int channel)
 					SSD_REG_WRITE_DELAY(r_num);
 					ret = FAIL;
 				}
+#ifdef VIRTUAL_TIME
+				SSD_SCHED_HOLD(r_num, -1);
+#endif
 			}
 			r_num++;	
 		}
@@ -459,6 +1460,19 @@ int SSD_CH_ACCESS(int channel)
 	return ret;
 }
 
+/* Take the channel bus for xfer_time from ready_time or later, return the start time */
+int64_t SSD_CH_RESERVE(int channel, int64_t ready_time, int64_t xfer_time)
+{
+	int64_t start_time = ready_time;
+
+	if(ch_busy_time[channel] > start_time){
+		start_time = ch_busy_time[channel];
+	}
+	ch_busy_time[channel] = start_time + xfer_time;
+
+	return start_time;
+}
+
 void SSD_UPDATE_IO_OVERHEAD(int reg, int64_t overhead_time)
 {
 	io_overhead[reg] += overhead_time;
@@ -497,9 +1511,7 @@ int64_t SSD_CH_SWITCH_DELAY(int channel)
   #endif
 #endif
 	if (diff < switch_delay){
-		while( diff < switch_delay ){
-			diff = get_usec() - old_channel_time;
-		}
+		SSD_WAIT_UNTIL(old_channel_time + switch_delay);
 	}
 	end = get_usec();
 
@@ -531,9 +1543,7 @@ int SSD_REG_WRITE_DELAY(int reg)
 #endif
 
 	if (diff < REG_WRITE_DELAY){
-		while( diff < REG_WRITE_DELAY ){
-			diff = get_usec() - time_stamp;
-		}
+		SSD_WAIT_UNTIL(time_stamp + REG_WRITE_DELAY);
 		ret = 1;
 	}
 	end = get_usec();
@@ -572,9 +1582,7 @@ int SSD_REG_READ_DELAY(int reg)
 #endif
 
 	if(diff < REG_READ_DELAY){
-		while(diff < REG_READ_DELAY){
-			diff = get_usec() - time_stamp;
-		}
+		SSD_WAIT_UNTIL(time_stamp + REG_READ_DELAY);
 		ret = 1;
 	}
 	end = get_usec();
@@ -589,6 +1597,14 @@ int SSD_REG_READ_DELAY(int reg)
 	reg_io_cmd[reg] = NOOP;
 	reg_io_type[reg] = NOOP;
 
+	/* The data out is over, the suspended command goes on */
+	if( IO_PARALLELISM == 0 ){
+		SSD_RESUME_FLASH(reg / PLANES_PER_FLASH, time_stamp + REG_READ_DELAY);
+	}
+	else if(suspend_io_cmd[reg] != NOOP){
+		SSD_RESUME(reg, time_stamp + REG_READ_DELAY);
+	}
+
 	return ret;
 }
 
@@ -596,7 +1612,6 @@ int SSD_CELL_WRITE_DELAY(int reg)
 {
 	int ret = 0;
 	int64_t start = 0;
-	int64_t end = 0;
 	int64_t diff = 0;
 	int64_t time_stamp = cell_io_time[reg];
 
@@ -619,15 +1634,12 @@ int SSD_CELL_WRITE_DELAY(int reg)
 
 	if( diff < CELL_PROGRAM_DELAY){
 		init_diff_reg = diff;
-		while(diff < CELL_PROGRAM_DELAY){
-			diff = get_usec() - time_stamp + io_overhead[reg];
-		}
+		SSD_WAIT_UNTIL(time_stamp + CELL_PROGRAM_DELAY - io_overhead[reg]);
 		ret = 1;
 	}
-	end = get_usec();
 
-	/* Send Delay Info To Perf Checker */
-	SEND_TO_PERF_CHECKER(reg_io_type[reg], end-start, REG_OP);
+	/* Send Delay Info To Perf Checker, the program from its issue */
+	SEND_TO_PERF_CHECKER(reg_io_type[reg], time_stamp + CELL_PROGRAM_DELAY - io_overhead[reg] - reg_issue_time[reg], REG_OP);
 	SSD_UPDATE_IO_REQUEST(reg);
 
 	/* Update Time Stamp Struct */
@@ -645,7 +1657,6 @@ int SSD_CELL_READ_DELAY(int reg)
 {
 	int ret = 0;
 	int64_t start = 0;
-	int64_t end = 0;
 	int64_t diff = 0;
 	int64_t time_stamp = cell_io_time[reg];
 
@@ -669,16 +1680,13 @@ int SSD_CELL_READ_DELAY(int reg)
 
 	if( diff < REG_DELAY){
 		init_diff_reg = diff;
-		while( diff < REG_DELAY ){
-			diff = get_usec() - time_stamp + io_overhead[reg];
-		}
+		SSD_WAIT_UNTIL(time_stamp + REG_DELAY - io_overhead[reg]);
 		ret = 1;
 
 	}
-	end = get_usec();
 
-	/* Send Delay Info To Perf Checker */
-	SEND_TO_PERF_CHECKER(reg_io_type[reg], end-start, REG_OP);
+	/* Send Delay Info To Perf Checker, the read from its issue to the end of the data out */
+	SEND_TO_PERF_CHECKER(reg_io_type[reg], SSD_GET_REG_DUE_TIME(reg) - reg_issue_time[reg], REG_OP);
 
 	/* Update Time Stamp Struct */
 	cell_io_time[reg] = -1;
@@ -693,7 +1701,6 @@ int SSD_BLOCK_ERASE_DELAY(int reg)
 {
 	int ret = 0;
 	int64_t start = 0;
-	int64_t end = 0;
 	int64_t diff;
 	int64_t time_stamp = cell_io_time[reg];
 
@@ -704,15 +1711,12 @@ int SSD_BLOCK_ERASE_DELAY(int reg)
 	start = get_usec();
 	diff = get_usec() - cell_io_time[reg];
 	if( diff < BLOCK_ERASE_DELAY){
-		while(diff < BLOCK_ERASE_DELAY){
-			diff = get_usec() - time_stamp;
-	  	}
+		SSD_WAIT_UNTIL(time_stamp + BLOCK_ERASE_DELAY);
 		ret = 1;
 	}
-	end = get_usec();
 
-	/* Send Delay Info to Perf Checker */
-	SEND_TO_PERF_CHECKER(reg_io_type[reg], end-start, REG_OP);
+	/* Send Delay Info to Perf Checker, the erase from its issue */
+	SEND_TO_PERF_CHECKER(reg_io_type[reg], time_stamp + BLOCK_ERASE_DELAY - reg_issue_time[reg], REG_OP);
 
 	/* Update IO Overhead */
 	cell_io_time[reg] = -1;
@@ -740,6 +1744,11 @@ int64_t SSD_GET_CH_ACCESS_TIME_FOR_READ(int channel, int reg)
 			else if(reg_io_cmd[r_num] == WRITE){
 				temp_time = reg_io_time[r_num] + REG_WRITE_DELAY;
 			}
+
+			/* Cache read, the data out of the previous page */
+			if(cache_io_cmd[r_num] == READ && cache_io_time[r_num] > temp_time){
+				temp_time = cache_io_time[r_num];
+			}
 	
 			if( temp_time > latest_time ){
 				latest_time = temp_time;
@@ -787,6 +1796,86 @@ void SSD_REMAIN_IO_DELAY(int reg)
 	SSD_REG_ACCESS(reg);
 }
 
+void SSD_WAIT_UNTIL(int64_t due_time)
+{
+#ifdef VIRTUAL_TIME
+	WAIT_VIRTUAL_TIME(due_time);
+#else
+	while(get_usec() < due_time){
+		/* Busy-wait delay */
+	}
+#endif
+}
+
+int64_t SSD_GET_REG_DUE_TIME(int reg)
+{
+	int64_t due_time = -1;
+	int64_t reg_due_time;
+
+	if(reg_io_cmd[reg] == READ){
+		due_time = cell_io_time[reg] + CELL_READ_DELAY;
+		reg_due_time = reg_io_time[reg] + REG_READ_DELAY;
+		if(reg_due_time > due_time){
+			due_time = reg_due_time;
+		}
+	}
+	else if(reg_io_cmd[reg] == WRITE){
+		due_time = cell_io_time[reg] + CELL_PROGRAM_DELAY - io_overhead[reg];
+	}
+	else if(reg_io_cmd[reg] == ERASE){
+		due_time = cell_io_time[reg] + BLOCK_ERASE_DELAY;
+	}
+
+	return due_time;
+}
+
+#ifdef VIRTUAL_TIME
+void SSD_SCHEDULE_COMPLETION(int reg)
+{
+	int64_t due_time = SSD_GET_REG_DUE_TIME(reg);
+
+	if(due_time == -1)
+		return;
+
+	/* The previous completion event of this register becomes stale */
+	reg_io_seq[reg]++;
+	SCHEDULE_TIME_EVENT(due_time, reg, reg_io_seq[reg]);
+}
+
+void SSD_REG_COMPLETE(int reg, unsigned int seq_nb)
+{
+	if(seq_nb != reg_io_seq[reg]){
+		/* Already completed by the following access */
+		return;
+	}
+
+	/* The plane is being accessed, the release completes it */
+	if(SSD_SCHED_DEFER(reg) == SUCCESS){
+		return;
+	}
+
+	if(reg_io_cmd[reg] != NOOP){
+		/* The channel was taken by other register, try again later */
+		if(SSD_GET_REG_DUE_TIME(reg) > get_usec()){
+			SSD_SCHEDULE_COMPLETION(reg);
+			return;
+		}
+
+		/* The read is over, the suspended command goes on with its own completion */
+		if(reg_io_cmd[reg] == READ && suspend_io_cmd[reg] != NOOP){
+			SSD_CELL_READ_DELAY(reg);
+			SSD_REG_READ_DELAY(reg);
+			return;
+		}
+
+		SSD_REG_ACCESS(reg);
+	}
+
+	/* The plane is free for the next queued command */
+	SSD_SCHED_KICK(reg);
+}
+#endif
+
 #ifndef VSSIM_BENCH
 void SSD_UPDATE_QEMU_OVERHEAD(int64_t delay)
 {
@@ -808,6 +1897,9 @@ void SSD_UPDATE_QEMU_OVERHEAD(int64_t delay)
 		cell_io_time[i] -= diff;
 		reg_io_time[i] -= diff;
 	}
+	for(i=0;i<CHANNEL_NB;i++){
+		ch_busy_time[i] -= diff;
+	}
 	qemu_overhead -= diff;
 }
 #endif
@@ -12,9 +12,24 @@
 #include "ssd_util.h"
 #endif
 
+/* A page of the vectored IO */
+typedef struct nand_io_vec
+{
+	unsigned int flash_nb;
+	unsigned int block_nb;
+	unsigned int page_nb;
+	int old_flash_nb;		// Partial write : the old page, -1 if the page is written whole
+	unsigned int old_block_nb;
+	unsigned int old_page_nb;
+	nand_io_info io_info;
+}nand_io_vec;
+
 extern int old_channel_nb;
 extern int64_t io_alloc_overhead;
 extern int64_t io_update_overhead;
+extern int ssd_timing_off;
+extern int64_t ssd_program_page_nb;
+extern int64_t ssd_partial_write_nb;
 
 /* Get Current time in micro second */
 int64_t get_usec(void);
@@ -31,13 +46,49 @@ int SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb,
 	unsigned int new_block_nb, unsigned int new_page_nb, \
 	nand_io_info* n_io_info);
 
+/* Issue the IO, n_io_info is kept by the caller */
+int _SSD_PAGE_READ(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info);
+int _SSD_PAGE_WRITE(unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info);
+int _SSD_PAGE_PARTIAL_WRITE(unsigned int old_flash_nb, unsigned int old_block_nb, \
+	unsigned int old_page_nb, unsigned new_flash_nb, \
+	unsigned int new_block_nb, unsigned int new_page_nb, \
+	nand_io_info* n_io_info);
+
+/* Vectored IO, the pages of a host request */
+nand_io_vec* SSD_GET_IO_VEC(int vec_nb);
+int SSD_GET_IO_VEC_REG(nand_io_vec* curr_vec);
+void SSD_ORDER_IO_VEC(nand_io_vec* io_vec, int vec_nb);
+int64_t SSD_PAGE_READV(nand_io_vec* io_vec, int vec_nb);
+int64_t SSD_PAGE_WRITEV(nand_io_vec* io_vec, int vec_nb);
+
+/* Multi-plane IO, the block of each plane or -1 */
+int SSD_MULTI_PLANE_WRITE(unsigned int flash_nb, int32_t* block_list, unsigned int page_nb, nand_io_info** n_io_info_list);
+int SSD_MULTI_PLANE_READ(unsigned int flash_nb, int32_t* block_list, unsigned int page_nb, nand_io_info** n_io_info_list);
+int SSD_MULTI_PLANE_ERASE(unsigned int flash_nb, int32_t* block_list);
+int SSD_CHECK_PLANE_SET(int32_t* block_list);
+
 /* Channel Access Delay */
 int SSD_CH_ENABLE(int channel);
 
+/* Channel Bandwidth Model */
+int64_t SSD_CH_RESERVE(int channel, int64_t ready_time, int64_t xfer_time);
+
 /* Flash or Register Access */
 int SSD_FLASH_ACCESS(unsigned int flash_nb, int reg);
 int SSD_REG_ACCESS(int reg);
 
+/* Program & Erase Suspend */
+int SSD_SUSPEND(unsigned int flash_nb, int reg);
+int SSD_SUSPEND_REG(int reg);
+void SSD_RESUME(int reg, int64_t resume_time);
+void SSD_RESUME_FLASH(unsigned int flash_nb, int64_t resume_time);
+
+/* Cache Program & Cache Read */
+int SSD_CACHE_ACCESS(unsigned int flash_nb, int reg, int cmd);
+int SSD_CACHE_WRITE_DELAY(int reg);
+int SSD_CACHE_READ_DELAY(int reg);
+void SSD_CACHE_COMPLETE(int reg);
+
 /* Channel Delay */
 int64_t SSD_CH_SWITCH_DELAY(int channel);
 
@@ -68,6 +119,18 @@ void SSD_UPDATE_IO_OVERHEAD(int reg, int64_t overhead_time);
 void SSD_REMAIN_IO_DELAY(int reg);
 void SSD_UPDATE_QEMU_OVERHEAD( int64_t delay);
 
+/* Wait Until the Time Stamp */
+void SSD_WAIT_UNTIL(int64_t due_time);
+
+/* The plane is busy until the time, -1 if it is idle */
+int64_t SSD_GET_REG_DUE_TIME(int reg);
+
+/* Completion Event */
+#ifdef VIRTUAL_TIME
+void SSD_SCHEDULE_COMPLETION(int reg);
+void SSD_REG_COMPLETE(int reg, unsigned int seq_nb);
+#endif
+
 /* SSD Module Debugging */
 void SSD_PRINT_STAMP(void);
 
@@ -0,0 +1,422 @@
+// File: ssd_sched_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+
+#ifdef VIRTUAL_TIME
+
+/* Pending GC, WL & erase commands of each plane, [reg] */
+sched_queue* sched_queue_list;
+
+/* Planes to be issued after the completion handler */
+int* sched_ready_stack;
+int sched_ready_nb;
+
+/* Nested by the dispatch, the issued command does not go to the queue again */
+int sched_dispatch_nb;
+
+/* The queue entries, SCHED_QUEUE_DEPTH of each plane */
+obj_pool sched_entry_pool;
+
+/* Statistics */
+int64_t sched_queued_nb;
+int64_t sched_expired_nb;
+int sched_max_depth;
+latency_histogram sched_depth_histogram;	// Plane queue depth at the enqueue, in commands
+
+static const char* sched_name[3] = {"FIFO", "READ_FIRST", "DEADLINE"};
+
+void INIT_SCHED_MANAGER(void)
+{
+	int reg_nb = FLASH_NB * PLANES_PER_FLASH;
+
+	if(IO_SCHEDULER < SCHED_FIFO || IO_SCHEDULER > SCHED_DEADLINE){
+		printf("ERROR[%s] Wrong IO_SCHEDULER %d, FIFO is used\n", __FUNCTION__, IO_SCHEDULER);
+		IO_SCHEDULER = SCHED_FIFO;
+	}
+
+	sched_queue_list = (sched_queue*)calloc(reg_nb, sizeof(sched_queue));
+	sched_ready_stack = (int*)calloc(reg_nb, sizeof(int));
+	if(sched_queue_list == NULL || sched_ready_stack == NULL){
+		printf("ERROR[%s] Calloc sched queue fail\n", __FUNCTION__);
+		IO_SCHEDULER = SCHED_FIFO;
+		return;
+	}
+
+	if(IO_SCHEDULER != SCHED_FIFO \
+			&& INIT_POOL(&sched_entry_pool, "sched_entry", sizeof(sched_entry), reg_nb * SCHED_QUEUE_DEPTH) == FAIL){
+		IO_SCHEDULER = SCHED_FIFO;
+	}
+
+	sched_ready_nb = 0;
+	sched_dispatch_nb = 0;
+
+	sched_queued_nb = 0;
+	sched_expired_nb = 0;
+	sched_max_depth = 0;
+	RESET_LATENCY_HISTOGRAM(&sched_depth_histogram);
+}
+
+void TERM_SCHED_MANAGER(void)
+{
+	int i;
+
+	if(sched_queue_list == NULL){
+		return;
+	}
+
+	/* The queued commands are issued by the completions */
+	FLUSH_TIME_EVENT();
+	for(i=0;i<FLASH_NB*PLANES_PER_FLASH;i++){
+		SSD_SCHED_DRAIN(i);
+	}
+	FLUSH_TIME_EVENT();
+
+	if(IO_SCHEDULER != SCHED_FIFO){
+		printf("IO Scheduler		%s, %lld queued, %lld expired\n", \
+				sched_name[IO_SCHEDULER], (long long)sched_queued_nb, \
+				(long long)sched_expired_nb);
+		if(sched_depth_histogram.total_count != 0){
+			printf("Queue Depth		avg %.1lf, p50 %lld, p99 %lld, max %d\n", \
+					sched_depth_histogram.total_value / sched_depth_histogram.total_count, \
+					(long long)GET_LATENCY_PERCENTILE(&sched_depth_histogram, 50), \
+					(long long)GET_LATENCY_PERCENTILE(&sched_depth_histogram, 99), \
+					sched_max_depth);
+		}
+		TERM_POOL(&sched_entry_pool);
+	}
+
+	free(sched_queue_list);
+	free(sched_ready_stack);
+	sched_queue_list = NULL;
+	sched_ready_stack = NULL;
+}
+
+/* Return SUCCESS if the command is queued, the caller issues it otherwise */
+int SSD_SCHED_SUBMIT(int cmd, unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info)
+{
+	int reg = flash_nb*PLANES_PER_FLASH + block_nb%PLANES_PER_FLASH;
+	int type = ERASE;
+	sched_queue* curr_queue;
+	sched_entry* new_entry;
+
+	if(n_io_info != NULL){
+		type = n_io_info->type;
+	}
+
+	if(IO_SCHEDULER == SCHED_FIFO || sched_dispatch_nb != 0){
+		return FAIL;
+	}
+
+	if(SSD_SCHED_IS_BACKGROUND(type) == 0){
+		SSD_SCHED_HOST_ACCESS(reg, block_nb, cmd);
+		return FAIL;
+	}
+
+	curr_queue = sched_queue_list + reg;
+
+	/* The plane is idle, no need to wait */
+	if(curr_queue->entry_nb == 0 && SSD_SCHED_IS_IDLE(reg)){
+		return FAIL;
+	}
+
+	/* The queue is full, the oldest command goes first */
+	if(curr_queue->entry_nb >= SCHED_QUEUE_DEPTH){
+		SSD_SCHED_DISPATCH(reg);
+	}
+
+	new_entry = (sched_entry*)POOL_ALLOC(&sched_entry_pool);
+	if(new_entry == NULL){
+		printf("ERROR[%s] Alloc sched entry fail\n", __FUNCTION__);
+		return FAIL;
+	}
+	new_entry->cmd = cmd;
+	new_entry->flash_nb = flash_nb;
+	new_entry->block_nb = block_nb;
+	new_entry->page_nb = page_nb;
+	new_entry->n_io_info = n_io_info;
+	new_entry->enqueue_time = get_usec();
+	new_entry->next = NULL;
+
+	if(curr_queue->tail == NULL){
+		curr_queue->head = new_entry;
+	}
+	else{
+		curr_queue->tail->next = new_entry;
+	}
+	curr_queue->tail = new_entry;
+	curr_queue->entry_nb++;
+
+	sched_queued_nb++;
+	if(curr_queue->entry_nb > sched_max_depth){
+		sched_max_depth = curr_queue->entry_nb;
+	}
+	RECORD_LATENCY(&sched_depth_histogram, curr_queue->entry_nb);
+
+	return SUCCESS;
+}
+
+/* A host command of the plane : the reads pass the queue,
+	the writes keep the order with the queued commands of their block */
+void SSD_SCHED_HOST_ACCESS(int reg, unsigned int block_nb, int cmd)
+{
+	if(IO_SCHEDULER == SCHED_FIFO || sched_dispatch_nb != 0){
+		return;
+	}
+
+	if(cmd == READ){
+		if(IO_SCHEDULER == SCHED_DEADLINE){
+			SSD_SCHED_EXPIRE(reg);
+		}
+	}
+	else{
+		SSD_SCHED_DRAIN_BLOCK(reg, block_nb);
+	}
+}
+
+int SSD_SCHED_IS_BACKGROUND(int type)
+{
+	switch(type){
+		case GC_READ:
+		case GC_WRITE:
+		case WL_READ:
+		case WL_WRITE:
+		case ERASE:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/* The plane (or the flash, without IO_PARALLELISM) has no command in progress */
+int SSD_SCHED_IS_IDLE(int reg)
+{
+	int i;
+	int r_num = reg;
+	int plane_nb = 1;
+	int64_t curr_time = get_usec();
+
+	if(IO_PARALLELISM == 0){
+		r_num = (reg / PLANES_PER_FLASH) * PLANES_PER_FLASH;
+		plane_nb = PLANES_PER_FLASH;
+	}
+
+	for(i=0;i<plane_nb;i++){
+		if(SSD_GET_REG_DUE_TIME(r_num) > curr_time){
+			return 0;
+		}
+		r_num++;
+	}
+
+	return 1;
+}
+
+/* Issue the oldest command of the plane */
+int SSD_SCHED_DISPATCH(int reg)
+{
+	sched_queue* curr_queue = sched_queue_list + reg;
+	sched_entry* curr_entry = curr_queue->head;
+
+	if(curr_entry == NULL){
+		return FAIL;
+	}
+
+	curr_queue->head = curr_entry->next;
+	if(curr_queue->head == NULL){
+		curr_queue->tail = NULL;
+	}
+	curr_queue->entry_nb--;
+
+	RECORD_OP_LATENCY(HIST_QUEUE_WAIT, get_usec() - curr_entry->enqueue_time);
+
+	/* The command starts a new sequence on the channel */
+	if(curr_entry->n_io_info != NULL){
+		curr_entry->n_io_info->offset = 0;
+	}
+
+	sched_dispatch_nb++;
+	if(curr_entry->cmd == READ){
+		SSD_PAGE_READ(curr_entry->flash_nb, curr_entry->block_nb, curr_entry->page_nb, curr_entry->n_io_info);
+	}
+	else if(curr_entry->cmd == WRITE){
+		SSD_PAGE_WRITE(curr_entry->flash_nb, curr_entry->block_nb, curr_entry->page_nb, curr_entry->n_io_info);
+	}
+	else{
+		SSD_BLOCK_ERASE(curr_entry->flash_nb, curr_entry->block_nb);
+	}
+	sched_dispatch_nb--;
+
+	POOL_FREE(&sched_entry_pool, curr_entry);
+
+	return SUCCESS;
+}
+
+/* Issue all the queued commands of the plane, in order */
+void SSD_SCHED_DRAIN(int reg)
+{
+	sched_queue* curr_queue = sched_queue_list + reg;
+
+	if(curr_queue->entry_nb == 0){
+		return;
+	}
+
+	while(curr_queue->head != NULL){
+		SSD_SCHED_DISPATCH(reg);
+	}
+}
+
+/* Issue the queued commands up to the last one of the block, in order.
+	The pages of a block are programmed in order, after the erase of the block */
+void SSD_SCHED_DRAIN_BLOCK(int reg, unsigned int block_nb)
+{
+	int i = 0;
+	int dispatch_nb = 0;
+	sched_queue* curr_queue = sched_queue_list + reg;
+	sched_entry* curr_entry;
+
+	for(curr_entry = curr_queue->head; curr_entry != NULL; curr_entry = curr_entry->next){
+		i++;
+		if(curr_entry->block_nb == block_nb){
+			dispatch_nb = i;
+		}
+	}
+
+	/* The waits of the dispatch may issue the head of the queue too */
+	for(i=0;i<dispatch_nb && curr_queue->head != NULL;i++){
+		SSD_SCHED_DISPATCH(reg);
+	}
+}
+
+/* Issue the commands which have waited longer than SCHED_EXPIRE_TIME,
+	at most SCHED_EXPIRE_BATCH of them: a full queue of expired programs
+	would delay the host read by the whole queue */
+void SSD_SCHED_EXPIRE(int reg)
+{
+	int i;
+	sched_queue* curr_queue = sched_queue_list + reg;
+
+	if(curr_queue->entry_nb == 0){
+		return;
+	}
+
+	for(i=0;i<SCHED_EXPIRE_BATCH && curr_queue->head != NULL;i++){
+		if(get_usec() - curr_queue->head->enqueue_time < SCHED_EXPIRE_TIME){
+			break;
+		}
+		SSD_SCHED_DISPATCH(reg);
+		sched_expired_nb++;
+	}
+}
+
+/* A command is being issued to the plane (the flash, without IO_PARALLELISM),
+	the waits of the issue may run the completion handlers of the other planes */
+void SSD_SCHED_HOLD(int reg, int hold)
+{
+	int i;
+	int r_num = reg;
+	int plane_nb = 1;
+	sched_queue* curr_queue;
+
+	if(IO_SCHEDULER == SCHED_FIFO){
+		return;
+	}
+
+	if(IO_PARALLELISM == 0){
+		r_num = (reg / PLANES_PER_FLASH) * PLANES_PER_FLASH;
+		plane_nb = PLANES_PER_FLASH;
+	}
+
+	for(i=0;i<plane_nb;i++){
+		curr_queue = sched_queue_list + r_num;
+		curr_queue->hold_nb += hold;
+
+		if(curr_queue->hold_nb == 0){
+			/* The completion was deferred by the hold */
+			if(curr_queue->deferred == 1){
+				curr_queue->deferred = 0;
+				if(SSD_GET_REG_DUE_TIME(r_num) != -1){
+					SSD_SCHEDULE_COMPLETION(r_num);
+					r_num++;
+					continue;
+				}
+			}
+			if(curr_queue->entry_nb != 0 && curr_queue->ready == 0){
+				curr_queue->ready = 1;
+				sched_ready_stack[sched_ready_nb++] = r_num;
+			}
+		}
+		r_num++;
+	}
+}
+
+/* Return SUCCESS if the plane is held, the completion is scheduled again by the release */
+int SSD_SCHED_DEFER(int reg)
+{
+	if(IO_SCHEDULER == SCHED_FIFO || sched_queue_list == NULL){
+		return FAIL;
+	}
+
+	if(sched_queue_list[reg].hold_nb == 0){
+		return FAIL;
+	}
+
+	sched_queue_list[reg].deferred = 1;
+
+	return SUCCESS;
+}
+
+/* Called by the completion handler, the planes are issued after the handler */
+void SSD_SCHED_KICK(int reg)
+{
+	int i;
+	int r_num = reg;
+	int plane_nb = 1;
+
+	if(IO_SCHEDULER == SCHED_FIFO || sched_queue_list == NULL){
+		return;
+	}
+
+	/* The other planes of the flash may wait for this plane */
+	if(IO_PARALLELISM == 0){
+		r_num = (reg / PLANES_PER_FLASH) * PLANES_PER_FLASH;
+		plane_nb = PLANES_PER_FLASH;
+	}
+
+	for(i=0;i<plane_nb;i++){
+		if(sched_queue_list[r_num].entry_nb != 0 && sched_queue_list[r_num].ready == 0){
+			sched_queue_list[r_num].ready = 1;
+			sched_ready_stack[sched_ready_nb++] = r_num;
+		}
+		r_num++;
+	}
+}
+
+void SSD_SCHED_DISPATCH_READY(void)
+{
+	int reg;
+	sched_queue* curr_queue;
+
+	while(sched_ready_nb > 0){
+		reg = sched_ready_stack[--sched_ready_nb];
+		curr_queue = sched_queue_list + reg;
+		curr_queue->ready = 0;
+
+		/* A busy plane is kicked again by its completion */
+		if(curr_queue->hold_nb != 0 || SSD_SCHED_IS_IDLE(reg) == 0 || curr_queue->head == NULL){
+			continue;
+		}
+
+		/* One command of the plane at a time, the host commands go between them */
+		if(IO_SCHEDULER == SCHED_DEADLINE \
+				&& get_usec() - curr_queue->head->enqueue_time >= SCHED_EXPIRE_TIME){
+			sched_expired_nb++;
+		}
+		SSD_SCHED_DISPATCH(reg);
+	}
+}
+
+#endif
@@ -0,0 +1,64 @@
+// File: ssd_sched_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _SCHED_MANAGER_H_
+#define _SCHED_MANAGER_H_
+
+/* IO Scheduler of the die queues */
+#define SCHED_FIFO		0	// The commands are issued in the FTL call order
+#define SCHED_READ_FIRST	1	// The host reads go ahead of the queued GC & WL commands
+#define SCHED_DEADLINE		2	// READ_FIRST, but the expired commands go ahead of the host reads
+
+#define SCHED_EXPIRE_BATCH	1	// Expired commands issued ahead of a host read, the rest wait for the next one
+
+/* A GC, WL or erase command waiting for its plane */
+typedef struct sched_entry
+{
+	int cmd;
+	unsigned int flash_nb;
+	unsigned int block_nb;
+	unsigned int page_nb;
+	nand_io_info* n_io_info;
+	int64_t enqueue_time;
+	struct sched_entry* next;
+}sched_entry;
+
+typedef struct sched_queue
+{
+	sched_entry* head;
+	sched_entry* tail;
+	int entry_nb;
+	int hold_nb;		// A command is being issued to the plane
+	int deferred;		// The completion came while the plane was held
+	int ready;		// In the ready stack
+}sched_queue;
+
+extern int64_t sched_queued_nb;
+extern int64_t sched_expired_nb;
+extern int sched_max_depth;
+extern latency_histogram sched_depth_histogram;
+
+void INIT_SCHED_MANAGER(void);
+void TERM_SCHED_MANAGER(void);
+
+/* Queue the background command, or prepare the plane for the host command */
+int SSD_SCHED_SUBMIT(int cmd, unsigned int flash_nb, unsigned int block_nb, unsigned int page_nb, nand_io_info* n_io_info);
+void SSD_SCHED_HOST_ACCESS(int reg, unsigned int block_nb, int cmd);
+int SSD_SCHED_IS_BACKGROUND(int type);
+int SSD_SCHED_IS_IDLE(int reg);
+
+/* Issue the queued commands */
+int SSD_SCHED_DISPATCH(int reg);
+void SSD_SCHED_DRAIN(int reg);
+void SSD_SCHED_DRAIN_BLOCK(int reg, unsigned int block_nb);
+void SSD_SCHED_EXPIRE(int reg);
+void SSD_SCHED_HOLD(int reg, int hold);
+int SSD_SCHED_DEFER(int reg);
+void SSD_SCHED_KICK(int reg);
+void SSD_SCHED_DISPATCH_READY(void);
+
+#endif
@@ -0,0 +1,242 @@
+// File: ssd_time_manager.c
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#include "common.h"
+#include <time.h>
+
+#ifdef VIRTUAL_TIME
+
+/* Virtual Clock */
+int64_t virtual_time;
+int vtime_mode = VTIME_ONLINE;
+
+/* Completion Event Queue (binary min-heap ordered by due time) */
+time_event* time_event_heap;
+int time_event_nb;
+int time_event_max_nb;
+
+int vtime_in_event;
+
+void PUSH_TIME_EVENT(int64_t due_time, int reg, unsigned int seq_nb);
+void POP_TIME_EVENT(time_event* t_event);
+void MOVE_VIRTUAL_TIME(int64_t time);
+
+void INIT_TIME_MANAGER(void)
+{
+	time_event_max_nb = FLASH_NB * PLANES_PER_FLASH * 4;
+	time_event_heap = (time_event*)calloc(time_event_max_nb, sizeof(time_event));
+	if(time_event_heap == NULL){
+		printf("ERROR[%s] Calloc time event heap fail\n", __FUNCTION__);
+		return;
+	}
+	time_event_nb = 0;
+	vtime_in_event = 0;
+
+	if(vtime_mode == VTIME_ONLINE){
+		virtual_time = get_wall_usec();
+	}
+	else{
+		virtual_time = 0;
+	}
+}
+
+void TERM_TIME_MANAGER(void)
+{
+	/* Complete all the pending NAND operations */
+	FLUSH_TIME_EVENT();
+
+	free(time_event_heap);
+	time_event_heap = NULL;
+	time_event_max_nb = 0;
+}
+
+int64_t get_wall_usec(void)
+{
+	int64_t t = 0;
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	t = tv.tv_sec;
+	t *= 1000000;
+	t += tv.tv_usec;
+
+	return t;
+}
+
+void SET_VTIME_MODE(int mode)
+{
+	if(mode != VTIME_ONLINE && mode != VTIME_OFFLINE){
+		printf("ERROR[%s] Wrong virtual time mode %d\n", __FUNCTION__, mode);
+		return;
+	}
+	vtime_mode = mode;
+}
+
+int64_t GET_VIRTUAL_TIME(void)
+{
+	int64_t wall_time;
+
+	/* In online mode, the idle time of the host also passes */
+	if(vtime_mode == VTIME_ONLINE){
+		wall_time = get_wall_usec();
+		if(wall_time > virtual_time){
+			virtual_time = wall_time;
+		}
+	}
+
+	return virtual_time;
+}
+
+void SET_VIRTUAL_TIME(int64_t time)
+{
+	/* Process the completions due before the new arrival */
+	WAIT_VIRTUAL_TIME(time);
+}
+
+void WAIT_VIRTUAL_TIME(int64_t due_time)
+{
+	time_event t_event;
+
+	/* Completion handler can not wait for other events */
+	if(vtime_in_event == 1){
+		if(due_time > virtual_time){
+			virtual_time = due_time;
+		}
+		return;
+	}
+
+	/* The planes released since the last handler */
+	SSD_SCHED_DISPATCH_READY();
+
+	while(time_event_nb > 0 && time_event_heap[0].due_time < due_time){
+		POP_TIME_EVENT(&t_event);
+		MOVE_VIRTUAL_TIME(t_event.due_time);
+
+		vtime_in_event = 1;
+		SSD_REG_COMPLETE(t_event.reg, t_event.seq_nb);
+		vtime_in_event = 0;
+
+		/* The queued commands are issued out of the handler, they may wait */
+		SSD_SCHED_DISPATCH_READY();
+	}
+
+	MOVE_VIRTUAL_TIME(due_time);
+}
+
+void MOVE_VIRTUAL_TIME(int64_t time)
+{
+	int64_t diff;
+	struct timespec ts;
+
+	if(vtime_mode == VTIME_ONLINE){
+		diff = time - get_wall_usec();
+
+		/* Sleep instead of spinning until the due time */
+		if(diff > 0){
+			ts.tv_sec = diff / 1000000;
+			ts.tv_nsec = (diff % 1000000) * 1000;
+			nanosleep(&ts, NULL);
+		}
+	}
+
+	if(time > virtual_time){
+		virtual_time = time;
+	}
+}
+
+int SCHEDULE_TIME_EVENT(int64_t due_time, int reg, unsigned int seq_nb)
+{
+	time_event* new_heap;
+
+	if(time_event_nb == time_event_max_nb){
+		new_heap = (time_event*)realloc(time_event_heap, sizeof(time_event) * time_event_max_nb * 2);
+		if(new_heap == NULL){
+			printf("ERROR[%s] Realloc time event heap fail\n", __FUNCTION__);
+			return FAIL;
+		}
+		time_event_heap = new_heap;
+		time_event_max_nb *= 2;
+	}
+
+	PUSH_TIME_EVENT(due_time, reg, seq_nb);
+
+	return SUCCESS;
+}
+
+int64_t GET_NEXT_EVENT_TIME(void)
+{
+	if(time_event_nb == 0){
+		return -1;
+	}
+
+	return time_event_heap[0].due_time;
+}
+
+void FLUSH_TIME_EVENT(void)
+{
+	while(time_event_nb > 0){
+		WAIT_VIRTUAL_TIME(GET_NEXT_EVENT_TIME() + 1);
+	}
+}
+
+void PUSH_TIME_EVENT(int64_t due_time, int reg, unsigned int seq_nb)
+{
+	int index = time_event_nb;
+	int parent;
+
+	/* Sift up */
+	while(index > 0){
+		parent = (index - 1) / 2;
+		if(time_event_heap[parent].due_time <= due_time){
+			break;
+		}
+		time_event_heap[index] = time_event_heap[parent];
+		index = parent;
+	}
+
+	time_event_heap[index].due_time = due_time;
+	time_event_heap[index].reg = reg;
+	time_event_heap[index].seq_nb = seq_nb;
+
+	time_event_nb++;
+}
+
+void POP_TIME_EVENT(time_event* t_event)
+{
+	int index = 0;
+	int child;
+	time_event last_event;
+
+	*t_event = time_event_heap[0];
+
+	time_event_nb--;
+	if(time_event_nb == 0){
+		return;
+	}
+	last_event = time_event_heap[time_event_nb];
+
+	/* Sift down */
+	while(1){
+		child = index * 2 + 1;
+		if(child >= time_event_nb){
+			break;
+		}
+		if(child + 1 < time_event_nb && \
+			time_event_heap[child+1].due_time < time_event_heap[child].due_time){
+			child++;
+		}
+		if(last_event.due_time <= time_event_heap[child].due_time){
+			break;
+		}
+		time_event_heap[index] = time_event_heap[child];
+		index = child;
+	}
+
+	time_event_heap[index] = last_event;
+}
+
+#endif
@@ -0,0 +1,42 @@
+// File: ssd_time_manager.h
+// Date: 2026. 10. 18.
+// Author: Jinsoo Yoo (jedisty@hanyang.ac.kr)
+// Copyright(c)2026
+// Hanyang University, Seoul, Korea
+// Embedded Software Systems Laboratory. All right reserved
+
+#ifndef _TIME_MANAGER_H_
+#define _TIME_MANAGER_H_
+
+/* Virtual Time Mode */
+#define VTIME_ONLINE	0	// Virtual clock follows the host clock, sleep until due
+#define VTIME_OFFLINE	1	// Virtual clock only, never sleep
+
+typedef struct time_event
+{
+	int64_t due_time;
+	int reg;
+	unsigned int seq_nb;
+}time_event;
+
+extern int64_t virtual_time;
+extern int vtime_mode;
+
+void INIT_TIME_MANAGER(void);
+void TERM_TIME_MANAGER(void);
+
+/* Get Host time in micro second */
+int64_t get_wall_usec(void);
+
+/* Virtual Clock */
+void SET_VTIME_MODE(int mode);
+int64_t GET_VIRTUAL_TIME(void);
+void SET_VIRTUAL_TIME(int64_t time);
+void WAIT_VIRTUAL_TIME(int64_t due_time);
+
+/* Completion Event Queue */
+int SCHEDULE_TIME_EVENT(int64_t due_time, int reg, unsigned int seq_nb);
+int64_t GET_NEXT_EVENT_TIME(void);
+void FLUSH_TIME_EVENT(void);
+
+#endif
@@ -8,31 +8,22 @@
 #ifndef _TRIM_MANAGER_H_
 #define _TRIM_MANAGER_H_
 
-#ifndef VSSIM_BENCH
-#include "ssd_util.h"
-#endif
-
-typedef struct sector_entry
-{
-	int64_t sector_nb;
-	unsigned long long int length;
-
-	struct sector_entry* prev;
-	struct sector_entry* next;	
-}sector_entry;
+#include <stdint.h>
 
-sector_entry* new_sector_entry(void);
-void add_sector_list(sector_entry* List, sector_entry* SE);
-void release_sector_list(sector_entry* SE);
-void remove_sector_entry(sector_entry* SE);
-
-void INSERT_TRIM_SECTORS(sector_entry* pSE);
-int	EXIST_IN_TRIM_LIST(int64_t sector_nb);
-int	REMOVE_TRIM_SECTOR(int64_t sector_nb);
-//int	REMOVE_TRIM_SECTOR2(int64_t sector_nb, unsigned int length);
+#define TRIM_RANGE_NB		4096	// Pending ranges, the table goes to the FTL when it is full
 
+/* Trimmed sectors [sector_nb, sector_nb + length) */
+typedef struct trim_range
+{
+	int32_t sector_nb;
+	uint32_t length;
+}trim_range;
 
 void INIT_TRIM(void);
 void TERM_TRIM(void);
 
+void INSERT_TRIM_SECTORS(int64_t sector_nb, unsigned int length);
+void APPLY_TRIM_SECTORS(void);
+int FIND_TRIM_RANGE(int32_t sector_nb);
+
 #endif